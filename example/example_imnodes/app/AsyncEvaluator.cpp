@@ -0,0 +1,335 @@
+﻿#include "AsyncEvaluator.h"
+
+#include <algorithm>
+#include <chrono>
+
+AsyncEvaluator::AsyncEvaluator( MemoCache* memo )
+    : _pool( (int)std::thread::hardware_concurrency() ) {
+    _evaluator.SetMemo( memo );
+    _evaluator.SetCancel( &_cancel );
+    _optimizedEvaluator.SetMemo( memo );
+    _optimizedEvaluator.SetCancel( &_cancel );
+    _thread = std::thread( [ this ] { Work(); } );
+}
+
+AsyncEvaluator::~AsyncEvaluator() {
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _stop = true;
+        _cancel.store( true, std::memory_order_relaxed );
+    }
+    _wake.notify_one();
+    _thread.join();
+}
+
+AsyncEvaluator::Structure AsyncEvaluator::Diff( const Editor& editor ) {
+    Structure structure;
+    structure.revision = editor.revision;
+
+    // 增删节点都保持其余节点的相对顺序，按对象比较去掉首尾相同的部分，只处理中间一段
+    const size_t count = editor.nodes.size(), sent = _sent.size();
+    size_t prefix = 0;
+    while ( prefix < count && prefix < sent && _sent[ prefix ].node == editor.nodes[ prefix ].get() )
+        ++prefix;
+    size_t suffix = 0;
+    while ( suffix < count - prefix && suffix < sent - prefix
+            && _sent[ sent - 1 - suffix ].node == editor.nodes[ count - 1 - suffix ].get() )
+        ++suffix;
+    structure.prefix = prefix;
+    structure.oldEnd = sent - suffix;
+
+    // 中间一段按 id 与类型对应旧节点，对不上的复制；撤销、加载快照后对象换了，值也随之提交
+    std::unordered_map<int, size_t> old;
+    for ( size_t j = prefix; j < structure.oldEnd; ++j )
+        old.emplace( _sent[ j ].id, j );
+    std::vector<SentNode> middle;
+    for ( size_t i = prefix; i < count - suffix; ++i ) {
+        const NodeBase& node = *editor.nodes[ i ];
+        const auto found = old.find( node.node_id );
+        if ( found != old.end() && _sent[ found->second ].kind == node.kind ) {
+            const bool replaced = _sent[ found->second ].node != &node;
+            structure.middle.push_back( Slot{ (int64_t)found->second, nullptr, replaced } );
+            if ( replaced ) {
+                for ( uint32_t p = 0; p < node.pins.size(); ++p ) {
+                    if ( node.pins[ p ].ptype == PinType::Input && !node.pins[ p ].isLinked )
+                        structure.after.push_back( Edit{ node.node_id, p, node.pins[ p ].value } );
+                }
+            }
+            old.erase( found );
+        }
+        else {
+            structure.middle.push_back( Slot{ -1, CloneNode( node ) } );
+        }
+        middle.push_back( SentNode{ &node, node.node_id, node.kind } );
+    }
+    _sent.erase( _sent.begin() + prefix, _sent.begin() + structure.oldEnd );
+    _sent.insert( _sent.begin() + prefix, middle.begin(), middle.end() );
+
+    const auto same = []( const Link& a, const Link& b ) {
+        return a.id == b.id && a.start_attr == b.start_attr && a.end_attr == b.end_attr;
+    };
+    const size_t links = editor.links.size(), sentLinks = _sentLinks.size();
+    size_t linkPrefix = 0;
+    while ( linkPrefix < links && linkPrefix < sentLinks && same( _sentLinks[ linkPrefix ], editor.links[ linkPrefix ] ) )
+        ++linkPrefix;
+    size_t linkSuffix = 0;
+    while ( linkSuffix < links - linkPrefix && linkSuffix < sentLinks - linkPrefix
+            && same( _sentLinks[ sentLinks - 1 - linkSuffix ], editor.links[ links - 1 - linkSuffix ] ) )
+        ++linkSuffix;
+    structure.linkPrefix = linkPrefix;
+    structure.linkOldEnd = sentLinks - linkSuffix;
+    structure.links.assign( editor.links.begin() + linkPrefix, editor.links.end() - linkSuffix );
+    _sentLinks.erase( _sentLinks.begin() + linkPrefix, _sentLinks.begin() + structure.linkOldEnd );
+    _sentLinks.insert( _sentLinks.begin() + linkPrefix, structure.links.begin(), structure.links.end() );
+    return structure;
+}
+
+void AsyncEvaluator::Submit( const Editor& editor, const std::vector<NodeBase*>& edited ) {
+    Structure structure;
+    const bool changed = editor.revision != _submittedRevision;
+    if ( changed ) {
+        // 新节点在界面线程中复制，之后两边不再共享可变状态
+        structure = Diff( editor );
+        _submittedRevision = editor.revision;
+    }
+    std::vector<Edit> edits;
+    for ( const NodeBase* node : edited ) {
+        for ( uint32_t p = 0; p < node->pins.size(); ++p ) {
+            if ( node->pins[ p ].ptype == PinType::Input && !node->pins[ p ].isLinked )
+                edits.push_back( Edit{ node->node_id, p, node->pins[ p ].value } );
+        }
+    }
+    if ( !changed && edits.empty() )
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        // 结构变化按提交顺序排队，之前提交的值修改在它之前应用
+        if ( changed ) {
+            structure.before = std::move( _edits );
+            _edits.clear();
+            _structures.push_back( std::move( structure ) );
+        }
+        _edits.insert( _edits.end(), std::make_move_iterator( edits.begin() ), std::make_move_iterator( edits.end() ) );
+        ++_generation;
+        _hasJob = true;
+        _busy.store( true, std::memory_order_release );
+        _cancel.store( true, std::memory_order_relaxed );
+    }
+    _wake.notify_one();
+}
+
+void AsyncEvaluator::SetOptimize( const bool optimize ) {
+    if ( _optimize.exchange( optimize, std::memory_order_relaxed ) == optimize )
+        return;
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        ++_generation;
+        _hasJob = true;
+        _busy.store( true, std::memory_order_release );
+        _cancel.store( true, std::memory_order_relaxed );
+    }
+    _wake.notify_one();
+}
+
+bool AsyncEvaluator::Poll( Editor& editor ) {
+    if ( !( _middle.load( std::memory_order_acquire ) & Fresh ) )
+        return false;
+    _front = _middle.exchange( _front, std::memory_order_acq_rel ) & ~Fresh;
+    const Result& result = _buffers[ _front ];
+    // 结构已经又变了：新的结构正在求值，这份结果对不上，其中的改变留到下一个结果
+    if ( result.revision != editor.revision )
+        return false;
+
+    // 未连接的输入由界面修改，不覆盖
+    for ( const Result::Change& change : result.changes ) {
+        if ( change.node >= editor.nodes.size() || change.pin >= editor.nodes[ change.node ]->pins.size() )
+            continue;
+        Pin& pin = editor.nodes[ change.node ]->pins[ change.pin ];
+        pin.isLinked = change.linked;
+        if ( pin.ptype == PinType::Output || pin.isLinked ) {
+            pin.value = change.value;
+            pin.version = change.version;
+        }
+    }
+    _applied.store( result.sequence, std::memory_order_release );
+    return true;
+}
+
+void AsyncEvaluator::Work() {
+    std::unique_lock<std::mutex> lock( _mutex );
+    for ( ;; ) {
+        _wake.wait( lock, [ this ] { return _stop || _hasJob; } );
+        if ( _stop )
+            return;
+        std::vector<Structure> structures = std::move( _structures );
+        _structures.clear();
+        std::vector<Edit> edits = std::move( _edits );
+        _edits.clear();
+        const uint64_t generation = _generation;
+        _hasJob = false;
+        _cancel.store( false, std::memory_order_relaxed );
+        lock.unlock();
+
+        const bool optimize = _optimize.load( std::memory_order_relaxed );
+        for ( Structure& structure : structures ) {
+            Apply( structure.before, optimize );
+            Load( structure );
+            Apply( structure.after, optimize );
+        }
+        Apply( edits, optimize );
+        if ( optimize && _reoptimize ) {
+            GraphOptimizer::Options options;
+            options.variable = []( const Pin& pin ) { return pin.As<float>() != nullptr; };
+            _optimized = _optimizer.Optimize( _editor, options );
+            _reoptimize = false;
+        }
+        else if ( !optimize ) {
+            _reoptimize = true;
+        }
+
+        // 图中有环时不优化，求值原图
+        const bool useOptimized = optimize && _optimized;
+        Editor& graph = useOptimized ? _optimizer.Graph() : _editor;
+        GraphEvaluator& evaluator = useOptimized ? _optimizedEvaluator : _evaluator;
+        // 优化后的图求值期间原图的值由 Publish 同步，逐节点求值器的指令带寄存器已过期
+        if ( !useOptimized && _evaluatedOptimized )
+            _evaluator.SetTape( _evaluator.Tape() );
+        _evaluatedOptimized = useOptimized;
+        const bool single = _singleThread.load( std::memory_order_relaxed );
+        WorkStealingPool* pool = !single && graph.nodes.size() >= ParallelNodeCount ? &_pool : nullptr;
+        evaluator.Update( graph, pool );
+        if ( evaluator.Cancelled() )
+            _cancelledCount.fetch_add( 1, std::memory_order_relaxed );
+        else
+            Publish( generation, pool ? pool->ThreadCount() : 1, evaluator, useOptimized ? &_optimizer : nullptr );
+
+        lock.lock();
+        if ( !_hasJob )
+            _busy.store( false, std::memory_order_release );
+    }
+}
+
+void AsyncEvaluator::Load( Structure& structure ) {
+    // 不变的节点连同引脚的值与版本号原样保留，求值器重新排程时只计算新节点与连线变化影响到的下游
+    std::vector<std::shared_ptr<NodeBase>> old = std::move( _editor.nodes );
+    std::vector<int64_t> from;
+    from.reserve( old.size() - ( structure.oldEnd - structure.prefix ) + structure.middle.size() );
+    _editor.nodes.clear();
+    _editor.nodes.reserve( from.capacity() );
+    for ( size_t j = 0; j < structure.prefix; ++j ) {
+        _editor.nodes.push_back( std::move( old[ j ] ) );
+        from.push_back( (int64_t)j );
+    }
+    for ( Slot& slot : structure.middle ) {
+        _editor.nodes.push_back( slot.from >= 0 ? std::move( old[ slot.from ] ) : std::move( slot.node ) );
+        from.push_back( slot.from );
+    }
+    for ( size_t j = structure.oldEnd; j < old.size(); ++j ) {
+        _editor.nodes.push_back( std::move( old[ j ] ) );
+        from.push_back( (int64_t)j );
+    }
+
+    std::vector<Link>& links = _editor.links;
+    links.erase( links.begin() + structure.linkPrefix, links.begin() + structure.linkOldEnd );
+    links.insert( links.begin() + structure.linkPrefix, structure.links.begin(), structure.links.end() );
+    _editor.revision = structure.revision;
+    _indexed = false;
+    _reoptimize = true;
+
+    // 引脚发布状态随节点移动；新节点与界面换了对象的节点连接状态未知，下一个结果一定包含它们
+    std::vector<uint32_t> pinBegin{ 0 };
+    std::vector<PinState> pins;
+    pinBegin.reserve( _editor.nodes.size() + 1 );
+    pins.reserve( _pins.size() );
+    for ( size_t i = 0; i < _editor.nodes.size(); ++i ) {
+        const std::pmr::vector<Pin>& nodePins = _editor.nodes[ i ]->pins;
+        const bool replaced = i >= structure.prefix && i < structure.prefix + structure.middle.size()
+                              && structure.middle[ i - structure.prefix ].replaced;
+        if ( from[ i ] >= 0 && (size_t)from[ i ] + 1 < _pinBegin.size() && !replaced ) {
+            const uint32_t begin = _pinBegin[ from[ i ] ];
+            const uint32_t end = std::min<uint32_t>( _pinBegin[ from[ i ] + 1 ], begin + (uint32_t)nodePins.size() );
+            pins.insert( pins.end(), _pins.begin() + begin, _pins.begin() + end );
+        }
+        while ( pins.size() < pinBegin.back() + nodePins.size() )
+            pins.push_back( PinState{ nodePins[ pins.size() - pinBegin.back() ].version, 0, 2 } );
+        pinBegin.push_back( (uint32_t)pins.size() );
+    }
+    _pinBegin = std::move( pinBegin );
+    _pins = std::move( pins );
+}
+
+void AsyncEvaluator::Apply( std::vector<Edit>& edits, const bool optimize ) {
+    if ( !_indexed ) {
+        _index.clear();
+        for ( uint32_t i = 0; i < _editor.nodes.size(); ++i )
+            _index.emplace( _editor.nodes[ i ]->node_id, i );
+        _indexed = true;
+    }
+    // 原图始终记录修改，关闭优化后从这里继续增量求值；优化后的图中仍存在的参数修改直接转发
+    for ( Edit& edit : edits ) {
+        const auto found = _index.find( edit.node );
+        if ( found == _index.end() || edit.pin >= _editor.nodes[ found->second ]->pins.size() )
+            continue;
+        const uint32_t index = found->second;
+        NodeBase& node = *_editor.nodes[ index ];
+        // 与原值相同的数值不算修改，加载快照后未变的输入不会引起重新计算
+        const float* number = edit.value.As<float>();
+        const float* current = node.pins[ edit.pin ].As<float>();
+        if ( number && current && *number == *current )
+            continue;
+        NodeBase* live = optimize && !_reoptimize ? _optimizer.Live( index ) : nullptr;
+        if ( live && _optimizer.Variable( index, edit.pin ) && number ) {
+            live->pins[ edit.pin ].Assign( edit.value );
+            _optimizedEvaluator.MarkDirty( *live );
+        }
+        else {
+            _reoptimize = true;
+        }
+        node.pins[ edit.pin ].Assign( std::move( edit.value ) );
+        _evaluator.MarkDirty( node );
+    }
+}
+
+void AsyncEvaluator::Publish( const uint64_t generation, const int threads, const GraphEvaluator& evaluator,
+                              const GraphOptimizer* optimizer ) {
+    Result& result = _buffers[ _back ];
+    result.revision = _editor.revision;
+    result.generation = generation;
+    result.sequence = ++_sequence;
+    result.changes.clear();
+    // 界面还没应用的结果中的改变也要带上，界面跳过的结果不会丢失改变
+    const uint64_t applied = _applied.load( std::memory_order_acquire );
+    // 优化后按原图的引脚取值：折叠、合并的节点取常量或保留节点的值，消除的节点保持原值。
+    // 取到的值同时写回原图，之后断开连线的输入保留界面显示的值，关闭优化后也从这些值继续增量求值
+    for ( uint32_t i = 0; i < _editor.nodes.size(); ++i ) {
+        std::pmr::vector<Pin>& pins = _editor.nodes[ i ]->pins;
+        for ( uint32_t p = 0; p < pins.size(); ++p ) {
+            const Pin* resolved = optimizer ? optimizer->Resolve( i, p ) : nullptr;
+            if ( resolved && resolved->version != pins[ p ].version
+                 && ( pins[ p ].ptype == PinType::Output || pins[ p ].isLinked ) ) {
+                pins[ p ].value = resolved->value;
+                pins[ p ].version = resolved->version;
+            }
+            const Pin& pin = resolved ? *resolved : pins[ p ];
+            PinState& state = _pins[ _pinBegin[ i ] + p ];
+            const uint8_t linked = pins[ p ].isLinked;
+            if ( state.version != pin.version || state.linked != linked ) {
+                state.version = pin.version;
+                state.linked = linked;
+                state.changedAt = result.sequence;
+            }
+            if ( state.changedAt > applied )
+                result.changes.push_back( Result::Change{ i, p, linked != 0, pin.value, pin.version } );
+        }
+    }
+    result.computed = evaluator.ComputedCount();
+    result.scheduled = evaluator.ScheduledCount();
+    result.blocked = evaluator.BlockedCount();
+    result.ms = evaluator.LastMs();
+    result.tape = evaluator.UsedTape();
+    result.threads = threads;
+    result.optimized = optimizer != nullptr;
+    result.optimization = optimizer ? optimizer->LastReport() : GraphOptimizer::Report{};
+    _back = _middle.exchange( _back | Fresh, std::memory_order_acq_rel ) & ~Fresh;
+}
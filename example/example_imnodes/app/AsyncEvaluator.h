@@ -0,0 +1,168 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Editor.h"
+#include "Evaluator.h"
+#include "GraphOptimizer.h"
+#include "MemoCache.h"
+#include "WorkStealingPool.h"
+
+// 后台求值。界面线程提交模型的修改后立即返回，后台线程在自己的模型副本上求值，界面线程从不等待计算：
+// 结构变化（增删节点或连线、撤销、导入、加载）时只提交与上次提交相比不同的节点与连线，后台就地修改副本，
+// id 与类型不变的节点保留引脚的值与版本号，因此只计算新节点与连线变化影响到的下游；只修改了输入值时只提交这些值。
+// 结果通过三个缓冲发布：后台写完一个缓冲后与“最新”缓冲原子交换，界面每帧取走最新的一个，双方都不加锁。
+// 每个结果只包含界面最近应用的结果之后改变的引脚，界面应用结果的代价与改变的引脚数成正比。
+// 求值中途有新的提交时当前求值被取消，未计算的节点留到下一次继续。
+// 开启优化时求值 GraphOptimizer 优化后的图：未连接的标量输入是参数，列是常量。只修改参数时增量求值优化后的图，
+// 结构或常量变化时重新优化
+class AsyncEvaluator {
+public:
+    // 一次求值的结果：与界面最近应用的结果相比改变了值或连接状态的引脚，node 与 pin 为 revision 时的下标
+    struct Result {
+        struct Change {
+            uint32_t node;
+            uint32_t pin;
+            bool linked;
+            PinValue value;
+            uint64_t version;
+        };
+        uint64_t revision = 0;
+        uint64_t generation = 0;
+        uint64_t sequence = 0;
+        std::vector<Change> changes;
+        size_t computed = 0;
+        size_t scheduled = 0;
+        size_t blocked = 0;
+        double ms = 0.0;
+        bool tape = false;
+        int threads = 1;
+        // 是否求值的是优化后的图，以及优化节省的节点
+        bool optimized = false;
+        GraphOptimizer::Report optimization;
+    };
+
+    explicit AsyncEvaluator( MemoCache* memo = nullptr );
+    ~AsyncEvaluator();
+
+    AsyncEvaluator( const AsyncEvaluator& ) = delete;
+    AsyncEvaluator& operator=( const AsyncEvaluator& ) = delete;
+
+    // 在界面线程中调用。结构变化时提交与上次提交相比不同的节点与连线，并提交 edited 中节点的输入值；
+    // 没有修改时什么也不做
+    void Submit( const Editor& editor, const std::vector<NodeBase*>& edited );
+    // 在界面线程中调用。有新的结果且与 editor 的结构一致时写入改变的输出引脚与连接的输入引脚，返回是否写入
+    bool Poll( Editor& editor );
+    // 最近一次取走的结果，只在界面线程中读取
+    const Result& Latest() const { return _buffers[ _front ]; }
+
+    // 后台是否有尚未完成的求值
+    bool Busy() const { return _busy.load( std::memory_order_acquire ); }
+    // 被新的提交取消的求值次数
+    size_t CancelledCount() const { return _cancelledCount.load( std::memory_order_relaxed ); }
+    // 节点较多时并行求值，关闭后逐节点求值
+    void SetSingleThread( const bool single ) { _singleThread.store( single, std::memory_order_relaxed ); }
+    // 开启或关闭求值前的图优化，改变时重新求值
+    void SetOptimize( bool optimize );
+
+private:
+    static constexpr size_t ParallelNodeCount = 4096;
+
+    // 未连接的输入值的修改，节点按 id 查找
+    struct Edit {
+        int node;
+        uint32_t pin;
+        PinValue value;
+    };
+    // 结构变化：上次提交的节点序列中前 prefix 个与从 oldEnd 开始的节点不变，中间一段换成 middle。
+    // middle 中的节点取自旧序列的 from 位置，from 为 -1 时是界面线程复制的新节点。连线同样处理。
+    // replaced 表示界面换了节点对象，下一个结果要重新发送它的全部引脚
+    struct Slot {
+        int64_t from;
+        std::shared_ptr<NodeBase> node;
+        bool replaced = false;
+    };
+    struct Structure {
+        uint64_t revision = 0;
+        size_t prefix = 0, oldEnd = 0;
+        std::vector<Slot> middle;
+        size_t linkPrefix = 0, linkOldEnd = 0;
+        std::vector<Link> links;
+        // 这次结构变化之前提交的值修改，以及 id 与类型不变但界面换了节点对象（加载快照等）时的输入值
+        std::vector<Edit> before, after;
+    };
+    // 后台记录的每个引脚最近发布的版本号与连接状态，以及最近一次改变所在结果的序号
+    struct PinState {
+        uint64_t version;
+        uint64_t changedAt;
+        uint8_t linked;
+    };
+    // 上次提交的节点，界面线程据此比较出结构变化
+    struct SentNode {
+        const NodeBase* node;
+        int id;
+        NodeKind kind;
+    };
+
+    Structure Diff( const Editor& editor );
+    void Work();
+    void Load( Structure& structure );
+    void Apply( std::vector<Edit>& edits, bool optimize );
+    void Publish( uint64_t generation, int threads, const GraphEvaluator& evaluator, const GraphOptimizer* optimizer );
+
+    // 界面线程与后台线程之间的提交，由 _mutex 保护
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::vector<Structure> _structures;
+    std::vector<Edit> _edits;
+    uint64_t _generation = 0;
+    bool _hasJob = false;
+    bool _stop = false;
+    std::atomic<bool> _cancel = false;
+    std::atomic<bool> _busy = false;
+    std::atomic<size_t> _cancelledCount = 0;
+    std::atomic<bool> _singleThread = false;
+    std::atomic<bool> _optimize = false;
+
+    // 界面最近应用的结果的序号
+    std::atomic<uint64_t> _applied = 0;
+
+    // 只在界面线程中使用
+    uint64_t _submittedRevision = ~0ull;
+    std::vector<SentNode> _sent;
+    std::vector<Link> _sentLinks;
+
+    // 只在后台线程中使用
+    Editor _editor;
+    // 节点 id 到 _editor.nodes 下标，结构变化后在需要时重建
+    std::unordered_map<int, uint32_t> _index;
+    bool _indexed = false;
+    // 按节点、引脚顺序排列的引脚发布状态
+    std::vector<uint32_t> _pinBegin{ 0 };
+    std::vector<PinState> _pins;
+    uint64_t _sequence = 0;
+    GraphEvaluator _evaluator;
+    WorkStealingPool _pool;
+    // 优化后的图与它的求值器。_editor 的结构或常量改变后需要重新优化
+    GraphOptimizer _optimizer;
+    GraphEvaluator _optimizedEvaluator;
+    bool _optimized = false;
+    bool _reoptimize = true;
+    // 上一次求值的是否是优化后的图
+    bool _evaluatedOptimized = false;
+
+    // 三个结果缓冲：_front 归界面线程，_back 归后台线程，_middle 为最近发布的一个，带 Fresh 标记表示界面还没取走
+    static constexpr uint8_t Fresh = 4;
+    Result _buffers[ 3 ];
+    std::atomic<uint8_t> _middle = 1;
+    uint8_t _front = 0;
+    uint8_t _back = 2;
+
+    std::thread _thread;
+};
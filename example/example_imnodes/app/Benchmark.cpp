@@ -0,0 +1,1377 @@
+﻿#include "imnodes_internal.h"
+
+#include "AsyncEvaluator.h"
+#include "Benchmark.h"
+#include "Evaluator.h"
+#include "GraphImport.h"
+#include "GraphOptimizer.h"
+#include "Snapshot.h"
+#include "StreamPipeline.h"
+#include "TopologicalOrder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+double ElapsedMs( const std::chrono::steady_clock::time_point& start ) {
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+// 与 imnodes 中连线曲线的控制点计算方式一致
+ImVector<ImLinkBatchEntry> MakeLinks( const int count ) {
+    std::mt19937 rng( 42 );
+    std::uniform_real_distribution<float> pos( 0.0f, 2000.0f );
+    std::uniform_int_distribution<int> segments( 4, 40 );
+
+    ImVector<ImLinkBatchEntry> links;
+    links.reserve( count );
+    for ( int i = 0; i < count; ++i ) {
+        ImLinkBatchEntry entry;
+        entry.P0 = ImVec2( pos( rng ), pos( rng ) );
+        entry.P3 = ImVec2( pos( rng ), pos( rng ) );
+        const float offset = 0.25f * ImFabs( entry.P3.x - entry.P0.x );
+        entry.P1 = ImVec2( entry.P0.x + offset, entry.P0.y );
+        entry.P2 = ImVec2( entry.P3.x - offset, entry.P3.y );
+        entry.NumSegments = segments( rng );
+        entry.Color = IM_COL32( 200, 200, 100, 255 );
+        entry.Thickness = ImNodes::GetStyle().LinkThickness;
+        entry.AntiAliased = true;
+        links.push_back( entry );
+    }
+    return links;
+}
+
+// 在指定编辑器中创建随机位置的节点
+void MakeNodes( ImNodesEditorContext* editor, const int count ) {
+    std::mt19937 rng( 7 );
+    std::uniform_int_distribution<int> pos( -20000, 20000 );
+
+    ImNodesEditorContext* previous = &ImNodes::EditorContextGet();
+    ImNodes::EditorContextSet( editor );
+    for ( int i = 0; i < count; ++i ) {
+        const int idx = ImNodes::ObjectPoolFindOrCreateIndex( editor->Nodes, i * 3 + 1 );
+        editor->Nodes.Pool[ idx ].Origin = ImVec2( (float)pos( rng ), (float)pos( rng ) );
+    }
+    editor->Panning = ImVec2( 123.0f, -45.0f );
+    ImNodes::EditorContextSet( previous );
+}
+
+// 比较两个编辑器中使用中节点的 id、位置及平移量
+bool SameEditorState( const ImNodesEditorContext& a, const ImNodesEditorContext& b ) {
+    if ( a.Panning.x != b.Panning.x || a.Panning.y != b.Panning.y )
+        return false;
+    int count = 0;
+    for ( int i = 0; i < a.Nodes.Pool.Size; ++i ) {
+        if ( !a.Nodes.InUse[ i ] )
+            continue;
+        const ImNodeData& node = a.Nodes.Pool[ i ];
+        const int idx = ImNodes::ObjectPoolFind( b.Nodes, node.Id );
+        if ( idx < 0 || !b.Nodes.InUse[ idx ] )
+            return false;
+        const ImVec2 origin = b.Nodes.Pool[ idx ].Origin;
+        if ( origin.x != node.Origin.x || origin.y != node.Origin.y )
+            return false;
+        ++count;
+    }
+    for ( int i = 0; i < b.Nodes.InUse.Size; ++i )
+        count -= b.Nodes.InUse[ i ] ? 1 : 0;
+    return count == 0 && b.NodeDepthOrder.Size == b.Nodes.Pool.Size;
+}
+
+// 旧版 INI 解析器（逐行 sscanf、逐个创建节点），仅作为性能对比基准
+void LegacyNodeLineHandler( ImNodesEditorContext& editor, const char* line ) {
+    int id;
+    int x, y;
+    if ( sscanf( line, "[node.%i", &id ) == 1 ) {
+        const int nodeIdx = ImNodes::ObjectPoolFindOrCreateIndex( editor.Nodes, id );
+        GImNodes->CurrentNodeIdx = nodeIdx;
+        editor.Nodes.Pool[ nodeIdx ].Id = id;
+    }
+    else if ( sscanf( line, "origin=%i,%i", &x, &y ) == 2 ) {
+        ImNodeData& node = editor.Nodes.Pool[ GImNodes->CurrentNodeIdx ];
+        node.Origin = ImVec2( (float)x, (float)y );
+    }
+}
+
+void LegacyEditorLineHandler( ImNodesEditorContext& editor, const char* line ) {
+    (void)sscanf( line, "panning=%f,%f", &editor.Panning.x, &editor.Panning.y );
+}
+
+// 调用前需将 editor 设为当前编辑器
+void LegacyLoadIniString( ImNodesEditorContext& editor, const char* data, size_t dataSize ) {
+    char* buf = (char*)ImGui::MemAlloc( dataSize + 1 );
+    const char* bufEnd = buf + dataSize;
+    memcpy( buf, data, dataSize );
+    buf[ dataSize ] = 0;
+
+    void ( *lineHandler )( ImNodesEditorContext&, const char* ) = nullptr;
+    char* lineEnd = nullptr;
+    for ( char* line = buf; line < bufEnd; line = lineEnd + 1 ) {
+        while ( *line == '\n' || *line == '\r' )
+            line++;
+        lineEnd = line;
+        while ( lineEnd < bufEnd && *lineEnd != '\n' && *lineEnd != '\r' )
+            lineEnd++;
+        lineEnd[ 0 ] = 0;
+        if ( *line == ';' || *line == '\0' )
+            continue;
+
+        if ( line[ 0 ] == '[' && lineEnd[ -1 ] == ']' ) {
+            lineEnd[ -1 ] = 0;
+            if ( strncmp( line + 1, "node", 4 ) == 0 )
+                lineHandler = LegacyNodeLineHandler;
+            else if ( strcmp( line + 1, "editor" ) == 0 )
+                lineHandler = LegacyEditorLineHandler;
+        }
+        if ( lineHandler )
+            lineHandler( editor, line );
+    }
+    ImGui::MemFree( buf );
+}
+
+// 生成一个 nodeCount 个节点、每个节点约两条出边的图文件，返回文件大小
+size_t WriteGraphFile( const std::string& path, const GraphFormat format, const int nodeCount ) {
+    std::mt19937 rng( 11 );
+    std::uniform_int_distribution<int> target( 0, nodeCount - 1 );
+    FILE* file = ImFileOpen( path.c_str(), "wb" );
+    if ( !file )
+        return 0;
+    if ( format == GraphFormat::Dot ) {
+        fprintf( file, "digraph pipeline {\n    node [shape=box];\n" );
+        for ( int i = 0; i < nodeCount; ++i )
+            fprintf( file, "    \"task_%d\" [type=%s, label=\"step %d\"];\n", i, i % 3 ? "Add" : "Sub", i );
+        for ( int i = 0; i < nodeCount; ++i )
+            fprintf( file, "    \"task_%d\" -> \"task_%d\" -> \"task_%d\";\n", i, target( rng ), target( rng ) );
+        fprintf( file, "}\n" );
+    }
+    else {
+        fprintf( file, "{\n  \"nodes\": [\n" );
+        for ( int i = 0; i < nodeCount; ++i ) {
+            const char* separator = i + 1 < nodeCount ? "," : "";
+            fprintf( file, "    { \"id\": \"task_%d\", \"type\": \"%s\" }%s\n", i, i % 3 ? "Add" : "Sub", separator );
+        }
+        fprintf( file, "  ],\n  \"edges\": [\n" );
+        for ( int i = 0; i < nodeCount; ++i ) {
+            fprintf( file, "    { \"from\": \"task_%d\", \"to\": \"task_%d\" },\n", i, target( rng ) );
+            fprintf( file, "    [ \"task_%d\", \"task_%d\" ]%s\n", i, target( rng ), i + 1 < nodeCount ? "," : "" );
+        }
+        fprintf( file, "  ]\n}\n" );
+    }
+    const size_t size = (size_t)ftell( file );
+    fclose( file );
+    return size;
+}
+
+// 只计数的解析结果接收者
+class CountingSink : public GraphSink {
+public:
+    void OnNode( NodeKind ) override { ++nodes; }
+    void OnEdge( int, int ) override { ++edges; }
+
+    int nodes = 0;
+    int edges = 0;
+};
+
+// 快照测试用的节点 id 起始值，避开 UniqueId 分配的 id
+constexpr int SnapshotBaseId = 1 << 28;
+
+// 创建 nodeCount 个随机位置的节点，相邻节点首尾相连
+void MakeEditor( Editor& editor, const int nodeCount ) {
+    std::mt19937 rng( 5 );
+    std::uniform_int_distribution<int> pos( -20000, 20000 );
+
+    editor.context = ImNodes::EditorContextCreate();
+    ImNodesEditorContext* previous = &ImNodes::EditorContextGet();
+    ImNodes::EditorContextSet( editor.context );
+    editor.nodes.reserve( nodeCount );
+    for ( int i = 0; i < nodeCount; ++i ) {
+        const NodeKind kind = i % 3 ? NodeKind::Add : NodeKind::Sub;
+        editor.nodes.push_back( MakeNode( kind, SnapshotBaseId + i * NodeBase::IdStride ) );
+        ImNodes::SetNodeGridSpacePos( editor.nodes.back()->node_id, ImVec2( (float)pos( rng ), (float)pos( rng ) ) );
+    }
+    for ( int i = 1; i < nodeCount; ++i ) {
+        const int startAttr = editor.nodes[ i - 1 ]->pins.back().pid;
+        editor.links.emplace_back( -i, startAttr, editor.nodes[ i ]->pins.front().pid );
+    }
+    editor.current_id = nodeCount;
+    ImNodes::EditorContextSet( previous );
+}
+
+// 随机 DAG：前 1% 的节点是源节点，其余节点的两个输入各连到任意一个更早节点的输出，图宽而浅
+void MakeDag( Editor& editor, const int nodeCount ) {
+    std::mt19937 rng( 11 );
+    editor.context = ImNodes::EditorContextCreate();
+    editor.nodes.reserve( nodeCount );
+    const int sources = nodeCount / 100 + 1;
+    for ( int i = 0; i < nodeCount; ++i ) {
+        const NodeKind kind = rng() % 3 ? NodeKind::Add : NodeKind::Sub;
+        editor.nodes.push_back( MakeNode( kind, SnapshotBaseId + i * NodeBase::IdStride ) );
+        NodeBase& node = *editor.nodes.back();
+        for ( Pin& pin : node.pins )
+            pin.Set( (float)( rng() % 16 ) * 0.125f );
+        if ( i < sources )
+            continue;
+        for ( int p = 0; p < 2; ++p ) {
+            const NodeBase& from = *editor.nodes[ rng() % (unsigned)i ];
+            const int output = from.kind == NodeKind::Sub ? 2 + (int)( rng() % 2 ) : 2;
+            editor.links.emplace_back( -(int)editor.links.size() - 1, from.pins[ output ].pid, node.pins[ p ].pid );
+        }
+    }
+}
+
+// 长度为 chainLength 的 Add / Sub 链：每个节点的 B 是一列，第一个节点的 A 也是一列，其余节点的 A 连到上一个节点的 C
+void MakeColumnChain( Editor& editor, const int chainLength, const int rows, std::vector<ColumnPtr>& columns ) {
+    std::mt19937 rng( 17 );
+    editor.context = ImNodes::EditorContextCreate();
+    for ( int i = 0; i <= chainLength; ++i ) {
+        auto column = std::make_shared<Column>( ColumnType::Float, rows );
+        float* data = (float*)column->Data();
+        for ( int r = 0; r < rows; ++r )
+            data[ r ] = (float)( rng() % 64 ) * 0.125f;
+        columns.push_back( std::move( column ) );
+    }
+    for ( int i = 0; i < chainLength; ++i ) {
+        editor.nodes.push_back( MakeNode( i % 2 ? NodeKind::Sub : NodeKind::Add, SnapshotBaseId + i * NodeBase::IdStride ) );
+        NodeBase& node = *editor.nodes.back();
+        node.pins[ 1 ].Assign( columns[ i + 1 ] );
+        if ( i == 0 )
+            node.pins[ 0 ].Assign( columns[ 0 ] );
+        else
+            editor.links.emplace_back( -i, editor.nodes[ i - 1 ]->pins[ 2 ].pid, node.pins[ 0 ].pid );
+    }
+}
+
+// 与 MakeDag 相同的随机 DAG，但每 4 个节点中有一个复制之前某个节点的类型与输入来源。
+// 偶数序号源节点的 B 是参数，放入 variables；奇数序号的源节点全是常量。最后 10% 的节点是输出
+void MakeRedundantDag( Editor& editor, const int nodeCount, std::unordered_set<int>& variables, std::vector<int>& outputs ) {
+    std::mt19937 rng( 23 );
+    editor.context = ImNodes::EditorContextCreate();
+    editor.nodes.reserve( nodeCount );
+    const int sources = nodeCount / 100 + 1;
+    // 每个节点两个输入的来源：节点序号与输出引脚序号
+    std::vector<std::pair<int, int>> inputs( (size_t)nodeCount * 2 );
+    for ( int i = 0; i < nodeCount; ++i ) {
+        NodeKind kind = rng() % 3 ? NodeKind::Add : NodeKind::Sub;
+        const int copy = i > sources && i % 4 == 0 ? sources + (int)( rng() % (unsigned)( i - sources ) ) : -1;
+        if ( copy >= 0 )
+            kind = editor.nodes[ copy ]->kind;
+        editor.nodes.push_back( MakeNode( kind, SnapshotBaseId + i * NodeBase::IdStride ) );
+        NodeBase& node = *editor.nodes.back();
+        for ( Pin& pin : node.pins )
+            pin.Set( (float)( rng() % 16 ) * 0.125f );
+        if ( i < sources ) {
+            if ( i % 2 == 0 )
+                variables.insert( node.pins[ 1 ].pid );
+            continue;
+        }
+        for ( int p = 0; p < 2; ++p ) {
+            std::pair<int, int>& input = inputs[ i * 2 + p ];
+            if ( copy >= 0 ) {
+                input = inputs[ copy * 2 + p ];
+            }
+            else {
+                input.first = (int)( rng() % (unsigned)i );
+                input.second = editor.nodes[ input.first ]->kind == NodeKind::Sub ? 2 + (int)( rng() % 2 ) : 2;
+            }
+            const int startAttr = editor.nodes[ input.first ]->pins[ input.second ].pid;
+            editor.links.emplace_back( -(int)editor.links.size() - 1, startAttr, node.pins[ p ].pid );
+        }
+    }
+    for ( int i = nodeCount - nodeCount / 10; i < nodeCount; ++i )
+        outputs.push_back( editor.nodes[ i ]->node_id );
+}
+
+// 比较两个编辑器的节点类型、引脚、连线与布局
+bool SameModel( const Editor& a, const Editor& b ) {
+    if ( a.nodes.size() != b.nodes.size() || a.links.size() != b.links.size() || a.current_id != b.current_id )
+        return false;
+    for ( size_t i = 0; i < a.nodes.size(); ++i ) {
+        const NodeBase& x = *a.nodes[ i ];
+        const NodeBase& y = *b.nodes[ i ];
+        if ( x.node_id != y.node_id || x.kind != y.kind || x.name != y.name || x.pins.size() != y.pins.size() )
+            return false;
+        for ( size_t p = 0; p < x.pins.size(); ++p ) {
+            if ( x.pins[ p ].pid != y.pins[ p ].pid || x.pins[ p ].ptype != y.pins[ p ].ptype ||
+                 x.pins[ p ].Number() != y.pins[ p ].Number() )
+                return false;
+        }
+    }
+    for ( size_t i = 0; i < a.links.size(); ++i ) {
+        const Link& x = a.links[ i ];
+        const Link& y = b.links[ i ];
+        if ( x.id != y.id || x.start_attr != y.start_attr || x.end_attr != y.end_attr )
+            return false;
+    }
+    return SameEditorState( *a.context, *b.context );
+}
+
+}  // namespace
+
+void BenchmarkPanel::Draw() {
+    ImGui::Begin( "Benchmark" );
+
+    ImGui::SetNextItemWidth( 120.0f );
+    ImGui::InputInt( "Links", &_linkCount, 1000, 10000 );
+    ImGui::SetNextItemWidth( 120.0f );
+    ImGui::InputInt( "Iterations", &_iterations );
+    _linkCount = ImClamp( _linkCount, 1, 1000000 );
+    ImGui::SetNextItemWidth( 120.0f );
+    ImGui::InputInt( "Nodes", &_nodeCount, 1000, 100000 );
+    _iterations = ImClamp( _iterations, 1, 1000 );
+    _nodeCount = ImClamp( _nodeCount, 1, 1000000 );
+
+    if ( ImGui::Button( "Link batch" ) )
+        RunLinkBatch();
+    ImGui::SameLine();
+    if ( ImGui::Button( "Editor state" ) )
+        RunEditorState();
+    ImGui::SameLine();
+    if ( ImGui::Button( "INI parser" ) )
+        RunIniParser();
+    ImGui::SameLine();
+    if ( ImGui::Button( "Graph import" ) )
+        RunGraphImport();
+    ImGui::SameLine();
+    if ( ImGui::Button( "Snapshot" ) )
+        RunSnapshot();
+    ImGui::SameLine();
+    if ( ImGui::Button( "Evaluate" ) )
+        RunEvaluate();
+    ImGui::SameLine();
+    if ( ImGui::Button( "Parallel evaluate" ) )
+        RunParallelEvaluate();
+    ImGui::SameLine();
+    if ( ImGui::Button( "Columns" ) )
+        RunColumns();
+    ImGui::SameLine();
+    if ( ImGui::Button( "Tape" ) )
+        RunTape();
+    ImGui::SameLine();
+    if ( ImGui::Button( "Memo" ) )
+        RunMemo();
+    ImGui::SameLine();
+    if ( ImGui::Button( "Topology" ) )
+        RunTopology();
+    ImGui::SameLine();
+    if ( ImGui::Button( "Async" ) )
+        RunAsync();
+    ImGui::SameLine();
+    if ( ImGui::Button( "Stream" ) )
+        RunStream();
+    ImGui::SameLine();
+    if ( ImGui::Button( "Optimize" ) )
+        RunOptimize();
+
+    _log.Draw();
+
+    ImGui::End();
+}
+
+void BenchmarkPanel::RunLinkBatch() {
+    const ImVector<ImLinkBatchEntry> links = MakeLinks( _linkCount );
+    // 低细节连线：细线、不做抗锯齿、线段数减半
+    ImVector<ImLinkBatchEntry> lodLinks = links;
+    for ( ImLinkBatchEntry& e : lodLinks ) {
+        e.NumSegments = ImMax( e.NumSegments / 2, 1 );
+        e.Thickness = ImNodes::GetStyle().LinkLodThickness;
+        e.AntiAliased = false;
+    }
+
+    // 使用独立的 ImDrawList，结果不参与渲染
+    ImDrawList drawList( ImGui::GetDrawListSharedData() );
+    const ImDrawListFlags flags = ImGui::GetWindowDrawList()->Flags;
+    auto run = [ & ]( const ImVector<ImLinkBatchEntry>& links, const int mode ) {
+        const auto start = std::chrono::steady_clock::now();
+        for ( int i = 0; i < _iterations; ++i ) {
+            drawList._ResetForNewFrame();
+            drawList.Flags = flags;
+            drawList.PushClipRectFullScreen();
+            drawList.PushTextureID( ImGui::GetIO().Fonts->TexID );
+            if ( mode < 0 ) {
+                for ( const ImLinkBatchEntry& e : links )
+                    drawList.AddBezierCubic( e.P0, e.P1, e.P2, e.P3, e.Color, e.Thickness, e.NumSegments );
+            }
+            else {
+                ImNodes::LinkBatchRender( &drawList, links.Data, links.Size, mode );
+            }
+        }
+        return ElapsedMs( start ) / _iterations;
+    };
+
+    const double reference = run( links, -1 );
+    const int vtxCount = drawList.VtxBuffer.Size;
+    const double scalar = run( links, ImNodesLinkBatchKernel_Scalar );
+    const double simd = run( links, ImNodesLinkBatchKernel_Simd );
+    const double lod = run( lodLinks, ImNodesLinkBatchKernel_Simd );
+    const int lodVtxCount = drawList.VtxBuffer.Size;
+    const char* isa = ImNodes::LinkBatchSimdInstructionSet();
+
+    _log.AddLog( "Link batch: %d links, %d vertices", _linkCount, vtxCount );
+    _log.AddLog( "  AddBezierCubic %.3f ms", reference );
+    _log.AddLog( "  Scalar         %.3f ms (x%.2f)", scalar, reference / scalar );
+    _log.AddLog( "  SIMD (%s) %.3f ms (x%.2f)", isa ? isa : "none", simd, reference / simd );
+    _log.AddLog( "  SIMD, LOD      %.3f ms (x%.2f), %d vertices", lod, reference / lod, lodVtxCount );
+}
+
+void BenchmarkPanel::RunEditorState() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string iniPath = ( dir / "imnodes_benchmark.ini" ).string();
+    const std::string binPath = ( dir / "imnodes_benchmark.bin" ).string();
+
+    ImNodesEditorContext* source = ImNodes::EditorContextCreate();
+    ImNodesEditorContext* fromIni = ImNodes::EditorContextCreate();
+    ImNodesEditorContext* fromBin = ImNodes::EditorContextCreate();
+    MakeNodes( source, _nodeCount );
+
+    // 加载函数会在当前编辑器中创建节点，测试期间切换到目标编辑器
+    ImNodesEditorContext* previous = &ImNodes::EditorContextGet();
+
+    auto start = std::chrono::steady_clock::now();
+    ImNodes::SaveEditorStateToIniFile( source, iniPath.c_str() );
+    const double iniSave = ElapsedMs( start );
+
+    ImNodes::EditorContextSet( fromIni );
+    start = std::chrono::steady_clock::now();
+    ImNodes::LoadEditorStateFromIniFile( fromIni, iniPath.c_str() );
+    const double iniLoad = ElapsedMs( start );
+
+    start = std::chrono::steady_clock::now();
+    const bool saved = ImNodes::SaveEditorStateToBinaryFile( source, binPath.c_str() );
+    const double binSave = ElapsedMs( start );
+
+    ImNodes::EditorContextSet( fromBin );
+    start = std::chrono::steady_clock::now();
+    const bool loaded = ImNodes::LoadEditorStateFromBinaryFile( fromBin, binPath.c_str() );
+    const double binLoad = ElapsedMs( start );
+    ImNodes::EditorContextSet( previous );
+
+    // 异步保存：界面线程只复制节点状态，格式化与写盘在后台线程完成
+    start = std::chrono::steady_clock::now();
+    ImNodes::SaveEditorStateToIniFileAsync( source, iniPath.c_str() );
+    const double asyncCall = ElapsedMs( start );
+    ImNodes::WaitForEditorStateSaves();
+    const double asyncTotal = ElapsedMs( start );
+
+    const bool roundTrip = saved && loaded && SameEditorState( *source, *fromBin );
+    // INI 格式按整数保存坐标，源节点坐标均为整数，因此也应一致
+    const bool iniRoundTrip = SameEditorState( *source, *fromIni );
+
+    // 截断或当前版本无法读取的数据应被拒绝，且不修改编辑器；只追加字段的新版本仍可读取
+    size_t size = 0;
+    const char* data = (const char*)ImNodes::SaveEditorStateToBinaryMemory( source, &size );
+    std::string corrupt( data, size );
+    const bool rejectsTruncated =
+        !ImNodes::LoadEditorStateFromBinaryMemory( fromBin, corrupt.data(), size - 1 );
+    ImNodesBinaryStateHeader header;
+    memcpy( &header, corrupt.data(), sizeof( header ) );
+    header.Version = IMNODES_BINARY_STATE_VERSION + 1;
+    memcpy( corrupt.data(), &header, sizeof( header ) );
+    const bool acceptsNewer = ImNodes::LoadEditorStateFromBinaryMemory( fromBin, corrupt.data(), corrupt.size() )
+                              && SameEditorState( *source, *fromBin );
+    header.MinReaderVersion = header.Version;
+    memcpy( corrupt.data(), &header, sizeof( header ) );
+    const bool rejectsVersion =
+        !ImNodes::LoadEditorStateFromBinaryMemory( fromBin, corrupt.data(), corrupt.size() );
+
+    _log.AddLog( "Editor state: %d nodes, INI %d KB, binary %d KB", _nodeCount,
+                 (int)( std::filesystem::file_size( iniPath ) / 1024 ),
+                 (int)( std::filesystem::file_size( binPath ) / 1024 ) );
+    _log.AddLog( "  INI    save %.3f ms, load %.3f ms, round trip %s", iniSave, iniLoad,
+                 iniRoundTrip ? "OK" : "FAILED" );
+    _log.AddLog( "  Binary save %.3f ms, load %.3f ms (x%.1f), round trip %s", binSave, binLoad,
+                 iniLoad / binLoad, roundTrip ? "OK" : "FAILED" );
+    _log.AddLog( "  Async INI save %.3f ms on the UI thread, %.3f ms until written", asyncCall, asyncTotal );
+    _log.AddLog( "  Binary rejects truncated data: %s, incompatible version: %s; reads newer compatible version: %s",
+                 rejectsTruncated ? "OK" : "FAILED", rejectsVersion ? "OK" : "FAILED", acceptsNewer ? "OK" : "FAILED" );
+
+    // 日志式保存：首次写入快照，之后每次只追加移动过的 1% 节点
+    const std::string journalPath = ( dir / "imnodes_benchmark.journal" ).string();
+    ImNodesEditorContext* fromJournal = ImNodes::EditorContextCreate();
+    ImNodes::EditorContextSet( source );
+    bool journalOk = ImNodes::SaveEditorStateToJournal( source, binPath.c_str(), journalPath.c_str() );
+    std::mt19937 rng( 11 );
+    double journalSave = 0.0;
+    const int saves = 10;
+    for ( int i = 0; i < saves; ++i ) {
+        for ( int j = 0; j < ImMax( _nodeCount / 100, 1 ); ++j ) {
+            const int id = (int)( rng() % (unsigned)_nodeCount ) * 3 + 1;
+            ImNodes::SetNodeGridSpacePos( id, ImVec2( (float)( rng() % 1000 ), (float)( rng() % 1000 ) ) );
+        }
+        start = std::chrono::steady_clock::now();
+        journalOk &= ImNodes::SaveEditorStateToJournal( source, binPath.c_str(), journalPath.c_str() );
+        journalSave += ElapsedMs( start );
+    }
+
+    ImNodes::EditorContextSet( fromJournal );
+    start = std::chrono::steady_clock::now();
+    journalOk &= ImNodes::LoadEditorStateFromJournal( fromJournal, binPath.c_str(), journalPath.c_str() );
+    const double journalLoad = ElapsedMs( start );
+    ImNodes::EditorContextSet( previous );
+    journalOk &= SameEditorState( *source, *fromJournal );
+
+    // 模拟在写入新快照之后、清空日志之前崩溃：用移动前的编辑器重新开始保存，再放回旧日志。
+    // 旧日志属于上一个快照，加载时应被忽略，而不是把节点移回旧位置
+    const std::string stalePath = journalPath + ".stale";
+    std::error_code ec;
+    std::filesystem::copy_file( journalPath, stalePath, std::filesystem::copy_options::overwrite_existing, ec );
+    bool staleOk = !ec && !SameEditorState( *source, *fromBin );
+    ImNodes::EditorContextSet( fromBin );
+    staleOk &= ImNodes::SaveEditorStateToJournal( fromBin, binPath.c_str(), journalPath.c_str() );
+    std::filesystem::rename( stalePath, journalPath, ec );
+    ImNodesEditorContext* afterCrash = ImNodes::EditorContextCreate();
+    ImNodes::EditorContextSet( afterCrash );
+    staleOk &= !ec && ImNodes::LoadEditorStateFromJournal( afterCrash, binPath.c_str(), journalPath.c_str() );
+    ImNodes::EditorContextSet( previous );
+    staleOk &= SameEditorState( *fromBin, *afterCrash );
+    ImNodes::EditorContextFree( afterCrash );
+
+    _log.AddLog( "  Journal save %.3f ms (1%% of nodes moved), load %.3f ms, round trip %s, stale journal ignored: %s",
+                 journalSave / saves, journalLoad, journalOk ? "OK" : "FAILED", staleOk ? "OK" : "FAILED" );
+
+    ImNodes::EditorContextFree( fromJournal );
+    ImNodes::EditorContextFree( fromBin );
+    ImNodes::EditorContextFree( fromIni );
+    ImNodes::EditorContextFree( source );
+    std::filesystem::remove( iniPath, ec );
+    std::filesystem::remove( binPath, ec );
+    std::filesystem::remove( journalPath, ec );
+}
+
+void BenchmarkPanel::RunIniParser() {
+    ImNodesEditorContext* previous = &ImNodes::EditorContextGet();
+    for ( const int count : { 10000, 100000, 1000000 } ) {
+        ImNodesEditorContext* source = ImNodes::EditorContextCreate();
+        MakeNodes( source, count );
+        size_t size = 0;
+        const char* data = ImNodes::SaveEditorStateToIniString( source, &size );
+        const std::string ini( data, size );
+
+        ImNodesEditorContext* legacy = ImNodes::EditorContextCreate();
+        ImNodes::EditorContextSet( legacy );
+        auto start = std::chrono::steady_clock::now();
+        LegacyLoadIniString( *legacy, ini.data(), ini.size() );
+        const double legacyMs = ElapsedMs( start );
+
+        ImNodesEditorContext* current = ImNodes::EditorContextCreate();
+        ImNodes::EditorContextSet( current );
+        start = std::chrono::steady_clock::now();
+        ImNodes::LoadEditorStateFromIniString( current, ini.data(), ini.size() );
+        const double currentMs = ElapsedMs( start );
+        ImNodes::EditorContextSet( previous );
+
+        const bool same = SameEditorState( *source, *current ) && SameEditorState( *legacy, *current );
+        _log.AddLog( "INI parser: %d nodes, %d KB, sscanf %.3f ms, from_chars %.3f ms (x%.1f), %s", count,
+                     (int)( size / 1024 ), legacyMs, currentMs, legacyMs / currentMs,
+                     same ? "same result" : "DIFFERENT RESULT" );
+
+        ImNodes::EditorContextFree( current );
+        ImNodes::EditorContextFree( legacy );
+        ImNodes::EditorContextFree( source );
+    }
+}
+
+void BenchmarkPanel::RunGraphImport() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    for ( const GraphFormat format : { GraphFormat::Dot, GraphFormat::Json } ) {
+        const char* name = format == GraphFormat::Dot ? "DOT" : "JSON";
+        const std::string path = ( dir / ( format == GraphFormat::Dot ? "imnodes_import.dot" : "imnodes_import.json" ) ).string();
+        const size_t size = WriteGraphFile( path, format, _nodeCount );
+
+        CountingSink sink;
+        std::string error;
+        const auto start = std::chrono::steady_clock::now();
+        const bool ok = ReadGraph( path, format, sink, error );
+        const double ms = ElapsedMs( start );
+        const double mb = size / ( 1024.0 * 1024.0 );
+        if ( ok )
+            _log.AddLog( "Graph import %s: %.1f MB, %d nodes, %d edges in %.1f ms, %.1f MB/s", name, mb, sink.nodes,
+                         sink.edges, ms, mb * 1000.0 / ms );
+        else
+            _log.AddLog( "Graph import %s failed: %s", name, error.c_str() );
+        std::filesystem::remove( path );
+    }
+
+    // 扇入：d 有两条入边，e 有三条入边，每个节点只有两个输入引脚
+    const std::string fanInPath = ( dir / "imnodes_import_fanin.dot" ).string();
+    if ( FILE* file = ImFileOpen( fanInPath.c_str(), "wb" ) ) {
+        fprintf( file, "digraph fanin { a; b; c; d; e; a -> d; b -> d; a -> e; b -> e; c -> e; }\n" );
+        fclose( file );
+    }
+    Editor fanIn;
+    fanIn.context = ImNodes::EditorContextCreate();
+    std::string error;
+    int dropped = 0;
+    const bool imported = ImportGraph( fanInPath, fanIn, error, &dropped );
+    std::filesystem::remove( fanInPath );
+    if ( !imported ) {
+        _log.AddLog( "Graph import fan-in failed: %s", error.c_str() );
+        return;
+    }
+    // 每个输入引脚恰好连接一次
+    auto inputsLinkedOnce = [ & ]( const NodeBase& node ) {
+        for ( const Pin& pin : node.pins ) {
+            if ( pin.ptype != PinType::Input )
+                continue;
+            const auto count = std::count_if( fanIn.links.begin(), fanIn.links.end(),
+                                              [ & ]( const Link& link ) { return link.end_attr == pin.pid; } );
+            if ( count != 1 )
+                return false;
+        }
+        return true;
+    };
+    const bool fanIn2 = fanIn.nodes.size() == 5 && inputsLinkedOnce( *fanIn.nodes[ 3 ] );
+    const bool fanIn3 = fanIn.nodes.size() == 5 && inputsLinkedOnce( *fanIn.nodes[ 4 ] ) && dropped == 1;
+    _log.AddLog( "Graph import fan-in 2 uses both inputs: %s; fan-in 3 drops the extra link: %s (%d links, %d dropped)",
+                 fanIn2 ? "OK" : "WRONG", fanIn3 ? "OK" : "WRONG", (int)fanIn.links.size(), dropped );
+}
+
+void BenchmarkPanel::RunSnapshot() {
+    const std::string path = ( std::filesystem::temp_directory_path() / "imnodes_benchmark.snapshot" ).string();
+    Editor source;
+    MakeEditor( source, _nodeCount );
+
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    const bool saved = SaveSnapshot( source, path, error );
+    const double saveMs = ElapsedMs( start );
+
+    Editor restored;
+    restored.context = ImNodes::EditorContextCreate();
+    start = std::chrono::steady_clock::now();
+    const bool loaded = saved && LoadSnapshot( restored, path, error );
+    const double loadMs = ElapsedMs( start );
+    if ( !loaded ) {
+        _log.AddLog( "Snapshot failed: %s", error.c_str() );
+        return;
+    }
+
+    // 对比：逐个节点 make_shared 创建（含引脚数组分配），不含文件读取与布局
+    start = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<NodeBase>> nodes;
+    nodes.reserve( source.nodes.size() );
+    for ( const auto& node : source.nodes )
+        nodes.push_back( MakeNode( node->kind, node->node_id ) );
+    const double perNodeMs = ElapsedMs( start );
+
+    // 截断的文件应被拒绝，且不修改编辑器
+    const auto size = std::filesystem::file_size( path );
+    std::filesystem::resize_file( path, size - 1 );
+    const bool rejectsTruncated = !LoadSnapshot( restored, path, error ) && SameModel( source, restored );
+    std::filesystem::remove( path );
+
+    _log.AddLog( "Snapshot: %d nodes, %d links, %d KB", (int)source.nodes.size(), (int)source.links.size(),
+                 (int)( size / 1024 ) );
+    _log.AddLog( "  save %.3f ms, load %.3f ms (per-node make_shared alone %.3f ms), round trip %s", saveMs, loadMs, perNodeMs,
+                 SameModel( source, restored ) ? "OK" : "FAILED" );
+    _log.AddLog( "  Truncated file rejected: %s", rejectsTruncated ? "OK" : "FAILED" );
+}
+
+void BenchmarkPanel::RunEvaluate() {
+    Editor editor;
+    MakeEditor( editor, _nodeCount );
+    for ( const auto& node : editor.nodes ) {
+        for ( Pin& pin : node->pins )
+            pin.Set( 1.0f );
+    }
+    const int count = (int)editor.nodes.size();
+
+    GraphEvaluator evaluator;
+    auto start = std::chrono::steady_clock::now();
+    evaluator.Evaluate( editor );
+    const double firstMs = ElapsedMs( start );
+
+    // 修改某个节点的输入 B（链式图中 B 不连线）后增量求值，返回平均耗时
+    const auto editAt = [ & ]( const int index, size_t& computed ) {
+        const auto begin = std::chrono::steady_clock::now();
+        for ( int i = 0; i < _iterations; ++i ) {
+            NodeBase& node = *editor.nodes[ index ];
+            node.pins[ 1 ].Set( node.pins[ 1 ].Number() + 1.0f );
+            evaluator.MarkDirty( node );
+            evaluator.Update( editor );
+            computed = evaluator.ComputedCount();
+        }
+        return ElapsedMs( begin ) / _iterations;
+    };
+    size_t firstComputed = 0, middleComputed = 0, lastComputed = 0;
+    const double firstEditMs = editAt( 0, firstComputed );
+    const double middleEditMs = editAt( count / 2, middleComputed );
+    const double lastEditMs = editAt( count - 1, lastComputed );
+
+    // 值没有变化时不向下游传播
+    editor.nodes.front()->pins[ 1 ].Set( editor.nodes.front()->pins[ 1 ].Number() );
+    evaluator.MarkDirty( *editor.nodes.front() );
+    evaluator.Update( editor );
+    const size_t unchangedComputed = evaluator.ComputedCount();
+
+    // 对照：相同的输入在另一个编辑器中按 editor.nodes 的顺序（链式图中即拓扑顺序）全部重新计算
+    Editor reference;
+    MakeEditor( reference, _nodeCount );
+    std::unordered_map<int, Pin*> pins;
+    for ( size_t i = 0; i < reference.nodes.size(); ++i ) {
+        for ( size_t p = 0; p < reference.nodes[ i ]->pins.size(); ++p ) {
+            Pin& pin = reference.nodes[ i ]->pins[ p ];
+            pin.value = editor.nodes[ i ]->pins[ p ].value;
+            pins[ pin.pid ] = &pin;
+        }
+    }
+    bool same = evaluator.ScheduledCount() == editor.nodes.size();
+    for ( size_t i = 0; i < reference.nodes.size() && same; ++i ) {
+        if ( i > 0 ) {
+            const Link& link = reference.links[ i - 1 ];
+            pins[ link.end_attr ]->value = pins[ link.start_attr ]->value;
+        }
+        reference.nodes[ i ]->Compute();
+        for ( size_t p = 0; p < reference.nodes[ i ]->pins.size() && same; ++p )
+            same = reference.nodes[ i ]->pins[ p ].Number() == editor.nodes[ i ]->pins[ p ].Number();
+    }
+
+    // 首尾相连成环后所有节点都无法求值
+    editor.links.emplace_back( -_nodeCount, editor.nodes.back()->pins.back().pid, editor.nodes.front()->pins.front().pid );
+    ++editor.revision;
+    evaluator.Update( editor );
+    const bool cycleDetected = count < 2 || evaluator.BlockedCount() == editor.nodes.size();
+
+    _log.AddLog( "Evaluate: %d nodes, %d links", count, (int)editor.links.size() - 1 );
+    _log.AddLog( "  schedule + evaluate all %.3f ms", firstMs );
+    _log.AddLog( "  edit first node %.3f ms (%d computed), middle %.3f ms (%d), last %.3f ms (%d), unchanged value %d computed",
+                 firstEditMs, (int)firstComputed, middleEditMs, (int)middleComputed, lastEditMs, (int)lastComputed,
+                 (int)unchangedComputed );
+    _log.AddLog( "  Result matches full recomputation: %s", same ? "OK" : "DIFFERENT RESULT" );
+    _log.AddLog( "  Cycle detected: %s", cycleDetected ? "OK" : "FAILED" );
+}
+
+void BenchmarkPanel::RunParallelEvaluate() {
+    Editor editor;
+    MakeDag( editor, _nodeCount );
+    const int count = (int)editor.nodes.size();
+
+    // 单线程确定性模式的结果作为基准
+    std::vector<float> expected;
+    double baseMs = 0.0;
+    const int hardware = (int)std::max( 1u, std::thread::hardware_concurrency() );
+    _log.AddLog( "Parallel evaluate: %d nodes, %d links, %d hardware threads", count, (int)editor.links.size(), hardware );
+    for ( int threads = 1;; threads = std::min( threads * 2, hardware ) ) {
+        WorkStealingPool pool( threads );
+        GraphEvaluator evaluator;
+        evaluator.SetTape( false );
+        evaluator.Evaluate( editor, &pool );
+
+        // 全部节点标脏后重新计算，不含调度
+        const size_t steals = pool.StealCount();
+        const auto start = std::chrono::steady_clock::now();
+        for ( int i = 0; i < _iterations; ++i ) {
+            for ( const auto& node : editor.nodes )
+                evaluator.MarkDirty( *node );
+            // 输出先改成无关的值，保证每个节点都真正重新计算并写回
+            for ( const auto& node : editor.nodes )
+                node->pins.back().Set( -1.0f );
+            evaluator.Update( editor, &pool );
+        }
+        const double ms = ElapsedMs( start ) / _iterations;
+
+        std::vector<float> results;
+        results.reserve( count );
+        for ( const auto& node : editor.nodes )
+            results.push_back( node->pins.back().Number() );
+        if ( threads == 1 ) {
+            expected = results;
+            baseMs = ms;
+        }
+        _log.AddLog( "  %2d threads: %.3f ms, speedup %.2fx, %d computed, %d steals, result %s", threads, ms, baseMs / ms,
+                     (int)evaluator.ComputedCount(), (int)( ( pool.StealCount() - steals ) / _iterations ),
+                     results == expected ? "OK" : "DIFFERENT RESULT" );
+        if ( threads == hardware )
+            break;
+    }
+}
+
+void BenchmarkPanel::RunColumns() {
+    constexpr int ChainLength = 16;
+    const int rows = _nodeCount;
+    Editor editor;
+    std::vector<ColumnPtr> columns;
+    MakeColumnChain( editor, ChainLength, rows, columns );
+    const Pin& result = editor.nodes.back()->pins[ 2 ];
+
+    const ColumnIsa best = DetectColumnIsa();
+    GraphEvaluator evaluator;
+    // 每次都全部重新计算，返回平均耗时
+    const auto measure = [ & ]( const bool fusion, const ColumnIsa isa ) {
+        SetColumnIsa( isa );
+        evaluator.SetFusion( fusion );
+        const auto start = std::chrono::steady_clock::now();
+        for ( int i = 0; i < _iterations; ++i )
+            evaluator.Evaluate( editor );
+        return ElapsedMs( start ) / _iterations;
+    };
+    const double unfusedMs = measure( false, best );
+    const double fusedScalarMs = measure( true, ColumnIsa::Scalar );
+    const double fusedMs = measure( true, best );
+    SetColumnIsa( best );
+    const ColumnPtr* fused = result.As<ColumnPtr>();
+
+    // 对照：同一个图，每个元素单独以标量求值一次
+    Editor naive;
+    std::vector<ColumnPtr> naiveColumns;
+    MakeColumnChain( naive, ChainLength, 1, naiveColumns );
+    GraphEvaluator scalarEvaluator;
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<float> expected( rows );
+    for ( int r = 0; r < rows; ++r ) {
+        for ( int i = 0; i < ChainLength; ++i ) {
+            NodeBase& node = *naive.nodes[ i ];
+            node.pins[ 1 ].Set( ( (const float*)columns[ i + 1 ]->Data() )[ r ] );
+            if ( i == 0 )
+                node.pins[ 0 ].Set( ( (const float*)columns[ 0 ]->Data() )[ r ] );
+            scalarEvaluator.MarkDirty( node );
+        }
+        scalarEvaluator.Update( naive );
+        expected[ r ] = naive.nodes.back()->pins[ 2 ].Number();
+    }
+    const double naiveMs = ElapsedMs( start );
+
+    const bool same = fused && ( *fused )->Size() == (size_t)rows &&
+                      memcmp( ( *fused )->Data(), expected.data(), rows * sizeof( float ) ) == 0;
+    _log.AddLog( "Columns: %d-node chain, %d rows f32, kernels %s", ChainLength, rows, ColumnIsaName( best ) );
+    _log.AddLog( "  naive per element %.3f ms, unfused %.3f ms, fused scalar %.3f ms, fused %.3f ms (%.1fx vs naive)", naiveMs,
+                 unfusedMs, fusedScalarMs, fusedMs, naiveMs / fusedMs );
+    _log.AddLog( "  Result matches per-element evaluation: %s", same ? "OK" : "DIFFERENT RESULT" );
+}
+
+void BenchmarkPanel::RunTape() {
+    const int count = _nodeCount;
+    const int sources = count / 100 + 1;
+
+    // 两个相同的图分别用指令带与逐节点求值，做相同的修改：先改一个源节点，再改全部源节点
+    Editor editors[ 2 ];
+    GraphEvaluator evaluators[ 2 ];
+    double scheduleMs[ 2 ], oneMs[ 2 ], allMs[ 2 ];
+    for ( int t = 0; t < 2; ++t ) {
+        Editor& editor = editors[ t ];
+        GraphEvaluator& evaluator = evaluators[ t ];
+        MakeDag( editor, count );
+        evaluator.SetTape( t == 0 );
+        auto start = std::chrono::steady_clock::now();
+        evaluator.Evaluate( editor );
+        scheduleMs[ t ] = ElapsedMs( start );
+
+        start = std::chrono::steady_clock::now();
+        for ( int i = 0; i < _iterations; ++i ) {
+            NodeBase& node = *editor.nodes[ 0 ];
+            node.pins[ 0 ].Set( node.pins[ 0 ].Number() + 1.0f );
+            evaluator.MarkDirty( node );
+            evaluator.Update( editor );
+        }
+        oneMs[ t ] = ElapsedMs( start ) / _iterations;
+
+        start = std::chrono::steady_clock::now();
+        for ( int i = 0; i < _iterations; ++i ) {
+            for ( int s = 0; s < sources && s < count; ++s ) {
+                NodeBase& node = *editor.nodes[ s ];
+                node.pins[ 1 ].Set( node.pins[ 1 ].Number() + 0.5f );
+                evaluator.MarkDirty( node );
+            }
+            evaluator.Update( editor );
+        }
+        allMs[ t ] = ElapsedMs( start ) / _iterations;
+    }
+
+    bool same = evaluators[ 0 ].UsedTape() && !evaluators[ 1 ].UsedTape();
+    for ( int i = 0; i < count && same; ++i ) {
+        const auto& a = editors[ 0 ].nodes[ i ]->pins;
+        const auto& b = editors[ 1 ].nodes[ i ]->pins;
+        for ( size_t p = 0; p < a.size() && same; ++p )
+            same = a[ p ].Number() == b[ p ].Number();
+    }
+    _log.AddLog( "Tape: %d nodes, %d links, %d instructions", count, (int)editors[ 0 ].links.size(),
+                 (int)evaluators[ 0 ].TapeSize() );
+    _log.AddLog( "  schedule + evaluate all: tape %.3f ms, per node %.3f ms", scheduleMs[ 0 ], scheduleMs[ 1 ] );
+    _log.AddLog( "  edit one source: tape %.3f ms, per node %.3f ms (%.1fx)", oneMs[ 0 ], oneMs[ 1 ], oneMs[ 1 ] / oneMs[ 0 ] );
+    _log.AddLog( "  edit %d sources: tape %.3f ms, per node %.3f ms (%.1fx)", sources, allMs[ 0 ], allMs[ 1 ],
+                 allMs[ 1 ] / allMs[ 0 ] );
+    _log.AddLog( "  Result matches per-node evaluation: %s", same ? "OK" : "DIFFERENT RESULT" );
+}
+
+void BenchmarkPanel::RunMemo() {
+    constexpr int ChainLength = 16;
+    const int rows = _nodeCount;
+    Editor editor;
+    std::vector<ColumnPtr> columns;
+    MakeColumnChain( editor, ChainLength, rows, columns );
+    auto other = std::make_shared<Column>( ColumnType::Float, rows );
+    for ( int r = 0; r < rows; ++r )
+        ( (float*)other->Data() )[ r ] = (float)( r % 29 ) * 0.25f;
+    const ColumnPtr values[ 2 ] = { columns[ 1 ], other };
+    NodeBase& first = *editor.nodes.front();
+
+    // 第一个节点的 B 在两列之间来回切换，每次切换后增量求值，返回平均耗时
+    MemoCache memo;
+    const auto measure = [ & ]( const bool fusion, MemoCache* cache ) {
+        GraphEvaluator evaluator;
+        evaluator.SetFusion( fusion );
+        evaluator.SetMemo( cache );
+        first.pins[ 1 ].Assign( values[ 0 ] );
+        evaluator.Evaluate( editor );
+        const auto start = std::chrono::steady_clock::now();
+        for ( int i = 0; i < _iterations; ++i ) {
+            first.pins[ 1 ].Assign( values[ ( i + 1 ) % 2 ] );
+            evaluator.MarkDirty( first );
+            evaluator.Update( editor );
+        }
+        return ElapsedMs( start ) / _iterations;
+    };
+    const auto resultOf = [ & ]() {
+        const ColumnPtr* column = editor.nodes.back()->pins[ 2 ].As<ColumnPtr>();
+        return column ? *column : ColumnPtr();
+    };
+    const auto same = []( const ColumnPtr& a, const ColumnPtr& b ) {
+        return a && b && a->Size() == b->Size() && memcmp( a->Data(), b->Data(), a->Size() * sizeof( float ) ) == 0;
+    };
+
+    const double unfusedMs = measure( false, nullptr );
+    const ColumnPtr expected = resultOf();
+    const double unfusedMemoMs = measure( false, &memo );
+    const bool unfusedSame = same( resultOf(), expected );
+    const size_t unfusedHits = memo.Hits(), unfusedMisses = memo.Misses();
+    memo.Clear();
+    memo.ResetStats();
+    const double fusedMs = measure( true, nullptr );
+    const double fusedMemoMs = measure( true, &memo );
+    const bool fusedSame = same( resultOf(), expected );
+
+    _log.AddLog( "Memo: %d-node chain, %d rows f32, toggling one input %d times", ChainLength, rows, _iterations );
+    _log.AddLog( "  unfused %.3f ms, with cache %.3f ms (%.1fx), %d hits, %d misses", unfusedMs, unfusedMemoMs,
+                 unfusedMs / unfusedMemoMs, (int)unfusedHits, (int)unfusedMisses );
+    _log.AddLog( "  fused %.3f ms, with cache %.3f ms (%.1fx), %d hits, %d misses, %d entries, %.1f MB", fusedMs, fusedMemoMs,
+                 fusedMs / fusedMemoMs, (int)memo.Hits(), (int)memo.Misses(), (int)memo.EntryCount(),
+                 memo.Bytes() / ( 1024.0 * 1024.0 ) );
+    _log.AddLog( "  Result matches uncached evaluation: %s", unfusedSame && fusedSame ? "OK" : "DIFFERENT RESULT" );
+}
+
+void BenchmarkPanel::RunTopology() {
+    Editor editor;
+    MakeDag( editor, _nodeCount );
+    const int count = (int)editor.nodes.size();
+    if ( count < 2 )
+        return;
+
+    TopologicalOrder topology;
+    auto start = std::chrono::steady_clock::now();
+    topology.Rebuild( editor );
+    const double rebuildMs = ElapsedMs( start );
+
+    // 随机两个节点之间连线，输出端为其中一个的 C。约一半的连线方向与现有顺序相反
+    std::mt19937 rng( 23 );
+    const int attempts = _iterations * 100;
+    int accepted = 0, rejected = 0;
+    size_t affected = 0;
+    std::vector<int> cycle;
+    std::vector<std::pair<int, int>> rejectedLinks;
+    start = std::chrono::steady_clock::now();
+    for ( int i = 0; i < attempts; ++i ) {
+        const NodeBase& from = *editor.nodes[ rng() % (unsigned)count ];
+        const NodeBase& to = *editor.nodes[ rng() % (unsigned)count ];
+        const int startAttr = from.pins[ 2 ].pid;
+        const int endAttr = to.pins[ rng() % 2 ].pid;
+        if ( topology.AddLink( startAttr, endAttr, &cycle ) ) {
+            editor.links.emplace_back( -(int)editor.links.size() - 1, startAttr, endAttr );
+            affected += topology.LastAffected();
+            ++accepted;
+        }
+        else {
+            rejectedLinks.emplace_back( from.node_id, to.node_id );
+            ++rejected;
+        }
+    }
+    const double addMs = ElapsedMs( start );
+
+    // 每条连线的上游节点都排在下游节点之前
+    std::unordered_map<int, const NodeBase*> owners;
+    for ( const auto& node : editor.nodes ) {
+        for ( const Pin& pin : node->pins )
+            owners[ pin.pid ] = node.get();
+    }
+    bool ordered = true;
+    for ( const Link& link : editor.links ) {
+        const NodeBase* a = owners[ link.start_attr ];
+        const NodeBase* b = owners[ link.end_attr ];
+        ordered = ordered && topology.Position( a->node_id ) < topology.Position( b->node_id );
+    }
+
+    // 被拒绝的连线确实会形成环：在最终的图中下游节点能到达上游节点（最终的图只多了边，可达性只增不减）
+    std::unordered_map<int, std::vector<int>> downstream;
+    for ( const Link& link : editor.links )
+        downstream[ owners[ link.start_attr ]->node_id ].push_back( owners[ link.end_attr ]->node_id );
+    bool cycles = true;
+    for ( size_t r = 0; r < rejectedLinks.size() && r < 20 && cycles; ++r ) {
+        const auto [ from, to ] = rejectedLinks[ r ];
+        std::vector<int> stack{ to };
+        std::unordered_map<int, bool> seen{ { to, true } };
+        bool reached = from == to;
+        while ( !stack.empty() && !reached ) {
+            const int node = stack.back();
+            stack.pop_back();
+            for ( const int next : downstream[ node ] ) {
+                reached |= next == from;
+                if ( !seen[ next ] ) {
+                    seen[ next ] = true;
+                    stack.push_back( next );
+                }
+            }
+        }
+        cycles = reached;
+    }
+
+    // 对照：每次加入连线后完整重建
+    start = std::chrono::steady_clock::now();
+    TopologicalOrder full;
+    for ( int i = 0; i < _iterations; ++i ) {
+        ++editor.revision;
+        full.Sync( editor );
+    }
+    const double fullMs = ElapsedMs( start ) / _iterations;
+
+    _log.AddLog( "Topology: %d nodes, %d links after %d attempts (%d accepted, %d rejected as cycles)", count,
+                 (int)editor.links.size(), attempts, accepted, rejected );
+    _log.AddLog( "  initial build %.3f ms, incremental %.3f us per link (%.1f nodes reordered on average), full rebuild %.3f ms",
+                 rebuildMs, addMs * 1000.0 / attempts, accepted ? (double)affected / accepted : 0.0, fullMs );
+    _log.AddLog( "  Order respects every link: %s", ordered ? "OK" : "FAILED" );
+    _log.AddLog( "  Rejected links close a cycle: %s", cycles ? "OK" : "FAILED" );
+}
+
+void BenchmarkPanel::RunAsync() {
+    constexpr int Frames = 120;
+    Editor editor;
+    MakeDag( editor, _nodeCount );
+    const int count = (int)editor.nodes.size();
+    const int sources = count / 100 + 1;
+
+    // 对照：同样的修改在另一个相同的图上同步求值
+    Editor reference;
+    MakeDag( reference, _nodeCount );
+    GraphEvaluator evaluator;
+    evaluator.Evaluate( reference );
+    double syncMs = 0.0;
+
+    // 每帧：取走结果，修改一个源节点的输入并提交。记录界面线程每帧的耗时
+    AsyncEvaluator async;
+    auto start = std::chrono::steady_clock::now();
+    async.Submit( editor, {} );
+    const double submitAllMs = ElapsedMs( start );
+    double frameMs = 0.0, worstMs = 0.0;
+    int applied = 0;
+    for ( int frame = 0; frame < Frames; ++frame ) {
+        start = std::chrono::steady_clock::now();
+        applied += async.Poll( editor );
+        const int index = frame % sources;
+        NodeBase& node = *editor.nodes[ index ];
+        node.pins[ 1 ].Set( node.pins[ 1 ].Number() + 0.5f );
+        std::vector<NodeBase*> edited{ &node };
+        async.Submit( editor, edited );
+        const double ms = ElapsedMs( start );
+        frameMs += ms;
+        worstMs = std::max( worstMs, ms );
+
+        NodeBase& same = *reference.nodes[ index ];
+        same.pins[ 1 ].Set( same.pins[ 1 ].Number() + 0.5f );
+        start = std::chrono::steady_clock::now();
+        evaluator.MarkDirty( same );
+        evaluator.Update( reference );
+        syncMs += ElapsedMs( start );
+    }
+    // 只为校验等待后台完成；界面中从不等待
+    while ( async.Busy() )
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    applied += async.Poll( editor );
+
+    // 结构变化：在末尾加入一个节点并连到最后一个节点的输出，后台只应计算这个新节点
+    const auto append = []( Editor& graph ) {
+        const int id = SnapshotBaseId + (int)graph.nodes.size() * NodeBase::IdStride;
+        const int from = graph.nodes.back()->pins[ 2 ].pid;
+        graph.nodes.push_back( MakeNode( NodeKind::Add, id ) );
+        graph.links.emplace_back( -(int)graph.links.size() - 1, from, graph.nodes.back()->pins[ 0 ].pid );
+        ++graph.revision;
+    };
+    append( editor );
+    start = std::chrono::steady_clock::now();
+    async.Submit( editor, {} );
+    const double submitStructureMs = ElapsedMs( start );
+    append( reference );
+    evaluator.Update( reference );
+    while ( async.Busy() )
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    applied += async.Poll( editor );
+    const size_t structureComputed = async.Latest().computed;
+
+    bool same = true;
+    for ( int i = 0; i <= count && same; ++i ) {
+        for ( size_t p = 0; p < editor.nodes[ i ]->pins.size() && same; ++p )
+            same = editor.nodes[ i ]->pins[ p ].Number() == reference.nodes[ i ]->pins[ p ].Number();
+    }
+    _log.AddLog( "Async: %d nodes, %d frames with one input edit each", count, Frames );
+    _log.AddLog( "  UI thread per frame %.3f ms (worst %.3f ms, first submit %.3f ms), synchronous evaluation %.3f ms",
+                 frameMs / Frames, worstMs, submitAllMs, syncMs / Frames );
+    _log.AddLog( "  %d results applied, %d stale runs cancelled", applied, (int)async.CancelledCount() );
+    _log.AddLog( "  Structural edit (one node and link added): UI thread %.3f ms, %d computed (synchronous %d): %s",
+                 submitStructureMs, (int)structureComputed, (int)evaluator.ComputedCount(),
+                 structureComputed == evaluator.ComputedCount() ? "OK" : "FULL RECOMPUTE" );
+    _log.AddLog( "  Final result matches synchronous evaluation: %s", same ? "OK" : "DIFFERENT RESULT" );
+
+    // 取消：节点数超过并行阈值时，后台的并行求值与指令带同样要在新的提交到来时停下，未计算的节点留到下一次 Update。
+    // 求值前已取消的一次不计算任何节点；求值中途由另一个线程在完整求值约一半耗时时取消
+    const int bigCount = std::max( _nodeCount, 20000 );
+    const int bigSources = bigCount / 100 + 1;
+    WorkStealingPool pool( (int)std::max( 1u, std::thread::hardware_concurrency() ) );
+    _log.AddLog( "  Cancellation: %d nodes", bigCount );
+    for ( const bool tape : { false, true } ) {
+        Editor bigReference;
+        MakeDag( bigReference, bigCount );
+        GraphEvaluator referenceEvaluator;
+        referenceEvaluator.Evaluate( bigReference );
+        Editor graph;
+        MakeDag( graph, bigCount );
+        GraphEvaluator cancellable;
+        cancellable.SetTape( tape );
+        std::atomic<bool> cancel = true;
+        cancellable.SetCancel( &cancel );
+        cancellable.Evaluate( graph, &pool );
+        const bool stopped = cancellable.Cancelled() && cancellable.ComputedCount() == 0;
+        cancel = false;
+        start = std::chrono::steady_clock::now();
+        cancellable.Update( graph, &pool );
+        const double fullMs = ElapsedMs( start );
+        const auto matches = [ & ] {
+            bool equal = !cancellable.Cancelled();
+            for ( int i = 0; i < bigCount && equal; ++i ) {
+                for ( size_t p = 0; p < graph.nodes[ i ]->pins.size() && equal; ++p )
+                    equal = graph.nodes[ i ]->pins[ p ].Number() == bigReference.nodes[ i ]->pins[ p ].Number();
+            }
+            return equal;
+        };
+        const bool resumed = matches();
+
+        // 修改全部源节点后求值，中途取消
+        for ( int i = 0; i < bigSources; ++i ) {
+            NodeBase& node = *graph.nodes[ i ];
+            node.pins[ 0 ].Set( node.pins[ 0 ].Number() + 1.0f );
+            cancellable.MarkDirty( node );
+            NodeBase& same = *bigReference.nodes[ i ];
+            same.pins[ 0 ].Set( same.pins[ 0 ].Number() + 1.0f );
+            referenceEvaluator.MarkDirty( same );
+        }
+        referenceEvaluator.Update( bigReference );
+        std::chrono::steady_clock::time_point cancelledAt;
+        std::thread canceller( [ & ] {
+            std::this_thread::sleep_for( std::chrono::duration<double, std::milli>( fullMs / 2 ) );
+            cancelledAt = std::chrono::steady_clock::now();
+            cancel = true;
+        } );
+        cancellable.Update( graph, &pool );
+        const auto stoppedAt = std::chrono::steady_clock::now();
+        canceller.join();
+        const bool midRun = cancellable.Cancelled();
+        const size_t before = cancellable.ComputedCount();
+        const double stopMs = std::chrono::duration<double, std::milli>( stoppedAt - cancelledAt ).count();
+        cancel = false;
+        cancellable.Update( graph, &pool );
+        const bool completed = matches();
+        _log.AddLog( "    %s: full evaluation %.3f ms; cancelled before start computes nothing: %s, resumed result: %s",
+                     tape ? "tape" : "parallel", fullMs, stopped ? "OK" : "FAILED", resumed ? "OK" : "DIFFERENT RESULT" );
+        if ( midRun )
+            _log.AddLog( "      cancelled mid-run after %d nodes, stopped %.3f ms after the cancel", (int)before, stopMs );
+        else
+            _log.AddLog( "      finished before the mid-run cancel (%d nodes)", (int)before );
+        _log.AddLog( "      result after resuming: %s", completed ? "OK" : "DIFFERENT RESULT" );
+    }
+}
+
+void BenchmarkPanel::RunStream() {
+    constexpr int ChainLength = 16;
+    const int rows = _nodeCount * 10;
+    Editor editor;
+    std::vector<ColumnPtr> columns;
+    MakeColumnChain( editor, ChainLength, rows, columns );
+    const int resultPin = editor.nodes.back()->pins[ 2 ].pid;
+
+    StreamPipeline::Options options;
+    // 汇按块累加，对照结果也按同样的块累加，结果应逐位相同
+    const auto chunkedSum = [ & ]( const Column& column ) {
+        double sum = 0.0;
+        const float* data = (const float*)column.Data();
+        for ( size_t begin = 0; begin < column.Size(); begin += options.chunkRows ) {
+            double chunk = 0.0;
+            for ( size_t r = begin; r < std::min( column.Size(), begin + options.chunkRows ); ++r )
+                chunk += data[ r ];
+            sum += chunk;
+        }
+        return sum;
+    };
+    const auto waitFor = [ & ]( StreamPipeline& pipeline ) {
+        while ( pipeline.Running() )
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        pipeline.Stop();
+    };
+    const auto sinkOf = [ & ]( const StreamPipeline& pipeline ) -> const StreamPipeline::SinkStats* {
+        for ( const auto& sink : pipeline.Sinks() ) {
+            if ( sink->pinId == resultPin )
+                return sink.get();
+        }
+        return nullptr;
+    };
+    const auto stallsOf = []( const StreamPipeline& pipeline ) {
+        uint64_t stalls = 0;
+        for ( const auto& link : pipeline.Links() )
+            stalls += link->stalls.load();
+        return stalls;
+    };
+
+    // 整列求值：每个节点的结果都是一整列
+    GraphEvaluator evaluator;
+    evaluator.SetFusion( false );
+    auto start = std::chrono::steady_clock::now();
+    evaluator.Evaluate( editor );
+    const double wholeMs = ElapsedMs( start );
+    const ColumnPtr* whole = editor.nodes.back()->pins[ 2 ].As<ColumnPtr>();
+    const double expected = whole && *whole ? chunkedSum( **whole ) : 0.0;
+    const double wholeMb = ( columns.size() + ChainLength * 1.5 ) * rows * sizeof( float ) / ( 1024.0 * 1024.0 );
+
+    StreamPipeline pipeline;
+    std::string error;
+    start = std::chrono::steady_clock::now();
+    bool started = pipeline.Start( editor, {}, options, &error );
+    waitFor( pipeline );
+    const double streamMs = ElapsedMs( start );
+    const StreamPipeline::SinkStats* sink = sinkOf( pipeline );
+    const bool same = started && sink && sink->rows.load() == (uint64_t)rows && sink->sum.load() == expected;
+
+    _log.AddLog( "Stream: %d-node chain, %d rows f32, %d-row chunks, %d chunks per queue", ChainLength, rows,
+                 (int)options.chunkRows, (int)options.queueChunks );
+    if ( !started ) {
+        _log.AddLog( "  Failed to start: %s", error.c_str() );
+        return;
+    }
+    _log.AddLog( "  whole columns %.3f ms, about %.1f MB of columns", wholeMs, wholeMb );
+    _log.AddLog( "  streamed %.3f ms on %d threads, at most %.1f MB in flight, %d back-pressure stalls", streamMs,
+                 (int)pipeline.ThreadCount(), pipeline.MemoryBound() / ( 1024.0 * 1024.0 ), (int)stallsOf( pipeline ) );
+    _log.AddLog( "  Result matches whole-column evaluation: %s", same ? "OK" : "DIFFERENT RESULT" );
+
+    // 生成的输入：行数远多于整列能放进内存的，内存占用仍只与块大小和队列容量有关
+    const size_t generatedRows = (size_t)rows * 100;
+    std::unordered_map<int, StreamPipeline::Reader> readers;
+    for ( const auto& node : editor.nodes ) {
+        for ( const Pin& pin : node->pins ) {
+            if ( pin.ptype != PinType::Input || pin.isLinked || !pin.As<ColumnPtr>() )
+                continue;
+            const int seed = pin.pid;
+            readers[ pin.pid ] = [ generatedRows, seed ]( const size_t row, const size_t count ) -> ColumnPtr {
+                if ( row >= generatedRows )
+                    return nullptr;
+                auto chunk = std::make_shared<Column>( ColumnType::Float, std::min( count, generatedRows - row ) );
+                float* data = (float*)chunk->Data();
+                for ( size_t r = 0; r < chunk->Size(); ++r )
+                    data[ r ] = (float)( ( row + r + seed ) % 64 ) * 0.125f;
+                return chunk;
+            };
+        }
+    }
+    start = std::chrono::steady_clock::now();
+    started = pipeline.Start( editor, readers, options, &error );
+    waitFor( pipeline );
+    const double generatedMs = ElapsedMs( start );
+    sink = sinkOf( pipeline );
+    _log.AddLog( "  generated input: %.0f M rows in %.3f ms (%.1f M rows/s), whole columns would need %.0f MB, %d stalls",
+                 generatedRows / 1e6, generatedMs, sink ? sink->rows.load() / generatedMs / 1e3 : 0.0,
+                 wholeMb * 100.0, (int)stallsOf( pipeline ) );
+    if ( !started || !sink || sink->rows.load() != generatedRows )
+        _log.AddLog( "  Stream ended early: %s", started ? "missing rows" : error.c_str() );
+}
+
+void BenchmarkPanel::RunOptimize() {
+    Editor editor;
+    std::unordered_set<int> variables;
+    std::vector<int> outputs;
+    MakeRedundantDag( editor, _nodeCount, variables, outputs );
+    const int count = (int)editor.nodes.size();
+    const int sources = count / 100 + 1;
+
+    GraphEvaluator reference;
+    auto start = std::chrono::steady_clock::now();
+    reference.Evaluate( editor );
+    const double fullMs = ElapsedMs( start );
+
+    GraphOptimizer optimizer;
+    GraphOptimizer::Options options;
+    options.outputs = outputs;
+    options.variable = [ & ]( const Pin& pin ) { return variables.count( pin.pid ) != 0; };
+    const bool optimized = optimizer.Optimize( editor, options );
+    const GraphOptimizer::Report& report = optimizer.LastReport();
+    GraphEvaluator evaluator;
+    start = std::chrono::steady_clock::now();
+    evaluator.Evaluate( optimizer.Graph() );
+    const double optimizedMs = ElapsedMs( start );
+
+    // 输出节点的全部引脚与不优化时相同
+    std::unordered_set<int> outputIds( outputs.begin(), outputs.end() );
+    const auto same = [ & ]() {
+        for ( int i = 0; i < count; ++i ) {
+            if ( !outputIds.count( editor.nodes[ i ]->node_id ) )
+                continue;
+            for ( uint32_t p = 0; p < editor.nodes[ i ]->pins.size(); ++p ) {
+                const Pin* pin = optimizer.Resolve( i, p );
+                if ( !pin || pin->Number() != editor.nodes[ i ]->pins[ p ].Number() )
+                    return false;
+            }
+        }
+        return true;
+    };
+    bool matches = optimized && same();
+
+    // 逐次修改一个参数，原图与优化后的图各自增量求值
+    double updateMs = 0.0, optimizedUpdateMs = 0.0;
+    size_t computed = 0, optimizedComputed = 0;
+    for ( int i = 0; i < _iterations && optimized; ++i ) {
+        const int index = ( i * 2 ) % sources;
+        NodeBase& node = *editor.nodes[ index ];
+        const float value = node.pins[ 1 ].Number() + 0.5f;
+        node.pins[ 1 ].Set( value );
+        start = std::chrono::steady_clock::now();
+        reference.MarkDirty( node );
+        reference.Update( editor );
+        updateMs += ElapsedMs( start );
+        computed += reference.ComputedCount();
+
+        NodeBase* live = optimizer.Live( index );
+        start = std::chrono::steady_clock::now();
+        if ( live ) {
+            live->pins[ 1 ].Set( value );
+            evaluator.MarkDirty( *live );
+            evaluator.Update( optimizer.Graph() );
+            optimizedComputed += evaluator.ComputedCount();
+        }
+        optimizedUpdateMs += ElapsedMs( start );
+    }
+    matches = matches && same();
+
+    _log.AddLog( "Optimize: %d nodes, %d outputs, %d parameters, pass %.3f ms", count, (int)outputs.size(), (int)variables.size(),
+                 report.ms );
+    if ( !optimized ) {
+        _log.AddLog( "  Not optimized: the graph contains a cycle" );
+        return;
+    }
+    _log.AddLog( "  %d folded, %d merged, %d dead -> %d nodes, %d links (%.0f%% fewer nodes)", (int)report.folded,
+                 (int)report.merged, (int)report.dead, (int)report.remaining, (int)report.links,
+                 100.0 * ( report.nodes - report.remaining ) / std::max<size_t>( report.nodes, 1 ) );
+    _log.AddLog( "  full evaluation %.3f ms -> %.3f ms", fullMs, optimizedMs );
+    _log.AddLog( "  after a parameter edit %.3f ms -> %.3f ms (%.0f -> %.0f nodes computed)", updateMs / _iterations,
+                 optimizedUpdateMs / _iterations, (double)computed / _iterations, (double)optimizedComputed / _iterations );
+    _log.AddLog( "  Outputs match the unoptimized graph: %s", matches ? "OK" : "DIFFERENT RESULT" );
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+#include "LogPanel.h"
+
+// 性能测试面板，结果输出到日志
+class BenchmarkPanel {
+public:
+    BenchmarkPanel()
+        : _log( "Benchmark Log" ) {}
+
+    void Draw();
+
+private:
+    // 对比 AddBezierCubic 与 ImNodes 批量连线绘制 (标量 / SIMD)
+    void RunLinkBatch();
+    // 编辑器状态 INI / 二进制 / 日志式保存、加载耗时，并校验往返一致
+    void RunEditorState();
+    // 对比旧版 sscanf INI 解析器与 from_chars 解析器 (10k / 100k / 1M 节点)
+    void RunIniParser();
+    // DOT / JSON 图文件流式解析吞吐量 (MB/s)
+    void RunGraphImport();
+    // 编辑器模型二进制快照的保存、加载耗时，并校验往返一致
+    void RunSnapshot();
+    // 数据流求值：建立调度与逐节点求值的耗时，并校验结果与环路检测
+    void RunEvaluate();
+    // 随机宽 DAG 上工作窃取并行求值的加速比（1 到 N 线程），并校验结果与单线程一致
+    void RunParallelEvaluate();
+    // 列运算：逐元素链的融合 SIMD 执行与逐元素朴素求值、不融合、标量内核对比，并校验结果一致
+    void RunColumns();
+    // 随机宽 DAG 上修改源节点输入后，指令带与逐节点求值（增量）的耗时对比，并校验结果一致
+    void RunTape();
+    // 列链中来回切换一个输入（相当于撤销 / 重做）时，节点输出缓存的命中率与耗时，并校验结果与不缓存时一致
+    void RunMemo();
+    // 随机宽 DAG 上逐条加入随机连线：动态拓扑顺序的增量更新与每次完整重建对比，校验顺序与环检测
+    void RunTopology();
+    // 随机宽 DAG 上模拟逐帧修改输入值：后台求值时界面线程每帧的耗时与同步求值对比，并校验最终结果一致
+    void RunAsync();
+    // 列链的分块流式执行：与整列求值对比耗时与内存，校验结果一致；再用生成的输入流过远大于单列内存的行数
+    void RunStream();
+    // 带重复子树、常量分支与无用节点的随机 DAG：优化前后全量与修改参数后的求值耗时，并校验输出节点的结果一致
+    void RunOptimize();
+
+    ImGuiLogPanel _log;
+    int _linkCount = 50000;
+    int _iterations = 20;
+    int _nodeCount = 100000;
+};
@@ -0,0 +1,412 @@
+﻿#include "Column.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#include "PinValue.h"
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#define COLUMN_X86
+#include <immintrin.h>
+#if defined( _MSC_VER ) && !defined( __clang__ )
+#include <intrin.h>
+#define COLUMN_TARGET( isa )
+#else
+#define COLUMN_TARGET( isa ) __attribute__( ( target( isa ) ) )
+#endif
+#endif
+
+namespace {
+
+// 每块的元素数：double 时一块 8 KB，几个暂存块一起放得进 L1
+constexpr size_t BlockSize = 1024;
+
+template <typename T>
+T ScalarOp( const ColumnOp op, const T a, const T b ) {
+    return op == ColumnOp::Add ? a + b : a - b;
+}
+
+// 整数按补码回绕，与 SIMD 指令一致
+template <>
+int32_t ScalarOp<int32_t>( const ColumnOp op, const int32_t a, const int32_t b ) {
+    return (int32_t)( op == ColumnOp::Add ? (uint32_t)a + (uint32_t)b : (uint32_t)a - (uint32_t)b );
+}
+
+template <typename T>
+void ScalarBinary( const ColumnOp op, const T* a, const T* b, T* out, const size_t n ) {
+    for ( size_t i = 0; i < n; ++i )
+        out[ i ] = ScalarOp( op, a[ i ], b[ i ] );
+}
+
+using BinaryKernel = void ( * )( ColumnOp op, const void* a, const void* b, void* out, size_t n );
+
+template <typename T>
+void ScalarKernel( const ColumnOp op, const void* a, const void* b, void* out, const size_t n ) {
+    ScalarBinary( op, (const T*)a, (const T*)b, (T*)out, n );
+}
+
+#if defined( COLUMN_X86 )
+// 整块用 SIMD，余下的元素按标量计算
+#define COLUMN_SIMD_LOOP( T, WIDTH, LOAD, STORE, ADD, SUB )                                 \
+    const T* x = (const T*)a;                                                               \
+    const T* y = (const T*)b;                                                               \
+    T* z = (T*)out;                                                                         \
+    size_t i = 0;                                                                           \
+    if ( op == ColumnOp::Add ) {                                                            \
+        for ( ; i + WIDTH <= n; i += WIDTH )                                                \
+            STORE( z + i, ADD( LOAD( x + i ), LOAD( y + i ) ) );                            \
+    }                                                                                       \
+    else {                                                                                  \
+        for ( ; i + WIDTH <= n; i += WIDTH )                                                \
+            STORE( z + i, SUB( LOAD( x + i ), LOAD( y + i ) ) );                            \
+    }                                                                                       \
+    ScalarBinary( op, x + i, y + i, z + i, n - i );
+
+#define COLUMN_LOAD_SI256( p ) _mm256_loadu_si256( (const __m256i*)( p ) )
+#define COLUMN_STORE_SI256( p, v ) _mm256_storeu_si256( (__m256i*)( p ), v )
+
+COLUMN_TARGET( "avx2" )
+void Avx2Float( const ColumnOp op, const void* a, const void* b, void* out, const size_t n ) {
+    COLUMN_SIMD_LOOP( float, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_add_ps, _mm256_sub_ps )
+}
+
+COLUMN_TARGET( "avx2" )
+void Avx2Double( const ColumnOp op, const void* a, const void* b, void* out, const size_t n ) {
+    COLUMN_SIMD_LOOP( double, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, _mm256_sub_pd )
+}
+
+COLUMN_TARGET( "avx2" )
+void Avx2Int( const ColumnOp op, const void* a, const void* b, void* out, const size_t n ) {
+    COLUMN_SIMD_LOOP( int32_t, 8, COLUMN_LOAD_SI256, COLUMN_STORE_SI256, _mm256_add_epi32, _mm256_sub_epi32 )
+}
+
+COLUMN_TARGET( "avx512f" )
+void Avx512Float( const ColumnOp op, const void* a, const void* b, void* out, const size_t n ) {
+    COLUMN_SIMD_LOOP( float, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_add_ps, _mm512_sub_ps )
+}
+
+COLUMN_TARGET( "avx512f" )
+void Avx512Double( const ColumnOp op, const void* a, const void* b, void* out, const size_t n ) {
+    COLUMN_SIMD_LOOP( double, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_add_pd, _mm512_sub_pd )
+}
+
+COLUMN_TARGET( "avx512f" )
+void Avx512Int( const ColumnOp op, const void* a, const void* b, void* out, const size_t n ) {
+    COLUMN_SIMD_LOOP( int32_t, 16, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_add_epi32, _mm512_sub_epi32 )
+}
+
+bool CpuSupports( const ColumnIsa isa ) {
+#if defined( _MSC_VER ) && !defined( __clang__ )
+    int info[ 4 ];
+    __cpuid( info, 1 );
+    // 操作系统需要保存 YMM（以及 AVX-512 的 ZMM 与掩码）寄存器
+    const bool osxsave = ( info[ 2 ] & ( 1 << 27 ) ) != 0;
+    if ( !osxsave )
+        return false;
+    const unsigned long long xcr0 = _xgetbv( 0 );
+    __cpuidex( info, 7, 0 );
+    if ( isa == ColumnIsa::Avx2 )
+        return ( xcr0 & 0x6 ) == 0x6 && ( info[ 1 ] & ( 1 << 5 ) ) != 0;
+    return ( xcr0 & 0xe6 ) == 0xe6 && ( info[ 1 ] & ( 1 << 16 ) ) != 0;
+#else
+    __builtin_cpu_init();
+    return isa == ColumnIsa::Avx2 ? __builtin_cpu_supports( "avx2" ) : __builtin_cpu_supports( "avx512f" );
+#endif
+}
+#endif
+
+// 按 ColumnType 索引
+const BinaryKernel ScalarKernels[ 3 ] = { ScalarKernel<int32_t>, ScalarKernel<float>, ScalarKernel<double> };
+#if defined( COLUMN_X86 )
+const BinaryKernel Avx2Kernels[ 3 ] = { Avx2Int, Avx2Float, Avx2Double };
+const BinaryKernel Avx512Kernels[ 3 ] = { Avx512Int, Avx512Float, Avx512Double };
+#endif
+
+std::atomic<int> ActiveIsa = (int)DetectColumnIsa();
+
+const BinaryKernel* Kernels() {
+#if defined( COLUMN_X86 )
+    switch ( (ColumnIsa)ActiveIsa.load( std::memory_order_relaxed ) ) {
+    case ColumnIsa::Avx512:
+        return Avx512Kernels;
+    case ColumnIsa::Avx2:
+        return Avx2Kernels;
+    default:
+        break;
+    }
+#endif
+    return ScalarKernels;
+}
+
+template <typename From, typename To>
+void Convert( const From* in, To* out, const size_t n ) {
+    for ( size_t i = 0; i < n; ++i )
+        out[ i ] = (To)in[ i ];
+}
+
+// 把 in 的 n 个元素转换为 type 类型写入 out
+void ConvertBlock( const ColumnType from, const void* in, const ColumnType type, void* out, const size_t n ) {
+    switch ( type ) {
+    case ColumnType::Float:
+        if ( from == ColumnType::Int )
+            Convert( (const int32_t*)in, (float*)out, n );
+        else
+            Convert( (const double*)in, (float*)out, n );
+        break;
+    case ColumnType::Double:
+        if ( from == ColumnType::Int )
+            Convert( (const int32_t*)in, (double*)out, n );
+        else
+            Convert( (const float*)in, (double*)out, n );
+        break;
+    default:
+        break;
+    }
+}
+
+void FillBlock( const ColumnType type, const float scalar, void* out, const size_t n ) {
+    switch ( type ) {
+    case ColumnType::Int:
+        std::fill_n( (int32_t*)out, n, (int32_t)scalar );
+        break;
+    case ColumnType::Float:
+        std::fill_n( (float*)out, n, scalar );
+        break;
+    case ColumnType::Double:
+        std::fill_n( (double*)out, n, (double)scalar );
+        break;
+    }
+}
+
+struct AlignedDelete {
+    void operator()( void* p ) const { ::operator delete( p, std::align_val_t( Column::Alignment ) ); }
+};
+
+}  // namespace
+
+Column::Column( const ColumnType type, const size_t size )
+    : _type( type )
+    , _size( size ) {
+    // 末尾补齐到整个对齐单位，SIMD 读写最后一组元素时不会越过分配的内存
+    const size_t bytes = ( size * ColumnTypeSize( type ) + Alignment - 1 ) / Alignment * Alignment;
+    _data = ::operator new( bytes ? bytes : Alignment, std::align_val_t( Alignment ) );
+}
+
+Column::~Column() {
+    ::operator delete( _data, std::align_val_t( Alignment ) );
+}
+
+uint64_t Column::Hash() const {
+    uint64_t hash = _hash.load( std::memory_order_relaxed );
+    if ( hash )
+        return hash;
+    // 四路独立累加，乘法链之间没有依赖；只读取有效元素，不读取末尾补齐的部分
+    constexpr uint64_t Prime = 0x9E3779B97F4A7C15ull;
+    const size_t bytes = _size * ColumnTypeSize( _type );
+    const unsigned char* data = (const unsigned char*)_data;
+    uint64_t lanes[ 4 ] = { 1, 2, 3, 4 };
+    size_t i = 0;
+    for ( ; i + 32 <= bytes; i += 32 ) {
+        for ( int k = 0; k < 4; ++k ) {
+            uint64_t word;
+            memcpy( &word, data + i + k * 8, 8 );
+            lanes[ k ] = ( lanes[ k ] ^ word ) * Prime;
+            lanes[ k ] ^= lanes[ k ] >> 29;
+        }
+    }
+    hash = ( (uint64_t)_type << 56 ) ^ bytes;
+    for ( ; i < bytes; ++i )
+        hash = ( hash ^ data[ i ] ) * Prime;
+    for ( const uint64_t lane : lanes )
+        hash = ( ( hash ^ lane ) * Prime ) ^ ( hash >> 31 );
+    // 0 表示尚未计算
+    hash = hash ? hash : 1;
+    _hash.store( hash, std::memory_order_relaxed );
+    return hash;
+}
+
+size_t ColumnTypeSize( const ColumnType type ) {
+    return type == ColumnType::Double ? sizeof( double ) : 4;
+}
+
+const char* ColumnTypeName( const ColumnType type ) {
+    switch ( type ) {
+    case ColumnType::Int:
+        return "i32";
+    case ColumnType::Float:
+        return "f32";
+    default:
+        return "f64";
+    }
+}
+
+ColumnIsa DetectColumnIsa() {
+#if defined( COLUMN_X86 )
+    if ( CpuSupports( ColumnIsa::Avx512 ) )
+        return ColumnIsa::Avx512;
+    if ( CpuSupports( ColumnIsa::Avx2 ) )
+        return ColumnIsa::Avx2;
+#endif
+    return ColumnIsa::Scalar;
+}
+
+ColumnIsa GetColumnIsa() {
+    return (ColumnIsa)ActiveIsa.load( std::memory_order_relaxed );
+}
+
+void SetColumnIsa( const ColumnIsa isa ) {
+    ActiveIsa = (int)std::min( isa, DetectColumnIsa() );
+}
+
+const char* ColumnIsaName( const ColumnIsa isa ) {
+    switch ( isa ) {
+    case ColumnIsa::Avx512:
+        return "AVX-512";
+    case ColumnIsa::Avx2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
+
+int ColumnProgram::Leaf( const PinValue& value ) {
+    Instruction leaf = { true, ColumnOp::Add, -1, -1, 0.0f, nullptr };
+    if ( const float* number = value.As<float>() )
+        leaf.scalar = *number;
+    else if ( const ColumnPtr* column = value.As<ColumnPtr>() )
+        leaf.column = *column;
+    _code.push_back( std::move( leaf ) );
+    return (int)_code.size() - 1;
+}
+
+int ColumnProgram::Apply( const ColumnOp op, const int lhs, const int rhs ) {
+    _code.push_back( Instruction{ false, op, lhs, rhs, 0.0f, nullptr } );
+    return (int)_code.size() - 1;
+}
+
+size_t ColumnProgram::OpCount() const {
+    return (size_t)std::count_if( _code.begin(), _code.end(), []( const Instruction& i ) { return !i.leaf; } );
+}
+
+void ColumnProgram::ExecuteScalar( const int* roots, const size_t count, PinValue* results ) const {
+    std::vector<float> values( _code.size() );
+    for ( size_t i = 0; i < _code.size(); ++i ) {
+        const Instruction& code = _code[ i ];
+        values[ i ] = code.leaf ? code.scalar : ApplyColumnOp( code.op, values[ code.lhs ], values[ code.rhs ] );
+    }
+    for ( size_t r = 0; r < count; ++r )
+        results[ r ] = values[ roots[ r ] ];
+}
+
+void ColumnProgram::Execute( const int* roots, const size_t count, PinValue* results ) const {
+    bool hasColumn = false;
+    ColumnType type = ColumnType::Int;
+    size_t size = SIZE_MAX;
+    for ( const Instruction& code : _code ) {
+        if ( code.column ) {
+            hasColumn = true;
+            type = std::max( type, code.column->Type() );
+            size = std::min( size, code.column->Size() );
+        }
+    }
+    if ( !hasColumn ) {
+        ExecuteScalar( roots, count, results );
+        return;
+    }
+
+    // 每条指令的结果放在哪里：结果列、原列（类型相同的列叶子不复制）或暂存块。
+    // 暂存块在最后一次被读取之后回收，长链只需要两三个暂存块
+    const size_t n = _code.size();
+    std::vector<int> lastUse( n, -1 );
+    for ( size_t i = 0; i < n; ++i ) {
+        if ( !_code[ i ].leaf ) {
+            lastUse[ _code[ i ].lhs ] = (int)i;
+            lastUse[ _code[ i ].rhs ] = (int)i;
+        }
+    }
+    std::vector<int> rootOf( n, -1 );
+    std::vector<std::shared_ptr<Column>> outputs( count );
+    for ( size_t r = 0; r < count; ++r ) {
+        if ( rootOf[ roots[ r ] ] < 0 && !_code[ roots[ r ] ].leaf ) {
+            rootOf[ roots[ r ] ] = (int)r;
+            outputs[ r ] = std::make_shared<Column>( type, size );
+        }
+    }
+    // 叶子在所有块中都保持不变的标量，暂存块只填充一次
+    std::vector<int> slot( n, -1 );
+    std::vector<int> freeSlots;
+    int slotCount = 0;
+    const auto allocate = [ & ]() {
+        if ( freeSlots.empty() )
+            return slotCount++;
+        const int s = freeSlots.back();
+        freeSlots.pop_back();
+        return s;
+    };
+    for ( size_t i = 0; i < n; ++i ) {
+        const Instruction& code = _code[ i ];
+        if ( !code.leaf ) {
+            for ( const int operand : { code.lhs, code.rhs } ) {
+                if ( slot[ operand ] >= 0 && lastUse[ operand ] == (int)i && !_code[ operand ].leaf ) {
+                    freeSlots.push_back( slot[ operand ] );
+                    lastUse[ operand ] = -2;
+                }
+            }
+            if ( rootOf[ i ] < 0 )
+                slot[ i ] = allocate();
+        }
+        else if ( !code.column || code.column->Type() != type ) {
+            // 标量与需要转换类型的列占用固定的暂存块
+            slot[ i ] = allocate();
+        }
+    }
+
+    const size_t elementSize = ColumnTypeSize( type );
+    const size_t blockBytes = BlockSize * elementSize;
+    std::unique_ptr<char, AlignedDelete> scratch(
+        (char*)::operator new( std::max<size_t>( 1, slotCount ) * blockBytes, std::align_val_t( Column::Alignment ) ) );
+    for ( size_t i = 0; i < n; ++i ) {
+        if ( _code[ i ].leaf && !_code[ i ].column )
+            FillBlock( type, _code[ i ].scalar, scratch.get() + slot[ i ] * blockBytes, BlockSize );
+    }
+
+    const BinaryKernel kernel = Kernels()[ (int)type ];
+    std::vector<const void*> source( n );
+    for ( size_t begin = 0; begin < size; begin += BlockSize ) {
+        const size_t length = std::min( BlockSize, size - begin );
+        for ( size_t i = 0; i < n; ++i ) {
+            const Instruction& code = _code[ i ];
+            if ( code.leaf ) {
+                char* block = slot[ i ] >= 0 ? scratch.get() + slot[ i ] * blockBytes : nullptr;
+                if ( !code.column ) {
+                    source[ i ] = block;
+                }
+                else if ( code.column->Type() == type ) {
+                    source[ i ] = (const char*)code.column->Data() + begin * elementSize;
+                }
+                else {
+                    const size_t from = ColumnTypeSize( code.column->Type() );
+                    ConvertBlock( code.column->Type(), (const char*)code.column->Data() + begin * from, type, block, length );
+                    source[ i ] = block;
+                }
+                continue;
+            }
+            void* out = rootOf[ i ] >= 0 ? (char*)outputs[ rootOf[ i ] ]->Data() + begin * elementSize
+                                         : scratch.get() + slot[ i ] * blockBytes;
+            kernel( code.op, source[ code.lhs ], source[ code.rhs ], out, length );
+            source[ i ] = out;
+        }
+    }
+
+    for ( size_t r = 0; r < count; ++r ) {
+        if ( _code[ roots[ r ] ].leaf ) {
+            results[ r ] = _code[ roots[ r ] ].column ? PinValue( _code[ roots[ r ] ].column ) : PinValue( _code[ roots[ r ] ].scalar );
+        }
+        else {
+            const int owner = rootOf[ roots[ r ] ];
+            results[ r ] = ColumnPtr( outputs[ owner ] );
+        }
+    }
+}
@@ -0,0 +1,89 @@
+﻿#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 列：按 64 字节对齐、连续存放的一组数值。引脚之间通过 ColumnPtr 共享，创建后不再修改
+enum class ColumnType : uint8_t { Int = 0, Float, Double };
+
+class Column {
+public:
+    static constexpr size_t Alignment = 64;
+
+    // 内容未初始化
+    Column( ColumnType type, size_t size );
+    ~Column();
+
+    Column( const Column& ) = delete;
+    Column& operator=( const Column& ) = delete;
+
+    ColumnType Type() const { return _type; }
+    size_t Size() const { return _size; }
+    void* Data() { return _data; }
+    const void* Data() const { return _data; }
+
+    // 类型、长度与内容的哈希。第一次调用时计算并保存，之后内容不能再修改
+    uint64_t Hash() const;
+
+private:
+    ColumnType _type;
+    size_t _size;
+    void* _data;
+    mutable std::atomic<uint64_t> _hash = 0;
+};
+
+using ColumnPtr = std::shared_ptr<const Column>;
+
+class PinValue;
+
+size_t ColumnTypeSize( ColumnType type );
+const char* ColumnTypeName( ColumnType type );
+
+// 逐元素运算
+enum class ColumnOp : uint8_t { Add = 0, Sub };
+
+inline float ApplyColumnOp( const ColumnOp op, const float a, const float b ) {
+    return op == ColumnOp::Add ? a + b : a - b;
+}
+
+// 融合执行时没有物化的中间结果。引脚持有它时，值由下游节点沿连线展开计算
+struct FusedValue {};
+
+// 运行时按 CPU 支持选择的 SIMD 指令集
+enum class ColumnIsa { Scalar = 0, Avx2, Avx512 };
+
+ColumnIsa DetectColumnIsa();
+// 当前使用的指令集，默认为 DetectColumnIsa()。设置不支持的指令集时退回到支持的最高一级
+ColumnIsa GetColumnIsa();
+void SetColumnIsa( ColumnIsa isa );
+const char* ColumnIsaName( ColumnIsa isa );
+
+// 逐元素表达式。叶子是标量 (float) 或列，运算按添加顺序排列，操作数只能引用之前的叶子或运算。
+// 执行时按块计算：每块的中间结果放在 L1 大小的对齐暂存区中并尽早复用，不为中间结果分配整列
+class ColumnProgram {
+public:
+    // 叶子：float 或 ColumnPtr，其他值按 0 处理
+    int Leaf( const PinValue& value );
+    int Apply( ColumnOp op, int lhs, int rhs );
+
+    // 计算 roots 指定的结果。全是标量时结果为 float；否则为列，元素类型取列叶子中最宽的类型
+    // (Int < Float < Double)，标量转换为该类型，长度取最短的列
+    void Execute( const int* roots, size_t count, PinValue* results ) const;
+
+    size_t OpCount() const;
+
+private:
+    struct Instruction {
+        bool leaf;
+        ColumnOp op;
+        int lhs, rhs;
+        float scalar;
+        ColumnPtr column;
+    };
+
+    void ExecuteScalar( const int* roots, size_t count, PinValue* results ) const;
+
+    std::vector<Instruction> _code;
+};
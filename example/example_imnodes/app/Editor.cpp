@@ -0,0 +1,115 @@
+﻿#include "Editor.h"
+
+const Pin* FindPin( const Editor& editor, const int id ) {
+    for ( const auto& node : editor.nodes ) {
+        for ( const Pin& pin : node->pins ) {
+            if ( pin.pid == id )
+                return &pin;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<ResolvedLink> ResolveLinks( const Editor& editor ) {
+    struct PinRef {
+        uint32_t node, pin;
+    };
+    size_t pinCount = 0;
+    for ( const auto& node : editor.nodes )
+        pinCount += node->pins.size();
+    std::unordered_map<int, PinRef> owners;
+    owners.reserve( pinCount );
+    for ( uint32_t i = 0; i < editor.nodes.size(); ++i ) {
+        const std::pmr::vector<Pin>& pins = editor.nodes[ i ]->pins;
+        for ( uint32_t p = 0; p < pins.size(); ++p )
+            owners.emplace( pins[ p ].pid, PinRef{ i, p } );
+    }
+
+    std::vector<ResolvedLink> links;
+    links.reserve( editor.links.size() );
+    for ( const Link& link : editor.links ) {
+        const auto a = owners.find( link.start_attr );
+        const auto b = owners.find( link.end_attr );
+        if ( a == owners.end() || b == owners.end() )
+            continue;
+        PinRef from = a->second;
+        PinRef to = b->second;
+        if ( editor.nodes[ from.node ]->pins[ from.pin ].ptype == PinType::Input )
+            std::swap( from, to );
+        if ( !CanLink( editor.nodes[ from.node ]->pins[ from.pin ], editor.nodes[ to.node ]->pins[ to.pin ] ) )
+            continue;
+        links.push_back( ResolvedLink{ link.id, from.node, from.pin, to.node, to.pin } );
+    }
+    return links;
+}
+
+void MarkLinkedPins( Editor& editor, const std::vector<ResolvedLink>& links ) {
+    for ( const auto& node : editor.nodes ) {
+        for ( Pin& pin : node->pins )
+            pin.isLinked = false;
+    }
+    for ( const ResolvedLink& link : links ) {
+        editor.nodes[ link.fromNode ]->pins[ link.fromPin ].isLinked = true;
+        editor.nodes[ link.toNode ]->pins[ link.toPin ].isLinked = true;
+    }
+}
+
+std::vector<uint32_t> TopologicalSort( const size_t nodeCount, const std::vector<ResolvedLink>& links ) {
+    // 每个节点的下游节点，按起始位置连续存放
+    std::vector<uint32_t> inDegree( nodeCount, 0 );
+    std::vector<uint32_t> outBegin( nodeCount + 1, 0 );
+    for ( const ResolvedLink& link : links ) {
+        ++inDegree[ link.toNode ];
+        ++outBegin[ link.fromNode + 1 ];
+    }
+    for ( size_t i = 0; i < nodeCount; ++i )
+        outBegin[ i + 1 ] += outBegin[ i ];
+    std::vector<uint32_t> downstream( links.size() );
+    {
+        std::vector<uint32_t> cursor( outBegin.begin(), outBegin.end() - 1 );
+        for ( const ResolvedLink& link : links )
+            downstream[ cursor[ link.fromNode ]++ ] = link.toNode;
+    }
+
+    std::vector<uint32_t> order;
+    order.reserve( nodeCount );
+    for ( uint32_t i = 0; i < nodeCount; ++i ) {
+        if ( inDegree[ i ] == 0 )
+            order.push_back( i );
+    }
+    for ( size_t head = 0; head < order.size(); ++head ) {
+        const uint32_t node = order[ head ];
+        for ( uint32_t e = outBegin[ node ]; e < outBegin[ node + 1 ]; ++e ) {
+            if ( --inDegree[ downstream[ e ] ] == 0 )
+                order.push_back( downstream[ e ] );
+        }
+    }
+    return order;
+}
+
+std::shared_ptr<NodeBase> CloneNode( const NodeBase& original ) {
+    std::shared_ptr<NodeBase> node = MakeNode( original.kind, original.node_id );
+    if ( !node )
+        node = std::make_shared<NodeBase>( original.node_id );
+    for ( size_t p = 0; p < node->pins.size() && p < original.pins.size(); ++p ) {
+        node->pins[ p ].pid = original.pins[ p ].pid;
+        node->pins[ p ].Assign( original.pins[ p ].value );
+    }
+    return node;
+}
+
+void DrawGraph( const Editor& editor, std::vector<NodeBase*>* edited, const std::unordered_map<int, ImU32>* linkColors ) {
+    for ( const auto& node : editor.nodes ) {
+        if ( node->Render() && edited )
+            edited->push_back( node.get() );
+    }
+    for ( const Link& link : editor.links ) {
+        const auto color = linkColors ? linkColors->find( link.id ) : std::unordered_map<int, ImU32>::const_iterator();
+        const bool colored = linkColors && color != linkColors->end();
+        if ( colored )
+            ImNodes::PushColorStyle( ImNodesCol_Link, color->second );
+        ImNodes::Link( link.id, link.start_attr, link.end_attr );
+        if ( colored )
+            ImNodes::PopColorStyle();
+    }
+}
@@ -0,0 +1,60 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "History.h"
+#include "node.h"
+
+struct Link {
+    int id;
+    int start_attr, end_attr;
+
+    Link() = default;
+    Link( const int i, const int s, const int e )
+        : id( i )
+        , start_attr( s )
+        , end_attr( e ) {}
+};
+
+struct Editor {
+    ImNodesEditorContext* context = nullptr;
+    std::vector<std::shared_ptr<NodeBase>> nodes;
+    std::vector<Link> links;
+    int current_id = 0;
+    // 每次增删节点或连线后递增，求值器据此判断是否需要重建调度
+    uint64_t revision = 0;
+    EditHistory history;
+
+    ~Editor() {
+        if ( context )
+            ImNodes::EditorContextFree( context );
+    }
+};
+
+// 按 id 查找引脚，找不到时返回 nullptr
+const Pin* FindPin( const Editor& editor, int id );
+
+// 解析后的连线：节点为 editor.nodes 中的下标，引脚为节点 pins 中的下标，from 一端是输出，to 一端是输入
+struct ResolvedLink {
+    int id;
+    uint32_t fromNode, fromPin;
+    uint32_t toNode, toPin;
+};
+
+// 按 editor.links 的顺序解析连线。连线两端可能是任意顺序，统一为输出 -> 输入；
+// 找不到引脚、两端方向相同或值类型不兼容的连线忽略。同一个输入连了多条线时都保留，求值时最后一条生效
+std::vector<ResolvedLink> ResolveLinks( const Editor& editor );
+// 按解析后的连线重新设置全部引脚的 isLinked
+void MarkLinkedPins( Editor& editor, const std::vector<ResolvedLink>& links );
+// Kahn 算法，返回节点下标的拓扑顺序。没有入边的节点按 editor.nodes 中的顺序开始，结果与运行次数无关；
+// 位于环路中或环路下游的节点不在结果中
+std::vector<uint32_t> TopologicalSort( size_t nodeCount, const std::vector<ResolvedLink>& links );
+// 复制节点的类型、id、引脚 id 与引脚的值，其余状态为初始值。未知类型的节点复制为 NodeBase
+std::shared_ptr<NodeBase> CloneNode( const NodeBase& node );
+
+// 提交 editor 的全部节点与连线，需在 ImNodes::BeginNodeEditor / EndNodeEditor 之间调用。
+// 用户修改了输入值的节点放入 edited；linkColors 中的连线使用指定的颜色
+void DrawGraph( const Editor& editor, std::vector<NodeBase*>* edited = nullptr,
+                const std::unordered_map<int, ImU32>* linkColors = nullptr );
@@ -0,0 +1,614 @@
+﻿#include "Evaluator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#include "Editor.h"
+
+namespace {
+
+bool IsElementwise( const NodeBase& node ) {
+    ElementwiseOp op;
+    for ( size_t p = 0; p < node.pins.size(); ++p ) {
+        if ( node.Elementwise( p, op ) )
+            return true;
+    }
+    return false;
+}
+
+// 节点 from 的输出连到节点 to 的输入
+struct Dependency {
+    uint32_t from, to;
+    const Pin* source;
+    Pin* target;
+};
+
+}  // namespace
+
+void GraphEvaluator::MarkDirty( NodeBase& node ) {
+    // 已经是脏的节点要么在 _pending 中，要么会在下次调度时被找到
+    if ( node.dirty )
+        return;
+    node.dirty = true;
+    _pending.push_back( &node );
+}
+
+bool GraphEvaluator::Update( Editor& editor, WorkStealingPool* pool ) {
+    const bool rebuild = _editor != &editor || _revision != editor.revision;
+    if ( !rebuild && _pending.empty() && _queue.empty() )
+        return false;
+    const auto start = std::chrono::steady_clock::now();
+    if ( rebuild ) {
+        Schedule( editor );
+    }
+    else {
+        for ( NodeBase* node : _pending ) {
+            const auto it = _position.find( node );
+            if ( it != _position.end() )
+                Push( it->second );
+        }
+    }
+    _pending.clear();
+    _cancelled = false;
+    _ranTape = _useTape && _tapeReady && RunTape();
+    if ( !_ranTape ) {
+        _tapeLoaded = false;
+        if ( pool )
+            RunParallel( *pool );
+        else
+            Run();
+    }
+    _lastMs = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+    return _computed > 0;
+}
+
+void GraphEvaluator::SetFusion( const bool fusion ) {
+    if ( _fusion == fusion )
+        return;
+    _fusion = fusion;
+    _editor = nullptr;
+}
+
+void GraphEvaluator::SetTape( const bool tape ) {
+    _useTape = tape;
+    _tapeLoaded = false;
+}
+
+void GraphEvaluator::Evaluate( Editor& editor, WorkStealingPool* pool ) {
+    for ( const auto& node : editor.nodes )
+        node->dirty = true;
+    _editor = nullptr;
+    Update( editor, pool );
+}
+
+void GraphEvaluator::Schedule( Editor& editor ) {
+    const size_t nodeCount = editor.nodes.size();
+    const std::vector<ResolvedLink> links = ResolveLinks( editor );
+    MarkLinkedPins( editor, links );
+
+    std::vector<Dependency> dependencies;
+    dependencies.reserve( links.size() );
+    for ( const ResolvedLink& link : links ) {
+        dependencies.push_back( Dependency{ link.fromNode, link.toNode, &editor.nodes[ link.fromNode ]->pins[ link.fromPin ],
+                                            &editor.nodes[ link.toNode ]->pins[ link.toPin ] } );
+    }
+
+    const std::vector<uint32_t> order = TopologicalSort( nodeCount, links );
+    _blocked = nodeCount - order.size();
+
+    // 输入来源按节点的求值顺序分组；同一节点内保持连线顺序，同一个输入连了多条线时最后一条生效
+    constexpr uint32_t Unscheduled = ~0u;
+    std::vector<uint32_t> position( nodeCount, Unscheduled );
+    for ( uint32_t i = 0; i < order.size(); ++i )
+        position[ order[ i ] ] = i;
+    _routeBegin.assign( order.size() + 1, 0 );
+    _fanoutBegin.assign( order.size() + 1, 0 );
+    for ( const Dependency& d : dependencies ) {
+        if ( position[ d.to ] != Unscheduled ) {
+            ++_routeBegin[ position[ d.to ] + 1 ];
+            ++_fanoutBegin[ position[ d.from ] + 1 ];
+        }
+    }
+    for ( size_t i = 0; i < order.size(); ++i ) {
+        _routeBegin[ i + 1 ] += _routeBegin[ i ];
+        _fanoutBegin[ i + 1 ] += _fanoutBegin[ i ];
+    }
+    _routes.resize( _routeBegin.back() );
+    _fanout.resize( _fanoutBegin.back() );
+    {
+        std::vector<uint32_t> cursor( _routeBegin.begin(), _routeBegin.end() - 1 );
+        std::vector<uint32_t> fanoutCursor( _fanoutBegin.begin(), _fanoutBegin.end() - 1 );
+        for ( const Dependency& d : dependencies ) {
+            const uint32_t target = position[ d.to ];
+            if ( target == Unscheduled )
+                continue;
+            const uint32_t r = cursor[ target ]++;
+            _routes[ r ] = Route{ d.source, d.target, position[ d.from ], target };
+            _fanout[ fanoutCursor[ position[ d.from ] ]++ ] = r;
+        }
+    }
+
+    _order.resize( order.size() );
+    _position.clear();
+    _position.reserve( order.size() );
+    for ( uint32_t i = 0; i < order.size(); ++i ) {
+        _order[ i ] = editor.nodes[ order[ i ] ].get();
+        _position.emplace( _order[ i ], i );
+    }
+    _inCone.assign( _order.size(), 0 );
+
+    // 逐元素节点的输出全部连到同一个逐元素节点时可以融合；融合链过长时在中间物化一次
+    _fusable.assign( _order.size(), 0 );
+    std::vector<uint32_t> chain( _order.size(), 0 );
+    ElementwiseOp op;
+    for ( uint32_t i = 0; i < _order.size(); ++i ) {
+        for ( uint32_t r = _routeBegin[ i ]; r < _routeBegin[ i + 1 ]; ++r ) {
+            if ( _fusable[ _routes[ r ].source ] )
+                chain[ i ] = std::max( chain[ i ], chain[ _routes[ r ].source ] + 1 );
+        }
+        if ( _fanoutBegin[ i ] == _fanoutBegin[ i + 1 ] || chain[ i ] + 1 >= MaxFusedChain )
+            continue;
+        const NodeBase& node = *_order[ i ];
+        const uint32_t consumer = _routes[ _fanout[ _fanoutBegin[ i ] ] ].target;
+        bool fusable = IsElementwise( *_order[ consumer ] );
+        for ( uint32_t f = _fanoutBegin[ i ]; f < _fanoutBegin[ i + 1 ] && fusable; ++f ) {
+            const Route& route = _routes[ _fanout[ f ] ];
+            fusable = route.target == consumer && node.Elementwise( (size_t)( route.from - node.pins.data() ), op );
+        }
+        _fusable[ i ] = fusable;
+    }
+    _waiting.reset( new std::atomic<uint32_t>[ _order.size() ] );
+
+    // 新节点、被修改过的节点，以及连线改变后输入与上游版本不一致的节点需要计算
+    _queue.clear();
+    for ( uint32_t i = 0; i < _order.size(); ++i ) {
+        bool dirty = _order[ i ]->dirty;
+        // 断开连线后留下的未物化值无法再展开；不再融合的节点需要物化输出
+        for ( Pin& pin : _order[ i ]->pins ) {
+            if ( !pin.As<FusedValue>() )
+                continue;
+            if ( pin.ptype == PinType::Input && !pin.isLinked ) {
+                pin.Set( 0.0f );
+                dirty = true;
+            }
+            else if ( pin.ptype == PinType::Output && !( _fusion && _fusable[ i ] ) ) {
+                dirty = true;
+            }
+        }
+        for ( uint32_t r = _routeBegin[ i ]; r < _routeBegin[ i + 1 ] && !dirty; ++r )
+            dirty = _routes[ r ].to->version != _routes[ r ].from->version;
+        if ( dirty )
+            Push( i );
+    }
+    CompileTape();
+    _editor = &editor;
+    _revision = editor.revision;
+}
+
+void GraphEvaluator::Push( const uint32_t position ) {
+    _order[ position ]->dirty = true;
+    _queue.push_back( position );
+    std::push_heap( _queue.begin(), _queue.end(), std::greater<uint32_t>() );
+}
+
+void GraphEvaluator::Run() {
+    _computed = 0;
+    while ( !_queue.empty() ) {
+        if ( _cancel && _cancel->load( std::memory_order_relaxed ) ) {
+            _cancelled = true;
+            break;
+        }
+        std::pop_heap( _queue.begin(), _queue.end(), std::greater<uint32_t>() );
+        const uint32_t i = _queue.back();
+        _queue.pop_back();
+        NodeBase* node = _order[ i ];
+        // 同一节点可能被多个上游放入队列
+        if ( !node->dirty )
+            continue;
+        node->dirty = false;
+
+        for ( uint32_t r = _routeBegin[ i ]; r < _routeBegin[ i + 1 ]; ++r ) {
+            Route& route = _routes[ r ];
+            if ( route.to->version != route.from->version ) {
+                route.to->value = route.from->value;
+                route.to->version = route.from->version;
+            }
+        }
+        Compute( i );
+        ++_computed;
+
+        // 只有输出的值改变了，下游才需要重新计算
+        for ( uint32_t f = _fanoutBegin[ i ]; f < _fanoutBegin[ i + 1 ]; ++f ) {
+            const Route& route = _routes[ _fanout[ f ] ];
+            if ( route.to->version != route.from->version && !_order[ route.target ]->dirty )
+                Push( route.target );
+        }
+    }
+}
+
+void GraphEvaluator::RunParallel( WorkStealingPool& pool ) {
+    // 脏节点的全部下游。是否真正需要计算要等上游完成后按版本号判断，这里只确定依赖关系
+    _cone.clear();
+    for ( const uint32_t i : _queue ) {
+        if ( !_inCone[ i ] ) {
+            _inCone[ i ] = 1;
+            _cone.push_back( i );
+        }
+    }
+    _queue.clear();
+    for ( size_t k = 0; k < _cone.size(); ++k ) {
+        const uint32_t i = _cone[ k ];
+        for ( uint32_t f = _fanoutBegin[ i ]; f < _fanoutBegin[ i + 1 ]; ++f ) {
+            const uint32_t target = _routes[ _fanout[ f ] ].target;
+            if ( !_inCone[ target ] ) {
+                _inCone[ target ] = 1;
+                _cone.push_back( target );
+            }
+        }
+    }
+
+    for ( const uint32_t i : _cone )
+        _waiting[ i ].store( 0, std::memory_order_relaxed );
+    for ( const uint32_t i : _cone ) {
+        for ( uint32_t f = _fanoutBegin[ i ]; f < _fanoutBegin[ i + 1 ]; ++f )
+            _waiting[ _routes[ _fanout[ f ] ].target ].fetch_add( 1, std::memory_order_relaxed );
+    }
+    std::vector<uint32_t> roots;
+    for ( const uint32_t i : _cone ) {
+        if ( _waiting[ i ].load( std::memory_order_relaxed ) == 0 )
+            roots.push_back( i );
+    }
+
+    // 每个节点只由一个任务访问；上游的写入通过 _waiting 的 acq_rel 递减对下游可见。
+    // 取消后的任务不再计算也不派生下游，正在执行的任务完成后 Run 即返回
+    std::atomic<size_t> computed = 0;
+    std::atomic<bool> cancelled = false;
+    pool.Run( roots, [ & ]( const uint32_t i, const int worker ) {
+        NodeBase* node = _order[ i ];
+        if ( _cancel && _cancel->load( std::memory_order_relaxed ) ) {
+            cancelled.store( true, std::memory_order_relaxed );
+            return;
+        }
+        bool changed = node->dirty;
+        for ( uint32_t r = _routeBegin[ i ]; r < _routeBegin[ i + 1 ]; ++r ) {
+            Route& route = _routes[ r ];
+            if ( route.to->version != route.from->version ) {
+                route.to->value = route.from->value;
+                route.to->version = route.from->version;
+                changed = true;
+            }
+        }
+        if ( changed ) {
+            Compute( i );
+            node->dirty = false;
+            computed.fetch_add( 1, std::memory_order_relaxed );
+        }
+        for ( uint32_t f = _fanoutBegin[ i ]; f < _fanoutBegin[ i + 1 ]; ++f ) {
+            const uint32_t target = _routes[ _fanout[ f ] ].target;
+            if ( _waiting[ target ].fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+                pool.Spawn( worker, target );
+        }
+    } );
+
+    // 未计算的脏节点，以及上游已经改变而自己被跳过的节点，放回队列由下一次 Update 继续
+    _cancelled = cancelled.load( std::memory_order_relaxed );
+    for ( const uint32_t i : _cone ) {
+        _inCone[ i ] = 0;
+        if ( !_cancelled )
+            continue;
+        bool pending = _order[ i ]->dirty;
+        for ( uint32_t r = _routeBegin[ i ]; r < _routeBegin[ i + 1 ] && !pending; ++r )
+            pending = _routes[ r ].to->version != _routes[ r ].from->version;
+        if ( pending )
+            Push( i );
+    }
+    _computed = computed;
+}
+
+void GraphEvaluator::Compute( const uint32_t position ) {
+    NodeBase* node = _order[ position ];
+    bool scalar = true;
+    bool columns = false;
+    bool fused = false;
+    for ( const Pin& pin : node->pins ) {
+        if ( pin.ptype != PinType::Input || pin.As<float>() )
+            continue;
+        scalar = false;
+        fused |= pin.As<FusedValue>() != nullptr;
+        columns |= pin.As<ColumnPtr>() != nullptr;
+    }
+    if ( scalar ) {
+        node->Compute();
+        return;
+    }
+    // 标量直接计算，结果显示在节点中；有列时才推迟到下游
+    if ( _fusion && _fusable[ position ] && ( columns || fused ) ) {
+        for ( Pin& pin : node->pins ) {
+            if ( pin.ptype == PinType::Output )
+                pin.Assign( FusedValue{} );
+        }
+        return;
+    }
+    // 融合的输入按上游的输入内容计算键，整条链命中时不执行 ColumnProgram
+    uint64_t key = 0;
+    const bool memoize = _memo && MemoKey( position, key );
+    std::vector<PinValue> outputs;
+    if ( memoize && _memo->Find( key, outputs ) ) {
+        size_t r = 0;
+        for ( Pin& pin : node->pins ) {
+            if ( pin.ptype == PinType::Output && r < outputs.size() )
+                pin.Assign( std::move( outputs[ r++ ] ) );
+        }
+        return;
+    }
+    if ( fused )
+        ComputeFused( position );
+    else
+        node->Compute();
+    if ( memoize ) {
+        for ( const Pin& pin : node->pins ) {
+            if ( pin.ptype == PinType::Output )
+                outputs.push_back( pin.value );
+        }
+        _memo->Insert( key, std::move( outputs ) );
+    }
+}
+
+bool GraphEvaluator::MemoKey( const uint32_t position, uint64_t& key ) const {
+    const NodeBase* node = _order[ position ];
+    key = HashCombine( 0, (uint64_t)node->kind );
+    for ( const Pin& pin : node->pins ) {
+        if ( pin.ptype != PinType::Input )
+            continue;
+        uint64_t hash;
+        if ( pin.As<FusedValue>() ) {
+            // 没有物化的值由上游节点的键与输出引脚确定
+            const Route* source = SourceOf( position, pin );
+            if ( !source || !MemoKey( source->source, hash ) )
+                return false;
+            hash = HashCombine( hash, (uint64_t)( source->from - _order[ source->source ]->pins.data() ) );
+        }
+        else if ( !HashValue( pin.value, hash ) ) {
+            return false;
+        }
+        key = HashCombine( key, hash );
+    }
+    return true;
+}
+
+const GraphEvaluator::Route* GraphEvaluator::SourceOf( const uint32_t position, const Pin& input ) const {
+    // 同一个输入连了多条线时最后一条生效
+    const Route* source = nullptr;
+    for ( uint32_t r = _routeBegin[ position ]; r < _routeBegin[ position + 1 ]; ++r ) {
+        if ( _routes[ r ].to == &input )
+            source = &_routes[ r ];
+    }
+    return source;
+}
+
+void GraphEvaluator::ComputeFused( const uint32_t position ) {
+    NodeBase* node = _order[ position ];
+    ColumnProgram program;
+    std::vector<std::pair<const Pin*, int>> memo;
+    std::vector<int> roots;
+    std::vector<size_t> outputs;
+    ElementwiseOp op;
+    for ( size_t p = 0; p < node->pins.size(); ++p ) {
+        if ( !node->Elementwise( p, op ) )
+            continue;
+        const int lhs = Expand( program, position, op.lhs, memo );
+        const int rhs = Expand( program, position, op.rhs, memo );
+        roots.push_back( program.Apply( op.op, lhs, rhs ) );
+        outputs.push_back( p );
+    }
+    std::vector<PinValue> results( roots.size() );
+    program.Execute( roots.data(), roots.size(), results.data() );
+    for ( size_t r = 0; r < roots.size(); ++r )
+        node->pins[ outputs[ r ] ].Assign( std::move( results[ r ] ) );
+}
+
+int GraphEvaluator::Expand( ColumnProgram& program, const uint32_t position, const int pin,
+                            std::vector<std::pair<const Pin*, int>>& memo ) const {
+    const Pin& input = _order[ position ]->pins[ pin ];
+    for ( const auto& [ expanded, index ] : memo ) {
+        if ( expanded == &input )
+            return index;
+    }
+
+    int index;
+    if ( input.As<FusedValue>() ) {
+        // 沿最后一条连到该输入的连线展开上游节点的运算
+        const Route* source = SourceOf( position, input );
+        const NodeBase* upstream = source ? _order[ source->source ] : nullptr;
+        ElementwiseOp op;
+        if ( upstream && upstream->Elementwise( (size_t)( source->from - upstream->pins.data() ), op ) ) {
+            const int lhs = Expand( program, source->source, op.lhs, memo );
+            const int rhs = Expand( program, source->source, op.rhs, memo );
+            index = program.Apply( op.op, lhs, rhs );
+        }
+        else {
+            index = program.Leaf( 0.0f );
+        }
+    }
+    else {
+        index = program.Leaf( input.value );
+    }
+    memo.emplace_back( &input, index );
+    return index;
+}
+
+void GraphEvaluator::CompileTape() {
+    _tape.clear();
+    _params.clear();
+    _results.clear();
+    _paramBegin.assign( 1, 0 );
+    _resultBegin.assign( 1, 0 );
+    _tapeReady = false;
+    _tapeLoaded = false;
+
+    // 每个节点的引脚占用一段连续的寄存器；连接的输入改为读取上游输出的寄存器，自己的寄存器不使用
+    std::vector<uint32_t> regBase( _order.size() + 1, 0 );
+    for ( uint32_t i = 0; i < _order.size(); ++i )
+        regBase[ i + 1 ] = regBase[ i ] + (uint32_t)_order[ i ]->pins.size();
+
+    std::vector<uint32_t> pinReg;
+    ElementwiseOp op;
+    for ( uint32_t i = 0; i < _order.size(); ++i ) {
+        NodeBase& node = *_order[ i ];
+        const size_t pinCount = node.pins.size();
+        pinReg.resize( pinCount );
+        for ( uint32_t p = 0; p < pinCount; ++p )
+            pinReg[ p ] = regBase[ i ] + p;
+        // 同一个输入连了多条线时最后一条生效
+        for ( uint32_t r = _routeBegin[ i ]; r < _routeBegin[ i + 1 ]; ++r ) {
+            const Route& route = _routes[ r ];
+            const uint32_t input = (uint32_t)( route.to - node.pins.data() );
+            pinReg[ input ] = regBase[ route.source ] + (uint32_t)( route.from - _order[ route.source ]->pins.data() );
+        }
+        for ( uint32_t p = 0; p < pinCount; ++p ) {
+            Pin& pin = node.pins[ p ];
+            if ( pin.ptype == PinType::Input ) {
+                if ( !pin.isLinked )
+                    _params.push_back( TapeSlot{ &pin, pinReg[ p ] } );
+                continue;
+            }
+            // 有不是逐元素运算的输出时整个图都不使用指令带
+            if ( !node.Elementwise( p, op ) || op.lhs < 0 || op.rhs < 0 || (size_t)op.lhs >= pinCount ||
+                 (size_t)op.rhs >= pinCount ) {
+                _tape.clear();
+                return;
+            }
+            _tape.push_back( TapeOp{ op.op, pinReg[ p ], pinReg[ op.lhs ], pinReg[ op.rhs ] } );
+            _results.push_back( TapeSlot{ &pin, pinReg[ p ] } );
+        }
+        _paramBegin.push_back( (uint32_t)_params.size() );
+        _resultBegin.push_back( (uint32_t)_results.size() );
+    }
+    _registers.assign( regBase.back(), 0.0f );
+    _written.assign( _results.size(), 0.0f );
+    _tapeReady = true;
+}
+
+bool GraphEvaluator::LoadParams( const uint32_t position ) {
+    for ( uint32_t k = _paramBegin[ position ]; k < _paramBegin[ position + 1 ]; ++k ) {
+        const float* number = _params[ k ].pin->As<float>();
+        if ( !number )
+            return false;
+        _registers[ _params[ k ].reg ] = *number;
+    }
+    return true;
+}
+
+bool GraphEvaluator::RunTape() {
+    // 寄存器与引脚一致时只需载入被修改节点的输入；输入不是标量时退回逐节点求值
+    const bool full = !_tapeLoaded;
+    // 重建调度后未被修改的节点的输出仍与引脚一致，载入后只需从最靠前的被修改节点开始执行
+    bool seeded = false;
+    if ( full ) {
+        for ( uint32_t i = 0; i < _order.size(); ++i ) {
+            if ( !LoadParams( i ) )
+                return false;
+        }
+        seeded = true;
+        for ( size_t k = 0; k < _results.size() && seeded; ++k ) {
+            const float* number = _results[ k ].pin->As<float>();
+            seeded = number != nullptr;
+            if ( seeded ) {
+                _registers[ _results[ k ].reg ] = *number;
+                _written[ k ] = *number;
+            }
+        }
+        // 新连上的输入在逐节点求值时由上游复制，这里同样同步，供界面显示
+        for ( const uint32_t i : _queue ) {
+            for ( uint32_t r = _routeBegin[ i ]; r < _routeBegin[ i + 1 ] && seeded; ++r ) {
+                Route& route = _routes[ r ];
+                if ( route.to->version != route.from->version ) {
+                    route.to->value = route.from->value;
+                    route.to->version = route.from->version;
+                }
+            }
+        }
+    }
+    else {
+        for ( const uint32_t i : _queue ) {
+            if ( !LoadParams( i ) ) {
+                _tapeLoaded = false;
+                return false;
+            }
+        }
+    }
+
+    if ( ( !full || seeded ) && _queue.empty() ) {
+        _computed = 0;
+        _tapeLoaded = true;
+        return true;
+    }
+    // 指令按拓扑顺序排列，最靠前的被修改节点之前的结果不变
+    const uint32_t first = full && !seeded ? 0 : _queue.front();
+    float* registers = _registers.data();
+    // 每执行一段指令检查一次取消。取消时不写回，被修改的节点留在队列中，下一次从不晚于这里的位置重新执行。
+    // 寄存器中已算出的结果会被重新执行覆盖
+    for ( size_t begin = _resultBegin[ first ]; begin < _tape.size(); begin += TapeCancelInterval ) {
+        if ( _cancel && _cancel->load( std::memory_order_relaxed ) ) {
+            _cancelled = true;
+            _computed = 0;
+            return true;
+        }
+        const size_t end = std::min( begin + TapeCancelInterval, _tape.size() );
+        for ( size_t k = begin; k < end; ++k ) {
+            const TapeOp& op = _tape[ k ];
+            const float a = registers[ op.lhs ];
+            const float b = registers[ op.rhs ];
+            registers[ op.dst ] = op.op == ColumnOp::Add ? a + b : a - b;
+        }
+    }
+
+    // 只有值改变的输出写回引脚，并同步到连接的输入，供界面显示与逐节点求值使用。
+    // 与上次写回的值比较，不读取引脚：输出引脚只由求值器写入，逐节点求值之后会重新全部写回
+    size_t written = 0;
+    for ( uint32_t i = first; i < _order.size(); ++i ) {
+        // 写回中途取消时其余节点的寄存器已算出但未写回：下一次重新载入全部引脚，从队列中最靠前的节点重新执行
+        if ( _cancel && _cancel->load( std::memory_order_relaxed ) ) {
+            _cancelled = true;
+            _computed = written;
+            _tapeLoaded = false;
+            return true;
+        }
+        // 重建后被修改的节点都算作计算过，与逐节点求值一致
+        bool changed = seeded && _order[ i ]->dirty;
+        for ( uint32_t k = _resultBegin[ i ]; k < _resultBegin[ i + 1 ]; ++k ) {
+            const float value = registers[ _results[ k ].reg ];
+            if ( ( !full || seeded ) && memcmp( &value, &_written[ k ], sizeof( float ) ) == 0 )
+                continue;
+            _written[ k ] = value;
+            changed = true;
+            Pin* pin = _results[ k ].pin;
+            pin->Set( value );
+            for ( uint32_t f = _fanoutBegin[ i ]; f < _fanoutBegin[ i + 1 ]; ++f ) {
+                Route& route = _routes[ _fanout[ f ] ];
+                if ( route.from == pin && route.to->version != pin->version ) {
+                    route.to->Set( value );
+                    route.to->version = pin->version;
+                }
+            }
+        }
+        written += changed;
+    }
+
+    if ( full ) {
+        for ( NodeBase* node : _order )
+            node->dirty = false;
+    }
+    else {
+        for ( const uint32_t i : _queue )
+            _order[ i ]->dirty = false;
+    }
+    _queue.clear();
+    // 指令带每次执行被修改节点之后的全部指令，这里统计输出有变化的节点数
+    _computed = full && !seeded ? _order.size() : written;
+    _tapeLoaded = true;
+    return true;
+}
@@ -0,0 +1,140 @@
+﻿#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "MemoCache.h"
+#include "WorkStealingPool.h"
+#include "node.h"
+
+struct Editor;
+
+// 数据流求值：由 Editor::links 得到节点间的依赖，按拓扑顺序把上游输出的值写入下游输入，再调用节点的 Compute。
+// 调度（拓扑顺序与每个节点的输入来源）只在图结构变化时重建。求值是增量的：只计算脏节点，
+// 输出的版本号改变时才把下游节点标脏，因此一次小的修改只访问受影响的下游节点。
+// 指定线程池时并行求值：节点的全部上游完成后立即作为任务派生，不按层同步。
+// 输入是列时，输出只连到同一个逐元素节点的逐元素节点不物化结果，由下游节点把整条链作为一个 ColumnProgram 执行。
+// 图中只有逐元素节点、值都是标量时，调度编译为一条指令带：每个引脚对应一个寄存器，连接的输入直接读取上游输出的寄存器，
+// 求值就是按顺序执行指令，不经过节点对象、虚函数与连线。指令带只在图结构变化时重新编译。
+// 指定 MemoCache 时，输入含有列的节点先按输入内容查缓存，命中则直接使用缓存的输出
+class GraphEvaluator {
+public:
+    // 节点的输入值被用户修改后调用，下一次 Update 时从该节点开始重新求值
+    void MarkDirty( NodeBase& node );
+    // 图结构变化（editor.revision 改变）时重建调度；之后计算所有脏节点及其输出变化影响到的下游节点。
+    // 返回是否计算了节点
+    bool Update( Editor& editor, WorkStealingPool* pool = nullptr );
+    // 重建调度并求值全部节点
+    void Evaluate( Editor& editor, WorkStealingPool* pool = nullptr );
+    // 是否融合逐元素节点，默认开启。修改后下一次 Update 重建调度
+    void SetFusion( bool fusion );
+    bool Fusion() const { return _fusion; }
+    // 是否使用指令带，默认开启
+    void SetTape( bool tape );
+    bool Tape() const { return _useTape; }
+    // 最近一次 Update 是否由指令带完成
+    bool UsedTape() const { return _ranTape; }
+    size_t TapeSize() const { return _tape.size(); }
+    // 节点输出缓存，nullptr 时不缓存。标量节点的计算比查缓存快，不缓存
+    void SetMemo( MemoCache* memo ) { _memo = memo; }
+    // cancel 变为 true 时求值尽快停止，未计算的节点留在队列中，下一次 Update 继续。
+    // 逐节点求值在每个节点之前、并行求值在每个任务开始时检查；指令带每执行 TapeCancelInterval 条指令、
+    // 写回时每个节点之前检查
+    void SetCancel( const std::atomic<bool>* cancel ) { _cancel = cancel; }
+    // 最近一次 Update 是否被取消
+    bool Cancelled() const { return _cancelled; }
+
+    size_t ScheduledCount() const { return _order.size(); }
+    // 位于环路中或环路下游、无法求值的节点数
+    size_t BlockedCount() const { return _blocked; }
+    // 最近一次 Update 计算的节点数与耗时
+    size_t ComputedCount() const { return _computed; }
+    double LastMs() const { return _lastMs; }
+
+private:
+    void Schedule( Editor& editor );
+    void Run();
+    void RunParallel( WorkStealingPool& pool );
+    void Push( uint32_t position );
+    void Compute( uint32_t position );
+    void ComputeFused( uint32_t position );
+    int Expand( ColumnProgram& program, uint32_t position, int pin, std::vector<std::pair<const Pin*, int>>& memo ) const;
+    bool MemoKey( uint32_t position, uint64_t& key ) const;
+    void CompileTape();
+    bool RunTape();
+    bool LoadParams( uint32_t position );
+
+    // 一条连线：求值 to 所在节点之前把 from 的值复制到 to。source、target 为两端节点在 _order 中的位置
+    struct Route {
+        const Pin* from;
+        Pin* to;
+        uint32_t source;
+        uint32_t target;
+    };
+    // 连到 _order[ position ] 的输入 input 的连线，没有时为 nullptr
+    const Route* SourceOf( uint32_t position, const Pin& input ) const;
+
+    // 融合链的最大长度，限制展开的递归深度
+    static constexpr uint32_t MaxFusedChain = 256;
+    // 指令带两次检查取消之间执行的指令数
+    static constexpr size_t TapeCancelInterval = 4096;
+
+    // 指针在图结构改变前有效
+    std::vector<NodeBase*> _order;
+    std::unordered_map<const NodeBase*, uint32_t> _position;
+    // _order[ i ] 的输入来源为 _routes[ _routeBegin[ i ] ] .. _routes[ _routeBegin[ i + 1 ] - 1 ]
+    std::vector<uint32_t> _routeBegin;
+    std::vector<Route> _routes;
+    // _order[ i ] 的输出去向（_routes 中的序号）为 _fanout[ _fanoutBegin[ i ] ] .. _fanout[ _fanoutBegin[ i + 1 ] - 1 ]
+    std::vector<uint32_t> _fanoutBegin;
+    std::vector<uint32_t> _fanout;
+    // 可以融合到唯一下游节点中执行的节点
+    std::vector<uint8_t> _fusable;
+    bool _fusion = true;
+    size_t _blocked = 0;
+    MemoCache* _memo = nullptr;
+    const std::atomic<bool>* _cancel = nullptr;
+    bool _cancelled = false;
+
+    // _registers[ dst ] = _registers[ lhs ] op _registers[ rhs ]
+    struct TapeOp {
+        ColumnOp op;
+        uint32_t dst, lhs, rhs;
+    };
+    // 与引脚对应的寄存器
+    struct TapeSlot {
+        Pin* pin;
+        uint32_t reg;
+    };
+    std::vector<TapeOp> _tape;
+    std::vector<float> _registers;
+    // 未连接的输入，_order[ i ] 的为 _params[ _paramBegin[ i ] ] .. _params[ _paramBegin[ i + 1 ] - 1 ]
+    std::vector<TapeSlot> _params;
+    std::vector<uint32_t> _paramBegin;
+    // 输出，执行后值有变化的写回引脚；_order[ i ] 的为 _results[ _resultBegin[ i ] ] ..，与 _tape 一一对应
+    std::vector<TapeSlot> _results;
+    std::vector<uint32_t> _resultBegin;
+    std::vector<float> _written;
+    bool _useTape = true;
+    bool _tapeReady = false;
+    // 寄存器与引脚的值一致；逐节点求值之后需要重新载入
+    bool _tapeLoaded = false;
+    bool _ranTape = false;
+
+    // 待计算节点在 _order 中的位置，小顶堆，保证按拓扑顺序计算
+    std::vector<uint32_t> _queue;
+    // 调度之后被标脏、尚未放入 _queue 的节点
+    std::vector<NodeBase*> _pending;
+
+    // 并行求值：_queue 中节点的全部下游，以及每个节点还在等待的上游连线数
+    std::vector<uint32_t> _cone;
+    std::vector<uint8_t> _inCone;
+    std::unique_ptr<std::atomic<uint32_t>[]> _waiting;
+    size_t _computed = 0;
+    double _lastMs = 0.0;
+
+    const Editor* _editor = nullptr;
+    uint64_t _revision = 0;
+};
@@ -0,0 +1,988 @@
+﻿#include "imnodes_internal.h"
+
+#include "GraphImport.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <string_view>
+
+namespace {
+
+constexpr size_t ChunkSize = 1 << 16;
+// 后台线程每解析这么多个节点或连线，交给主线程一次
+constexpr size_t BatchSize = 16384;
+// 导入节点的网格排布
+constexpr int LayoutColumns = 100;
+constexpr float LayoutSpacingX = 180.0f;
+constexpr float LayoutSpacingY = 120.0f;
+
+double ElapsedMs( const std::chrono::steady_clock::time_point& start ) {
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+// 按块读取文件，逐字符访问
+class ChunkReader {
+public:
+    ChunkReader( FILE* file, const std::function<bool( int64_t )>& progress )
+        : _file( file )
+        , _progress( progress )
+        , _buffer( ChunkSize ) {}
+
+    int Peek() { return _pos < _end || Refill() ? (unsigned char)_buffer[ _pos ] : EOF; }
+    int Get() {
+        const int c = Peek();
+        if ( c != EOF ) {
+            ++_pos;
+            if ( c == '\n' )
+                ++_line;
+        }
+        return c;
+    }
+    int Line() const { return _line; }
+    bool Cancelled() const { return _cancelled; }
+
+private:
+    bool Refill() {
+        if ( _cancelled )
+            return false;
+        _read += _end;
+        _pos = 0;
+        _end = fread( _buffer.data(), 1, _buffer.size(), _file );
+        if ( _progress && !_progress( _read + (int64_t)_end ) ) {
+            _cancelled = true;
+            _end = 0;
+        }
+        return _end > 0;
+    }
+
+    FILE* _file;
+    const std::function<bool( int64_t )>& _progress;
+    std::vector<char> _buffer;
+    size_t _pos = 0, _end = 0;
+    int64_t _read = 0;
+    int _line = 1;
+    bool _cancelled = false;
+};
+
+enum class TokenType { End, Id, String, Punct, EdgeOp, Error };
+
+struct Token {
+    TokenType type = TokenType::End;
+    char punct = 0;
+    std::string text;
+};
+
+int HexDigit( const int c ) {
+    if ( c >= '0' && c <= '9' )
+        return c - '0';
+    if ( c >= 'a' && c <= 'f' )
+        return c - 'a' + 10;
+    if ( c >= 'A' && c <= 'F' )
+        return c - 'A' + 10;
+    return -1;
+}
+
+bool IsIdChar( const int c ) {
+    return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || ( c >= '0' && c <= '9' ) || c == '_' || c == '.' || c >= 0x80;
+}
+
+// DOT 与 JSON 共用的词法分析器
+class Lexer {
+public:
+    Lexer( ChunkReader& reader, const bool dot )
+        : _reader( reader )
+        , _dot( dot ) {}
+
+    void Next( Token& token ) {
+        token.text.clear();
+        token.punct = 0;
+        if ( !SkipSpaces() ) {
+            token.type = TokenType::Error;
+            return;
+        }
+        const int c = _reader.Peek();
+        if ( c == EOF ) {
+            token.type = TokenType::End;
+        }
+        else if ( c == '"' ) {
+            _reader.Get();
+            token.type = ReadString( token.text ) ? TokenType::String : TokenType::Error;
+        }
+        else if ( _dot && c == '<' ) {
+            token.type = ReadHtmlString( token.text ) ? TokenType::String : TokenType::Error;
+        }
+        else if ( _dot && c == '-' ) {
+            _reader.Get();
+            const int n = _reader.Peek();
+            if ( n == '>' || n == '-' ) {
+                _reader.Get();
+                token.type = TokenType::EdgeOp;
+            }
+            else {
+                token.type = TokenType::Id;
+                token.text.push_back( '-' );
+                ReadId( token.text );
+            }
+        }
+        else if ( IsIdChar( c ) || ( !_dot && ( c == '-' || c == '+' ) ) ) {
+            token.type = TokenType::Id;
+            ReadId( token.text );
+        }
+        else {
+            token.type = TokenType::Punct;
+            token.punct = (char)_reader.Get();
+        }
+    }
+
+private:
+    // 跳过空白与 DOT 注释，注释未结束时返回 false
+    bool SkipSpaces() {
+        for ( ;; ) {
+            const int c = _reader.Peek();
+            if ( c == ' ' || c == '\t' || c == '\n' || c == '\r' ) {
+                _reader.Get();
+            }
+            else if ( _dot && c == '#' ) {
+                SkipLine();
+            }
+            else if ( _dot && c == '/' ) {
+                _reader.Get();
+                const int n = _reader.Get();
+                if ( n == '/' ) {
+                    SkipLine();
+                }
+                else if ( n == '*' ) {
+                    int prev = 0, cur;
+                    while ( ( cur = _reader.Get() ) != EOF && !( prev == '*' && cur == '/' ) )
+                        prev = cur;
+                    if ( cur == EOF )
+                        return false;
+                }
+                else {
+                    return false;
+                }
+            }
+            else {
+                return true;
+            }
+        }
+    }
+
+    void SkipLine() {
+        int c;
+        while ( ( c = _reader.Get() ) != EOF && c != '\n' ) {}
+    }
+
+    void ReadId( std::string& text ) {
+        for ( int c = _reader.Peek(); IsIdChar( c ) || ( !_dot && ( c == '-' || c == '+' ) ); c = _reader.Peek() )
+            text.push_back( (char)_reader.Get() );
+    }
+
+    bool ReadString( std::string& text ) {
+        for ( ;; ) {
+            int c = _reader.Get();
+            if ( c == EOF )
+                return false;
+            if ( c == '"' )
+                return true;
+            if ( c != '\\' ) {
+                text.push_back( (char)c );
+                continue;
+            }
+            c = _reader.Get();
+            if ( _dot ) {
+                // DOT 只转义引号与换行续行，其余反斜杠原样保留
+                if ( c == '"' )
+                    text.push_back( '"' );
+                else if ( c != '\n' && c != EOF ) {
+                    text.push_back( '\\' );
+                    text.push_back( (char)c );
+                }
+                continue;
+            }
+            switch ( c ) {
+            case 'n': text.push_back( '\n' ); break;
+            case 't': text.push_back( '\t' ); break;
+            case 'r': text.push_back( '\r' ); break;
+            case 'b': text.push_back( '\b' ); break;
+            case 'f': text.push_back( '\f' ); break;
+            case 'u': {
+                unsigned code = 0;
+                for ( int i = 0; i < 4; ++i ) {
+                    const int digit = HexDigit( _reader.Get() );
+                    if ( digit < 0 )
+                        return false;
+                    code = code * 16 + digit;
+                }
+                AppendUtf8( text, code );
+                break;
+            }
+            case EOF: return false;
+            default: text.push_back( (char)c ); break;
+            }
+        }
+    }
+
+    // DOT 的 HTML 字符串 <...>，尖括号可以嵌套
+    bool ReadHtmlString( std::string& text ) {
+        _reader.Get();
+        for ( int depth = 1;; ) {
+            const int c = _reader.Get();
+            if ( c == EOF )
+                return false;
+            if ( c == '<' )
+                ++depth;
+            else if ( c == '>' && --depth == 0 )
+                return true;
+            text.push_back( (char)c );
+        }
+    }
+
+    static void AppendUtf8( std::string& text, const unsigned code ) {
+        if ( code < 0x80 ) {
+            text.push_back( (char)code );
+        }
+        else if ( code < 0x800 ) {
+            text.push_back( (char)( 0xc0 | ( code >> 6 ) ) );
+            text.push_back( (char)( 0x80 | ( code & 0x3f ) ) );
+        }
+        else {
+            text.push_back( (char)( 0xe0 | ( code >> 12 ) ) );
+            text.push_back( (char)( 0x80 | ( ( code >> 6 ) & 0x3f ) ) );
+            text.push_back( (char)( 0x80 | ( code & 0x3f ) ) );
+        }
+    }
+
+    ChunkReader& _reader;
+    bool _dot;
+};
+
+// 节点名到槽位编号的开放寻址哈希表。不超过 16 字节的名字直接存在表项中，更长的名字连续存放在
+// 一个字符串中。大图的节点名查找以缓存未命中为主，通常只需访问一个表项
+class NameTable {
+public:
+    // 返回名字的槽位编号，槽位按首次插入的顺序从 0 开始编号
+    int Insert( const std::string& name, bool& inserted ) {
+        if ( ( _count + 1 ) * 2 > _entries.size() )
+            Grow();
+        const uint64_t hash = std::hash<std::string_view>()( name );
+        const size_t mask = _entries.size() - 1;
+        for ( size_t i = hash & mask;; i = ( i + 1 ) & mask ) {
+            Entry& entry = _entries[ i ];
+            if ( entry.slot < 0 ) {
+                entry.hash = hash;
+                entry.length = (uint32_t)name.size();
+                entry.slot = (int)_count++;
+                if ( name.size() <= sizeof( entry.name ) ) {
+                    memcpy( entry.name, name.data(), name.size() );
+                }
+                else {
+                    entry.offset = _longNames.size();
+                    _longNames += name;
+                }
+                inserted = true;
+                return entry.slot;
+            }
+            if ( entry.hash == hash && entry.length == name.size() && Name( entry ) == name ) {
+                inserted = false;
+                return entry.slot;
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        uint64_t hash = 0;
+        int slot = -1;
+        uint32_t length = 0;
+        union {
+            char name[ 16 ];
+            size_t offset;
+        };
+    };
+
+    std::string_view Name( const Entry& entry ) const {
+        return entry.length <= sizeof( entry.name ) ? std::string_view( entry.name, entry.length )
+                                                    : std::string_view( _longNames.data() + entry.offset, entry.length );
+    }
+
+    void Grow() {
+        std::vector<Entry> entries( std::max<size_t>( _entries.size() * 2, 1024 ) );
+        const size_t mask = entries.size() - 1;
+        for ( const Entry& entry : _entries ) {
+            if ( entry.slot < 0 )
+                continue;
+            size_t i = entry.hash & mask;
+            while ( entries[ i ].slot >= 0 )
+                i = ( i + 1 ) & mask;
+            entries[ i ] = entry;
+        }
+        _entries.swap( entries );
+    }
+
+    std::vector<Entry> _entries;
+    std::string _longNames;
+    size_t _count = 0;
+};
+
+NodeKind ParseKind( const std::string& text ) {
+    return text == "Sub" || text == "sub" ? NodeKind::Sub : NodeKind::Add;
+}
+
+// DOT 与 JSON 解析器。节点名先映射到槽位，节点编号在报告给 sink 时才分配；
+// 编号为 -1 表示节点已出现、但所在语句尚未结束
+class GraphParser {
+public:
+    GraphParser( ChunkReader& reader, GraphSink& sink, const bool dot )
+        : _reader( reader )
+        , _lexer( reader, dot )
+        , _sink( sink ) {}
+
+    bool ParseDot() {
+        if ( IsKeyword( Peek(), "strict" ) )
+            Skip();
+        if ( !IsKeyword( Peek(), "graph" ) && !IsKeyword( Peek(), "digraph" ) )
+            return Fail( "expected graph or digraph" );
+        Skip();
+        if ( IsName( Peek() ) )
+            Skip();
+        return Expect( '{' ) && ParseStmtList( nullptr );
+    }
+
+    bool ParseJson() {
+        if ( !Expect( '{' ) )
+            return false;
+        if ( IsPunct( Peek(), '}' ) ) {
+            Skip();
+            return true;
+        }
+        for ( ;; ) {
+            if ( Peek().type != TokenType::String )
+                return Fail( "expected key" );
+            const std::string key = Peek().text;
+            Skip();
+            if ( !Expect( ':' ) )
+                return false;
+            bool ok;
+            if ( key == "nodes" )
+                ok = ParseJsonArray( &GraphParser::ParseJsonNode );
+            else if ( key == "edges" || key == "links" )
+                ok = ParseJsonArray( &GraphParser::ParseJsonEdge );
+            else
+                ok = SkipJsonValue();
+            if ( !ok )
+                return false;
+            if ( !IsPunct( Peek(), ',' ) )
+                return Expect( '}' );
+            Skip();
+        }
+    }
+
+    const std::string& Error() const { return _error; }
+
+private:
+    const Token& Peek() {
+        if ( !_peeked ) {
+            _lexer.Next( _token );
+            _peeked = true;
+        }
+        return _token;
+    }
+    void Skip() {
+        Peek();
+        _peeked = false;
+    }
+
+    bool Fail( const char* message ) {
+        if ( _error.empty() ) {
+            const char* reason = Peek().type == TokenType::Error ? "malformed token" : message;
+            _error = "line " + std::to_string( _reader.Line() ) + ": " + reason;
+        }
+        return false;
+    }
+    bool Expect( const char punct ) {
+        if ( !IsPunct( Peek(), punct ) ) {
+            const char message[] = { 'e', 'x', 'p', 'e', 'c', 't', 'e', 'd', ' ', '\'', punct, '\'', 0 };
+            return Fail( message );
+        }
+        Skip();
+        return true;
+    }
+
+    static bool IsPunct( const Token& token, const char punct ) { return token.type == TokenType::Punct && token.punct == punct; }
+    static bool IsName( const Token& token ) { return token.type == TokenType::Id || token.type == TokenType::String; }
+    // DOT 关键字不区分大小写，带引号的字符串不是关键字
+    static bool IsKeyword( const Token& token, const char* keyword ) {
+        if ( token.type != TokenType::Id )
+            return false;
+        size_t i = 0;
+        for ( ; keyword[ i ]; ++i ) {
+            if ( i >= token.text.size() || ( token.text[ i ] | 0x20 ) != keyword[ i ] )
+                return false;
+        }
+        return i == token.text.size();
+    }
+
+    // 查找节点名，新节点记入 created，在语句结束时报告
+    int Ref( const std::string& name, std::vector<int>& created ) {
+        bool inserted;
+        const int slot = _names.Insert( name, inserted );
+        if ( inserted ) {
+            _nodes.push_back( -1 );
+            created.push_back( slot );
+        }
+        return slot;
+    }
+    int Emit( const int slot, const NodeKind kind ) {
+        int& node = _nodes[ slot ];
+        if ( node < 0 ) {
+            node = _nodeCount++;
+            _sink.OnNode( kind );
+        }
+        return node;
+    }
+
+    // 解析到 '}' 为止；group 不为空时收集其中出现的节点，子图作为连线端点时使用
+    bool ParseStmtList( std::vector<int>* group ) {
+        for ( ;; ) {
+            const Token& token = Peek();
+            if ( token.type == TokenType::End )
+                return Fail( "unexpected end of file" );
+            if ( IsPunct( token, '}' ) ) {
+                Skip();
+                return true;
+            }
+            if ( IsPunct( token, ';' ) || IsPunct( token, ',' ) )
+                Skip();
+            else if ( !ParseStmt( group ) )
+                return false;
+        }
+    }
+
+    // 语句的临时数组按子图嵌套深度复用，避免每个语句分配内存
+    struct StmtScratch {
+        std::vector<int> created, lhs, rhs;
+        std::vector<std::pair<int, int>> edges;
+    };
+
+    bool ParseStmt( std::vector<int>* group ) {
+        if ( _depth >= MaxDepth )
+            return Fail( "subgraphs nested too deeply" );
+        if ( _depth == _scratch.size() )
+            _scratch.emplace_back();
+        StmtScratch& scratch = _scratch[ _depth++ ];
+        scratch.created.clear();
+        scratch.lhs.clear();
+        scratch.edges.clear();
+        const bool ok = ParseStmt( group, scratch );
+        --_depth;
+        return ok;
+    }
+
+    bool ParseStmt( std::vector<int>* group, StmtScratch& scratch ) {
+        std::vector<int>& created = scratch.created;
+        std::vector<int>& lhs = scratch.lhs;
+        std::vector<int>& rhs = scratch.rhs;
+        std::vector<std::pair<int, int>>& edges = scratch.edges;
+        NodeKind kind = NodeKind::Add;
+        bool hasKind = false;
+        if ( IsKeyword( Peek(), "graph" ) || IsKeyword( Peek(), "node" ) || IsKeyword( Peek(), "edge" ) ) {
+            Skip();
+            return ParseAttrLists( kind, hasKind );
+        }
+
+        if ( IsName( Peek() ) && !IsKeyword( Peek(), "subgraph" ) ) {
+            _name = Peek().text;
+            Skip();
+            // 图属性 ID = ID
+            if ( IsPunct( Peek(), '=' ) ) {
+                Skip();
+                if ( !IsName( Peek() ) )
+                    return Fail( "expected attribute value" );
+                Skip();
+                return true;
+            }
+            lhs.push_back( Ref( _name, created ) );
+            if ( !SkipPort() )
+                return false;
+        }
+        else if ( !ParseOperand( lhs, created ) ) {
+            return false;
+        }
+        if ( group )
+            group->insert( group->end(), lhs.begin(), lhs.end() );
+
+        while ( Peek().type == TokenType::EdgeOp ) {
+            Skip();
+            rhs.clear();
+            if ( !ParseOperand( rhs, created ) )
+                return false;
+            for ( const int from : lhs ) {
+                for ( const int to : rhs )
+                    edges.emplace_back( from, to );
+            }
+            if ( group )
+                group->insert( group->end(), rhs.begin(), rhs.end() );
+            lhs.swap( rhs );
+        }
+        if ( !ParseAttrLists( kind, hasKind ) )
+            return false;
+
+        // 属性只在节点语句中决定节点类型，连线语句的属性属于连线
+        const NodeKind createdKind = edges.empty() && hasKind ? kind : NodeKind::Add;
+        for ( const int slot : created )
+            Emit( slot, createdKind );
+        for ( const auto& [ from, to ] : edges ) {
+            const int a = Emit( from, NodeKind::Add );
+            const int b = Emit( to, NodeKind::Add );
+            _sink.OnEdge( a, b );
+        }
+        return true;
+    }
+
+    // 连线端点：节点（可带端口）或子图
+    bool ParseOperand( std::vector<int>& nodes, std::vector<int>& created ) {
+        if ( IsKeyword( Peek(), "subgraph" ) || IsPunct( Peek(), '{' ) ) {
+            if ( IsKeyword( Peek(), "subgraph" ) ) {
+                Skip();
+                if ( IsName( Peek() ) )
+                    Skip();
+            }
+            return Expect( '{' ) && ParseStmtList( &nodes );
+        }
+        if ( !IsName( Peek() ) )
+            return Fail( "expected node id" );
+        nodes.push_back( Ref( Peek().text, created ) );
+        Skip();
+        return SkipPort();
+    }
+
+    bool SkipPort() {
+        while ( IsPunct( Peek(), ':' ) ) {
+            Skip();
+            if ( !IsName( Peek() ) )
+                return Fail( "expected port" );
+            Skip();
+        }
+        return true;
+    }
+
+    bool ParseAttrLists( NodeKind& kind, bool& hasKind ) {
+        while ( IsPunct( Peek(), '[' ) ) {
+            Skip();
+            for ( ;; ) {
+                const Token& key = Peek();
+                if ( IsPunct( key, ']' ) ) {
+                    Skip();
+                    break;
+                }
+                if ( IsPunct( key, ',' ) || IsPunct( key, ';' ) ) {
+                    Skip();
+                    continue;
+                }
+                if ( !IsName( key ) )
+                    return Fail( "expected attribute name" );
+                const bool isKind = key.text == "type" || key.text == "kind";
+                Skip();
+                if ( !IsPunct( Peek(), '=' ) )
+                    continue;
+                Skip();
+                if ( !IsName( Peek() ) )
+                    return Fail( "expected attribute value" );
+                if ( isKind ) {
+                    kind = ParseKind( Peek().text );
+                    hasKind = true;
+                }
+                Skip();
+            }
+        }
+        return true;
+    }
+
+    bool ParseJsonArray( bool ( GraphParser::*element )() ) {
+        if ( !Expect( '[' ) )
+            return false;
+        if ( IsPunct( Peek(), ']' ) ) {
+            Skip();
+            return true;
+        }
+        for ( ;; ) {
+            if ( !( this->*element )() )
+                return false;
+            if ( !IsPunct( Peek(), ',' ) )
+                return Expect( ']' );
+            Skip();
+        }
+    }
+
+    // 遍历 JSON 对象的键，值由 onValue 消费
+    template <typename OnValue>
+    bool ParseJsonObject( OnValue&& onValue ) {
+        if ( !Expect( '{' ) )
+            return false;
+        if ( IsPunct( Peek(), '}' ) ) {
+            Skip();
+            return true;
+        }
+        for ( ;; ) {
+            if ( Peek().type != TokenType::String )
+                return Fail( "expected key" );
+            _key = Peek().text;
+            Skip();
+            if ( !Expect( ':' ) || !onValue( _key ) )
+                return false;
+            if ( !IsPunct( Peek(), ',' ) )
+                return Expect( '}' );
+            Skip();
+        }
+    }
+
+    // 读取字符串或数字值
+    bool ReadJsonName( std::string& name ) {
+        if ( !IsName( Peek() ) )
+            return Fail( "expected string or number" );
+        name = Peek().text;
+        Skip();
+        return true;
+    }
+
+    bool ParseJsonNode() {
+        NodeKind kind = NodeKind::Add;
+        bool hasId = false;
+        const bool ok = ParseJsonObject( [ & ]( const std::string& key ) {
+            if ( key == "id" ) {
+                hasId = true;
+                return ReadJsonName( _name );
+            }
+            if ( key == "type" || key == "kind" ) {
+                if ( !ReadJsonName( _value ) )
+                    return false;
+                kind = ParseKind( _value );
+                return true;
+            }
+            return SkipJsonValue();
+        } );
+        if ( !ok )
+            return false;
+        if ( !hasId )
+            return Fail( "node without id" );
+        // 已被连线引用过的节点保持原来的类型
+        _created.clear();
+        Emit( Ref( _name, _created ), kind );
+        return true;
+    }
+
+    bool ParseJsonEdge() {
+        bool ok;
+        int found = 0;
+        if ( IsPunct( Peek(), '[' ) ) {
+            Skip();
+            ok = ReadJsonName( _name ) && Expect( ',' ) && ReadJsonName( _value ) && Expect( ']' );
+            found = 2;
+        }
+        else {
+            ok = ParseJsonObject( [ & ]( const std::string& key ) {
+                if ( key == "from" || key == "source" ) {
+                    ++found;
+                    return ReadJsonName( _name );
+                }
+                if ( key == "to" || key == "target" ) {
+                    ++found;
+                    return ReadJsonName( _value );
+                }
+                return SkipJsonValue();
+            } );
+        }
+        if ( !ok )
+            return false;
+        if ( found != 2 )
+            return Fail( "edge needs from and to" );
+        _created.clear();
+        const int from = Emit( Ref( _name, _created ), NodeKind::Add );
+        const int to = Emit( Ref( _value, _created ), NodeKind::Add );
+        _sink.OnEdge( from, to );
+        return true;
+    }
+
+    bool SkipJsonValue() {
+        if ( IsPunct( Peek(), '{' ) || IsPunct( Peek(), '[' ) ) {
+            if ( _jsonDepth >= MaxDepth )
+                return Fail( "values nested too deeply" );
+            ++_jsonDepth;
+            const bool ok = IsPunct( Peek(), '{' )
+                                ? ParseJsonObject( [ this ]( const std::string& ) { return SkipJsonValue(); } )
+                                : ParseJsonArray( &GraphParser::SkipJsonValue );
+            --_jsonDepth;
+            return ok;
+        }
+        if ( !IsName( Peek() ) )
+            return Fail( "expected value" );
+        Skip();
+        return true;
+    }
+
+    ChunkReader& _reader;
+    Lexer _lexer;
+    GraphSink& _sink;
+    Token _token;
+    bool _peeked = false;
+    std::string _error;
+
+    NameTable _names;
+    // 槽位对应的节点编号
+    std::vector<int> _nodes;
+    int _nodeCount = 0;
+    // 复用的临时字符串，避免每个语句分配
+    std::string _name, _value, _key;
+    std::vector<int> _created;
+    std::deque<StmtScratch> _scratch;
+    size_t _depth = 0;
+    size_t _jsonDepth = 0;
+    // 子图与跳过的 JSON 值都递归解析，限制嵌套深度，恶意文件不会耗尽导入线程的栈
+    static constexpr size_t MaxDepth = 256;
+};
+
+// 第 index 个 type 类型的引脚，没有时返回 -1
+int FindPin( const NodeBase& node, const PinType type, int index = 0 ) {
+    for ( const Pin& pin : node.pins ) {
+        if ( pin.ptype == type && index-- == 0 )
+            return pin.pid;
+    }
+    return -1;
+}
+
+// 创建节点并按网格排布，imported 为全局节点编号到节点的映射，连线按该编号引用节点。
+// 同一节点的入边依次连到它的各个输入引脚，linkedInputs 记录每个节点已连接的输入数；
+// 超出输入引脚数的连线被丢弃，返回丢弃的条数
+int AddToEditor( Editor& editor, const std::vector<NodeKind>& kinds, const std::vector<std::pair<int, int>>& edges,
+                 std::vector<std::shared_ptr<NodeBase>>& imported, std::vector<int>& linkedInputs ) {
+    ImNodesEditorContext* previous = &ImNodes::EditorContextGet();
+    ImNodes::EditorContextSet( editor.context );
+    editor.nodes.reserve( editor.nodes.size() + kinds.size() );
+    for ( const NodeKind kind : kinds ) {
+        std::shared_ptr<NodeBase> node = MakeNode( kind );
+        const int i = (int)imported.size();
+        const ImVec2 pos( ( i % LayoutColumns ) * LayoutSpacingX, ( i / LayoutColumns ) * LayoutSpacingY );
+        ImNodes::SetNodeGridSpacePos( node->node_id, pos );
+        editor.nodes.push_back( node );
+        imported.push_back( std::move( node ) );
+    }
+    linkedInputs.resize( imported.size(), 0 );
+    editor.links.reserve( editor.links.size() + edges.size() );
+    int dropped = 0;
+    for ( const auto& [ from, to ] : edges ) {
+        const int endAttr = FindPin( *imported[ to ], PinType::Input, linkedInputs[ to ] );
+        if ( endAttr < 0 ) {
+            ++dropped;
+            continue;
+        }
+        ++linkedInputs[ to ];
+        editor.links.emplace_back( UniqueId::get_id(), FindPin( *imported[ from ], PinType::Output ), endAttr );
+    }
+    ++editor.revision;
+    ImNodes::EditorContextSet( previous );
+    return dropped;
+}
+
+}  // namespace
+
+GraphFormat GraphFormatFromPath( const std::string& path ) {
+    std::string ext = std::filesystem::path( path ).extension().string();
+    for ( char& c : ext )
+        c = (char)( c | 0x20 );
+    return ext == ".json" ? GraphFormat::Json : GraphFormat::Dot;
+}
+
+bool ReadGraph( const std::string& path, const GraphFormat format, GraphSink& sink, std::string& error,
+                const std::function<bool( int64_t )>& progress ) {
+    FILE* file = ImFileOpen( path.c_str(), "rb" );
+    if ( !file ) {
+        error = "cannot open " + path;
+        return false;
+    }
+    ChunkReader reader( file, progress );
+    GraphParser parser( reader, sink, format == GraphFormat::Dot );
+    const bool ok = format == GraphFormat::Dot ? parser.ParseDot() : parser.ParseJson();
+    fclose( file );
+    if ( reader.Cancelled() )
+        error = "cancelled";
+    else if ( !ok )
+        error = parser.Error();
+    return ok && !reader.Cancelled();
+}
+
+bool ImportGraph( const std::string& path, Editor& editor, std::string& error, int* droppedLinks ) {
+    class CollectSink : public GraphSink {
+    public:
+        void OnNode( const NodeKind kind ) override { nodes.push_back( kind ); }
+        void OnEdge( const int from, const int to ) override { edges.emplace_back( from, to ); }
+
+        std::vector<NodeKind> nodes;
+        std::vector<std::pair<int, int>> edges;
+    };
+
+    CollectSink sink;
+    if ( !ReadGraph( path, GraphFormatFromPath( path ), sink, error ) )
+        return false;
+    std::vector<std::shared_ptr<NodeBase>> imported;
+    std::vector<int> linkedInputs;
+    const int dropped = AddToEditor( editor, sink.nodes, sink.edges, imported, linkedInputs );
+    if ( droppedLinks )
+        *droppedLinks = dropped;
+    return true;
+}
+
+bool GraphImporter::Start( const std::string& path ) {
+    Cancel();
+    std::error_code ec;
+    const auto size = std::filesystem::file_size( path, ec );
+    if ( ec ) {
+        _error = "cannot open " + path;
+        return false;
+    }
+
+    _fileSize = (int64_t)size;
+    _bytesRead = 0;
+    _cancel = false;
+    _finished = false;
+    _error.clear();
+    _parseMs = 0.0;
+    _pending = Batch();
+    _nodes.clear();
+    _linkedInputs.clear();
+    _nodeCount = 0;
+    _linkCount = 0;
+    _droppedLinkCount = 0;
+
+    _thread = std::thread( [ this, path ] {
+        // 攒够一批后交给主线程
+        class BatchSink : public GraphSink {
+        public:
+            explicit BatchSink( GraphImporter& importer )
+                : _importer( importer ) {}
+
+            void OnNode( const NodeKind kind ) override {
+                _batch.nodes.push_back( kind );
+                if ( _batch.nodes.size() >= BatchSize )
+                    Flush();
+            }
+            void OnEdge( const int from, const int to ) override {
+                _batch.edges.emplace_back( from, to );
+                if ( _batch.edges.size() >= BatchSize )
+                    Flush();
+            }
+            void Flush() {
+                std::lock_guard<std::mutex> lock( _importer._mutex );
+                Batch& pending = _importer._pending;
+                pending.nodes.insert( pending.nodes.end(), _batch.nodes.begin(), _batch.nodes.end() );
+                pending.edges.insert( pending.edges.end(), _batch.edges.begin(), _batch.edges.end() );
+                _batch.nodes.clear();
+                _batch.edges.clear();
+            }
+
+        private:
+            GraphImporter& _importer;
+            Batch _batch;
+        };
+
+        const auto start = std::chrono::steady_clock::now();
+        BatchSink sink( *this );
+        const bool ok = ReadGraph( path, GraphFormatFromPath( path ), sink, _error, [ this ]( const int64_t bytes ) {
+            _bytesRead = bytes;
+            return !_cancel;
+        } );
+        // 出错时保留已解析的部分
+        sink.Flush();
+        if ( ok )
+            _bytesRead = _fileSize;
+        _parseMs = ElapsedMs( start );
+        _finished = true;
+    } );
+    return true;
+}
+
+void GraphImporter::Cancel() {
+    if ( !_thread.joinable() )
+        return;
+    _cancel = true;
+    _thread.join();
+}
+
+bool GraphImporter::Apply( Editor& editor ) {
+    if ( !_thread.joinable() )
+        return false;
+
+    // 先读取完成标志再取批次，保证完成时取到的是最后的批次
+    const bool finished = _finished;
+    Batch batch;
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        std::swap( batch, _pending );
+    }
+
+    if ( !batch.nodes.empty() || !batch.edges.empty() ) {
+        const int dropped = AddToEditor( editor, batch.nodes, batch.edges, _nodes, _linkedInputs );
+        _nodeCount += (int)batch.nodes.size();
+        _linkCount += (int)batch.edges.size() - dropped;
+        _droppedLinkCount += dropped;
+    }
+
+    if ( !finished )
+        return false;
+    _thread.join();
+    _nodes.clear();
+    _nodes.shrink_to_fit();
+    _linkedInputs.clear();
+    _linkedInputs.shrink_to_fit();
+    return true;
+}
+
+float GraphImporter::Progress() const {
+    return _fileSize > 0 ? (float)( (double)_bytesRead / _fileSize ) : 1.0f;
+}
+
+void GraphImportPanel::Draw( Editor& editor ) {
+    ImGui::Begin( "Graph Import" );
+
+    ImGui::SetNextItemWidth( 360.0f );
+    ImGui::InputTextWithHint( "##path", ".dot / .gv / .json", _path, sizeof( _path ) );
+    ImGui::SameLine();
+    ImGui::BeginDisabled( _importer.Busy() );
+    if ( ImGui::Button( "Import" ) ) {
+        if ( _importer.Start( _path ) )
+            _log.AddLog( "Importing %s", _path );
+        else
+            _log.AddLog( "%s", _importer.Error().c_str() );
+    }
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::BeginDisabled( !_importer.Busy() );
+    if ( ImGui::Button( "Cancel" ) )
+        _importer.Cancel();
+    ImGui::EndDisabled();
+
+    if ( _importer.Apply( editor ) ) {
+        const double mb = _importer.BytesRead() / ( 1024.0 * 1024.0 );
+        if ( _importer.Error().empty() )
+            _log.AddLog( "Imported %d nodes, %d links (%.1f MB) in %.0f ms, %.1f MB/s", _importer.NodeCount(),
+                         _importer.LinkCount(), mb, _importer.ParseMs(), mb * 1000.0 / ImMax( _importer.ParseMs(), 1e-3 ) );
+        else
+            _log.AddLog( "Import stopped after %d nodes, %d links: %s", _importer.NodeCount(), _importer.LinkCount(),
+                         _importer.Error().c_str() );
+        if ( _importer.DroppedLinkCount() > 0 )
+            _log.AddLog( "Dropped %d links into nodes whose input pins were all linked", _importer.DroppedLinkCount() );
+    }
+
+    if ( _importer.Busy() ) {
+        char overlay[ 64 ];
+        snprintf( overlay, sizeof( overlay ), "%.1f / %.1f MB", _importer.BytesRead() / ( 1024.0 * 1024.0 ),
+                  _importer.FileSize() / ( 1024.0 * 1024.0 ) );
+        ImGui::ProgressBar( _importer.Progress(), ImVec2( -1.0f, 0.0f ), overlay );
+    }
+    _log.Draw( 120.0f );
+
+    ImGui::End();
+}
@@ -0,0 +1,103 @@
+﻿#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Editor.h"
+#include "LogPanel.h"
+#include "node.h"
+
+enum class GraphFormat { Dot, Json };
+
+// 流式解析结果的接收者。节点按报告顺序从 0 开始编号，连线只引用已经报告过的节点
+class GraphSink {
+public:
+    virtual ~GraphSink() = default;
+
+    virtual void OnNode( NodeKind kind ) = 0;
+    virtual void OnEdge( int from, int to ) = 0;
+};
+
+// 由扩展名判断格式：.json 为 JSON，其余按 GraphViz DOT 处理
+GraphFormat GraphFormatFromPath( const std::string& path );
+
+// 按块读取并解析图文件，不把整个文档读入内存。
+// DOT 支持节点、连线（含子图端点）与属性语句，节点属性 type=Add/Sub 决定节点类型；
+// JSON 格式为 { "nodes": [ { "id": "a", "type": "Sub" } ], "edges": [ { "from": "a", "to": "b" } ] }，
+// 连线也可以写成 [ "a", "b" ]。每读入一块调用一次 progress( 已读字节数 )，返回 false 时取消。
+// 失败或被取消时返回 false，error 为错误描述
+bool ReadGraph( const std::string& path, GraphFormat format, GraphSink& sink, std::string& error,
+                const std::function<bool( int64_t )>& progress = nullptr );
+
+// 在当前线程读取整个图文件并加入 editor，失败时 editor 不变。
+// 同一节点的入边依次连到它的各个输入引脚，超出输入引脚数的连线被丢弃，条数写入 droppedLinks
+bool ImportGraph( const std::string& path, Editor& editor, std::string& error, int* droppedLinks = nullptr );
+
+// 在后台线程解析图文件，主线程每帧把已解析的部分批量加入编辑器
+class GraphImporter {
+public:
+    ~GraphImporter() { Cancel(); }
+
+    bool Start( const std::string& path );
+    void Cancel();
+    bool Busy() const { return _thread.joinable(); }
+
+    // 把已解析的节点与连线加入 editor，导入在本次调用中结束时返回 true
+    bool Apply( Editor& editor );
+
+    float Progress() const;
+    int64_t BytesRead() const { return _bytesRead; }
+    int64_t FileSize() const { return _fileSize; }
+    int NodeCount() const { return _nodeCount; }
+    int LinkCount() const { return _linkCount; }
+    // 目标节点的输入引脚已全部连接而被丢弃的连线数
+    int DroppedLinkCount() const { return _droppedLinkCount; }
+    double ParseMs() const { return _parseMs; }
+    const std::string& Error() const { return _error; }
+
+private:
+    struct Batch {
+        std::vector<NodeKind> nodes;
+        std::vector<std::pair<int, int>> edges;
+    };
+
+    std::thread _thread;
+    std::atomic<bool> _cancel = false;
+    std::atomic<bool> _finished = false;
+    std::atomic<int64_t> _bytesRead = 0;
+    int64_t _fileSize = 0;
+
+    // 由后台线程写入，_finished 之后主线程才读取
+    std::string _error;
+    double _parseMs = 0.0;
+
+    std::mutex _mutex;
+    Batch _pending;
+
+    // 全局节点编号到节点的映射，连线可能引用之前批次的节点
+    std::vector<std::shared_ptr<NodeBase>> _nodes;
+    // 每个节点已连接的输入引脚数
+    std::vector<int> _linkedInputs;
+    int _nodeCount = 0;
+    int _linkCount = 0;
+    int _droppedLinkCount = 0;
+};
+
+// 图导入面板，导入到 editor 中
+class GraphImportPanel {
+public:
+    GraphImportPanel()
+        : _log( "Import Log" ) {}
+
+    void Draw( Editor& editor );
+
+private:
+    GraphImporter _importer;
+    ImGuiLogPanel _log;
+    char _path[ 512 ] = "";
+};
@@ -0,0 +1,252 @@
+﻿#include "GraphOptimizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+#include "MemoCache.h"
+
+namespace {
+
+// 两个常量值的内容是否相同。融合的值或没有值时不认为相同
+bool SameValue( const PinValue& a, const PinValue& b ) {
+    if ( a.Type() != b.Type() )
+        return false;
+    switch ( a.Type() ) {
+    case ValueType::Float:
+        return *a.As<float>() == *b.As<float>();
+    case ValueType::Vec4: {
+        const Vec4& x = *a.As<Vec4>();
+        const Vec4& y = *b.As<Vec4>();
+        return x.x == y.x && x.y == y.y && x.z == y.z && x.w == y.w;
+    }
+    case ValueType::Column: {
+        const ColumnPtr& x = *a.As<ColumnPtr>();
+        const ColumnPtr& y = *b.As<ColumnPtr>();
+        if ( x == y )
+            return true;
+        if ( !x || !y || x->Type() != y->Type() || x->Size() != y->Size() || x->Hash() != y->Hash() )
+            return false;
+        return memcmp( x->Data(), y->Data(), x->Size() * ColumnTypeSize( x->Type() ) ) == 0;
+    }
+    default:
+        return false;
+    }
+}
+
+}  // namespace
+
+bool GraphOptimizer::Optimize( Editor& editor, const Options& options ) {
+    const auto start = std::chrono::steady_clock::now();
+    const size_t nodeCount = editor.nodes.size();
+    _editor = &editor;
+    _report = Report{};
+    _report.nodes = nodeCount;
+    _graph.nodes.clear();
+    _graph.links.clear();
+    ++_graph.revision;
+    _folded.clear();
+    _mapping.assign( nodeCount, Mapping{ State::Dead, 0 } );
+
+    _pinBegin.assign( 1, 0 );
+    for ( const auto& node : editor.nodes )
+        _pinBegin.push_back( _pinBegin.back() + (uint32_t)node->pins.size() );
+
+    // 与求值器相同，同一个输入有多条连线时取最后一条
+    const std::vector<ResolvedLink> links = ResolveLinks( editor );
+    MarkLinkedPins( editor, links );
+    _inputs.assign( _pinBegin.back(), -1 );
+    std::vector<int> linkIds( _pinBegin.back(), 0 );
+    for ( const ResolvedLink& link : links ) {
+        _inputs[ _pinBegin[ link.toNode ] + link.toPin ] = (int64_t)_pinBegin[ link.fromNode ] + link.fromPin;
+        linkIds[ _pinBegin[ link.toNode ] + link.toPin ] = link.id;
+    }
+
+    const std::vector<uint32_t> order = TopologicalSort( nodeCount, links );
+    if ( order.size() != nodeCount ) {
+        _mapping.clear();
+        return false;
+    }
+
+    // 从输出节点沿连线向上游标记需要计算的节点
+    std::vector<uint8_t> live( nodeCount, options.outputs.empty() ? 1 : 0 );
+    if ( !options.outputs.empty() ) {
+        std::unordered_map<int, uint32_t> indices;
+        for ( uint32_t i = 0; i < nodeCount; ++i )
+            indices.emplace( editor.nodes[ i ]->node_id, i );
+        std::vector<uint32_t> stack;
+        for ( const int id : options.outputs ) {
+            const auto found = indices.find( id );
+            if ( found != indices.end() && !live[ found->second ] ) {
+                live[ found->second ] = 1;
+                stack.push_back( found->second );
+            }
+        }
+        while ( !stack.empty() ) {
+            const uint32_t i = stack.back();
+            stack.pop_back();
+            for ( uint32_t k = _pinBegin[ i ]; k < _pinBegin[ i + 1 ]; ++k ) {
+                if ( _inputs[ k ] < 0 )
+                    continue;
+                const uint32_t from = (uint32_t)( std::upper_bound( _pinBegin.begin(), _pinBegin.end(), (uint32_t)_inputs[ k ] ) -
+                                                  _pinBegin.begin() - 1 );
+                if ( !live[ from ] ) {
+                    live[ from ] = 1;
+                    stack.push_back( from );
+                }
+            }
+        }
+    }
+
+    _variables.assign( _pinBegin.back(), 0 );
+    std::unordered_map<uint64_t, std::vector<uint32_t>> candidates;
+    candidates.reserve( nodeCount );
+    for ( const uint32_t i : order ) {
+        if ( !live[ i ] ) {
+            ++_report.dead;
+            continue;
+        }
+        const NodeBase& node = *editor.nodes[ i ];
+        bool constant = true;
+        uint64_t key = HashCombine( 0, (uint64_t)node.kind );
+        for ( uint32_t p = 0; p < node.pins.size(); ++p ) {
+            const Pin& pin = node.pins[ p ];
+            if ( pin.ptype != PinType::Input )
+                continue;
+            if ( _inputs[ _pinBegin[ i ] + p ] < 0 && options.variable && options.variable( pin ) )
+                _variables[ _pinBegin[ i ] + p ] = 1;
+            const Source source = SourceOf( i, p );
+            uint64_t hash;
+            if ( source.kind == Source::Output ) {
+                constant = false;
+                key = HashCombine( key, HashCombine( (uint64_t)source.node << 8 | source.pin, 1 ) );
+            }
+            else if ( source.kind == Source::Constant && HashValue( *source.value, hash ) ) {
+                key = HashCombine( key, HashCombine( hash, 2 ) );
+            }
+            else {
+                constant = constant && source.kind == Source::Constant;
+                key = HashCombine( key, HashCombine( (uint64_t)(uint32_t)pin.pid, 3 ) );
+            }
+        }
+
+        // 全部输入为常量：现在计算，之后不再求值
+        if ( constant ) {
+            std::shared_ptr<NodeBase> folded = CloneNode( node );
+            for ( uint32_t p = 0; p < folded->pins.size(); ++p ) {
+                const Source source = SourceOf( i, p );
+                if ( folded->pins[ p ].ptype == PinType::Input && source.value && _inputs[ _pinBegin[ i ] + p ] >= 0 )
+                    folded->pins[ p ].Assign( *source.value );
+            }
+            folded->Compute();
+            _mapping[ i ] = Mapping{ State::Folded, (uint32_t)_folded.size() };
+            _folded.push_back( std::move( folded ) );
+            ++_report.folded;
+            continue;
+        }
+
+        std::vector<uint32_t>& same = candidates[ key ];
+        bool merged = false;
+        for ( const uint32_t other : same ) {
+            if ( SameInputs( i, other ) ) {
+                _mapping[ i ] = Mapping{ State::Merged, other };
+                ++_report.merged;
+                merged = true;
+                break;
+            }
+        }
+        if ( merged )
+            continue;
+        same.push_back( i );
+
+        // 保留的节点：上游被折叠的输入直接写入常量，其余连到保留的上游节点
+        std::shared_ptr<NodeBase> clone = CloneNode( node );
+        for ( uint32_t p = 0; p < clone->pins.size(); ++p ) {
+            const int64_t input = _inputs[ _pinBegin[ i ] + p ];
+            if ( clone->pins[ p ].ptype != PinType::Input || input < 0 )
+                continue;
+            const Source source = SourceOf( i, p );
+            if ( source.kind == Source::Output ) {
+                const int start = editor.nodes[ source.node ]->pins[ source.pin ].pid;
+                _graph.links.emplace_back( linkIds[ _pinBegin[ i ] + p ], start, clone->pins[ p ].pid );
+            }
+            else if ( source.value ) {
+                clone->pins[ p ].Assign( *source.value );
+            }
+        }
+        _mapping[ i ] = Mapping{ State::Live, (uint32_t)_graph.nodes.size() };
+        _graph.nodes.push_back( std::move( clone ) );
+    }
+
+    _report.remaining = _graph.nodes.size();
+    _report.links = _graph.links.size();
+    _report.ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+    return true;
+}
+
+GraphOptimizer::Source GraphOptimizer::SourceOf( const uint32_t node, const uint32_t pin ) const {
+    const uint32_t k = _pinBegin[ node ] + pin;
+    const int64_t input = _inputs[ k ];
+    if ( input < 0 ) {
+        if ( _variables[ k ] )
+            return Source{ Source::Unique, node, pin, nullptr };
+        return Source{ Source::Constant, node, pin, &_editor->nodes[ node ]->pins[ pin ].value };
+    }
+    // 连线来源：合并的节点换成保留的节点，折叠的节点换成它的值
+    uint32_t from = (uint32_t)( std::upper_bound( _pinBegin.begin(), _pinBegin.end(), (uint32_t)input ) - _pinBegin.begin() - 1 );
+    const uint32_t fromPin = (uint32_t)input - _pinBegin[ from ];
+    if ( _mapping[ from ].state == State::Merged )
+        from = _mapping[ from ].index;
+    if ( _mapping[ from ].state == State::Folded )
+        return Source{ Source::Constant, from, fromPin, &_folded[ _mapping[ from ].index ]->pins[ fromPin ].value };
+    return Source{ Source::Output, from, fromPin, nullptr };
+}
+
+bool GraphOptimizer::SameInputs( const uint32_t a, const uint32_t b ) const {
+    const NodeBase& x = *_editor->nodes[ a ];
+    const NodeBase& y = *_editor->nodes[ b ];
+    if ( x.kind != y.kind || x.pins.size() != y.pins.size() )
+        return false;
+    for ( uint32_t p = 0; p < x.pins.size(); ++p ) {
+        if ( x.pins[ p ].ptype != PinType::Input )
+            continue;
+        const Source s = SourceOf( a, p );
+        const Source t = SourceOf( b, p );
+        if ( s.kind != t.kind || s.kind == Source::Unique )
+            return false;
+        if ( s.kind == Source::Output ? s.node != t.node || s.pin != t.pin : !SameValue( *s.value, *t.value ) )
+            return false;
+    }
+    return true;
+}
+
+const Pin* GraphOptimizer::Resolve( const uint32_t node, const uint32_t pin ) const {
+    if ( node >= _mapping.size() )
+        return nullptr;
+    const Mapping& mapping = _mapping[ node ];
+    const NodeBase* resolved = nullptr;
+    switch ( mapping.state ) {
+    case State::Live:
+        resolved = _graph.nodes[ mapping.index ].get();
+        break;
+    case State::Folded:
+        resolved = _folded[ mapping.index ].get();
+        break;
+    case State::Merged:
+        return Resolve( mapping.index, pin );
+    case State::Dead:
+        return nullptr;
+    }
+    return pin < resolved->pins.size() ? &resolved->pins[ pin ] : nullptr;
+}
+
+NodeBase* GraphOptimizer::Live( const uint32_t node ) const {
+    if ( node >= _mapping.size() || _mapping[ node ].state != State::Live )
+        return nullptr;
+    return _graph.nodes[ _mapping[ node ].index ].get();
+}
+
+bool GraphOptimizer::Variable( const uint32_t node, const uint32_t pin ) const {
+    return node < _mapping.size() && pin < _pinBegin[ node + 1 ] - _pinBegin[ node ] && _variables[ _pinBegin[ node ] + pin ];
+}
@@ -0,0 +1,77 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Editor.h"
+
+// 求值前的图优化：由 Editor 模型构造一个更小的图来求值，再把结果映射回原图的每个引脚，用户看到的图不变。
+// 常量折叠：没有连接、也不是变量的输入为常量，全部输入为常量的节点在优化时计算一次，结果作为下游的常量。
+// 死节点消除：指定输出节点时，不能到达任何输出节点的节点不计算。
+// 公共子表达式合并：按拓扑顺序对每个节点的类型与输入来源（上游输出或常量的内容）哈希，类型相同、
+// 每个输入来源都相同的节点只保留第一个，下游改连到保留的节点，因此整棵重复的子树逐层合并
+class GraphOptimizer {
+public:
+    struct Options {
+        // 输出节点 id；为空时所有节点都是输出，不消除节点
+        std::vector<int> outputs;
+        // 值在两次求值之间会被修改的未连接输入（参数），不折叠也不按值合并；为空时所有未连接的输入都是常量
+        std::function<bool( const Pin& )> variable;
+    };
+
+    struct Report {
+        size_t nodes = 0;
+        size_t folded = 0;
+        size_t merged = 0;
+        size_t dead = 0;
+        // 优化后的图中需要求值的节点数与连线数
+        size_t remaining = 0;
+        size_t links = 0;
+        double ms = 0.0;
+    };
+
+    // 由 editor 构造优化后的图，并按求值器的规则设置 editor 中引脚的 isLinked。
+    // 图中有环时不优化，返回 false
+    bool Optimize( Editor& editor, const Options& options );
+
+    // 优化后的图，节点与引脚 id 与原图相同。每次 Optimize 后 revision 改变
+    Editor& Graph() { return _graph; }
+    const Report& LastReport() const { return _report; }
+
+    // 原图第 node 个节点的第 pin 个引脚的值在优化后所在的引脚；被消除的节点返回 nullptr
+    const Pin* Resolve( uint32_t node, uint32_t pin ) const;
+    // 原图第 node 个节点在优化后的图中的节点，被折叠、合并或消除时返回 nullptr
+    NodeBase* Live( uint32_t node ) const;
+    // 原图第 node 个节点的第 pin 个引脚在 Optimize 时是否为变量输入
+    bool Variable( uint32_t node, uint32_t pin ) const;
+
+private:
+    enum class State : uint8_t { Live, Folded, Merged, Dead };
+    // Live 时为 _graph.nodes 中的序号，Folded 时为 _folded 中的序号，Merged 时为保留的原图节点序号
+    struct Mapping {
+        State state;
+        uint32_t index;
+    };
+    // 输入来源：上游输出（原图节点序号与引脚序号），或常量值，或不能合并的变量
+    struct Source {
+        enum Kind : uint8_t { Output, Constant, Unique } kind;
+        uint32_t node, pin;
+        const PinValue* value;
+    };
+
+    Source SourceOf( uint32_t node, uint32_t pin ) const;
+    bool SameInputs( uint32_t a, uint32_t b ) const;
+
+    Editor _graph;
+    Report _report;
+    std::vector<Mapping> _mapping;
+    std::vector<std::shared_ptr<NodeBase>> _folded;
+    // 原图第 i 个节点的引脚从 _pinBegin[ i ] 开始
+    std::vector<uint32_t> _pinBegin;
+    std::vector<uint8_t> _variables;
+    // 输入引脚的连线来源，没有连接时为 -1
+    std::vector<int64_t> _inputs;
+    const Editor* _editor = nullptr;
+};
@@ -0,0 +1,160 @@
+﻿#include "imnodes_internal.h"
+
+#include "History.h"
+
+#include <algorithm>
+
+#include "Editor.h"
+
+namespace {
+
+// 在 editor 的 ImNodes 上下文中执行 fn，之后恢复原来的上下文
+template <typename Fn>
+void WithEditorContext( Editor& editor, Fn&& fn ) {
+    ImNodesEditorContext* previous = &ImNodes::EditorContextGet();
+    ImNodes::EditorContextSet( editor.context );
+    fn();
+    ImNodes::EditorContextSet( previous );
+}
+
+std::vector<Link>::iterator FindLink( Editor& editor, const int id ) {
+    return std::find_if( editor.links.begin(), editor.links.end(), [ id ]( const Link& link ) { return link.id == id; } );
+}
+
+class MoveNodesCommand : public EditCommand {
+public:
+    MoveNodesCommand( std::vector<int> nodeIds, const ImVec2 delta )
+        : _nodeIds( std::move( nodeIds ) )
+        , _delta( delta ) {}
+
+    void Undo( Editor& editor ) override { Move( editor, ImVec2( -_delta.x, -_delta.y ) ); }
+    void Redo( Editor& editor ) override { Move( editor, _delta ); }
+
+private:
+    void Move( Editor& editor, const ImVec2 delta ) const {
+        WithEditorContext( editor, [ & ] {
+            for ( const int id : _nodeIds ) {
+                const ImVec2 pos = ImNodes::GetNodeGridSpacePos( id );
+                ImNodes::SetNodeGridSpacePos( id, ImVec2( pos.x + delta.x, pos.y + delta.y ) );
+            }
+        } );
+    }
+
+    std::vector<int> _nodeIds;
+    ImVec2 _delta;
+};
+
+class AddLinkCommand : public EditCommand {
+public:
+    explicit AddLinkCommand( const Link& link )
+        : _link( link ) {}
+
+    void Undo( Editor& editor ) override {
+        const auto it = FindLink( editor, _link.id );
+        if ( it != editor.links.end() ) {
+            editor.links.erase( it );
+            ++editor.revision;
+        }
+    }
+    void Redo( Editor& editor ) override {
+        editor.links.push_back( _link );
+        ++editor.revision;
+    }
+
+private:
+    Link _link;
+};
+
+class RemoveLinkCommand : public EditCommand {
+public:
+    explicit RemoveLinkCommand( const int id )
+        : _link( id, 0, 0 ) {}
+
+    void Undo( Editor& editor ) override {
+        editor.links.push_back( _link );
+        ++editor.revision;
+    }
+    void Redo( Editor& editor ) override {
+        const auto it = FindLink( editor, _link.id );
+        if ( it != editor.links.end() ) {
+            _link = *it;
+            editor.links.erase( it );
+            ++editor.revision;
+        }
+    }
+
+private:
+    Link _link;
+};
+
+class AddNodeCommand : public EditCommand {
+public:
+    AddNodeCommand( std::shared_ptr<NodeBase> node, const ImVec2 pos )
+        : _node( std::move( node ) )
+        , _pos( pos ) {}
+
+    void Undo( Editor& editor ) override {
+        std::erase( editor.nodes, _node );
+        ++editor.revision;
+    }
+    void Redo( Editor& editor ) override {
+        editor.nodes.push_back( _node );
+        ++editor.revision;
+        WithEditorContext( editor, [ & ] { ImNodes::SetNodeGridSpacePos( _node->node_id, _pos ); } );
+    }
+
+private:
+    std::shared_ptr<NodeBase> _node;
+    ImVec2 _pos;
+};
+
+}  // namespace
+
+void EditHistory::Execute( Editor& editor, std::unique_ptr<EditCommand> command ) {
+    command->Redo( editor );
+    Record( std::move( command ) );
+}
+
+void EditHistory::Record( std::unique_ptr<EditCommand> command ) {
+    _undo.push_back( std::move( command ) );
+    _redo.clear();
+}
+
+bool EditHistory::Undo( Editor& editor ) {
+    if ( _undo.empty() )
+        return false;
+    _undo.back()->Undo( editor );
+    _redo.push_back( std::move( _undo.back() ) );
+    _undo.pop_back();
+    return true;
+}
+
+bool EditHistory::Redo( Editor& editor ) {
+    if ( _redo.empty() )
+        return false;
+    _redo.back()->Redo( editor );
+    _undo.push_back( std::move( _redo.back() ) );
+    _redo.pop_back();
+    return true;
+}
+
+void EditHistory::Clear() {
+    _undo.clear();
+    _redo.clear();
+}
+
+std::unique_ptr<EditCommand> MakeMoveNodesCommand( std::vector<int> nodeIds, const ImVec2 delta ) {
+    return std::make_unique<MoveNodesCommand>( std::move( nodeIds ), delta );
+}
+
+std::unique_ptr<EditCommand> MakeAddLinkCommand( const int id, const int startAttr, const int endAttr ) {
+    return std::make_unique<AddLinkCommand>( Link( id, startAttr, endAttr ) );
+}
+
+std::unique_ptr<EditCommand> MakeRemoveLinkCommand( const int id ) {
+    return std::make_unique<RemoveLinkCommand>( id );
+}
+
+std::unique_ptr<EditCommand> MakeAddNodeCommand( std::shared_ptr<NodeBase> node, const ImVec2 pos ) {
+    return std::make_unique<AddNodeCommand>( std::move( node ), pos );
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+#include <memory>
+#include <vector>
+
+#include "imnodes.h"
+
+#include "node.h"
+
+struct Editor;
+
+// 一次可撤销的编辑。命令只记录改动本身（移动了哪些节点、位移多少，增删的连线或节点），
+// 不复制整个图，历史占用的内存只与改动的规模有关
+class EditCommand {
+public:
+    virtual ~EditCommand() = default;
+
+    virtual void Undo( Editor& editor ) = 0;
+    virtual void Redo( Editor& editor ) = 0;
+};
+
+class EditHistory {
+public:
+    // 执行命令并记入历史
+    void Execute( Editor& editor, std::unique_ptr<EditCommand> command );
+    // 记录已经生效的改动（例如 ImNodes 中已经完成的拖动）
+    void Record( std::unique_ptr<EditCommand> command );
+
+    bool Undo( Editor& editor );
+    bool Redo( Editor& editor );
+    bool CanUndo() const { return !_undo.empty(); }
+    bool CanRedo() const { return !_redo.empty(); }
+    void Clear();
+
+private:
+    std::vector<std::unique_ptr<EditCommand>> _undo;
+    std::vector<std::unique_ptr<EditCommand>> _redo;
+};
+
+// 节点 nodeIds 在网格空间中移动了 delta
+std::unique_ptr<EditCommand> MakeMoveNodesCommand( std::vector<int> nodeIds, ImVec2 delta );
+std::unique_ptr<EditCommand> MakeAddLinkCommand( int id, int startAttr, int endAttr );
+std::unique_ptr<EditCommand> MakeRemoveLinkCommand( int id );
+// 撤销与重做之间共享同一个节点对象，不做复制
+std::unique_ptr<EditCommand> MakeAddNodeCommand( std::shared_ptr<NodeBase> node, ImVec2 pos );
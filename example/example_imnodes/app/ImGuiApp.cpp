@@ -1,6 +1,7 @@
 ﻿// ImGuiApp.cpp
 #include "ImGuiApp.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <stdexcept>
@@ -146,6 +147,8 @@ void ImGuiApp::UploadFonts() {
     err = vkBeginCommandBuffer( command_buffer, &begin_info );
     check_vk_result( err );
 
+    // 将引脚形状光栅化到字体图集中，每个引脚只需绘制一个纹理四边形
+    ImNodes::AddPinShapesToFontAtlas( ImGui::GetIO().Fonts );
     ImGui_ImplVulkan_CreateFontsTexture();
     // ImGui_ImplVulkan_CreateFontsTexture(command_buffer);
 
@@ -435,7 +438,8 @@ void ImGuiApp::InitImGui() {
     init_info.RenderPass = m_mainWindowData.RenderPass;
     init_info.Subpass = 0;
     init_info.MinImageCount = m_minImageCount;
-    init_info.ImageCount = m_mainWindowData.ImageCount;
+    // 离屏目标与主窗口在同一帧里各调用一次 RenderDrawData，后端的顶点缓冲按每帧两份轮换
+    init_info.ImageCount = m_mainWindowData.ImageCount * 2;
     init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;  // 或其他 MSAA 设置
     init_info.Allocator = m_allocator;
     init_info.CheckVkResultFn = check_vk_result;  // 使用静态检查函数
@@ -457,6 +461,9 @@ void ImGuiApp::InitImGui() {
 // --- Private Cleanup Methods ---
 
 void ImGuiApp::CleanupImGui() {
+    for ( RetiredTarget& retired : m_retiredTargets )
+        FreeOffscreenTarget( retired.target );
+    m_retiredTargets.clear();
     ImGui_ImplVulkan_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     if ( ImNodes::GetCurrentContext() ) {  // 检查 ImNodes 上下文是否存在
@@ -566,6 +573,7 @@ void ImGuiApp::RenderFrame() {
         check_vk_result( err );
         err = vkResetFences( m_device, 1, &fd->Fence );
         check_vk_result( err );
+        CollectRetiredTargets( wd->FrameIndex );
     }
     {
         // 重置并开始记录命令缓冲
@@ -577,6 +585,10 @@ void ImGuiApp::RenderFrame() {
         err = vkBeginCommandBuffer( fd->CommandBuffer, &info );
         check_vk_result( err );
     }
+
+    // 离屏目标 (小地图) 先于主 RenderPass 录制，两个 RenderPass 的外部依赖保证采样前已写完
+    RecordOffscreenTargets( fd->CommandBuffer );
+
     {
         // 开始 Render Pass
         VkRenderPassBeginInfo info = {};
@@ -648,6 +660,9 @@ void ImGuiApp::HandleResize( int newWidth, int newHeight ) {
     // 等待设备空闲，确保没有操作正在使用旧的交换链资源
     VkResult device_wait_err = vkDeviceWaitIdle( m_device );
     check_vk_result( device_wait_err );  // 最好处理这个错误，例如记录日志或抛出异常
+    for ( RetiredTarget& retired : m_retiredTargets )
+        FreeOffscreenTarget( retired.target );
+    m_retiredTargets.clear();
 
     // --- 重建 Vulkan 窗口资源 ---
     // (可选) 设置新的最小镜像数量，如果你允许它动态变化
@@ -686,7 +701,7 @@ void ImGuiApp::HandleResize( int newWidth, int newHeight ) {
     init_info.DescriptorPool = m_descriptorPool;
     init_info.Subpass = 0;
     init_info.MinImageCount = m_minImageCount;           // 使用当前的最小图像数
-    init_info.ImageCount = m_mainWindowData.ImageCount;  // **使用更新后的图像数**
+    init_info.ImageCount = m_mainWindowData.ImageCount * 2;  // **使用更新后的图像数**，每帧两份顶点缓冲
     init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;       // 或你使用的 MSAA 级别
     init_info.Allocator = m_allocator;
     init_info.CheckVkResultFn = check_vk_result;
@@ -709,6 +724,253 @@ void ImGuiApp::HandleResize( int newWidth, int newHeight ) {
     }
 }
 
+// --- Offscreen Rendering ---
+
+ImTextureID ImGuiApp::RenderToTexture( OffscreenTarget& target, ImDrawData* drawData, ImU32 clearColor ) {
+    const uint32_t width = ( uint32_t )( drawData->DisplaySize.x * drawData->FramebufferScale.x );
+    const uint32_t height = ( uint32_t )( drawData->DisplaySize.y * drawData->FramebufferScale.y );
+    if ( width == 0 || height == 0 )
+        return ImTextureID();
+
+    if ( target.width != width || target.height != height ) {
+        RetireOffscreenTarget( target );
+        CreateOffscreenTarget( target, width, height );
+    }
+
+    // 这里只记下要画的内容，RenderFrame 把它录制进本帧的命令缓冲，不单独提交也不等待队列
+    target.drawData = *drawData;
+    target.clearColor = clearColor;
+    if ( !target.pending ) {
+        target.pending = true;
+        m_pendingTargets.push_back( &target );
+    }
+    return ( ImTextureID )target.descriptorSet;
+}
+
+void ImGuiApp::RecordOffscreenTargets( VkCommandBuffer commandBuffer ) {
+    for ( OffscreenTarget* target : m_pendingTargets ) {
+        const ImVec4 color = ImGui::ColorConvertU32ToFloat4( target->clearColor );
+        VkClearValue clear_value = {};
+        clear_value.color.float32[ 0 ] = color.x;
+        clear_value.color.float32[ 1 ] = color.y;
+        clear_value.color.float32[ 2 ] = color.z;
+        clear_value.color.float32[ 3 ] = color.w;
+
+        VkRenderPassBeginInfo pass_info = {};
+        pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        pass_info.renderPass = target->renderPass;
+        pass_info.framebuffer = target->framebuffer;
+        pass_info.renderArea.extent.width = target->width;
+        pass_info.renderArea.extent.height = target->height;
+        pass_info.clearValueCount = 1;
+        pass_info.pClearValues = &clear_value;
+        vkCmdBeginRenderPass( commandBuffer, &pass_info, VK_SUBPASS_CONTENTS_INLINE );
+
+        // 离屏 RenderPass 与主窗口的格式一致，可以直接使用 ImGui 后端的管线
+        ImGui_ImplVulkan_RenderDrawData( &target->drawData, commandBuffer );
+
+        vkCmdEndRenderPass( commandBuffer );
+        target->pending = false;
+        target->drawData.Clear();
+    }
+    m_pendingTargets.clear();
+}
+
+void ImGuiApp::CreateOffscreenTarget( OffscreenTarget& target, uint32_t width, uint32_t height ) {
+    VkResult err;
+    const VkFormat format = m_mainWindowData.SurfaceFormat.format;
+    target.width = width;
+    target.height = height;
+
+    // 图像及其内存
+    {
+        VkImageCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        info.imageType = VK_IMAGE_TYPE_2D;
+        info.format = format;
+        info.extent.width = width;
+        info.extent.height = height;
+        info.extent.depth = 1;
+        info.mipLevels = 1;
+        info.arrayLayers = 1;
+        info.samples = VK_SAMPLE_COUNT_1_BIT;
+        info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        err = vkCreateImage( m_device, &info, m_allocator, &target.image );
+        check_vk_result( err );
+
+        VkMemoryRequirements req;
+        vkGetImageMemoryRequirements( m_device, target.image, &req );
+        VkMemoryAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = req.size;
+        alloc_info.memoryTypeIndex = FindMemoryType( req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT );
+        err = vkAllocateMemory( m_device, &alloc_info, m_allocator, &target.memory );
+        check_vk_result( err );
+        err = vkBindImageMemory( m_device, target.image, target.memory, 0 );
+        check_vk_result( err );
+    }
+
+    {
+        VkImageViewCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        info.image = target.image;
+        info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        info.format = format;
+        info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        info.subresourceRange.levelCount = 1;
+        info.subresourceRange.layerCount = 1;
+        err = vkCreateImageView( m_device, &info, m_allocator, &target.view );
+        check_vk_result( err );
+    }
+
+    {
+        VkSamplerCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        info.magFilter = VK_FILTER_LINEAR;
+        info.minFilter = VK_FILTER_LINEAR;
+        info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.minLod = -1000;
+        info.maxLod = 1000;
+        info.maxAnisotropy = 1.0f;
+        err = vkCreateSampler( m_device, &info, m_allocator, &target.sampler );
+        check_vk_result( err );
+    }
+
+    // RenderPass 需与主窗口的 RenderPass 兼容 (相同格式和采样数)，渲染结束后转换为着色器只读布局
+    {
+        VkAttachmentDescription attachment = {};
+        attachment.format = format;
+        attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        VkAttachmentReference color_attachment = {};
+        color_attachment.attachment = 0;
+        color_attachment.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        VkSubpassDescription subpass = {};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &color_attachment;
+        VkSubpassDependency dependencies[ 2 ] = {};
+        dependencies[ 0 ].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[ 0 ].dstSubpass = 0;
+        dependencies[ 0 ].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependencies[ 0 ].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[ 0 ].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        dependencies[ 0 ].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[ 1 ].srcSubpass = 0;
+        dependencies[ 1 ].dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[ 1 ].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[ 1 ].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependencies[ 1 ].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[ 1 ].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        VkRenderPassCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        info.attachmentCount = 1;
+        info.pAttachments = &attachment;
+        info.subpassCount = 1;
+        info.pSubpasses = &subpass;
+        info.dependencyCount = 2;
+        info.pDependencies = dependencies;
+        err = vkCreateRenderPass( m_device, &info, m_allocator, &target.renderPass );
+        check_vk_result( err );
+    }
+
+    {
+        VkFramebufferCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        info.renderPass = target.renderPass;
+        info.attachmentCount = 1;
+        info.pAttachments = &target.view;
+        info.width = width;
+        info.height = height;
+        info.layers = 1;
+        err = vkCreateFramebuffer( m_device, &info, m_allocator, &target.framebuffer );
+        check_vk_result( err );
+    }
+
+    target.descriptorSet =
+        ImGui_ImplVulkan_AddTexture( target.sampler, target.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+}
+
+void ImGuiApp::DestroyOffscreenTarget( OffscreenTarget& target ) {
+    if ( target.image == VK_NULL_HANDLE && m_retiredTargets.empty() )
+        return;
+
+    // 只在应用退出时调用：等待 GPU 不再使用该目标以及之前淘汰的目标
+    VkResult err = vkQueueWaitIdle( m_queue );
+    check_vk_result( err );
+
+    for ( RetiredTarget& retired : m_retiredTargets )
+        FreeOffscreenTarget( retired.target );
+    m_retiredTargets.clear();
+    FreeOffscreenTarget( target );
+}
+
+void ImGuiApp::FreeOffscreenTarget( OffscreenTarget& target ) {
+    if ( target.pending )
+        m_pendingTargets.erase( std::find( m_pendingTargets.begin(), m_pendingTargets.end(), &target ) );
+    if ( target.descriptorSet != VK_NULL_HANDLE )
+        ImGui_ImplVulkan_RemoveTexture( target.descriptorSet );
+    if ( target.framebuffer != VK_NULL_HANDLE )
+        vkDestroyFramebuffer( m_device, target.framebuffer, m_allocator );
+    if ( target.renderPass != VK_NULL_HANDLE )
+        vkDestroyRenderPass( m_device, target.renderPass, m_allocator );
+    if ( target.sampler != VK_NULL_HANDLE )
+        vkDestroySampler( m_device, target.sampler, m_allocator );
+    if ( target.view != VK_NULL_HANDLE )
+        vkDestroyImageView( m_device, target.view, m_allocator );
+    if ( target.image != VK_NULL_HANDLE )
+        vkDestroyImage( m_device, target.image, m_allocator );
+    if ( target.memory != VK_NULL_HANDLE )
+        vkFreeMemory( m_device, target.memory, m_allocator );
+    target = OffscreenTarget();
+}
+
+void ImGuiApp::RetireOffscreenTarget( OffscreenTarget& target ) {
+    if ( target.pending )
+        m_pendingTargets.erase( std::find( m_pendingTargets.begin(), m_pendingTargets.end(), &target ) );
+    target.pending = false;
+    if ( target.image != VK_NULL_HANDLE ) {
+        m_retiredTargets.push_back( RetiredTarget{ target, std::vector<bool>( m_mainWindowData.ImageCount, false ) } );
+        m_retiredTargets.back().target.drawData.Clear();
+    }
+    target = OffscreenTarget();
+}
+
+void ImGuiApp::CollectRetiredTargets( uint32_t frameIndex ) {
+    for ( size_t i = 0; i < m_retiredTargets.size(); ) {
+        RetiredTarget& retired = m_retiredTargets[ i ];
+        retired.waited[ frameIndex ] = true;
+        if ( std::find( retired.waited.begin(), retired.waited.end(), false ) == retired.waited.end() ) {
+            FreeOffscreenTarget( retired.target );
+            m_retiredTargets.erase( m_retiredTargets.begin() + i );
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+uint32_t ImGuiApp::FindMemoryType( uint32_t typeBits, VkMemoryPropertyFlags properties ) const {
+    VkPhysicalDeviceMemoryProperties mem_properties;
+    vkGetPhysicalDeviceMemoryProperties( m_physicalDevice, &mem_properties );
+    for ( uint32_t i = 0; i < mem_properties.memoryTypeCount; i++ ) {
+        if ( ( typeBits & ( 1u << i ) ) && ( mem_properties.memoryTypes[ i ].propertyFlags & properties ) == properties )
+            return i;
+    }
+    throw std::runtime_error( "[vulkan] No suitable memory type found." );
+}
+
 // --- Static Helper Functions ---
 
 void ImGuiApp::check_vk_result( VkResult err ) {
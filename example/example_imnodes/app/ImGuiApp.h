@@ -61,6 +61,28 @@ protected:
         return m_window;
     }  // 允许派生类访问窗口
 
+    // 离屏渲染目标，用于把 ImDrawData 渲染成纹理 (例如节点编辑器的小地图)
+    struct OffscreenTarget {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkSampler sampler = VK_NULL_HANDLE;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        VkFramebuffer framebuffer = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        // 等待录制进下一帧命令缓冲的内容
+        bool pending = false;
+        ImDrawData drawData;
+        ImU32 clearColor = 0;
+    };
+
+    // 清屏为 clearColor 后将 drawData 渲染到 target (尺寸变化时自动重建)，返回可供 ImGui 绘制的纹理。
+    // 渲染在本帧的命令缓冲中先于主 RenderPass 执行，drawData 引用的绘制列表须保持到本帧 RenderFrame 之后
+    ImTextureID RenderToTexture( OffscreenTarget& target, ImDrawData* drawData, ImU32 clearColor );
+    void DestroyOffscreenTarget( OffscreenTarget& target );
+
 private:
     // 初始化阶段
     void InitSDL( const std::string& windowTitle, int width, int height );
@@ -81,6 +103,15 @@ private:
     void PresentFrame();
     void HandleResize( int newWidth, int newHeight );
 
+    // 离屏渲染
+    void CreateOffscreenTarget( OffscreenTarget& target, uint32_t width, uint32_t height );
+    void FreeOffscreenTarget( OffscreenTarget& target );
+    // 尺寸变化时旧目标可能仍被在途的帧采样，等每个帧的围栏都等到过一次后再释放
+    void RetireOffscreenTarget( OffscreenTarget& target );
+    void CollectRetiredTargets( uint32_t frameIndex );
+    void RecordOffscreenTargets( VkCommandBuffer commandBuffer );
+    uint32_t FindMemoryType( uint32_t typeBits, VkMemoryPropertyFlags properties ) const;
+
     // Vulkan 辅助函数 (作为私有静态成员或移至单独的工具类)
     static void check_vk_result( VkResult err );
 #ifdef APP_USE_VULKAN_DEBUG_REPORT
@@ -112,6 +143,14 @@ private:
 
     // 字体加载相关
     bool m_fontsLoaded = false;  // 标记字体是否已上传
+
+    // 离屏渲染相关
+    struct RetiredTarget {
+        OffscreenTarget target;
+        std::vector<bool> waited;  // 按帧索引记录淘汰后是否已等待过该帧的围栏
+    };
+    std::vector<OffscreenTarget*> m_pendingTargets;
+    std::vector<RetiredTarget> m_retiredTargets;
 };
 
 #endif  // IMGUIAPP_H
\ No newline at end of file
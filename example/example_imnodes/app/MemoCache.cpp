@@ -0,0 +1,112 @@
+﻿#include "MemoCache.h"
+
+#include <cstring>
+
+namespace {
+
+// 条目占用的字节数：列按元素估计，共享同一列的条目会重复计入
+size_t ValueBytes( const PinValue& value ) {
+    if ( const ColumnPtr* column = value.As<ColumnPtr>() )
+        return sizeof( PinValue ) + ( *column ? ( *column )->Size() * ColumnTypeSize( ( *column )->Type() ) : 0 );
+    return sizeof( PinValue );
+}
+
+uint64_t HashFloat( const float number ) {
+    // 0.0f 与 -0.0f 相等，按同一个值处理
+    const float normalized = number == 0.0f ? 0.0f : number;
+    uint32_t bits;
+    memcpy( &bits, &normalized, sizeof( bits ) );
+    return bits;
+}
+
+}  // namespace
+
+bool HashValue( const PinValue& value, uint64_t& hash ) {
+    const uint64_t type = (uint64_t)value.Type();
+    switch ( value.Type() ) {
+    case ValueType::Float:
+        hash = HashCombine( type, HashFloat( *value.As<float>() ) );
+        return true;
+    case ValueType::Vec4: {
+        const Vec4& vector = *value.As<Vec4>();
+        hash = type;
+        for ( const float component : { vector.x, vector.y, vector.z, vector.w } )
+            hash = HashCombine( hash, HashFloat( component ) );
+        return true;
+    }
+    case ValueType::Column: {
+        const ColumnPtr& column = *value.As<ColumnPtr>();
+        if ( !column )
+            return false;
+        hash = HashCombine( type, column->Hash() );
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool MemoCache::Find( const uint64_t key, std::vector<PinValue>& outputs ) {
+    std::lock_guard<std::mutex> lock( _mutex );
+    const auto found = _index.find( key );
+    if ( found == _index.end() ) {
+        ++_misses;
+        return false;
+    }
+    ++_hits;
+    _lru.splice( _lru.begin(), _lru, found->second );
+    outputs = found->second->outputs;
+    return true;
+}
+
+void MemoCache::Insert( const uint64_t key, std::vector<PinValue> outputs ) {
+    size_t bytes = sizeof( Entry );
+    for ( const PinValue& value : outputs )
+        bytes += ValueBytes( value );
+    std::lock_guard<std::mutex> lock( _mutex );
+    // 比整个缓存还大的结果不缓存
+    if ( bytes > _capacity )
+        return;
+    const auto found = _index.find( key );
+    if ( found != _index.end() ) {
+        _bytes -= found->second->bytes;
+        _lru.erase( found->second );
+        _index.erase( found );
+    }
+    _lru.push_front( Entry{ key, std::move( outputs ), bytes } );
+    _index.emplace( key, _lru.begin() );
+    _bytes += bytes;
+    Evict();
+}
+
+size_t MemoCache::EntryCount() const {
+    std::lock_guard<std::mutex> lock( _mutex );
+    return _index.size();
+}
+
+void MemoCache::Clear() {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _lru.clear();
+    _index.clear();
+    _bytes = 0;
+}
+
+void MemoCache::SetCapacity( const size_t capacity ) {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _capacity = capacity;
+    Evict();
+}
+
+void MemoCache::ResetStats() {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _hits = _misses = _evictions = 0;
+}
+
+void MemoCache::Evict() {
+    while ( _bytes > _capacity && !_lru.empty() ) {
+        _bytes -= _lru.back().bytes;
+        _index.erase( _lru.back().key );
+        _lru.pop_back();
+        ++_evictions;
+    }
+}
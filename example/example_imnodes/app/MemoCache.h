@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "PinValue.h"
+
+// 哈希组合
+inline uint64_t HashCombine( const uint64_t hash, const uint64_t value ) {
+    uint64_t h = ( hash ^ value ) * 0x9E3779B97F4A7C15ull;
+    return h ^ ( h >> 32 );
+}
+
+// 引脚值的内容哈希：标量与向量按位、列按 Column::Hash，包含类型。没有值或融合的值不能哈希，返回 false
+bool HashValue( const PinValue& value, uint64_t& hash );
+
+// 节点输出的内容寻址缓存。键为节点类型与全部输入内容的哈希，值为节点的全部输出。
+// 输入重复出现时（撤销、把连线改回去、相同的子图）直接复用缓存的输出，不重新计算。
+// 按输出占用的字节数限制大小，超出时淘汰最近最少使用的条目。可以在多个线程中同时使用
+class MemoCache {
+public:
+    static constexpr size_t DefaultCapacity = 256u << 20;
+
+    explicit MemoCache( size_t capacity = DefaultCapacity )
+        : _capacity( capacity ) {}
+
+    // 命中时复制缓存的输出到 outputs
+    bool Find( uint64_t key, std::vector<PinValue>& outputs );
+    void Insert( uint64_t key, std::vector<PinValue> outputs );
+    void Clear();
+
+    // 容量（字节），缩小时立即淘汰
+    void SetCapacity( size_t capacity );
+    size_t Capacity() const { return Locked( _capacity ); }
+    size_t Bytes() const { return Locked( _bytes ); }
+    size_t EntryCount() const;
+
+    size_t Hits() const { return Locked( _hits ); }
+    size_t Misses() const { return Locked( _misses ); }
+    size_t Evictions() const { return Locked( _evictions ); }
+    void ResetStats();
+
+private:
+    struct Entry {
+        uint64_t key;
+        std::vector<PinValue> outputs;
+        size_t bytes;
+    };
+
+    void Evict();
+    // 界面线程读取统计时，其他线程可能正在求值
+    size_t Locked( const size_t& field ) const {
+        std::lock_guard<std::mutex> lock( _mutex );
+        return field;
+    }
+
+    mutable std::mutex _mutex;
+    // 最近使用的在前
+    std::list<Entry> _lru;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> _index;
+    size_t _capacity;
+    size_t _bytes = 0;
+    size_t _hits = 0;
+    size_t _misses = 0;
+    size_t _evictions = 0;
+};
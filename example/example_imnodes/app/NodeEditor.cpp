@@ -1,46 +1,268 @@
 ﻿#include "NodeEditor.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <unordered_set>
+
+namespace {
+
+// 流式执行的测试输入：共 rows 行，以 base 为起点的锯齿波
+StreamPipeline::Reader RampReader( const size_t rows, const float base ) {
+    return [ rows, base ]( const size_t row, const size_t count ) -> ColumnPtr {
+        if ( row >= rows )
+            return nullptr;
+        auto chunk = std::make_shared<Column>( ColumnType::Float, std::min( count, rows - row ) );
+        float* data = (float*)chunk->Data();
+        for ( size_t r = 0; r < chunk->Size(); ++r )
+            data[ r ] = base + (float)( ( row + r ) % 1000 ) * 0.001f;
+        return chunk;
+    };
+}
+
+}  // namespace
+
 void MyApplication::OnFrame() {
     // 3. (可选) 添加 ImNodes 编辑器示例
     {
         ImGui::Begin( "ImNodes Editor Example" );
+        ImNodes::EditorContextSet( nodeitor.context );
 
-        ImNodes::BeginNodeEditor();
+        // 撤销 / 重做：Ctrl+Z, Ctrl+Y 或 Ctrl+Shift+Z
+        const ImGuiIO& io = ImGui::GetIO();
+        const bool focused = ImGui::IsWindowFocused( ImGuiFocusedFlags_RootAndChildWindows );
+        const bool redoKey = ImGui::IsKeyPressed( ImGuiKey_Y ) || ( io.KeyShift && ImGui::IsKeyPressed( ImGuiKey_Z ) );
+        ImGui::BeginDisabled( !nodeitor.history.CanUndo() );
+        if ( ImGui::Button( "Undo" ) || ( focused && io.KeyCtrl && !io.KeyShift && ImGui::IsKeyPressed( ImGuiKey_Z ) ) )
+            nodeitor.history.Undo( nodeitor );
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::BeginDisabled( !nodeitor.history.CanRedo() );
+        if ( ImGui::Button( "Redo" ) || ( focused && io.KeyCtrl && redoKey ) )
+            nodeitor.history.Redo( nodeitor );
+        ImGui::EndDisabled();
 
-        DrawNodes();
+        // 整个模型（节点、引脚、连线与布局）保存为快照 / 从快照恢复
+        ImGui::SameLine();
+        if ( ImGui::Button( "Save" ) ) {
+            std::string error;
+            snapshotStatus = SaveSnapshot( nodeitor, SnapshotPath, error ) ? "Saved to " + std::string( SnapshotPath ) : error;
+        }
+        ImGui::SameLine();
+        if ( ImGui::Button( "Load" ) ) {
+            std::string error;
+            snapshotStatus = LoadSnapshot( nodeitor, SnapshotPath, error ) ? "Loaded " + std::string( SnapshotPath ) : error;
+        }
+        if ( !snapshotStatus.empty() ) {
+            ImGui::SameLine();
+            ImGui::TextDisabled( "%s", snapshotStatus.c_str() );
+        }
 
-        // 添加链接 (如果之前没有)
-        if ( ImNodes::IsEditorHovered() && ImGui::IsMouseClicked( ImGuiMouseButton_Left ) ) {
-            // 简单的连接逻辑示例，实际应用会更复杂
+        // 求值在后台进行，这里只取走已经完成的最新结果，不等待。只计算受影响的下游节点
+        evaluator.Poll( nodeitor );
+        if ( ImGui::Checkbox( "Single thread", &singleThread ) )
+            evaluator.SetSingleThread( singleThread );
+        ImGui::SameLine();
+        if ( ImGui::Checkbox( "Optimize", &optimize ) )
+            evaluator.SetOptimize( optimize );
+        ImGui::SameLine();
+        const AsyncEvaluator::Result& result = evaluator.Latest();
+        if ( result.tape )
+            ImGui::Text( "Computed %d of %d nodes in %.3f ms (tape)", (int)result.computed, (int)result.scheduled, result.ms );
+        else
+            ImGui::Text( "Computed %d of %d nodes in %.3f ms (%d threads)", (int)result.computed, (int)result.scheduled,
+                         result.ms, result.threads );
+        if ( evaluator.Busy() ) {
+            ImGui::SameLine();
+            ImGui::TextDisabled( "evaluating... (%d stale runs cancelled)", (int)evaluator.CancelledCount() );
         }
-        // 始终绘制链接 (假设已经有链接数据)
-        for ( int i = 0; i < nodeitor.links.size(); ++i ) {
-            const Link p = nodeitor.links[ i ];
-            ImNodes::Link( p.id, p.start_attr, p.end_attr );
+        if ( result.blocked ) {
+            ImGui::SameLine();
+            ImGui::TextColored( ImVec4( 1.0f, 0.4f, 0.4f, 1.0f ), "%d nodes in or after a cycle are not evaluated",
+                                (int)result.blocked );
+        }
+        if ( result.optimized ) {
+            const GraphOptimizer::Report& report = result.optimization;
+            ImGui::Text( "Optimized %d -> %d nodes: %d folded, %d merged, %d dead (%.0f%% less work), pass %.3f ms",
+                         (int)report.nodes, (int)report.remaining, (int)report.folded, (int)report.merged, (int)report.dead,
+                         report.nodes ? 100.0 * ( report.nodes - report.remaining ) / report.nodes : 0.0, report.ms );
+        }
+        if ( !linkStatus.empty() )
+            ImGui::TextColored( ImVec4( 1.0f, 0.4f, 0.4f, 1.0f ), "%s", linkStatus.c_str() );
+        const size_t lookups = memo.Hits() + memo.Misses();
+        ImGui::Text( "Cache: %d hits, %d misses (%.0f%%), %d entries, %.1f / %.0f MB, %d evicted", (int)memo.Hits(),
+                     (int)memo.Misses(), lookups ? 100.0 * memo.Hits() / lookups : 0.0, (int)memo.EntryCount(),
+                     memo.Bytes() / ( 1024.0 * 1024.0 ), memo.Capacity() / ( 1024.0 * 1024.0 ), (int)memo.Evictions() );
+        ImGui::SameLine();
+        if ( ImGui::SmallButton( "Clear cache" ) ) {
+            memo.Clear();
+            memo.ResetStats();
+        }
+
+        // 分块流式执行：未连接的标量输入生成测试数据流，列输入按块切分。流水线在图的副本上运行，不影响编辑
+        if ( stream.Running() ) {
+            stream.Sample();
+            if ( ImGui::Button( "Stop stream" ) )
+                stream.Stop();
+        }
+        else if ( ImGui::Button( "Stream" ) ) {
+            const size_t rows = (size_t)streamMillionRows * 1000000;
+            std::unordered_map<int, StreamPipeline::Reader> readers;
+            for ( const auto& node : nodeitor.nodes ) {
+                for ( const Pin& pin : node->pins ) {
+                    if ( pin.ptype == PinType::Input && !pin.isLinked && pin.As<float>() )
+                        readers[ pin.pid ] = RampReader( rows, pin.Number() );
+                }
+            }
+            streamStatus.clear();
+            if ( !stream.Start( nodeitor, readers, {}, &streamStatus ) )
+                streamStatus = "Cannot stream: " + streamStatus;
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth( 100.0f );
+        if ( ImGui::InputInt( "M rows", &streamMillionRows ) )
+            streamMillionRows = std::max( streamMillionRows, 1 );
+        ImGui::SameLine();
+        if ( !streamStatus.empty() ) {
+            ImGui::TextColored( ImVec4( 1.0f, 0.4f, 0.4f, 1.0f ), "%s", streamStatus.c_str() );
+        }
+        else if ( stream.ThreadCount() ) {
+            const double seconds = stream.Seconds();
+            ImGui::Text( "%.1f M rows in %.2f s (%.1f M rows/s), %d threads, at most %.1f MB in flight", stream.Rows() / 1e6,
+                         seconds, seconds > 0.0 ? stream.Rows() / seconds / 1e6 : 0.0, (int)stream.ThreadCount(),
+                         stream.MemoryBound() / ( 1024.0 * 1024.0 ) );
         }
 
+        // 流式执行时连线颜色表示队列占用：空为绿色，满（下游处理不过来，上游被反压）为红色
+        std::unordered_map<int, ImU32> linkColors;
+        if ( stream.Running() ) {
+            for ( const auto& link : stream.Links() ) {
+                const float fill = (float)link->depth.load( std::memory_order_relaxed ) / (float)link->capacity;
+                linkColors[ link->linkId ] = IM_COL32( 80 + (int)( 175 * fill ), 200 - (int)( 140 * fill ), 80, 255 );
+            }
+        }
+
+        ImNodes::BeginNodeEditor();
+
+        // 节点与链接的绘制与无界面的缩略图工具共用
+        std::vector<NodeBase*> edited;
+        DrawGraph( nodeitor, &edited, stream.Running() ? &linkColors : nullptr );
+
         ImNodes::MiniMap();
         ImNodes::EndNodeEditor();
 
+        // 连线中点标出吞吐量与队列深度，悬停时显示详细统计。流水线启动后删除的连线与节点不再标出
+        if ( stream.Running() ) {
+            std::unordered_set<int> nodeIds, linkIds;
+            for ( const auto& node : nodeitor.nodes )
+                nodeIds.insert( node->node_id );
+            for ( const Link& link : nodeitor.links )
+                linkIds.insert( link.id );
+            ImDrawList* drawList = ImGui::GetWindowDrawList();
+            drawList->PushClipRect( ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), true );
+            for ( const auto& link : stream.Links() ) {
+                if ( !linkIds.count( link->linkId ) || !nodeIds.count( link->fromNode ) || !nodeIds.count( link->toNode ) )
+                    continue;
+                const ImVec2 from = ImNodes::GetNodeScreenSpacePos( link->fromNode );
+                const ImVec2 fromSize = ImNodes::GetNodeDimensions( link->fromNode );
+                const ImVec2 to = ImNodes::GetNodeScreenSpacePos( link->toNode );
+                const ImVec2 toSize = ImNodes::GetNodeDimensions( link->toNode );
+                char label[ 64 ];
+                snprintf( label, sizeof( label ), "%.1f M/s %u/%u", link->rowsPerSecond / 1e6,
+                          link->depth.load( std::memory_order_relaxed ), link->capacity );
+                const ImVec2 size = ImGui::CalcTextSize( label );
+                const ImVec2 mid( ( from.x + fromSize.x + to.x - size.x ) * 0.5f,
+                                  ( from.y + fromSize.y * 0.5f + to.y + toSize.y * 0.5f - size.y ) * 0.5f );
+                drawList->AddRectFilled( ImVec2( mid.x - 2.0f, mid.y - 1.0f ), ImVec2( mid.x + size.x + 2.0f, mid.y + size.y + 1.0f ),
+                                         IM_COL32( 20, 20, 20, 200 ), 3.0f );
+                drawList->AddText( mid, IM_COL32_WHITE, label );
+            }
+            drawList->PopClipRect();
+        }
+        int hoveredLink;
+        if ( ImNodes::IsLinkHovered( &hoveredLink ) ) {
+            if ( const StreamPipeline::LinkStats* link = stream.FindLink( hoveredLink ) ) {
+                ImGui::SetTooltip( "%.2f M rows in %d chunks, %.1f M rows/s\nqueue %u / %u chunks, %d back-pressure stalls",
+                                   link->rows.load() / 1e6, (int)link->chunks.load(), link->rowsPerSecond / 1e6,
+                                   link->depth.load(), link->capacity, (int)link->stalls.load() );
+            }
+        }
+
         // AfterRender
         for ( size_t i = 0; i < nodeitor.nodes.size(); i++ ) {
             auto& node = nodeitor.nodes[ i ];
             node->AfterRender();
         }
 
+        // 编辑操作记入历史：拖动已由 ImNodes 完成，只记录移动的节点与位移
+        ImVec2 delta;
+        if ( ImNodes::IsNodeDragFinished( &delta ) ) {
+            std::vector<int> ids( ImNodes::NumDraggedNodes() );
+            ImNodes::GetDraggedNodes( ids.data() );
+            nodeitor.history.Record( MakeMoveNodesCommand( std::move( ids ), delta ) );
+        }
+
+        // 值类型在连线时检查一次，不兼容或会形成环的连线不创建；形成环时选中环上的节点
         int start_attr, end_attr;
         if ( ImNodes::IsLinkCreated( &start_attr, &end_attr ) ) {
-            nodeitor.links.emplace_back( UniqueId::get_id(), start_attr, end_attr );
+            const Pin* start = FindPin( nodeitor, start_attr );
+            const Pin* end = FindPin( nodeitor, end_attr );
+            std::vector<int> cycle;
+            topology.Sync( nodeitor );
+            if ( start && end && !CanLink( *start, *end ) && !CanLink( *end, *start ) ) {
+                linkStatus = "Cannot link " + start->pname + " to " + end->pname + ": value types do not match";
+            }
+            else if ( !topology.AddLink( start_attr, end_attr, &cycle ) ) {
+                linkStatus = "Cannot link: the link would close a cycle through " + std::to_string( cycle.size() ) + " nodes";
+                ImNodes::ClearNodeSelection();
+                for ( const int id : cycle )
+                    ImNodes::SelectNode( id );
+            }
+            else {
+                nodeitor.history.Execute( nodeitor, MakeAddLinkCommand( UniqueId::get_id(), start_attr, end_attr ) );
+                topology.MarkSynced( nodeitor.revision );
+                linkStatus.clear();
+            }
             // ImNodes::IsPinHovered
         }
 
+        int link_id;
+        if ( ImNodes::IsLinkDestroyed( &link_id ) ) {
+            topology.Sync( nodeitor );
+            for ( const Link& link : nodeitor.links ) {
+                if ( link.id == link_id )
+                    topology.RemoveLink( link.start_attr, link.end_attr );
+            }
+            nodeitor.history.Execute( nodeitor, MakeRemoveLinkCommand( link_id ) );
+            topology.MarkSynced( nodeitor.revision );
+        }
+
+        // 右键菜单添加节点
+        if ( ImNodes::IsEditorHovered() && ImGui::IsMouseReleased( ImGuiMouseButton_Right ) )
+            ImGui::OpenPopup( "Add Node" );
+        if ( ImGui::BeginPopup( "Add Node" ) ) {
+            std::shared_ptr<NodeBase> node;
+            if ( ImGui::MenuItem( "Add" ) )
+                node = MakeNode( NodeKind::Add );
+            if ( ImGui::MenuItem( "Sub" ) )
+                node = MakeNode( NodeKind::Sub );
+            if ( node ) {
+                ImNodes::SetNodeScreenSpacePos( node->node_id, ImGui::GetMousePosOnOpeningCurrentPopup() );
+                const ImVec2 pos = ImNodes::GetNodeGridSpacePos( node->node_id );
+                topology.Sync( nodeitor );
+                nodeitor.history.Execute( nodeitor, MakeAddNodeCommand( node, pos ) );
+                topology.AddNode( *node );
+                topology.MarkSynced( nodeitor.revision );
+            }
+            ImGui::EndPopup();
+        }
+
+        // 本帧的全部修改（输入值、连线、节点）交给后台求值
+        evaluator.Submit( nodeitor, edited );
+
         ImGui::End();
     }
-}
 
-void MyApplication::DrawNodes() const {
-    for ( size_t i = 0; i < nodeitor.nodes.size(); i++ ) {
-        auto& node = nodeitor.nodes[ i ];
-        node->Render();
-    }
+    benchmark.Draw();
+    graphImport.Draw( nodeitor );
+    tiledLayout.Draw();
 }
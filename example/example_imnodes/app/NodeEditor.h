@@ -1,34 +1,17 @@
 ﻿#pragma once
 #include <memory>
 
+#include "AsyncEvaluator.h"
+#include "Benchmark.h"
+#include "Editor.h"
+#include "GraphImport.h"
 #include "ImGuiApp.h"
+#include "Snapshot.h"
+#include "StreamPipeline.h"
+#include "TiledLayout.h"
+#include "TopologicalOrder.h"
 // #include "imnodes.h"
 
-#include "node.h"
-
-struct Link {
-    int id;
-    int start_attr, end_attr;
-
-    Link() = default;
-    Link( const int i, const int s, const int e )
-        : id( i )
-        , start_attr( s )
-        , end_attr( e ) {}
-};
-
-struct Editor {
-    ImNodesEditorContext* context = nullptr;
-    std::vector<std::shared_ptr<NodeBase>> nodes;
-    std::vector<Link> links;
-    int current_id = 0;
-
-    ~Editor() {
-        if ( context )
-            ImNodes::EditorContextFree( context );
-    }
-};
-
 // 定义一个具体的应用程序类，继承自 ImGuiApp
 class MyApplication : public ImGuiApp {
 public:
@@ -50,16 +33,44 @@ public:
         ImNodesStyle& style = ImNodes::GetStyle();
         style.PinCircleRadius = 6.0f;
         style.NodePadding = ImVec2(22.0f, 8.0f);
+
+        // 小地图内容变化时才渲染到离屏纹理，其余帧只绘制该纹理
+        io.MiniMapTexture.RenderCallback = []( ImDrawData* drawData, ImU32 clearColor, void* userData ) {
+            MyApplication* app = static_cast<MyApplication*>( userData );
+            return app->RenderToTexture( app->miniMapTarget, drawData, clearColor );
+        };
+        io.MiniMapTexture.UserData = this;
     }
     ~MyApplication() {
+        ImNodes::GetIO().MiniMapTexture.RenderCallback = nullptr;
+        DestroyOffscreenTarget( miniMapTarget );
         ImNodes::PopAttributeFlag();
     }
 
 protected:
     void OnFrame() override;
 
-    void DrawNodes() const;
-
 private:
     Editor nodeitor;
+    MemoCache memo;
+    AsyncEvaluator evaluator{ &memo };
+    // 连线前检查是否形成环；增删连线与节点时增量更新，其他修改后在下次连线时重建
+    TopologicalOrder topology;
+    // 勾选单线程时逐节点求值，便于调试
+    bool singleThread = false;
+    // 求值前折叠常量、合并重复的节点，编辑的仍是原图
+    bool optimize = false;
+    // 分块流式执行当前图的副本，连线上显示吞吐量与队列占用
+    StreamPipeline stream;
+    int streamMillionRows = 100;
+    std::string streamStatus;
+    BenchmarkPanel benchmark;
+    GraphImportPanel graphImport;
+    TiledLayoutPanel tiledLayout;
+    OffscreenTarget miniMapTarget;
+
+    static constexpr const char* SnapshotPath = "editor.snapshot";
+    std::string snapshotStatus;
+    // 最近一次被拒绝的连线
+    std::string linkStatus;
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <cstdint>
+#include <utility>
+#include <variant>
+
+#include "Column.h"
+
+struct Vec4 {
+    float x, y, z, w;
+};
+
+// 引脚值的类型，与 PinValue 中 variant 的序号一致
+enum class ValueType : uint8_t { None = 0, Float, Vec4, Column, Fused, Count };
+
+// 引脚接受或产生的类型集合，每个类型一位
+using ValueTypes = uint8_t;
+constexpr ValueTypes TypeBit( const ValueType type ) {
+    return (ValueTypes)( 1u << (int)type );
+}
+// 数值：标量或一列数值，Add / Sub 等逐元素节点的引脚
+constexpr ValueTypes NumberTypes = TypeBit( ValueType::Float ) | TypeBit( ValueType::Column );
+
+const char* ValueTypeName( ValueType type );
+
+// 引脚值：封闭的带标签联合。标量与向量直接存放在对象内，不分配内存；
+// 大数组为引用计数、创建后不再修改的 Column，复制时只增加引用计数。按类型读取只比较标签，不需要 RTTI
+class PinValue {
+public:
+    PinValue() = default;
+    PinValue( const float number )
+        : _value( number ) {}
+    PinValue( const Vec4& vector )
+        : _value( vector ) {}
+    PinValue( ColumnPtr column )
+        : _value( std::move( column ) ) {}
+    PinValue( const FusedValue fused )
+        : _value( fused ) {}
+
+    ValueType Type() const { return (ValueType)_value.index(); }
+
+    // 按类型读取，类型不符时返回 nullptr
+    template <typename T>
+    const T* As() const {
+        return std::get_if<T>( &_value );
+    }
+    template <typename T>
+    T* As() {
+        return std::get_if<T>( &_value );
+    }
+
+private:
+    using Storage = std::variant<std::monostate, float, Vec4, ColumnPtr, FusedValue>;
+    static_assert( std::variant_size_v<Storage> == (size_t)ValueType::Count );
+
+    Storage _value;
+};
@@ -0,0 +1,261 @@
+﻿#include "imnodes_internal.h"
+
+#include "Snapshot.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+
+namespace {
+
+constexpr char SnapshotMagic[ 4 ] = { 'E', 'D', 'S', 'N' };
+constexpr uint32_t SnapshotVersion = 2;
+
+struct SnapshotHeader {
+    char magic[ 4 ];
+    uint32_t version;
+    uint32_t headerSize;
+    int32_t nextId;     // UniqueId 计数器
+    int32_t currentId;  // Editor::current_id
+    uint32_t nodeCount;
+    uint32_t pinCount;
+    uint32_t linkCount;
+    uint32_t layoutSize;  // ImNodes 二进制状态的字节数
+    uint32_t reserved;
+};
+
+struct SnapshotNode {
+    int32_t id;
+    uint8_t kind;
+    uint8_t titlePos;
+    uint8_t pinCount;
+    uint8_t reserved;
+};
+
+struct SnapshotPin {
+    int32_t id;
+    uint8_t linked;
+    uint8_t reserved[ 3 ];
+    float value;  // 引脚值，不是数值时为 0
+};
+
+struct SnapshotLink {
+    int32_t id;
+    int32_t startAttr;
+    int32_t endAttr;
+};
+
+static_assert( sizeof( SnapshotHeader ) == 40 && sizeof( SnapshotNode ) == 8 && sizeof( SnapshotPin ) == 12 &&
+                   sizeof( SnapshotLink ) == 12,
+               "snapshot records must not contain padding" );
+
+// 各段在文件中的偏移，ImNodes 状态按 8 字节对齐
+struct SnapshotLayout {
+    uint64_t nodes, pins, links, layout, total;
+
+    explicit SnapshotLayout( const SnapshotHeader& h ) {
+        nodes = sizeof( SnapshotHeader );
+        pins = nodes + (uint64_t)h.nodeCount * sizeof( SnapshotNode );
+        links = pins + (uint64_t)h.pinCount * sizeof( SnapshotPin );
+        layout = ( links + (uint64_t)h.linkCount * sizeof( SnapshotLink ) + 7 ) & ~uint64_t( 7 );
+        total = layout + h.layoutSize;
+    }
+};
+
+// 快照恢复出的全部节点。editor.nodes 中的 shared_ptr 都共用这一个对象的引用计数，
+// 引脚数组从 pins 中顺序分配
+struct NodeArena {
+    explicit NodeArena( const size_t pinBytes )
+        : pins( pinBytes ) {}
+
+    std::pmr::monotonic_buffer_resource pins;
+    std::vector<AddNode> adds;
+    std::vector<SubNode> subs;
+};
+
+// 先写入 path.tmp 再替换 path，写到一半失败或崩溃时原文件保持完整
+bool WriteFile( const std::string& path, const char* data, const size_t size, std::string& error ) {
+    const std::string tempPath = path + ".tmp";
+    FILE* file = ImFileOpen( tempPath.c_str(), "wb" );
+    if ( !file ) {
+        error = "cannot open " + tempPath;
+        return false;
+    }
+    bool written = fwrite( data, 1, size, file ) == size && fflush( file ) == 0;
+    written = fclose( file ) == 0 && written;
+    std::error_code ec;
+    if ( !written ) {
+        std::filesystem::remove( tempPath, ec );
+        error = "cannot write " + tempPath;
+        return false;
+    }
+    std::filesystem::rename( tempPath, path, ec );
+    if ( ec ) {
+        std::filesystem::remove( tempPath, ec );
+        error = "cannot replace " + path;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool SaveSnapshot( const Editor& editor, const std::string& path, std::string& error ) {
+    SnapshotHeader header = {};
+    memcpy( header.magic, SnapshotMagic, sizeof( header.magic ) );
+    header.version = SnapshotVersion;
+    header.headerSize = sizeof( SnapshotHeader );
+    header.nextId = UniqueId::peek_id();
+    header.currentId = editor.current_id;
+    header.nodeCount = (uint32_t)editor.nodes.size();
+    header.linkCount = (uint32_t)editor.links.size();
+    for ( const auto& node : editor.nodes ) {
+        if ( node->kind == NodeKind::Count ) {
+            error = "node " + std::to_string( node->node_id ) + " has no snapshot type";
+            return false;
+        }
+        header.pinCount += (uint32_t)node->pins.size();
+    }
+
+    // 返回的指针在下次调用前有效
+    size_t layoutSize = 0;
+    const void* layout = ImNodes::SaveEditorStateToBinaryMemory( editor.context, &layoutSize );
+    header.layoutSize = (uint32_t)layoutSize;
+
+    const SnapshotLayout offsets( header );
+    std::unique_ptr<char[]> data( new char[ offsets.total ]() );
+    memcpy( data.get(), &header, sizeof( header ) );
+    SnapshotNode* nodes = (SnapshotNode*)( data.get() + offsets.nodes );
+    SnapshotPin* pins = (SnapshotPin*)( data.get() + offsets.pins );
+    for ( const auto& node : editor.nodes ) {
+        nodes->id = node->node_id;
+        nodes->kind = (uint8_t)node->kind;
+        nodes->titlePos = (uint8_t)node->title_pos;
+        nodes->pinCount = (uint8_t)node->pins.size();
+        ++nodes;
+        for ( const Pin& pin : node->pins ) {
+            pins->id = pin.pid;
+            pins->linked = pin.isLinked ? 1 : 0;
+            pins->value = pin.Number();
+            ++pins;
+        }
+    }
+    SnapshotLink* links = (SnapshotLink*)( data.get() + offsets.links );
+    for ( const Link& link : editor.links )
+        *links++ = SnapshotLink{ link.id, link.start_attr, link.end_attr };
+    memcpy( data.get() + offsets.layout, layout, layoutSize );
+
+    return WriteFile( path, data.get(), (size_t)offsets.total, error );
+}
+
+bool LoadSnapshot( Editor& editor, const std::string& path, std::string& error ) {
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size( path, ec );
+    FILE* file = ec ? nullptr : ImFileOpen( path.c_str(), "rb" );
+    if ( !file ) {
+        error = "cannot open " + path;
+        return false;
+    }
+    // 整个文件一次读入
+    std::unique_ptr<char[]> data( new char[ size ] );
+    const bool read = fread( data.get(), 1, size, file ) == size;
+    fclose( file );
+    if ( !read ) {
+        error = "cannot read " + path;
+        return false;
+    }
+
+    SnapshotHeader header;
+    if ( size < sizeof( header ) ) {
+        error = "not a snapshot file";
+        return false;
+    }
+    memcpy( &header, data.get(), sizeof( header ) );
+    if ( memcmp( header.magic, SnapshotMagic, sizeof( header.magic ) ) != 0 || header.headerSize != sizeof( header ) ) {
+        error = "not a snapshot file";
+        return false;
+    }
+    if ( header.version != SnapshotVersion ) {
+        error = "unsupported snapshot version " + std::to_string( header.version );
+        return false;
+    }
+    const SnapshotLayout offsets( header );
+    if ( offsets.total != size ) {
+        error = "truncated or corrupt snapshot";
+        return false;
+    }
+
+    // 记录按 4 字节对齐，可以直接在读入的内存中访问
+    const SnapshotNode* nodes = (const SnapshotNode*)( data.get() + offsets.nodes );
+    const SnapshotPin* pins = (const SnapshotPin*)( data.get() + offsets.pins );
+    const SnapshotLink* links = (const SnapshotLink*)( data.get() + offsets.links );
+
+    size_t counts[ (int)NodeKind::Count ] = {};
+    uint64_t pinTotal = 0;
+    for ( uint32_t i = 0; i < header.nodeCount; ++i ) {
+        if ( nodes[ i ].kind >= (uint8_t)NodeKind::Count || nodes[ i ].titlePos > (uint8_t)NodeBase::TitlePos::None ) {
+            error = "unknown node type in snapshot";
+            return false;
+        }
+        ++counts[ nodes[ i ].kind ];
+        pinTotal += nodes[ i ].pinCount;
+    }
+    if ( pinTotal != header.pinCount ) {
+        error = "truncated or corrupt snapshot";
+        return false;
+    }
+
+    // 所有节点放在两个预留好容量的数组中，引脚数组从同一块缓冲区顺序分配
+    auto arena = std::make_shared<NodeArena>( header.pinCount * sizeof( Pin ) + header.nodeCount * alignof( Pin ) );
+    arena->adds.reserve( counts[ (int)NodeKind::Add ] );
+    arena->subs.reserve( counts[ (int)NodeKind::Sub ] );
+    std::vector<std::shared_ptr<NodeBase>> restored;
+    restored.reserve( header.nodeCount );
+    for ( uint32_t i = 0; i < header.nodeCount; ++i, ++nodes ) {
+        NodeBase* node = nullptr;
+        if ( nodes->kind == (uint8_t)NodeKind::Add )
+            node = &arena->adds.emplace_back( nodes->id, &arena->pins );
+        else
+            node = &arena->subs.emplace_back( nodes->id, &arena->pins );
+        if ( node->pins.size() != nodes->pinCount ) {
+            error = "pin count does not match node type in snapshot";
+            return false;
+        }
+        node->title_pos = (NodeBase::TitlePos)nodes->titlePos;
+        for ( Pin& pin : node->pins ) {
+            pin.pid = pins->id;
+            pin.isLinked = pins->linked != 0;
+            pin.Set( pins->value );
+            ++pins;
+        }
+        // 与 arena 共用引用计数，不额外分配控制块
+        restored.emplace_back( arena, node );
+    }
+
+    ImNodesEditorContext* context = ImNodes::EditorContextCreate();
+    if ( !ImNodes::LoadEditorStateFromBinaryMemory( context, data.get() + offsets.layout, header.layoutSize ) ) {
+        ImNodes::EditorContextFree( context );
+        error = "corrupt layout in snapshot";
+        return false;
+    }
+
+    // 全部校验通过后才替换 editor 的内容
+    ImNodesEditorContext* current = &ImNodes::EditorContextGet();
+    if ( current == editor.context )
+        ImNodes::EditorContextSet( context );
+    if ( editor.context )
+        ImNodes::EditorContextFree( editor.context );
+    editor.context = context;
+    editor.nodes = std::move( restored );
+    editor.links.clear();
+    editor.links.reserve( header.linkCount );
+    for ( uint32_t i = 0; i < header.linkCount; ++i, ++links )
+        editor.links.emplace_back( links->id, links->startAttr, links->endAttr );
+    editor.current_id = header.currentId;
+    ++editor.revision;
+    editor.history.Clear();
+    UniqueId::advance_to( header.nextId );
+    return true;
+}
@@ -0,0 +1,14 @@
+﻿#pragma once
+#include <string>
+
+#include "Editor.h"
+
+// 编辑器模型的二进制快照：节点类型与引脚、连线、UniqueId 计数器以及 ImNodes 布局（平移量与节点位置）。
+// 文件布局为 头 | 节点表 | 引脚表 | 连线表 | ImNodes 二进制状态，各表均为定长记录。
+// 加载时整个文件一次读入，节点与引脚从同一块内存中创建，不会为每个节点单独分配内存。
+// 这些节点在全部被移除之前共同占用这块内存
+
+// 先写入临时文件再替换 path，失败时原文件不变。失败时返回 false，error 为错误描述
+bool SaveSnapshot( const Editor& editor, const std::string& path, std::string& error );
+// 用快照替换 editor 的节点、连线与布局，并清空撤销历史。失败时 editor 不变
+bool LoadSnapshot( Editor& editor, const std::string& path, std::string& error );
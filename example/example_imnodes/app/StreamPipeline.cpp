@@ -0,0 +1,320 @@
+﻿#include "StreamPipeline.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 列中全部元素按顺序累加
+double SumColumn( const Column& column ) {
+    double sum = 0.0;
+    const size_t size = column.Size();
+    switch ( column.Type() ) {
+    case ColumnType::Int: {
+        const int32_t* data = (const int32_t*)column.Data();
+        for ( size_t i = 0; i < size; ++i )
+            sum += data[ i ];
+        break;
+    }
+    case ColumnType::Float: {
+        const float* data = (const float*)column.Data();
+        for ( size_t i = 0; i < size; ++i )
+            sum += data[ i ];
+        break;
+    }
+    case ColumnType::Double: {
+        const double* data = (const double*)column.Data();
+        for ( size_t i = 0; i < size; ++i )
+            sum += data[ i ];
+        break;
+    }
+    }
+    return sum;
+}
+
+}  // namespace
+
+StreamPipeline::Reader SliceReader( ColumnPtr column ) {
+    return [ column = std::move( column ) ]( const size_t row, const size_t rows ) -> ColumnPtr {
+        if ( !column || row >= column->Size() )
+            return nullptr;
+        const size_t count = std::min( rows, column->Size() - row );
+        const size_t width = ColumnTypeSize( column->Type() );
+        auto chunk = std::make_shared<Column>( column->Type(), count );
+        memcpy( chunk->Data(), (const char*)column->Data() + row * width, count * width );
+        return chunk;
+    };
+}
+
+bool StreamPipeline::ChunkQueue::Push( ColumnPtr chunk ) {
+    std::unique_lock<std::mutex> lock( _mutex );
+    if ( !_closed && _chunks.size() >= _stats.capacity ) {
+        _stats.stalls.fetch_add( 1, std::memory_order_relaxed );
+        _notFull.wait( lock, [ this ] { return _closed || _chunks.size() < _stats.capacity; } );
+    }
+    if ( _closed )
+        return false;
+    if ( chunk ) {
+        _stats.chunks.fetch_add( 1, std::memory_order_relaxed );
+        _stats.rows.fetch_add( chunk->Size(), std::memory_order_relaxed );
+    }
+    _chunks.push_back( std::move( chunk ) );
+    _stats.depth.store( (uint32_t)_chunks.size(), std::memory_order_relaxed );
+    lock.unlock();
+    _notEmpty.notify_one();
+    return true;
+}
+
+bool StreamPipeline::ChunkQueue::Pop( ColumnPtr& chunk ) {
+    std::unique_lock<std::mutex> lock( _mutex );
+    _notEmpty.wait( lock, [ this ] { return _closed || !_chunks.empty(); } );
+    if ( _closed )
+        return false;
+    chunk = std::move( _chunks.front() );
+    _chunks.pop_front();
+    _stats.depth.store( (uint32_t)_chunks.size(), std::memory_order_relaxed );
+    lock.unlock();
+    _notFull.notify_one();
+    return true;
+}
+
+void StreamPipeline::ChunkQueue::Close() {
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _closed = true;
+        _chunks.clear();
+        _stats.depth.store( 0, std::memory_order_relaxed );
+    }
+    _notFull.notify_all();
+    _notEmpty.notify_all();
+}
+
+StreamPipeline::~StreamPipeline() {
+    Stop();
+}
+
+bool StreamPipeline::Start( const Editor& editor, const std::unordered_map<int, Reader>& readers, const Options& options,
+                            std::string* error ) {
+    Stop();
+    _stages.clear();
+    _queues.clear();
+    _links.clear();
+    _sinks.clear();
+    _linkIndices.clear();
+    _options = options;
+    _options.chunkRows = std::max<size_t>( _options.chunkRows, 1 );
+    _options.queueChunks = std::max<size_t>( _options.queueChunks, 1 );
+    _stop.store( false, std::memory_order_relaxed );
+    _seconds.store( 0.0, std::memory_order_relaxed );
+    auto fail = [ error ]( const char* message ) {
+        if ( error )
+            *error = message;
+        return false;
+    };
+
+    // 复制节点，节点线程只使用副本；副本与 editor.nodes 的下标相同
+    const size_t nodeCount = editor.nodes.size();
+    std::vector<std::shared_ptr<NodeBase>> nodes;
+    nodes.reserve( nodeCount );
+    for ( const auto& node : editor.nodes )
+        nodes.push_back( CloneNode( *node ) );
+
+    // 与求值器相同，同一个输入有多条连线时取最后一条
+    const std::vector<ResolvedLink> edges = ResolveLinks( editor );
+    std::unordered_map<int, size_t> inputEdge;
+    for ( size_t e = 0; e < edges.size(); ++e )
+        inputEdge[ nodes[ edges[ e ].toNode ]->pins[ edges[ e ].toPin ].pid ] = e;
+
+    const std::vector<uint32_t> order = TopologicalSort( nodeCount, edges );
+    if ( order.size() != nodeCount )
+        return fail( "the graph contains a cycle" );
+
+    // 按拓扑顺序区分流式节点：有输入来自读取器、未连接的列或上游的流式节点。
+    // 其余节点在这里计算一次，输出作为常量写入下游的输入
+    std::vector<int32_t> stageOf( nodeCount, -1 );
+    for ( const uint32_t i : order ) {
+        NodeBase& node = *nodes[ i ];
+        auto stage = std::make_unique<Stage>();
+        for ( uint32_t p = 0; p < node.pins.size(); ++p ) {
+            Pin& pin = node.pins[ p ];
+            if ( pin.ptype != PinType::Input )
+                continue;
+            const auto e = inputEdge.find( pin.pid );
+            if ( e != inputEdge.end() ) {
+                const ResolvedLink& edge = edges[ e->second ];
+                if ( stageOf[ edge.fromNode ] >= 0 )
+                    stage->inputs.push_back( Stage::Input{ p, nullptr, nullptr, e->second } );
+                else
+                    pin.Assign( nodes[ edge.fromNode ]->pins[ edge.fromPin ].value );
+            }
+            else if ( const auto r = readers.find( pin.pid ); r != readers.end() )
+                stage->inputs.push_back( Stage::Input{ p, nullptr, r->second, 0 } );
+            else if ( const ColumnPtr* column = pin.As<ColumnPtr>() )
+                stage->inputs.push_back( Stage::Input{ p, nullptr, SliceReader( *column ), 0 } );
+        }
+        if ( stage->inputs.empty() ) {
+            node.Compute();
+            continue;
+        }
+        stageOf[ i ] = (int32_t)_stages.size();
+        stage->node = nodes[ i ];
+        for ( uint32_t p = 0; p < node.pins.size(); ++p ) {
+            if ( node.pins[ p ].ptype == PinType::Output )
+                stage->outputs.push_back( Stage::Output{ p, {}, nullptr } );
+        }
+        _stages.push_back( std::move( stage ) );
+    }
+    if ( _stages.empty() )
+        return fail( "no input is a column or has a stream reader" );
+    if ( _stages.size() > MaxThreads )
+        return fail( "too many streaming nodes: each one needs a thread" );
+
+    // 流式节点之间的每条连线一个有界队列，上游的一个输出可以连到多个下游
+    std::vector<ChunkQueue*> edgeQueues( edges.size(), nullptr );
+    for ( size_t e = 0; e < edges.size(); ++e ) {
+        const ResolvedLink& edge = edges[ e ];
+        if ( stageOf[ edge.fromNode ] < 0 || inputEdge[ nodes[ edge.toNode ]->pins[ edge.toPin ].pid ] != e )
+            continue;
+        auto stats = std::make_unique<LinkStats>();
+        stats->linkId = edge.id;
+        stats->fromNode = nodes[ edge.fromNode ]->node_id;
+        stats->toNode = nodes[ edge.toNode ]->node_id;
+        stats->capacity = (uint32_t)_options.queueChunks;
+        _queues.push_back( std::make_unique<ChunkQueue>( *stats ) );
+        _linkIndices[ edge.id ] = _links.size();
+        _links.push_back( std::move( stats ) );
+        edgeQueues[ e ] = _queues.back().get();
+        for ( Stage::Output& output : _stages[ stageOf[ edge.fromNode ] ]->outputs ) {
+            if ( output.pin == edge.fromPin )
+                output.queues.push_back( edgeQueues[ e ] );
+        }
+    }
+    for ( auto& stage : _stages ) {
+        for ( Stage::Input& input : stage->inputs ) {
+            if ( !input.reader )
+                input.queue = edgeQueues[ input.edge ];
+        }
+        // 没有连接下游的输出是汇，只累计结果
+        for ( Stage::Output& output : stage->outputs ) {
+            if ( !output.queues.empty() )
+                continue;
+            _sinks.push_back( std::make_unique<SinkStats>() );
+            _sinks.back()->pinId = stage->node->pins[ output.pin ].pid;
+            output.sink = _sinks.back().get();
+        }
+    }
+
+    _begin = std::chrono::steady_clock::now();
+    _sampled = _begin;
+    _active.store( _stages.size(), std::memory_order_release );
+    _threads.reserve( _stages.size() );
+    for ( auto& stage : _stages )
+        _threads.emplace_back( [ this, s = stage.get() ] { Run( *s ); } );
+    return true;
+}
+
+void StreamPipeline::Run( Stage& stage ) {
+    NodeBase& node = *stage.node;
+    size_t row = 0;
+    while ( !_stop.load( std::memory_order_relaxed ) ) {
+        // 每个流式输入取一块；任意一个输入结束时整个节点结束
+        bool end = false;
+        for ( Stage::Input& input : stage.inputs ) {
+            ColumnPtr chunk;
+            if ( input.queue ) {
+                if ( !input.queue->Pop( chunk ) )
+                    chunk = nullptr;
+            }
+            else {
+                chunk = input.reader( row, _options.chunkRows );
+            }
+            if ( !chunk || chunk->Size() == 0 ) {
+                end = true;
+                break;
+            }
+            node.pins[ input.pin ].Assign( std::move( chunk ) );
+        }
+        if ( end )
+            break;
+        node.Compute();
+
+        size_t rows = 0;
+        for ( Stage::Output& output : stage.outputs ) {
+            const ColumnPtr* result = node.pins[ output.pin ].As<ColumnPtr>();
+            if ( !result || !*result )
+                continue;
+            rows = std::max( rows, ( *result )->Size() );
+            if ( output.sink ) {
+                output.sink->sum.store( output.sink->sum.load( std::memory_order_relaxed ) + SumColumn( **result ),
+                                        std::memory_order_relaxed );
+                output.sink->rows.fetch_add( ( *result )->Size(), std::memory_order_relaxed );
+            }
+            // 下游已经结束的队列不再写入
+            auto& queues = output.queues;
+            const auto closed = [ & ]( ChunkQueue* queue ) { return !queue->Push( *result ); };
+            queues.erase( std::remove_if( queues.begin(), queues.end(), closed ), queues.end() );
+        }
+        row += rows;
+    }
+
+    // 上游不必再为本节点生产；下游收到结束标记
+    for ( Stage::Input& input : stage.inputs ) {
+        if ( input.queue )
+            input.queue->Close();
+    }
+    for ( Stage::Output& output : stage.outputs ) {
+        for ( ChunkQueue* queue : output.queues )
+            queue->Push( nullptr );
+    }
+    if ( _active.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+        _seconds.store( std::chrono::duration<double>( std::chrono::steady_clock::now() - _begin ).count(),
+                        std::memory_order_release );
+}
+
+void StreamPipeline::Stop() {
+    _stop.store( true, std::memory_order_relaxed );
+    for ( auto& queue : _queues )
+        queue->Close();
+    for ( std::thread& thread : _threads )
+        thread.join();
+    _threads.clear();
+}
+
+double StreamPipeline::Seconds() const {
+    if ( Running() )
+        return std::chrono::duration<double>( std::chrono::steady_clock::now() - _begin ).count();
+    return _seconds.load( std::memory_order_acquire );
+}
+
+uint64_t StreamPipeline::Rows() const {
+    uint64_t rows = 0;
+    for ( const auto& sink : _sinks )
+        rows = std::max<uint64_t>( rows, sink->rows.load( std::memory_order_relaxed ) );
+    return rows;
+}
+
+size_t StreamPipeline::MemoryBound() const {
+    // 每个队列至多 queueChunks 块，每个节点的每个引脚至多再持有一块，按最宽的元素类型估计
+    size_t chunks = _links.size() * _options.queueChunks;
+    for ( const auto& stage : _stages )
+        chunks += stage->node->pins.size();
+    return chunks * _options.chunkRows * sizeof( double );
+}
+
+void StreamPipeline::Sample() {
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>( now - _sampled ).count();
+    if ( seconds < 0.25 )
+        return;
+    _sampled = now;
+    for ( auto& link : _links ) {
+        const uint64_t rows = link->rows.load( std::memory_order_relaxed );
+        link->rowsPerSecond = ( rows - link->sampledRows ) / seconds;
+        link->sampledRows = rows;
+    }
+}
+
+const StreamPipeline::LinkStats* StreamPipeline::FindLink( const int linkId ) const {
+    const auto found = _linkIndices.find( linkId );
+    return found == _linkIndices.end() ? nullptr : _links[ found->second ].get();
+}
@@ -0,0 +1,140 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Editor.h"
+
+// 分块流式执行：数据太大不能整列放进内存时，输入按固定行数切成块，每个节点一个线程，
+// 从上游连线的队列取块、计算、把结果块放入下游连线的队列。不同节点同时处理不同的块（流水线并行），
+// 队列有容量上限，下游处理不过来时上游在放入时阻塞，反压一直传到读取输入的节点，内存占用与数据总量无关。
+// 不依赖任何流式输入的节点只在开始时计算一次，结果作为常量。只支持逐块独立计算的节点（逐元素运算）
+class StreamPipeline {
+public:
+    // 读取输入从 row 开始的至多 rows 行；数据已读完时返回 nullptr 或空列
+    using Reader = std::function<ColumnPtr( size_t row, size_t rows )>;
+
+    struct Options {
+        size_t chunkRows = 64 * 1024;
+        // 每条连线的队列最多容纳的块数
+        size_t queueChunks = 4;
+    };
+
+    // 一条连线的统计。计数由节点线程更新，rowsPerSecond 由界面线程调用 Sample 更新
+    struct LinkStats {
+        int linkId = 0;
+        int fromNode = 0, toNode = 0;
+        uint32_t capacity = 0;
+        std::atomic<uint64_t> chunks = 0;
+        std::atomic<uint64_t> rows = 0;
+        std::atomic<uint32_t> depth = 0;
+        // 上游因队列已满而阻塞（反压）的次数
+        std::atomic<uint64_t> stalls = 0;
+        double rowsPerSecond = 0.0;
+        uint64_t sampledRows = 0;
+    };
+
+    // 没有连接下游的输出：累计行数与全部元素的和
+    struct SinkStats {
+        int pinId = 0;
+        std::atomic<uint64_t> rows = 0;
+        std::atomic<double> sum = 0.0;
+    };
+
+    StreamPipeline() = default;
+    ~StreamPipeline();
+
+    StreamPipeline( const StreamPipeline& ) = delete;
+    StreamPipeline& operator=( const StreamPipeline& ) = delete;
+
+    // 复制 editor 的节点与连线并启动节点线程，之后 editor 可以继续修改。readers 按输入引脚 id 指定流式输入；
+    // 不在 readers 中、没有连接的输入引脚值为列时按块切分，为标量时每块使用同一个值。
+    // 图中有环、没有流式输入或需要的线程过多时不启动，返回 false 并设置 error
+    bool Start( const Editor& editor, const std::unordered_map<int, Reader>& readers, const Options& options,
+                std::string* error = nullptr );
+    // 取消并等待全部节点线程结束。已经在 Start 之后结束的流水线只回收线程
+    void Stop();
+
+    bool Running() const { return _active.load( std::memory_order_acquire ) > 0; }
+    // 从开始到现在或到最后一个节点线程结束的时间
+    double Seconds() const;
+    // 汇已经收到的最多行数
+    uint64_t Rows() const;
+    size_t ThreadCount() const { return _stages.size(); }
+    // 队列中与节点正在处理的块占用内存的上限（字节），与数据总量无关
+    size_t MemoryBound() const;
+
+    // 在界面线程中调用，更新每条连线的吞吐量
+    void Sample();
+    const LinkStats* FindLink( int linkId ) const;
+    const std::vector<std::unique_ptr<LinkStats>>& Links() const { return _links; }
+    const std::vector<std::unique_ptr<SinkStats>>& Sinks() const { return _sinks; }
+
+    static constexpr size_t MaxThreads = 1024;
+
+private:
+    // 有界队列，块为列；值为空的块表示数据结束
+    class ChunkQueue {
+    public:
+        explicit ChunkQueue( LinkStats& stats )
+            : _stats( stats ) {}
+        // 队列已满时阻塞；下游已经停止读取时返回 false
+        bool Push( ColumnPtr chunk );
+        // 队列为空时阻塞；关闭后返回 false
+        bool Pop( ColumnPtr& chunk );
+        void Close();
+
+    private:
+        LinkStats& _stats;
+        std::mutex _mutex;
+        std::condition_variable _notFull, _notEmpty;
+        std::deque<ColumnPtr> _chunks;
+        bool _closed = false;
+    };
+
+    struct Stage {
+        std::shared_ptr<NodeBase> node;
+        // 来自上游的输入从 queue 读取，其余从 reader 读取
+        struct Input {
+            uint32_t pin;
+            ChunkQueue* queue;
+            Reader reader;
+            size_t edge;
+        };
+        struct Output {
+            uint32_t pin;
+            std::vector<ChunkQueue*> queues;
+            SinkStats* sink;
+        };
+        std::vector<Input> inputs;
+        std::vector<Output> outputs;
+    };
+
+    void Run( Stage& stage );
+
+    Options _options;
+    std::vector<std::unique_ptr<Stage>> _stages;
+    std::vector<std::unique_ptr<ChunkQueue>> _queues;
+    std::vector<std::unique_ptr<LinkStats>> _links;
+    std::vector<std::unique_ptr<SinkStats>> _sinks;
+    std::unordered_map<int, size_t> _linkIndices;
+    std::vector<std::thread> _threads;
+    std::atomic<bool> _stop = false;
+    std::atomic<size_t> _active = 0;
+    std::chrono::steady_clock::time_point _begin;
+    std::atomic<double> _seconds = 0.0;
+    std::chrono::steady_clock::time_point _sampled;
+};
+
+// 按块读取一列，最后一块可以不足 rows 行。列本身保持不变，多个读取器可以共用
+StreamPipeline::Reader SliceReader( ColumnPtr column );
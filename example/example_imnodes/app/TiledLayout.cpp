@@ -0,0 +1,349 @@
+﻿#include "TiledLayout.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <random>
+
+namespace {
+
+constexpr uint32_t TileFileMagic = 0x544e4d49;  // "IMNT"
+constexpr uint32_t TileFileVersion = 1;
+constexpr int NodesPerTileSide = 10;
+// 瓦片文件中节点 id 的起始值，避开 UniqueId 分配的 id
+constexpr int TiledNodeIdBase = 0x10000000;
+// 节点左上角在视口外、但节点仍可能可见的距离
+constexpr float NodeMargin = 300.0f;
+
+struct TileFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t tilesX, tilesY;
+    int64_t nodeCount;
+};
+
+double ElapsedMs( const std::chrono::steady_clock::time_point& start ) {
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+int64_t TileKey( const int tx, const int ty ) {
+    return ( (int64_t)ty << 32 ) | (uint32_t)tx;
+}
+
+int Seek( FILE* file, const uint64_t offset ) {
+#if defined( _WIN32 )
+    return _fseeki64( file, (int64_t)offset, SEEK_SET );
+#else
+    return fseeko( file, (off_t)offset, SEEK_SET );
+#endif
+}
+
+}  // namespace
+
+bool TileStore::Generate( const std::string& path, const int nodeCount ) {
+    constexpr int perTile = NodesPerTileSide * NodesPerTileSide;
+    const int tileCount = ( nodeCount + perTile - 1 ) / perTile;
+    const int tilesX = (int)std::ceil( std::sqrt( (double)tileCount ) );
+    const int tilesY = ( tileCount + tilesX - 1 ) / tilesX;
+
+    FILE* file = ImFileOpen( path.c_str(), "wb" );
+    if ( !file )
+        return false;
+
+    const TileFileHeader header{ TileFileMagic, TileFileVersion, tilesX, tilesY, nodeCount };
+    bool ok = fwrite( &header, sizeof( header ), 1, file ) == 1;
+
+    // 索引按行优先排列，节点记录紧随其后
+    std::vector<IndexEntry> index( (size_t)tilesX * tilesY );
+    uint64_t offset = sizeof( header ) + index.size() * sizeof( IndexEntry );
+    for ( size_t i = 0; i < index.size(); ++i ) {
+        const int64_t count = std::clamp<int64_t>( (int64_t)nodeCount - (int64_t)i * perTile, 0, perTile );
+        index[ i ] = IndexEntry{ offset, (uint32_t)count, 0 };
+        offset += count * sizeof( TiledNodeRecord );
+    }
+    ok = ok && fwrite( index.data(), sizeof( IndexEntry ), index.size(), file ) == index.size();
+
+    // 每个瓦片内的节点排成 10x10 网格并加少量抖动
+    std::mt19937 rng( 1234 );
+    std::uniform_real_distribution<float> jitter( 0.0f, 40.0f );
+    const float cell = TileSize / NodesPerTileSide;
+    std::vector<TiledNodeRecord> records;
+    for ( size_t i = 0; ok && i < index.size() && index[ i ].count > 0; ++i ) {
+        const float x0 = ( i % tilesX ) * TileSize;
+        const float y0 = ( i / tilesX ) * TileSize;
+        records.resize( index[ i ].count );
+        for ( uint32_t j = 0; j < index[ i ].count; ++j ) {
+            TiledNodeRecord& r = records[ j ];
+            r.id = TiledNodeIdBase + (int)( i * perTile + j ) * NodeBase::IdStride;
+            r.x = x0 + ( j % NodesPerTileSide ) * cell + jitter( rng );
+            r.y = y0 + ( j / NodesPerTileSide ) * cell + jitter( rng );
+            r.kind = (int32_t)( rng() % (unsigned)NodeKind::Count );
+        }
+        ok = fwrite( records.data(), sizeof( TiledNodeRecord ), records.size(), file ) == records.size();
+    }
+    ok = fclose( file ) == 0 && ok;
+    // 不完整的文件之后打开时会读到越界的记录，直接删除
+    if ( !ok ) {
+        std::error_code ec;
+        std::filesystem::remove( path, ec );
+    }
+    return ok;
+}
+
+bool TileStore::Open( const std::string& path ) {
+    if ( !Close() )
+        return false;
+    _file = ImFileOpen( path.c_str(), "r+b" );
+    if ( !_file )
+        return false;
+
+    TileFileHeader header;
+    if ( fread( &header, sizeof( header ), 1, _file ) != 1 || header.magic != TileFileMagic ||
+         header.version != TileFileVersion || header.tilesX <= 0 || header.tilesY <= 0 ) {
+        Close();
+        return false;
+    }
+
+    _index.resize( (size_t)header.tilesX * header.tilesY );
+    if ( fread( _index.data(), sizeof( IndexEntry ), _index.size(), _file ) != _index.size() ) {
+        Close();
+        return false;
+    }
+    _tilesX = header.tilesX;
+    _tilesY = header.tilesY;
+    _nodeCount = header.nodeCount;
+    _stats = Stats();
+    return true;
+}
+
+bool TileStore::Close() {
+    if ( !_file )
+        return true;
+    bool ok = true;
+    for ( Tile& tile : _resident ) {
+        if ( !tile.dirty )
+            continue;
+        if ( WriteTile( tile ) )
+            tile.dirty = false;
+        else
+            ok = false;
+    }
+    if ( !ok )
+        return false;
+    return Release();
+}
+
+bool TileStore::Release() {
+    if ( !_file )
+        return true;
+    _resident.clear();
+    _lookup.clear();
+    _index.clear();
+    _tilesX = _tilesY = 0;
+    _nodeCount = 0;
+    const bool ok = fclose( _file ) == 0;
+    _file = nullptr;
+    return ok;
+}
+
+void TileStore::Update( const ImRect& view ) {
+    if ( !_file )
+        return;
+
+    // 视口四周多保留一圈瓦片，平移时不必等待加载
+    const int tx0 = std::max( (int)std::floor( view.Min.x / TileSize ) - 1, 0 );
+    const int ty0 = std::max( (int)std::floor( view.Min.y / TileSize ) - 1, 0 );
+    const int tx1 = std::min( (int)std::floor( view.Max.x / TileSize ) + 1, _tilesX - 1 );
+    const int ty1 = std::min( (int)std::floor( view.Max.y / TileSize ) + 1, _tilesY - 1 );
+
+    size_t needed = 0;
+    for ( int ty = ty0; ty <= ty1; ++ty ) {
+        for ( int tx = tx0; tx <= tx1; ++tx ) {
+            const int64_t key = TileKey( tx, ty );
+            const auto it = _lookup.find( key );
+            if ( it != _lookup.end() ) {
+                _resident.splice( _resident.begin(), _resident, it->second );
+            }
+            else {
+                _resident.emplace_front();
+                if ( !LoadTile( tx, ty, _resident.front() ) ) {
+                    _resident.pop_front();
+                    continue;
+                }
+                _lookup[ key ] = _resident.begin();
+            }
+            ++needed;
+        }
+    }
+
+    const size_t capacity = std::max<size_t>( TileCapacity, needed );
+    while ( _resident.size() > capacity ) {
+        const Tile& tile = _resident.back();
+        // 写回失败时不淘汰，修改仍留在内存里，下一帧再试
+        if ( tile.dirty && !WriteTile( tile ) )
+            break;
+        _lookup.erase( TileKey( tile.tx, tile.ty ) );
+        _resident.pop_back();
+        ++_stats.tileEvictions;
+    }
+}
+
+ImRect TileStore::TileRect( const Tile& tile ) const {
+    const ImVec2 min( tile.tx * TileSize, tile.ty * TileSize );
+    return ImRect( min, ImVec2( min.x + TileSize, min.y + TileSize ) );
+}
+
+bool TileStore::LoadTile( const int tx, const int ty, Tile& tile ) {
+    const IndexEntry& entry = _index[ (size_t)ty * _tilesX + tx ];
+    tile.tx = tx;
+    tile.ty = ty;
+    tile.dirty = false;
+    tile.records.resize( entry.count );
+    if ( entry.count > 0 &&
+         ( Seek( _file, entry.offset ) != 0 ||
+           fread( tile.records.data(), sizeof( TiledNodeRecord ), entry.count, _file ) != entry.count ) ) {
+        ++_stats.loadErrors;
+        return false;
+    }
+    // 文件内容不可信，节点类型越界时整块瓦片视为损坏
+    for ( const TiledNodeRecord& record : tile.records ) {
+        if ( record.kind < 0 || record.kind >= (int32_t)NodeKind::Count ) {
+            ++_stats.loadErrors;
+            return false;
+        }
+    }
+
+    tile.nodes.resize( entry.count );
+    tile.submittedFrame.assign( entry.count, -1 );
+    for ( uint32_t i = 0; i < entry.count; ++i )
+        tile.nodes[ i ] = MakeNode( (NodeKind)tile.records[ i ].kind, tile.records[ i ].id );
+    ++_stats.tileLoads;
+    return true;
+}
+
+bool TileStore::WriteTile( const Tile& tile ) {
+    const IndexEntry& entry = _index[ (size_t)tile.ty * _tilesX + tile.tx ];
+    if ( Seek( _file, entry.offset ) != 0 ||
+         fwrite( tile.records.data(), sizeof( TiledNodeRecord ), tile.records.size(), _file ) != tile.records.size() ||
+         fflush( _file ) != 0 ) {
+        ++_stats.writeErrors;
+        return false;
+    }
+    ++_stats.tileWrites;
+    return true;
+}
+
+TiledLayoutPanel::TiledLayoutPanel()
+    : _log( "Tiled Layout Log" )
+    , _path( ( std::filesystem::temp_directory_path() / "imnodes_tiles.bin" ).string() ) {
+    _context = ImNodes::EditorContextCreate();
+}
+
+TiledLayoutPanel::~TiledLayoutPanel() {
+    _store.Close();
+    ImNodes::EditorContextFree( _context );
+}
+
+void TiledLayoutPanel::Draw() {
+    ImGui::Begin( "Tiled Layout" );
+
+    ImGui::SetNextItemWidth( 120.0f );
+    ImGui::InputInt( "Nodes", &_nodeCount, 100000, 1000000 );
+    _nodeCount = ImClamp( _nodeCount, 1, 20000000 );
+
+    if ( ImGui::Button( "Generate" ) ) {
+        // 写回失败时保留打开的文件与其中的修改，不覆盖
+        if ( !_store.Close() ) {
+            _log.AddLog( "Failed to write back modified tiles to %s, kept it open", _path.c_str() );
+        }
+        else {
+            const auto start = std::chrono::steady_clock::now();
+            if ( TileStore::Generate( _path, _nodeCount ) )
+                _log.AddLog( "Generated %d nodes in %.0f ms: %s", _nodeCount, ElapsedMs( start ), _path.c_str() );
+            else
+                _log.AddLog( "Failed to write %s", _path.c_str() );
+        }
+    }
+    ImGui::SameLine();
+    if ( ImGui::Button( "Open" ) ) {
+        const auto start = std::chrono::steady_clock::now();
+        if ( _store.Open( _path ) ) {
+            ImNodesEditorContext* previous = &ImNodes::EditorContextGet();
+            ImNodes::EditorContextSet( _context );
+            ImNodes::EditorContextResetPanning( ImVec2( 0.0f, 0.0f ) );
+            ImNodes::EditorContextSet( previous );
+            _log.AddLog( "Opened %lld nodes in %d tiles in %.1f ms", (long long)_store.NodeCount(), _store.TileCount(),
+                         ElapsedMs( start ) );
+        }
+        else if ( _store.IsOpen() ) {
+            _log.AddLog( "Failed to write back modified tiles to %s, kept it open", _path.c_str() );
+        }
+        else {
+            _log.AddLog( "Failed to open %s", _path.c_str() );
+        }
+    }
+    ImGui::SameLine();
+    if ( ImGui::Button( "Close" ) && !_store.Close() )
+        _log.AddLog( "Failed to write back modified tiles to %s, kept it open", _path.c_str() );
+
+    if ( _store.IsOpen() ) {
+        const TileStore::Stats& stats = _store.GetStats();
+        ImGui::Text( "Tiles %d / %d resident, %d nodes submitted, %d loads, %d evictions, %d write-backs",
+                     (int)_store.Resident().size(), _store.TileCount(), _submitted, stats.tileLoads,
+                     stats.tileEvictions, stats.tileWrites );
+        if ( stats.writeErrors > 0 || stats.loadErrors > 0 )
+            ImGui::TextColored( ImVec4( 1.0f, 0.4f, 0.4f, 1.0f ), "%d failed write-backs, %d unreadable tiles",
+                                stats.writeErrors, stats.loadErrors );
+    }
+    _log.Draw( 80.0f );
+
+    if ( _store.IsOpen() )
+        DrawEditor();
+
+    ImGui::End();
+}
+
+void TiledLayoutPanel::DrawEditor() {
+    ImNodesEditorContext* previous = &ImNodes::EditorContextGet();
+    ImNodes::EditorContextSet( _context );
+
+    // 编辑器画布占满剩余区域，其网格空间范围为 [-panning, size - panning]
+    const ImVec2 size = ImGui::GetContentRegionAvail();
+    const ImVec2 panning = ImNodes::EditorContextGetPanning();
+    const ImRect view( ImVec2( -panning.x, -panning.y ), ImVec2( size.x - panning.x, size.y - panning.y ) );
+    _store.Update( view );
+
+    // 只提交视口附近的节点；节点重新进入视口时，用瓦片中记录的位置恢复
+    const ImRect nearView( ImVec2( view.Min.x - NodeMargin, view.Min.y - NodeMargin ), view.Max );
+    std::vector<std::pair<TileStore::Tile*, int>> submitted;
+    ImNodes::BeginNodeEditor();
+    for ( TileStore::Tile& tile : _store.Resident() ) {
+        for ( int i = 0; i < (int)tile.records.size(); ++i ) {
+            const TiledNodeRecord& r = tile.records[ i ];
+            if ( !nearView.Contains( ImVec2( r.x, r.y ) ) )
+                continue;
+            if ( tile.submittedFrame[ i ] != _frame - 1 )
+                ImNodes::SetNodeGridSpacePos( r.id, ImVec2( r.x, r.y ) );
+            tile.submittedFrame[ i ] = _frame;
+            tile.nodes[ i ]->Render();
+            submitted.emplace_back( &tile, i );
+        }
+    }
+    ImNodes::EndNodeEditor();
+
+    // 拖动过的节点写回瓦片，瓦片被淘汰时再写回文件
+    for ( const auto& [ tile, i ] : submitted ) {
+        TiledNodeRecord& r = tile->records[ i ];
+        const ImVec2 pos = ImNodes::GetNodeGridSpacePos( r.id );
+        if ( pos.x != r.x || pos.y != r.y ) {
+            r.x = pos.x;
+            r.y = pos.y;
+            tile->dirty = true;
+        }
+    }
+    _submitted = (int)submitted.size();
+    ++_frame;
+
+    ImNodes::EditorContextSet( previous );
+}
@@ -0,0 +1,114 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "imnodes_internal.h"
+
+#include "LogPanel.h"
+#include "node.h"
+
+// 瓦片文件中的节点记录：节点 id、网格空间坐标、节点类型
+struct TiledNodeRecord {
+    int32_t id;
+    float x, y;
+    int32_t kind;
+};
+
+// 按空间瓦片存放节点布局的文件。启动时只读取文件头与瓦片索引，
+// 瓦片在视口靠近时才载入，超出容量后按 LRU 淘汰，被修改的瓦片淘汰时写回文件
+class TileStore {
+public:
+    struct Tile {
+        int tx = 0, ty = 0;
+        std::vector<TiledNodeRecord> records;
+        std::vector<std::shared_ptr<NodeBase>> nodes;
+        // 节点最近一次提交给 ImNodes 的帧，用于判断是否需要重新设置位置
+        std::vector<int> submittedFrame;
+        bool dirty = false;
+    };
+
+    struct Stats {
+        int tileLoads = 0;
+        int tileEvictions = 0;
+        int tileWrites = 0;
+        // 写回失败的次数；写回失败的瓦片保持常驻，下次淘汰或关闭时重试
+        int writeErrors = 0;
+        int loadErrors = 0;
+    };
+
+    // 析构时写回失败的修改被丢弃
+    ~TileStore() {
+        if ( !Close() )
+            Release();
+    }
+
+    // 生成一个包含 nodeCount 个节点的瓦片文件，任何一次写入失败都返回 false 并删除不完整的文件
+    static bool Generate( const std::string& path, int nodeCount );
+
+    // 已打开的文件无法关闭时返回 false
+    bool Open( const std::string& path );
+    // 写回所有被修改的瓦片并关闭文件。任何一次写入失败都返回 false，文件保持打开，
+    // 写回失败的瓦片仍标记为已修改并保持常驻，可以再次调用重试
+    bool Close();
+    bool IsOpen() const { return _file != nullptr; }
+
+    // 载入与 view（网格空间）相交或相邻的瓦片，并淘汰多余的瓦片
+    void Update( const ImRect& view );
+
+    const std::list<Tile>& Resident() const { return _resident; }
+    std::list<Tile>& Resident() { return _resident; }
+    ImRect TileRect( const Tile& tile ) const;
+    int TileCount() const { return _tilesX * _tilesY; }
+    int64_t NodeCount() const { return _nodeCount; }
+    const Stats& GetStats() const { return _stats; }
+
+    static constexpr float TileSize = 2000.0f;
+    static constexpr int TileCapacity = 64;
+
+private:
+    struct IndexEntry {
+        uint64_t offset;
+        uint32_t count;
+        uint32_t reserved;
+    };
+
+    bool LoadTile( int tx, int ty, Tile& tile );
+    bool WriteTile( const Tile& tile );
+    // 丢弃常驻瓦片并关闭文件，不写回
+    bool Release();
+
+    FILE* _file = nullptr;
+    int _tilesX = 0, _tilesY = 0;
+    int64_t _nodeCount = 0;
+    std::vector<IndexEntry> _index;
+
+    // 最近使用的瓦片在前
+    std::list<Tile> _resident;
+    std::unordered_map<int64_t, std::list<Tile>::iterator> _lookup;
+    Stats _stats;
+};
+
+// 瓦片分页的大规模节点布局示例，使用独立的编辑器上下文
+class TiledLayoutPanel {
+public:
+    TiledLayoutPanel();
+    ~TiledLayoutPanel();
+
+    void Draw();
+
+private:
+    void DrawEditor();
+
+    ImNodesEditorContext* _context = nullptr;
+    TileStore _store;
+    ImGuiLogPanel _log;
+    std::string _path;
+    int _nodeCount = 10000000;
+    int _frame = 0;
+    int _submitted = 0;
+};
@@ -0,0 +1,177 @@
+﻿#include "TopologicalOrder.h"
+
+#include <algorithm>
+
+#include "Editor.h"
+
+void TopologicalOrder::Rebuild( const Editor& editor ) {
+    _vertices.clear();
+    _nodes.clear();
+    _pins.clear();
+    _nextOrder = 0;
+    _affected = 0;
+    // 顶点与 editor.nodes 一一对应，下标相同
+    for ( const auto& node : editor.nodes )
+        AddVertex( *node );
+    const std::vector<ResolvedLink> links = ResolveLinks( editor );
+    for ( const ResolvedLink& link : links ) {
+        _vertices[ link.fromNode ].out.push_back( link.toNode );
+        _vertices[ link.toNode ].in.push_back( link.fromNode );
+    }
+
+    // 剩下的环上节点按原顺序排在最后
+    const size_t count = _vertices.size();
+    std::vector<uint32_t> order = TopologicalSort( count, links );
+    std::vector<uint8_t> sorted( count, 0 );
+    for ( const uint32_t i : order )
+        sorted[ i ] = 1;
+    for ( uint32_t i = 0; i < count; ++i ) {
+        if ( !sorted[ i ] )
+            order.push_back( i );
+    }
+    for ( size_t i = 0; i < count; ++i )
+        _vertices[ order[ i ] ].order = (int64_t)i;
+    _nextOrder = (int64_t)count;
+    _revision = editor.revision;
+}
+
+void TopologicalOrder::Sync( const Editor& editor ) {
+    if ( _revision != editor.revision )
+        Rebuild( editor );
+}
+
+void TopologicalOrder::AddNode( const NodeBase& node ) {
+    if ( !_nodes.count( node.node_id ) )
+        AddVertex( node );
+}
+
+uint32_t TopologicalOrder::AddVertex( const NodeBase& node ) {
+    const uint32_t index = (uint32_t)_vertices.size();
+    _vertices.push_back( Vertex{ node.node_id, _nextOrder++, {}, {} } );
+    _nodes[ node.node_id ] = index;
+    for ( const Pin& pin : node.pins )
+        _pins[ pin.pid ] = PinRef{ index, pin.ptype == PinType::Output };
+    return index;
+}
+
+bool TopologicalOrder::Resolve( const int startAttr, const int endAttr, uint32_t& from, uint32_t& to ) const {
+    const auto a = _pins.find( startAttr );
+    const auto b = _pins.find( endAttr );
+    if ( a == _pins.end() || b == _pins.end() || a->second.output == b->second.output )
+        return false;
+    from = a->second.output ? a->second.vertex : b->second.vertex;
+    to = a->second.output ? b->second.vertex : a->second.vertex;
+    return true;
+}
+
+bool TopologicalOrder::AddLink( const int startAttr, const int endAttr, std::vector<int>* cycle ) {
+    _affected = 0;
+    uint32_t u, v;
+    if ( !Resolve( startAttr, endAttr, u, v ) )
+        return true;
+    const int64_t lower = _vertices[ v ].order;
+    const int64_t upper = _vertices[ u ].order;
+    if ( u != v && upper < lower ) {
+        _vertices[ u ].out.push_back( v );
+        _vertices[ v ].in.push_back( u );
+        return true;
+    }
+
+    if ( _visited.size() < _vertices.size() ) {
+        _visited.resize( _vertices.size(), 0 );
+        _parent.resize( _vertices.size() );
+    }
+    if ( ++_epoch == 0 ) {
+        std::fill( _visited.begin(), _visited.end(), 0 );
+        _epoch = 1;
+    }
+    if ( u == v || !Forward( v, upper, u ) ) {
+        // 沿搜索树从 u 回到 v 即为环
+        if ( cycle ) {
+            cycle->clear();
+            for ( uint32_t w = u; w != v; w = _parent[ w ] )
+                cycle->push_back( _vertices[ w ].nodeId );
+            cycle->push_back( _vertices[ v ].nodeId );
+            std::reverse( cycle->begin(), cycle->end() );
+        }
+        return false;
+    }
+    Backward( u, lower );
+
+    // 上游一侧整体排到下游一侧之前，各自保持原有的相对顺序，使用的仍是原来那些序号
+    const auto byOrder = [ this ]( const uint32_t a, const uint32_t b ) { return _vertices[ a ].order < _vertices[ b ].order; };
+    std::sort( _backward.begin(), _backward.end(), byOrder );
+    std::sort( _forward.begin(), _forward.end(), byOrder );
+    _orders.clear();
+    for ( const uint32_t w : _backward )
+        _orders.push_back( _vertices[ w ].order );
+    for ( const uint32_t w : _forward )
+        _orders.push_back( _vertices[ w ].order );
+    std::sort( _orders.begin(), _orders.end() );
+    size_t next = 0;
+    for ( const uint32_t w : _backward )
+        _vertices[ w ].order = _orders[ next++ ];
+    for ( const uint32_t w : _forward )
+        _vertices[ w ].order = _orders[ next++ ];
+    _affected = _orders.size();
+
+    _vertices[ u ].out.push_back( v );
+    _vertices[ v ].in.push_back( u );
+    return true;
+}
+
+bool TopologicalOrder::Forward( const uint32_t v, const int64_t upper, const uint32_t target ) {
+    _forward.clear();
+    _stack.assign( 1, v );
+    _visited[ v ] = _epoch;
+    while ( !_stack.empty() ) {
+        const uint32_t w = _stack.back();
+        _stack.pop_back();
+        _forward.push_back( w );
+        for ( const uint32_t next : _vertices[ w ].out ) {
+            if ( _visited[ next ] == _epoch || _vertices[ next ].order > upper )
+                continue;
+            _visited[ next ] = _epoch;
+            _parent[ next ] = w;
+            if ( next == target )
+                return false;
+            _stack.push_back( next );
+        }
+    }
+    return true;
+}
+
+void TopologicalOrder::Backward( const uint32_t u, const int64_t lower ) {
+    // 前向搜索的节点序号都不大于 ord[ u ]，后向搜索的都大于 ord[ v ]，两者不会重叠（否则前向已经到达 u）
+    _backward.clear();
+    _stack.assign( 1, u );
+    _visited[ u ] = _epoch;
+    while ( !_stack.empty() ) {
+        const uint32_t w = _stack.back();
+        _stack.pop_back();
+        _backward.push_back( w );
+        for ( const uint32_t previous : _vertices[ w ].in ) {
+            if ( _visited[ previous ] == _epoch || _vertices[ previous ].order < lower )
+                continue;
+            _visited[ previous ] = _epoch;
+            _stack.push_back( previous );
+        }
+    }
+}
+
+void TopologicalOrder::RemoveLink( const int startAttr, const int endAttr ) {
+    uint32_t u, v;
+    if ( !Resolve( startAttr, endAttr, u, v ) )
+        return;
+    std::vector<uint32_t>& out = _vertices[ u ].out;
+    std::vector<uint32_t>& in = _vertices[ v ].in;
+    if ( const auto it = std::find( out.begin(), out.end(), v ); it != out.end() )
+        out.erase( it );
+    if ( const auto it = std::find( in.begin(), in.end(), u ); it != in.end() )
+        in.erase( it );
+}
+
+int64_t TopologicalOrder::Position( const int nodeId ) const {
+    const auto found = _nodes.find( nodeId );
+    return found == _nodes.end() ? -1 : _vertices[ found->second ].order;
+}
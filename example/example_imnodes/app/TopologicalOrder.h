@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "node.h"
+
+struct Editor;
+
+// 节点的动态拓扑顺序 (Pearce–Kelly)。加入连线 u -> v 时，u 已经排在 v 之前则只记录这条边；
+// 否则只搜索序号在 ord[ v ] 与 ord[ u ] 之间的节点：从 v 向下游、从 u 向上游，
+// 把搜索到的节点重新分配它们原有的那些序号，代价与受影响的区域成正比，不重新排序整个图。
+// 从 v 向下游能到达 u 时这条连线会形成环，拒绝加入。删除连线不会破坏已有的顺序
+class TopologicalOrder {
+public:
+    // 由 editor 的全部节点与连线重建。图中已有环时环上的节点排在最后，之后的增量更新不保证正确
+    void Rebuild( const Editor& editor );
+    // editor.revision 与上次同步的不同（撤销、导入、加载快照等不经过本类的修改）时重建
+    void Sync( const Editor& editor );
+    // 调用方已经用 AddNode / AddLink / RemoveLink 增量更新了对 editor 的修改
+    void MarkSynced( uint64_t revision ) { _revision = revision; }
+
+    // 新节点排在最后
+    void AddNode( const NodeBase& node );
+    // 加入 startAttr 与 endAttr 之间的连线，两端可以是任意顺序。会形成环时不加入并返回 false，
+    // cycle 中为环上的节点 id（从连线的下游端开始）
+    bool AddLink( int startAttr, int endAttr, std::vector<int>* cycle = nullptr );
+    void RemoveLink( int startAttr, int endAttr );
+
+    // 节点的序号，越小越靠前；序号不连续。未知节点为 -1
+    int64_t Position( int nodeId ) const;
+    size_t NodeCount() const { return _vertices.size(); }
+    // 最近一次 AddLink 重新分配了序号的节点数
+    size_t LastAffected() const { return _affected; }
+
+private:
+    struct Vertex {
+        int nodeId;
+        int64_t order;
+        // 下游与上游节点，两个节点之间有几条连线就出现几次
+        std::vector<uint32_t> out, in;
+    };
+    struct PinRef {
+        uint32_t vertex;
+        bool output;
+    };
+
+    uint32_t AddVertex( const NodeBase& node );
+    bool Resolve( int startAttr, int endAttr, uint32_t& from, uint32_t& to ) const;
+    // 从 v 向下游搜索序号不大于 upper 的节点，到达 target 时返回 false
+    bool Forward( uint32_t v, int64_t upper, uint32_t target );
+    void Backward( uint32_t u, int64_t lower );
+
+    std::vector<Vertex> _vertices;
+    std::unordered_map<int, uint32_t> _nodes;
+    std::unordered_map<int, PinRef> _pins;
+    int64_t _nextOrder = 0;
+    uint64_t _revision = ~0ull;
+    size_t _affected = 0;
+
+    // 搜索用的暂存，按代次标记访问过的节点，不必每次清空
+    std::vector<uint32_t> _visited;
+    std::vector<uint32_t> _parent;
+    uint32_t _epoch = 0;
+    std::vector<uint32_t> _stack;
+    std::vector<uint32_t> _forward, _backward;
+    std::vector<int64_t> _orders;
+};
@@ -0,0 +1,113 @@
+﻿#include "WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool( const int threadCount ) {
+    const int count = threadCount > 1 ? threadCount : 1;
+    for ( int i = 0; i < count; ++i )
+        _queues.push_back( std::make_unique<Queue>() );
+    for ( int i = 1; i < count; ++i )
+        _threads.emplace_back( [ this, i ] { WorkerMain( i ); } );
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _stop = true;
+    }
+    _wake.notify_all();
+    for ( std::thread& thread : _threads )
+        thread.join();
+}
+
+void WorkStealingPool::Run( const std::vector<uint32_t>& roots, const Job& job ) {
+    if ( roots.empty() )
+        return;
+    _job = &job;
+    _outstanding = roots.size();
+    if ( _threads.empty() ) {
+        // 单线程：逆序放入，按 roots 的顺序取出
+        Queue& queue = *_queues.front();
+        queue.tasks.assign( roots.rbegin(), roots.rend() );
+        Drain( 0 );
+        _job = nullptr;
+        return;
+    }
+
+    // 初始任务轮流分给各个队列
+    for ( size_t i = 0; i < roots.size(); ++i ) {
+        Queue& queue = *_queues[ i % _queues.size() ];
+        std::lock_guard<std::mutex> lock( queue.mutex );
+        queue.tasks.push_back( roots[ i ] );
+    }
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _busy = (int)_threads.size();
+        ++_generation;
+    }
+    _wake.notify_all();
+
+    Drain( 0 );
+    // 后台线程全部退出本轮后 job 才能失效
+    while ( _busy.load( std::memory_order_acquire ) > 0 )
+        std::this_thread::yield();
+    _job = nullptr;
+}
+
+void WorkStealingPool::Spawn( const int worker, const uint32_t task ) {
+    _outstanding.fetch_add( 1, std::memory_order_relaxed );
+    Queue& queue = *_queues[ worker ];
+    std::lock_guard<std::mutex> lock( queue.mutex );
+    queue.tasks.push_back( task );
+}
+
+void WorkStealingPool::WorkerMain( const int worker ) {
+    uint64_t seen = 0;
+    for ( ;; ) {
+        {
+            std::unique_lock<std::mutex> lock( _mutex );
+            _wake.wait( lock, [ & ] { return _stop || _generation != seen; } );
+            if ( _stop )
+                return;
+            seen = _generation;
+        }
+        Drain( worker );
+        _busy.fetch_sub( 1, std::memory_order_release );
+    }
+}
+
+void WorkStealingPool::Drain( const int worker ) {
+    while ( _outstanding.load( std::memory_order_acquire ) > 0 ) {
+        uint32_t task;
+        if ( Pop( worker, task ) ) {
+            ( *_job )( task, worker );
+            _outstanding.fetch_sub( 1, std::memory_order_acq_rel );
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool WorkStealingPool::Pop( const int worker, uint32_t& task ) {
+    {
+        Queue& own = *_queues[ worker ];
+        std::lock_guard<std::mutex> lock( own.mutex );
+        if ( !own.tasks.empty() ) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    // 从下一个线程开始依次尝试窃取最早放入的任务
+    const int count = (int)_queues.size();
+    for ( int i = 1; i < count; ++i ) {
+        Queue& victim = *_queues[ ( worker + i ) % count ];
+        std::lock_guard<std::mutex> lock( victim.mutex );
+        if ( !victim.tasks.empty() ) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            _steals.fetch_add( 1, std::memory_order_relaxed );
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,60 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池。每个工作线程有自己的双端队列：自己从尾部取（后进先出，缓存友好），
+// 空闲时从其他线程队列的头部窃取。任务是一个整数（例如节点在调度中的位置），任务执行中可以继续派生任务，
+// 没有按层的同步点。调用 Run 的线程也作为 0 号工作线程参与执行
+class WorkStealingPool {
+public:
+    using Job = std::function<void( uint32_t task, int worker )>;
+
+    // threadCount <= 1 时不创建线程，任务在调用线程上按确定的顺序执行，便于调试与复现
+    explicit WorkStealingPool( int threadCount );
+    ~WorkStealingPool();
+
+    WorkStealingPool( const WorkStealingPool& ) = delete;
+    WorkStealingPool& operator=( const WorkStealingPool& ) = delete;
+
+    int ThreadCount() const { return (int)_queues.size(); }
+
+    // 执行 roots 以及执行中派生的全部任务，全部完成后返回
+    void Run( const std::vector<uint32_t>& roots, const Job& job );
+    // 在任务中调用，把新任务放入当前工作线程 worker 的队列
+    void Spawn( int worker, uint32_t task );
+
+    // 累计的窃取次数
+    size_t StealCount() const { return _steals; }
+
+private:
+    struct alignas( 64 ) Queue {
+        std::mutex mutex;
+        std::deque<uint32_t> tasks;
+    };
+
+    void WorkerMain( int worker );
+    void Drain( int worker );
+    bool Pop( int worker, uint32_t& task );
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _threads;
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    uint64_t _generation = 0;
+    bool _stop = false;
+    const Job* _job = nullptr;
+
+    // 已派生但尚未执行完的任务数
+    std::atomic<size_t> _outstanding = 0;
+    // 本轮尚未退出的后台线程数
+    std::atomic<int> _busy = 0;
+    std::atomic<size_t> _steals = 0;
+};
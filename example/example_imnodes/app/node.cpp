@@ -6,10 +6,11 @@
 int UniqueId::id = 100;
 std::vector<int> UniqueId::ids = {};
 
-void NodeBase::Render() {
+bool NodeBase::Render() {
     const float node_width = 100.f;
     ImNodes::BeginNode( node_id );
     int column = 2;
+    bool changed = false;
     if ( title_pos == TitlePos::Top ) {
         ImNodes::BeginNodeTitleBar();
         ImGui::TextUnformatted( name.c_str() );
@@ -29,7 +30,7 @@ void NodeBase::Render() {
         ImGui::TableSetColumnIndex( col++ );
         for ( auto& pin : pins ) {
             if ( pin.ptype == PinType::Input )
-                pin.Render();
+                changed |= pin.Render();
         }
 
         if ( title_pos == TitlePos::Center ) {
@@ -50,6 +51,102 @@ void NodeBase::Render() {
     ImNodes::PopStyleVar();
 
     ImNodes::EndNode();
+    return changed;
 }
 
 void NodeBase::AfterRender() {}
+
+void NodeBase::ComputeElementwise() {
+    bool scalar = true;
+    for ( const Pin& pin : pins ) {
+        if ( pin.ptype == PinType::Input && !pin.As<float>() )
+            scalar = false;
+    }
+    ElementwiseOp op;
+    if ( scalar ) {
+        for ( size_t p = 0; p < pins.size(); ++p ) {
+            if ( Elementwise( p, op ) )
+                pins[ p ].Set( ApplyColumnOp( op.op, pins[ op.lhs ].Number(), pins[ op.rhs ].Number() ) );
+        }
+        return;
+    }
+
+    ColumnProgram program;
+    std::vector<int> leaves( pins.size(), -1 );
+    std::vector<int> roots;
+    std::vector<size_t> outputs;
+    for ( size_t p = 0; p < pins.size(); ++p ) {
+        if ( !Elementwise( p, op ) )
+            continue;
+        for ( const int input : { op.lhs, op.rhs } ) {
+            if ( leaves[ input ] < 0 )
+                leaves[ input ] = program.Leaf( pins[ input ].value );
+        }
+        roots.push_back( program.Apply( op.op, leaves[ op.lhs ], leaves[ op.rhs ] ) );
+        outputs.push_back( p );
+    }
+    std::vector<PinValue> results( roots.size() );
+    program.Execute( roots.data(), roots.size(), results.data() );
+    for ( size_t r = 0; r < roots.size(); ++r )
+        pins[ outputs[ r ] ].Assign( std::move( results[ r ] ) );
+}
+
+void AddNode::Compute() {
+    const float* a = pins[ 0 ].As<float>();
+    const float* b = pins[ 1 ].As<float>();
+    if ( a && b )
+        pins[ 2 ].Set( *a + *b );
+    else
+        ComputeElementwise();
+}
+
+bool AddNode::Elementwise( const size_t pin, ElementwiseOp& op ) const {
+    if ( pin != 2 )
+        return false;
+    op = { ColumnOp::Add, 0, 1 };
+    return true;
+}
+
+void SubNode::Compute() {
+    const float* a = pins[ 0 ].As<float>();
+    const float* b = pins[ 1 ].As<float>();
+    if ( a && b ) {
+        pins[ 2 ].Set( *a - *b );
+        pins[ 3 ].Set( *b - *a );
+    }
+    else {
+        ComputeElementwise();
+    }
+}
+
+bool SubNode::Elementwise( const size_t pin, ElementwiseOp& op ) const {
+    if ( pin == 2 )
+        op = { ColumnOp::Sub, 0, 1 };
+    else if ( pin == 3 )
+        op = { ColumnOp::Sub, 1, 0 };
+    else
+        return false;
+    return true;
+}
+
+std::shared_ptr<NodeBase> MakeNode( const NodeKind kind ) {
+    switch ( kind ) {
+    case NodeKind::Add:
+        return std::make_shared<AddNode>();
+    case NodeKind::Sub:
+        return std::make_shared<SubNode>();
+    default:
+        return nullptr;
+    }
+}
+
+std::shared_ptr<NodeBase> MakeNode( const NodeKind kind, const int id ) {
+    switch ( kind ) {
+    case NodeKind::Add:
+        return std::make_shared<AddNode>( id );
+    case NodeKind::Sub:
+        return std::make_shared<SubNode>( id );
+    default:
+        return nullptr;
+    }
+}
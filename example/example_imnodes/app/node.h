@@ -1,10 +1,12 @@
 #pragma once
-#include <any>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <vector>
 
 #include "imnodes.h"
 
+#include "Column.h"
 #include "pin.h"
 
 class UniqueId {
@@ -14,28 +16,64 @@ public:
         ids.emplace_back( id++ );
         return ids.back();
     }
+    // 下一个将分配的 id
+    static int peek_id() { return id; }
+    // 保证之后分配的 id 不小于 next，用于恢复快照后避免 id 重复
+    static void advance_to( const int next ) {
+        if ( id < next )
+            id = next;
+    }
 
 private:
     static int id;
     static std::vector<int> ids;
 };
 
+enum class NodeKind : int { Add = 0, Sub, Count };
+
+// 逐元素节点的一个输出：pins[ output ] = op( pins[ lhs ], pins[ rhs ] )
+struct ElementwiseOp {
+    ColumnOp op;
+    int lhs, rhs;
+};
+
 class NodeBase {
 public:
     enum class TitlePos { Top = 0, Center, None };
 
     NodeBase()
         : node_id( UniqueId::get_id() ) {}
+    // 使用指定 id，引脚 id 依次为 id + 1, id + 2, ...，每个节点最多占用 IdStride 个 id。
+    // 引脚数组从 resource 分配，批量创建节点时可以共用一块内存
+    explicit NodeBase( const int id, std::pmr::memory_resource* resource = std::pmr::get_default_resource() )
+        : pins( resource )
+        , node_id( id ) {}
+    virtual ~NodeBase() = default;
 
-    void Render();
+    static constexpr int IdStride = 8;
+
+    // 由输入引脚的值计算输出引脚的值。求值器按拓扑顺序调用，调用前已把上游的值写入连接的输入引脚
+    virtual void Compute() {}
+    // 输出引脚 pin 是否为两个输入的逐元素运算。求值器据此把相连的逐元素节点融合执行
+    virtual bool Elementwise( size_t, ElementwiseOp& ) const { return false; }
+
+    // 返回用户是否修改了某个输入引脚的值
+    bool Render();
 
     void AfterRender();
 
     std::string name;
-    std::vector<Pin> pins;
+    std::pmr::vector<Pin> pins;
     TitlePos title_pos = TitlePos::Top;
+    NodeKind kind = NodeKind::Count;
+    // 输入变化后尚未重新计算。新建的节点还没有计算过
+    bool dirty = true;
 
     int node_id = 0;
+
+protected:
+    // 按 Elementwise 计算全部输出：输入都是标量时直接计算，有列时用 SIMD 列运算
+    void ComputeElementwise();
 };
 
 class AddNode : public NodeBase {
@@ -43,9 +81,20 @@ public:
     AddNode()
         : NodeBase() {
         name = "Add";
-        pins = std::vector<Pin>{ Pin{ UniqueId::get_id(), "A", PinType::Input }, Pin{ UniqueId::get_id(), "B", PinType::Input },
-                                 Pin{ UniqueId::get_id(), "C", PinType::Output } };
+        kind = NodeKind::Add;
+        pins = { Pin{ UniqueId::get_id(), "A", PinType::Input }, Pin{ UniqueId::get_id(), "B", PinType::Input },
+                 Pin{ UniqueId::get_id(), "C", PinType::Output } };
     }
+    explicit AddNode( const int id, std::pmr::memory_resource* resource = std::pmr::get_default_resource() )
+        : NodeBase( id, resource ) {
+        name = "Add";
+        kind = NodeKind::Add;
+        pins = { Pin{ id + 1, "A", PinType::Input }, Pin{ id + 2, "B", PinType::Input }, Pin{ id + 3, "C", PinType::Output } };
+    }
+
+    // C = A + B
+    void Compute() override;
+    bool Elementwise( size_t pin, ElementwiseOp& op ) const override;
 };
 
 class SubNode : public NodeBase {
@@ -53,8 +102,23 @@ public:
     SubNode()
         : NodeBase() {
         name = "Sub";
-        pins =
-            std::vector<Pin>{ Pin{ UniqueId::get_id(), "A", PinType::Input }, Pin{ UniqueId::get_id(), "B", PinType::Input },
-                              Pin{ UniqueId::get_id(), "C", PinType::Output }, Pin{ UniqueId::get_id(), "D", PinType::Output } };
+        kind = NodeKind::Sub;
+        pins = { Pin{ UniqueId::get_id(), "A", PinType::Input }, Pin{ UniqueId::get_id(), "B", PinType::Input },
+                 Pin{ UniqueId::get_id(), "C", PinType::Output }, Pin{ UniqueId::get_id(), "D", PinType::Output } };
+    }
+    explicit SubNode( const int id, std::pmr::memory_resource* resource = std::pmr::get_default_resource() )
+        : NodeBase( id, resource ) {
+        name = "Sub";
+        kind = NodeKind::Sub;
+        pins = { Pin{ id + 1, "A", PinType::Input }, Pin{ id + 2, "B", PinType::Input }, Pin{ id + 3, "C", PinType::Output },
+                 Pin{ id + 4, "D", PinType::Output } };
     }
-};
\ No newline at end of file
+
+    // C = A - B, D = B - A
+    void Compute() override;
+    bool Elementwise( size_t pin, ElementwiseOp& op ) const override;
+};
+
+// 节点工厂：按类型创建节点，节点与引脚 id 由 UniqueId 分配，或使用指定的 id
+std::shared_ptr<NodeBase> MakeNode( NodeKind kind );
+std::shared_ptr<NodeBase> MakeNode( NodeKind kind, int id );
\ No newline at end of file
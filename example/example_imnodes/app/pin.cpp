@@ -1,10 +1,19 @@
 
 #include "pin.h"
 
+#include <iterator>
+
+#include "Column.h"
+
 #define Pin_Default IM_COL32( 200, 100, 100, 255 )
 #define Pin_Linked IM_COL32( 100, 200, 100, 255 )
 
-void Pin::Render() {
+const char* ValueTypeName( const ValueType type ) {
+    static const char* const Names[] = { "none", "float", "vec4", "column", "fused" };
+    return (size_t)type < std::size( Names ) ? Names[ (size_t)type ] : "?";
+}
+
+bool Pin::Render() {
     if ( ptype == PinType::Input ) {
         ImNodes::BeginInputAttribute( pid );
     }
@@ -12,7 +21,36 @@ void Pin::Render() {
         ImNodes::BeginOutputAttribute( pid );
     }
 
-    ImGui::Text( pname.c_str() );
+    // 未连接的输入可以直接编辑，其余引脚只显示求值结果
+    bool changed = false;
+    const float* number = As<float>();
+    if ( number && ptype == PinType::Input && !isLinked ) {
+        float edited = *number;
+        ImGui::TextUnformatted( pname.c_str() );
+        ImGui::SameLine();
+        ImGui::PushID( pid );
+        ImGui::SetNextItemWidth( 50.0f );
+        if ( ImGui::DragFloat( "##value", &edited, 0.1f, 0.0f, 0.0f, "%.3g" ) && edited != *number ) {
+            Set( edited );
+            changed = true;
+        }
+        ImGui::PopID();
+    }
+    else if ( number ) {
+        ImGui::Text( "%s %.3g", pname.c_str(), *number );
+    }
+    else if ( const Vec4* vector = As<Vec4>() ) {
+        ImGui::Text( "%s (%.3g, %.3g, %.3g, %.3g)", pname.c_str(), vector->x, vector->y, vector->z, vector->w );
+    }
+    else if ( const ColumnPtr* column = As<ColumnPtr>() ) {
+        ImGui::Text( "%s [%d %s]", pname.c_str(), (int)( *column )->Size(), ColumnTypeName( ( *column )->Type() ) );
+    }
+    else if ( As<FusedValue>() ) {
+        ImGui::Text( "%s (fused)", pname.c_str() );
+    }
+    else {
+        ImGui::TextUnformatted( pname.c_str() );
+    }
 
     if ( ptype == PinType::Input ) {
         ImNodes::EndInputAttribute();
@@ -20,6 +58,7 @@ void Pin::Render() {
     else {
         ImNodes::EndOutputAttribute();
     }
+    return changed;
 }
 
 // void Pin::Render( std::vector<Pin>& pins ) {
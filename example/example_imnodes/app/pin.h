@@ -1,10 +1,12 @@
 
 #pragma once
 
-#include <any>
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "PinValue.h"
 #include "imnodes.h"
 
 enum class PinType { Input, Output };
@@ -12,6 +14,12 @@ struct Pin {
     PinType ptype;
     int pid;
     std::string pname;
+    // 引脚值。输入引脚未连接时为用户设置的值，连接后由求值器写入上游输出的值；输出引脚为 Compute 的结果
+    PinValue value = 0.0f;
+    // 输入引脚接受、输出引脚产生的值类型，连线时检查
+    ValueTypes types = NumberTypes;
+    // 值最后一次改变时的版本号，全局递增。连接的输入与上游输出版本号相同时值一定相同，不必复制或重新计算
+    uint64_t version = 0;
 
     bool isLinked = false;
 
@@ -21,5 +29,46 @@ struct Pin {
         , pname( name )
         , ptype( type ) {}
 
-    void Render();
-};
\ No newline at end of file
+    // 按类型读取引脚值，类型不符时返回 nullptr
+    template <typename T>
+    const T* As() const {
+        return value.As<T>();
+    }
+    // 读取数值，没有值或类型不符时为 0
+    float Number() const {
+        const float* number = As<float>();
+        return number ? *number : 0.0f;
+    }
+
+    // 写入数值，只有值真正改变时才更新版本号
+    void Set( const float number ) {
+        float* current = value.As<float>();
+        if ( current && *current == number )
+            return;
+        if ( current )
+            *current = number;
+        else
+            value = number;
+        version = NextVersion();
+    }
+
+    // 并行求值时多个线程同时计算节点，只要求版本号唯一
+    // 写入任意值并更新版本号
+    void Assign( PinValue next ) {
+        value = std::move( next );
+        version = NextVersion();
+    }
+
+    static uint64_t NextVersion() { return lastVersion.fetch_add( 1, std::memory_order_relaxed ) + 1; }
+
+    // 返回用户是否在界面中修改了引脚值
+    bool Render();
+
+private:
+    static inline std::atomic<uint64_t> lastVersion = 0;
+};
+
+// 输出 output 能否连到输入 input。类型只在连线时检查一次，求值时读取引脚值不再检查
+inline bool CanLink( const Pin& output, const Pin& input ) {
+    return output.ptype == PinType::Output && input.ptype == PinType::Input && ( output.types & input.types ) != 0;
+}
\ No newline at end of file
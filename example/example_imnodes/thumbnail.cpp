@@ -0,0 +1,210 @@
+﻿// thumbnail.cpp
+// 无窗口、无 GPU 地把图文件渲染为 PNG 缩略图：
+//     imnodes_thumbnail [--size WxH] [--threads N] [--out DIR] graph.dot graph.json ...
+// 输出为 DIR/<输入文件名>.png。不读写 imgui.ini，多个进程可以同时渲染不同的图。
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+#include "imgui_impl_soft.h"
+#include "imnodes.h"
+
+#include "app/Editor.h"
+#include "app/Evaluator.h"
+#include "app/GraphImport.h"
+
+namespace
+{
+
+struct Options
+{
+    int width = 1280;
+    int height = 720;
+    int threads = 0; // 0: 每个核一个线程
+    std::string outDir = ".";
+    std::vector<std::string> inputs;
+};
+
+// 内容与画面边缘的距离（画布坐标）
+constexpr float ContentMargin = 32.0f;
+
+// 一帧的逻辑画面：displaySize 是画布上可见的区域，scale 把它缩放到输出图片的像素
+struct View
+{
+    ImVec2 displaySize;
+    float scale = 1.0f;
+};
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--size" && hasValue)
+        {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 || options.width <= 0 ||
+                options.height <= 0)
+                return false;
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if (arg == "--out" && hasValue)
+        {
+            options.outDir = argv[++i];
+        }
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            return false;
+        }
+        else
+        {
+            options.inputs.push_back(arg);
+        }
+    }
+    return !options.inputs.empty();
+}
+
+// 提交一帧：整个画面是一个节点编辑器
+void DrawFrame(const Editor& editor, const View& view)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = view.displaySize;
+    io.DisplayFramebufferScale = ImVec2(view.scale, view.scale);
+    io.DeltaTime = 1.0f / 60.0f;
+    ImGui_ImplSoft_NewFrame();
+    ImGui::NewFrame();
+
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0.0f);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(io.DisplaySize);
+    ImGui::Begin("Thumbnail", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoSavedSettings);
+    ImNodes::EditorContextSet(editor.context);
+    ImNodes::BeginNodeEditor();
+    DrawGraph(editor);
+    ImNodes::EndNodeEditor();
+    ImGui::End();
+    ImGui::PopStyleVar(3);
+
+    ImGui::Render();
+}
+
+// 平移画布并放大逻辑画面，使所有节点都落在画面内；内容大于输出尺寸时整体缩小，
+// 不放大小图。节点尺寸来自上一帧，因此要在至少绘制过一帧之后调用
+View FitToContent(const Editor& editor, const Options& options)
+{
+    View view;
+    view.displaySize = ImVec2((float)options.width, (float)options.height);
+    if (editor.nodes.empty())
+        return view;
+
+    ImVec2 min = ImNodes::GetNodeGridSpacePos(editor.nodes.front()->node_id);
+    ImVec2 max = min;
+    for (const auto& node : editor.nodes)
+    {
+        const ImVec2 pos = ImNodes::GetNodeGridSpacePos(node->node_id);
+        const ImVec2 size = ImNodes::GetNodeDimensions(node->node_id);
+        min.x = pos.x < min.x ? pos.x : min.x;
+        min.y = pos.y < min.y ? pos.y : min.y;
+        max.x = pos.x + size.x > max.x ? pos.x + size.x : max.x;
+        max.y = pos.y + size.y > max.y ? pos.y + size.y : max.y;
+    }
+
+    const float contentWidth = max.x - min.x + 2.0f * ContentMargin;
+    const float contentHeight = max.y - min.y + 2.0f * ContentMargin;
+    const float scaleX = (float)options.width / contentWidth;
+    const float scaleY = (float)options.height / contentHeight;
+    view.scale = scaleX < scaleY ? scaleX : scaleY;
+    view.scale = view.scale < 1.0f ? view.scale : 1.0f;
+    view.displaySize = ImVec2((float)options.width / view.scale, (float)options.height / view.scale);
+
+    // 较短的一边居中
+    const ImVec2 offset((view.displaySize.x - (max.x - min.x)) * 0.5f, (view.displaySize.y - (max.y - min.y)) * 0.5f);
+    ImNodes::EditorContextResetPanning(ImVec2(offset.x - min.x, offset.y - min.y));
+    return view;
+}
+
+bool RenderThumbnail(const std::string& input, const Options& options, std::vector<ImU32>& pixels)
+{
+    Editor editor;
+    editor.context = ImNodes::EditorContextCreate();
+    std::string error;
+    if (!ImportGraph(input, editor, error))
+    {
+        std::fprintf(stderr, "%s: %s\n", input.c_str(), error.c_str());
+        return false;
+    }
+    // 缩略图中显示求值结果
+    GraphEvaluator().Evaluate(editor);
+
+    // 第一帧确定节点尺寸，第二帧按内容范围平移、缩放后渲染
+    DrawFrame(editor, View{ImVec2((float)options.width, (float)options.height)});
+    ImNodes::EditorContextSet(editor.context);
+    DrawFrame(editor, FitToContent(editor, options));
+
+    const ImVec4 bg = ImGui::GetStyle().Colors[ImGuiCol_WindowBg];
+    const ImU32 clearColor = ImGui::ColorConvertFloat4ToU32(ImVec4(bg.x, bg.y, bg.z, 1.0f));
+    ImGui_ImplSoft_RenderDrawData(ImGui::GetDrawData(), pixels.data(), options.width, options.height, clearColor,
+                                  options.threads);
+
+    const std::filesystem::path output =
+        std::filesystem::path(options.outDir) / std::filesystem::path(input).filename().concat(".png");
+    if (!ImGui_ImplSoft_WritePng(output.string().c_str(), pixels.data(), options.width, options.height))
+    {
+        std::fprintf(stderr, "%s: cannot write %s\n", input.c_str(), output.string().c_str());
+        return false;
+    }
+    std::printf("%s -> %s (%zu nodes, %zu links)\n", input.c_str(), output.string().c_str(), editor.nodes.size(),
+                editor.links.size());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: %s [--size WxH] [--threads N] [--out DIR] graph.dot|graph.json ...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImNodes::CreateContext();
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.LogFilename = nullptr;
+    ImGui::StyleColorsDark();
+
+    // 与示例程序相同的节点外观
+    ImNodesStyle& style = ImNodes::GetStyle();
+    style.PinCircleRadius = 6.0f;
+    style.NodePadding = ImVec2(22.0f, 8.0f);
+
+    ImNodes::AddPinShapesToFontAtlas(io.Fonts);
+    ImGui_ImplSoft_Init();
+
+    std::vector<ImU32> pixels((size_t)options.width * options.height);
+    int failures = 0;
+    for (const std::string& input : options.inputs)
+    {
+        if (!RenderThumbnail(input, options, pixels))
+            failures++;
+    }
+
+    ImGui_ImplSoft_Shutdown();
+    ImNodes::DestroyContext();
+    ImGui::DestroyContext();
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
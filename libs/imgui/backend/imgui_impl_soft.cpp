@@ -0,0 +1,757 @@
+// dear imgui: Renderer Backend for CPU rasterization (no GPU, no graphics API)
+// This needs to be used along with a Platform Backend. For headless use, a "null" platform is enough:
+// set io.DisplaySize and io.DeltaTime yourself before each ImGui::NewFrame().
+
+// Implemented features:
+//  [X] Renderer: User texture binding. Use 'ImGui_ImplSoft_Texture*' as ImTextureID.
+//  [X] Renderer: Large meshes support (64k+ vertices) even with 16-bit indices (ImGuiBackendFlags_RendererHasVtxOffset).
+//  [X] Renderer: Multi-threaded rasterization over horizontal bands of the framebuffer.
+//  [X] Renderer: PNG output via ImGui_ImplSoft_WritePng().
+
+// You can use unmodified imgui_impl_* files in your project. See examples/ folder for examples of using this.
+// Prefer including the entire imgui/ repository into your project (either as a copy or as a submodule), and only build the backends you need.
+// Learn about Dear ImGui:
+// - FAQ                  https://dearimgui.com/faq
+// - Getting Started      https://dearimgui.com/getting-started
+// - Documentation        https://dearimgui.com/docs (same as your local docs/ folder).
+// - Introduction, links and more at the top of imgui.cpp
+
+// Notes about the rasterizer:
+// - Vertices are snapped to 1/16 pixel and triangles are filled with 64-bit edge functions evaluated at pixel centers.
+//   Pixels exactly on an edge belong to only one of the two triangles sharing it, so anti-aliased fringes and
+//   translucent quads are never blended twice along their diagonal.
+// - Vertex colors and UVs are interpolated with barycentric weights, textures are sampled with nearest filtering.
+// - Blending matches the other backends: color = src * src.a + dst * (1 - src.a), alpha = src.a + dst.a * (1 - src.a).
+// - The framebuffer is split into horizontal bands which worker threads claim one at a time. Triangles are culled and
+//   sorted into the bands they overlap first, in submission order, so the result does not depend on the number of threads.
+// - User callbacks are called once, from the calling thread, before rasterization starts.
+
+#if defined(_MSC_VER) && !defined(_CRT_SECURE_NO_WARNINGS)
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include "imgui.h"
+#ifndef IMGUI_DISABLE
+#include "imgui_impl_soft.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#ifndef IM_MIN
+#define IM_MIN(A, B)    (((A) < (B)) ? (A) : (B))
+#endif
+#ifndef IM_MAX
+#define IM_MAX(A, B)    (((A) >= (B)) ? (A) : (B))
+#endif
+
+// Visual Studio warnings
+#ifdef _MSC_VER
+#pragma warning (disable: 4127) // condition expression is constant
+#endif
+
+// Soft renderer data
+struct ImGui_ImplSoft_Data
+{
+    ImVector<ImU32>         FontPixels;
+    ImGui_ImplSoft_Texture  FontTexture;
+
+    ImGui_ImplSoft_Data()   { memset((void*)this, 0, sizeof(*this)); }
+};
+
+// Backend data stored in io.BackendRendererUserData to allow support for multiple Dear ImGui contexts
+// It is STRONGLY preferred that you use docking branch with multi-viewports (== single Dear ImGui context + multiple windows) instead of multiple Dear ImGui contexts.
+static ImGui_ImplSoft_Data* ImGui_ImplSoft_GetBackendData()
+{
+    return ImGui::GetCurrentContext() ? (ImGui_ImplSoft_Data*)ImGui::GetIO().BackendRendererUserData : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Rasterizer
+//-----------------------------------------------------------------------------
+
+static const int    SubpixelBits = 4;                       // Vertex positions are snapped to 1/16 pixel
+static const int    SubpixelOne = 1 << SubpixelBits;
+static const float  SubpixelRange = (float)(1 << 24);       // Keeps edge function products within 64 bits
+static const int    MinBandHeight = 16;
+
+// One draw command, flattened out of the draw lists with its offsets applied and clip rectangle in framebuffer pixels
+struct ImGui_ImplSoft_DrawJob
+{
+    const ImDrawVert*               Vtx;
+    const ImDrawIdx*                Idx;
+    unsigned int                    ElemCount;
+    int                             ClipX0, ClipY0, ClipX1, ClipY1;
+    const ImGui_ImplSoft_Texture*   Texture;
+};
+
+struct ImGui_ImplSoft_Target
+{
+    ImU32*                          Pixels;
+    int                             Width;
+    int                             Height;
+    ImVec2                          Offset;
+    ImVec2                          Scale;
+};
+
+static inline ImU32 ImGui_ImplSoft_Div255(ImU32 v)
+{
+    v += 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+static inline ImU32 ImGui_ImplSoft_Modulate(ImU32 a, ImU32 b)
+{
+    ImU32 r = ImGui_ImplSoft_Div255(((a >> IM_COL32_R_SHIFT) & 0xFF) * ((b >> IM_COL32_R_SHIFT) & 0xFF));
+    ImU32 g = ImGui_ImplSoft_Div255(((a >> IM_COL32_G_SHIFT) & 0xFF) * ((b >> IM_COL32_G_SHIFT) & 0xFF));
+    ImU32 bl = ImGui_ImplSoft_Div255(((a >> IM_COL32_B_SHIFT) & 0xFF) * ((b >> IM_COL32_B_SHIFT) & 0xFF));
+    ImU32 al = ImGui_ImplSoft_Div255(((a >> IM_COL32_A_SHIFT) & 0xFF) * ((b >> IM_COL32_A_SHIFT) & 0xFF));
+    return (r << IM_COL32_R_SHIFT) | (g << IM_COL32_G_SHIFT) | (bl << IM_COL32_B_SHIFT) | (al << IM_COL32_A_SHIFT);
+}
+
+static inline void ImGui_ImplSoft_Blend(ImU32* dst, ImU32 src)
+{
+    ImU32 sa = (src >> IM_COL32_A_SHIFT) & 0xFF;
+    if (sa == 0)
+        return;
+    if (sa == 255)
+    {
+        *dst = src;
+        return;
+    }
+    ImU32 d = *dst;
+    ImU32 ia = 255 - sa;
+    ImU32 r = ImGui_ImplSoft_Div255(((src >> IM_COL32_R_SHIFT) & 0xFF) * sa + ((d >> IM_COL32_R_SHIFT) & 0xFF) * ia);
+    ImU32 g = ImGui_ImplSoft_Div255(((src >> IM_COL32_G_SHIFT) & 0xFF) * sa + ((d >> IM_COL32_G_SHIFT) & 0xFF) * ia);
+    ImU32 b = ImGui_ImplSoft_Div255(((src >> IM_COL32_B_SHIFT) & 0xFF) * sa + ((d >> IM_COL32_B_SHIFT) & 0xFF) * ia);
+    ImU32 a = sa + ImGui_ImplSoft_Div255(((d >> IM_COL32_A_SHIFT) & 0xFF) * ia);
+    *dst = (r << IM_COL32_R_SHIFT) | (g << IM_COL32_G_SHIFT) | (b << IM_COL32_B_SHIFT) | (a << IM_COL32_A_SHIFT);
+}
+
+static inline ImU32 ImGui_ImplSoft_Sample(const ImGui_ImplSoft_Texture* tex, float u, float v)
+{
+    int x = (int)(u * tex->Width);
+    int y = (int)(v * tex->Height);
+    x = x < 0 ? 0 : (x >= tex->Width ? tex->Width - 1 : x);
+    y = y < 0 ? 0 : (y >= tex->Height ? tex->Height - 1 : y);
+    return tex->Pixels[y * tex->Width + x];
+}
+
+static inline int64_t ImGui_ImplSoft_Snap(float v)
+{
+    v = v < -SubpixelRange ? -SubpixelRange : (v > SubpixelRange ? SubpixelRange : v);
+    return (int64_t)(v * SubpixelOne + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline int64_t ImGui_ImplSoft_Edge(int64_t ax, int64_t ay, int64_t bx, int64_t by, int64_t px, int64_t py)
+{
+    return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+// Pixels exactly on an edge are owned by the edge if it points down, or right when horizontal.
+// Two triangles sharing an edge walk it in opposite directions, so exactly one of them owns those pixels.
+static inline int64_t ImGui_ImplSoft_EdgeBias(int64_t ax, int64_t ay, int64_t bx, int64_t by)
+{
+    int64_t dx = bx - ax, dy = by - ay;
+    return (dy > 0 || (dy == 0 && dx > 0)) ? 0 : -1;
+}
+
+static void ImGui_ImplSoft_RasterizeTriangle(const ImGui_ImplSoft_Target& target, const ImGui_ImplSoft_DrawJob& job, const ImDrawVert* v0, const ImDrawVert* v1, const ImDrawVert* v2, int band_y0, int band_y1)
+{
+    // Snap to subpixel grid in framebuffer space
+    int64_t x0 = ImGui_ImplSoft_Snap((v0->pos.x - target.Offset.x) * target.Scale.x), y0 = ImGui_ImplSoft_Snap((v0->pos.y - target.Offset.y) * target.Scale.y);
+    int64_t x1 = ImGui_ImplSoft_Snap((v1->pos.x - target.Offset.x) * target.Scale.x), y1 = ImGui_ImplSoft_Snap((v1->pos.y - target.Offset.y) * target.Scale.y);
+    int64_t x2 = ImGui_ImplSoft_Snap((v2->pos.x - target.Offset.x) * target.Scale.x), y2 = ImGui_ImplSoft_Snap((v2->pos.y - target.Offset.y) * target.Scale.y);
+
+    // Bounding box of pixel centers, clipped to the clip rectangle and the band
+    int64_t min_x = IM_MIN(x0, IM_MIN(x1, x2)), max_x = IM_MAX(x0, IM_MAX(x1, x2));
+    int64_t min_y = IM_MIN(y0, IM_MIN(y1, y2)), max_y = IM_MAX(y0, IM_MAX(y1, y2));
+    int64_t px0 = IM_MAX((int64_t)IM_MAX(job.ClipX0, 0), (min_x - SubpixelOne / 2 + SubpixelOne - 1) >> SubpixelBits);
+    int64_t px1 = IM_MIN((int64_t)IM_MIN(job.ClipX1, target.Width) - 1, (max_x - SubpixelOne / 2) >> SubpixelBits);
+    int64_t py0 = IM_MAX((int64_t)IM_MAX(job.ClipY0, band_y0), (min_y - SubpixelOne / 2 + SubpixelOne - 1) >> SubpixelBits);
+    int64_t py1 = IM_MIN((int64_t)IM_MIN(job.ClipY1, band_y1) - 1, (max_y - SubpixelOne / 2) >> SubpixelBits);
+    if (px0 > px1 || py0 > py1)
+        return;
+
+    // Counter-clockwise triangles (in y-down space) are flipped so that inside is always positive
+    int64_t area = ImGui_ImplSoft_Edge(x0, y0, x1, y1, x2, y2);
+    if (area == 0)
+        return;
+    if (area < 0)
+    {
+        int64_t tx = x1; x1 = x2; x2 = tx;
+        int64_t ty = y1; y1 = y2; y2 = ty;
+        const ImDrawVert* tv = v1; v1 = v2; v2 = tv;
+        area = -area;
+    }
+
+    // Edge functions at the first pixel center and their per-pixel steps
+    const int64_t sx = (px0 << SubpixelBits) + SubpixelOne / 2;
+    const int64_t sy = (py0 << SubpixelBits) + SubpixelOne / 2;
+    int64_t row0 = ImGui_ImplSoft_Edge(x1, y1, x2, y2, sx, sy);
+    int64_t row1 = ImGui_ImplSoft_Edge(x2, y2, x0, y0, sx, sy);
+    int64_t row2 = ImGui_ImplSoft_Edge(x0, y0, x1, y1, sx, sy);
+    const int64_t step_x0 = (y1 - y2) * SubpixelOne, step_y0 = (x2 - x1) * SubpixelOne;
+    const int64_t step_x1 = (y2 - y0) * SubpixelOne, step_y1 = (x0 - x2) * SubpixelOne;
+    const int64_t step_x2 = (y0 - y1) * SubpixelOne, step_y2 = (x1 - x0) * SubpixelOne;
+    const int64_t bias0 = ImGui_ImplSoft_EdgeBias(x1, y1, x2, y2);
+    const int64_t bias1 = ImGui_ImplSoft_EdgeBias(x2, y2, x0, y0);
+    const int64_t bias2 = ImGui_ImplSoft_EdgeBias(x0, y0, x1, y1);
+
+    // Most of ImGui's geometry is solid: same color on all vertices and the white pixel of the font atlas as UV
+    const ImGui_ImplSoft_Texture* tex = job.Texture;
+    const bool flat_col = v0->col == v1->col && v0->col == v2->col;
+    const bool flat_uv = tex == nullptr || (v0->uv.x == v1->uv.x && v0->uv.x == v2->uv.x && v0->uv.y == v1->uv.y && v0->uv.y == v2->uv.y);
+    const float inv_area = 1.0f / (float)area;
+    ImVec4 c0, c1, c2;
+    if (!flat_col)
+    {
+        c0 = ImGui::ColorConvertU32ToFloat4(v0->col);
+        c1 = ImGui::ColorConvertU32ToFloat4(v1->col);
+        c2 = ImGui::ColorConvertU32ToFloat4(v2->col);
+    }
+    ImU32 flat_src = v0->col;
+    if (flat_uv && tex != nullptr)
+        flat_src = ImGui_ImplSoft_Modulate(v0->col, ImGui_ImplSoft_Sample(tex, v0->uv.x, v0->uv.y));
+
+    for (int64_t y = py0; y <= py1; y++, row0 += step_y0, row1 += step_y1, row2 += step_y2)
+    {
+        ImU32* dst = target.Pixels + (size_t)y * target.Width;
+        int64_t w0 = row0, w1 = row1, w2 = row2;
+        for (int64_t x = px0; x <= px1; x++, w0 += step_x0, w1 += step_x1, w2 += step_x2)
+        {
+            if (((w0 + bias0) | (w1 + bias1) | (w2 + bias2)) < 0)
+                continue;
+            if (flat_col && flat_uv)
+            {
+                ImGui_ImplSoft_Blend(&dst[x], flat_src);
+                continue;
+            }
+            const float b1 = (float)w1 * inv_area;
+            const float b2 = (float)w2 * inv_area;
+            ImU32 src = flat_src;
+            if (!flat_col)
+                src = ImGui::ColorConvertFloat4ToU32(ImVec4(
+                    c0.x + (c1.x - c0.x) * b1 + (c2.x - c0.x) * b2,
+                    c0.y + (c1.y - c0.y) * b1 + (c2.y - c0.y) * b2,
+                    c0.z + (c1.z - c0.z) * b1 + (c2.z - c0.z) * b2,
+                    c0.w + (c1.w - c0.w) * b1 + (c2.w - c0.w) * b2));
+            if (!flat_uv)
+            {
+                const float u = v0->uv.x + (v1->uv.x - v0->uv.x) * b1 + (v2->uv.x - v0->uv.x) * b2;
+                const float v = v0->uv.y + (v1->uv.y - v0->uv.y) * b1 + (v2->uv.y - v0->uv.y) * b2;
+                src = ImGui_ImplSoft_Modulate(src, ImGui_ImplSoft_Sample(tex, u, v));
+            }
+            else if (tex != nullptr && !flat_col)
+            {
+                src = ImGui_ImplSoft_Modulate(src, ImGui_ImplSoft_Sample(tex, v0->uv.x, v0->uv.y));
+            }
+            ImGui_ImplSoft_Blend(&dst[x], src);
+        }
+    }
+}
+
+// Triangle that survived culling, with the range of bands it touches
+struct ImGui_ImplSoft_BinnedTriangle
+{
+    int                             Job;
+    unsigned int                    Elem;
+    int                             Band0, Band1;
+};
+
+// Culls triangles against their clip rectangle once, then sorts them into per-band lists (keeping submission order)
+// so that each band only walks the triangles which overlap it.
+static void ImGui_ImplSoft_BinTriangles(const ImGui_ImplSoft_Target& target, const ImVector<ImGui_ImplSoft_DrawJob>& jobs, int band_height, int bands_count, ImVector<ImGui_ImplSoft_BinnedTriangle>& triangles, ImVector<int>& band_starts, ImVector<int>& band_triangles)
+{
+    band_starts.resize(bands_count + 1);
+    memset(band_starts.Data, 0, (size_t)band_starts.size_in_bytes());
+    for (int job_n = 0; job_n < jobs.Size; job_n++)
+    {
+        const ImGui_ImplSoft_DrawJob& job = jobs[job_n];
+        for (unsigned int i = 0; i + 2 < job.ElemCount; i += 3)
+        {
+            const ImVec2& p0 = job.Vtx[job.Idx[i]].pos;
+            const ImVec2& p1 = job.Vtx[job.Idx[i + 1]].pos;
+            const ImVec2& p2 = job.Vtx[job.Idx[i + 2]].pos;
+            const float min_x = (IM_MIN(p0.x, IM_MIN(p1.x, p2.x)) - target.Offset.x) * target.Scale.x;
+            const float max_x = (IM_MAX(p0.x, IM_MAX(p1.x, p2.x)) - target.Offset.x) * target.Scale.x;
+            const float min_y = (IM_MIN(p0.y, IM_MIN(p1.y, p2.y)) - target.Offset.y) * target.Scale.y;
+            const float max_y = (IM_MAX(p0.y, IM_MAX(p1.y, p2.y)) - target.Offset.y) * target.Scale.y;
+            if (!(max_x >= (float)job.ClipX0 && min_x < (float)job.ClipX1 && max_y >= (float)job.ClipY0 && min_y < (float)job.ClipY1))
+                continue;
+            ImGui_ImplSoft_BinnedTriangle tri;
+            tri.Job = job_n;
+            tri.Elem = i;
+            tri.Band0 = (int)IM_MAX(min_y, (float)job.ClipY0) / band_height;
+            tri.Band1 = (int)IM_MIN(max_y, (float)(job.ClipY1 - 1)) / band_height;
+            for (int band = tri.Band0; band <= tri.Band1; band++)
+                band_starts[band + 1]++;
+            triangles.push_back(tri);
+        }
+    }
+    for (int band = 0; band < bands_count; band++)
+        band_starts[band + 1] += band_starts[band];
+
+    ImVector<int> fill;
+    fill.resize(bands_count);
+    memcpy(fill.Data, band_starts.Data, (size_t)fill.size_in_bytes());
+    band_triangles.resize(band_starts[bands_count]);
+    for (int n = 0; n < triangles.Size; n++)
+        for (int band = triangles[n].Band0; band <= triangles[n].Band1; band++)
+            band_triangles[fill[band]++] = n;
+}
+
+static void ImGui_ImplSoft_RasterizeBand(const ImGui_ImplSoft_Target& target, const ImVector<ImGui_ImplSoft_DrawJob>& jobs, const ImGui_ImplSoft_BinnedTriangle* triangles, const int* indices, int count, int band_y0, int band_y1)
+{
+    for (int n = 0; n < count; n++)
+    {
+        const ImGui_ImplSoft_BinnedTriangle& tri = triangles[indices[n]];
+        const ImGui_ImplSoft_DrawJob& job = jobs[tri.Job];
+        const ImDrawIdx* idx = job.Idx + tri.Elem;
+        ImGui_ImplSoft_RasterizeTriangle(target, job, &job.Vtx[idx[0]], &job.Vtx[idx[1]], &job.Vtx[idx[2]], band_y0, band_y1);
+    }
+}
+
+void ImGui_ImplSoft_RenderDrawData(ImDrawData* draw_data, ImU32* pixels, int width, int height, ImU32 clear_color, int threads_count)
+{
+    if (pixels == nullptr || width <= 0 || height <= 0)
+        return;
+    for (size_t i = 0, count = (size_t)width * height; i < count; i++)
+        pixels[i] = clear_color;
+
+    ImGui_ImplSoft_Data* bd = ImGui_ImplSoft_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplSoft_Init()?");
+    IM_UNUSED(bd);
+
+    ImGui_ImplSoft_Target target;
+    target.Pixels = pixels;
+    target.Width = width;
+    target.Height = height;
+    target.Offset = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
+    target.Scale = draw_data->FramebufferScale;    // (1,1) unless using retina display which are often (2,2)
+
+    // Flatten draw commands, project clipping rectangles into framebuffer space and run callbacks
+    ImVector<ImGui_ImplSoft_DrawJob> jobs;
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* draw_list = draw_data->CmdLists[n];
+        for (int cmd_i = 0; cmd_i < draw_list->CmdBuffer.Size; cmd_i++)
+        {
+            const ImDrawCmd* pcmd = &draw_list->CmdBuffer[cmd_i];
+            if (pcmd->UserCallback != nullptr)
+            {
+                // User callback, registered via ImDrawList::AddCallback()
+                // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer to reset render state.
+                // This renderer has no state to reset.)
+                if (pcmd->UserCallback != ImDrawCallback_ResetRenderState)
+                    pcmd->UserCallback(draw_list, pcmd);
+                continue;
+            }
+
+            ImVec2 clip_min((pcmd->ClipRect.x - target.Offset.x) * target.Scale.x, (pcmd->ClipRect.y - target.Offset.y) * target.Scale.y);
+            ImVec2 clip_max((pcmd->ClipRect.z - target.Offset.x) * target.Scale.x, (pcmd->ClipRect.w - target.Offset.y) * target.Scale.y);
+            if (clip_min.x < 0.0f) { clip_min.x = 0.0f; }
+            if (clip_min.y < 0.0f) { clip_min.y = 0.0f; }
+            if (clip_max.x > width) { clip_max.x = (float)width; }
+            if (clip_max.y > height) { clip_max.y = (float)height; }
+            if (clip_max.x <= clip_min.x || clip_max.y <= clip_min.y)
+                continue;
+
+            ImGui_ImplSoft_DrawJob job;
+            job.Vtx = draw_list->VtxBuffer.Data + pcmd->VtxOffset;
+            job.Idx = draw_list->IdxBuffer.Data + pcmd->IdxOffset;
+            job.ElemCount = pcmd->ElemCount;
+            job.ClipX0 = (int)clip_min.x;
+            job.ClipY0 = (int)clip_min.y;
+            job.ClipX1 = (int)clip_max.x;
+            job.ClipY1 = (int)clip_max.y;
+            job.Texture = (const ImGui_ImplSoft_Texture*)(intptr_t)pcmd->GetTexID();
+            jobs.push_back(job);
+        }
+    }
+    if (jobs.empty())
+        return;
+
+    // Split the framebuffer into a few bands per thread so that busy areas get shared out
+    if (threads_count <= 0)
+        threads_count = (int)std::thread::hardware_concurrency();
+    threads_count = IM_MIN(IM_MAX(threads_count, 1), IM_MAX(1, height / MinBandHeight));
+    const int band_height = IM_MAX(MinBandHeight, (height + threads_count * 4 - 1) / (threads_count * 4));
+    const int bands_count = (height + band_height - 1) / band_height;
+    ImVector<ImGui_ImplSoft_BinnedTriangle> triangles;
+    ImVector<int> band_starts, band_triangles;
+    ImGui_ImplSoft_BinTriangles(target, jobs, band_height, bands_count, triangles, band_starts, band_triangles);
+    if (triangles.empty())
+        return;
+
+    std::atomic<int> next_band(0);
+    auto worker = [&]()
+    {
+        for (int band = next_band++; band < bands_count; band = next_band++)
+        {
+            const int first = band_starts[band];
+            ImGui_ImplSoft_RasterizeBand(target, jobs, triangles.Data, band_triangles.Data + first, band_starts[band + 1] - first, band * band_height, IM_MIN(height, (band + 1) * band_height));
+        }
+    };
+
+    ImVector<std::thread*> threads;
+    for (int i = 1; i < threads_count; i++)
+        threads.push_back(IM_NEW(std::thread)(worker));
+    worker();
+    for (std::thread* thread : threads)
+    {
+        thread->join();
+        IM_DELETE(thread);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Fonts texture
+//-----------------------------------------------------------------------------
+
+bool ImGui_ImplSoft_CreateFontsTexture()
+{
+    ImGuiIO& io = ImGui::GetIO();
+    ImGui_ImplSoft_Data* bd = ImGui_ImplSoft_GetBackendData();
+
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    bd->FontPixels.resize(width * height);
+    for (int i = 0; i < width * height; i++, pixels += 4)
+        bd->FontPixels[i] = IM_COL32(pixels[0], pixels[1], pixels[2], pixels[3]);
+    bd->FontTexture.Pixels = bd->FontPixels.Data;
+    bd->FontTexture.Width = width;
+    bd->FontTexture.Height = height;
+
+    // Store our identifier
+    io.Fonts->SetTexID((ImTextureID)(intptr_t)&bd->FontTexture);
+    return true;
+}
+
+// You probably never need to call this, as it is called by ImGui_ImplSoft_Shutdown().
+void ImGui_ImplSoft_DestroyFontsTexture()
+{
+    ImGuiIO& io = ImGui::GetIO();
+    ImGui_ImplSoft_Data* bd = ImGui_ImplSoft_GetBackendData();
+    bd->FontPixels.clear();
+    bd->FontTexture.Pixels = nullptr;
+    io.Fonts->SetTexID(0);
+}
+
+//-----------------------------------------------------------------------------
+// PNG writer
+//-----------------------------------------------------------------------------
+// Self-contained: a zlib stream made of a single fixed-Huffman deflate block fed by a greedy LZ77 matcher.
+// UI screenshots are mostly flat colors, which the per-row filters turn into long runs that match well.
+
+struct ImGui_ImplSoft_BitWriter
+{
+    ImVector<unsigned char>* Out;
+    ImU32                   Bits;
+    int                     Count;
+
+    void Put(ImU32 value, int count)
+    {
+        Bits |= value << Count;
+        Count += count;
+        while (Count >= 8)
+        {
+            Out->push_back((unsigned char)(Bits & 0xFF));
+            Bits >>= 8;
+            Count -= 8;
+        }
+    }
+    // Huffman codes are stored most significant bit first
+    void PutCode(ImU32 code, int count)
+    {
+        ImU32 reversed = 0;
+        for (int i = 0; i < count; i++)
+            reversed |= ((code >> i) & 1) << (count - 1 - i);
+        Put(reversed, count);
+    }
+    void Flush()
+    {
+        if (Count > 0)
+            Out->push_back((unsigned char)(Bits & 0xFF));
+        Bits = 0;
+        Count = 0;
+    }
+};
+
+static void ImGui_ImplSoft_PutLiteral(ImGui_ImplSoft_BitWriter& w, int symbol)
+{
+    if (symbol < 144)       w.PutCode(0x30 + symbol, 8);
+    else if (symbol < 256)  w.PutCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280)  w.PutCode(symbol - 256, 7);
+    else                    w.PutCode(0xC0 + symbol - 280, 8);
+}
+
+static void ImGui_ImplSoft_PutMatch(ImGui_ImplSoft_BitWriter& w, int length, int distance)
+{
+    static const short length_base[29] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+    static const unsigned char length_extra[29] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+    static const unsigned short dist_base[30] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+    static const unsigned char dist_extra[30] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+    int l = 28;
+    while (length_base[l] > length)
+        l--;
+    ImGui_ImplSoft_PutLiteral(w, 257 + l);
+    w.Put(length - length_base[l], length_extra[l]);
+    int d = 29;
+    while (dist_base[d] > distance)
+        d--;
+    w.PutCode(d, 5);
+    w.Put(distance - dist_base[d], dist_extra[d]);
+}
+
+static void ImGui_ImplSoft_Deflate(const unsigned char* data, int size, ImVector<unsigned char>& out)
+{
+    const int window = 32768, min_match = 3, max_match = 258, max_chain = 32;
+    const int hash_bits = 15, hash_size = 1 << hash_bits;
+    ImVector<int> head, prev;
+    head.resize(hash_size);
+    prev.resize(window);
+    for (int& h : head)
+        h = -1;
+
+    out.push_back(0x78);    // zlib header: deflate, 32K window
+    out.push_back(0x01);
+    ImGui_ImplSoft_BitWriter w = { &out, 0, 0 };
+    w.Put(1, 1);            // BFINAL
+    w.Put(1, 2);            // BTYPE = fixed Huffman
+
+    auto hash = [&](int pos) { return (int)(((ImU32)data[pos] << 16 | (ImU32)data[pos + 1] << 8 | data[pos + 2]) * 2654435761u >> (32 - hash_bits)); };
+    auto insert = [&](int pos)
+    {
+        if (pos + min_match > size)
+            return;
+        int h = hash(pos);
+        prev[pos & (window - 1)] = head[h];
+        head[h] = pos;
+    };
+
+    int pos = 0;
+    while (pos < size)
+    {
+        int best_len = 0, best_dist = 0;
+        if (pos + min_match <= size)
+        {
+            const int limit = IM_MIN(max_match, size - pos);
+            int candidate = head[hash(pos)];
+            for (int chain = 0; candidate >= 0 && pos - candidate <= window && chain < max_chain; chain++)
+            {
+                if (data[candidate + best_len] == data[pos + best_len])
+                {
+                    int len = 0;
+                    while (len < limit && data[candidate + len] == data[pos + len])
+                        len++;
+                    if (len > best_len)
+                    {
+                        best_len = len;
+                        best_dist = pos - candidate;
+                        if (len == limit)
+                            break;
+                    }
+                }
+                const int next = prev[candidate & (window - 1)];
+                if (next >= candidate)
+                    break;
+                candidate = next;
+            }
+        }
+        if (best_len >= min_match)
+        {
+            ImGui_ImplSoft_PutMatch(w, best_len, best_dist);
+            for (int i = 0; i < best_len; i++)
+                insert(pos + i);
+            pos += best_len;
+        }
+        else
+        {
+            ImGui_ImplSoft_PutLiteral(w, data[pos]);
+            insert(pos);
+            pos++;
+        }
+    }
+    ImGui_ImplSoft_PutLiteral(w, 256);
+    w.Flush();
+
+    ImU32 a = 1, b = 0;
+    for (int i = 0; i < size; i++)
+    {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    const ImU32 adler = (b << 16) | a;
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back((unsigned char)(adler >> shift));
+}
+
+static ImU32 ImGui_ImplSoft_Crc32(ImU32 crc, const unsigned char* data, int size)
+{
+    static ImU32 table[256] = {};
+    static bool table_ready = [] {
+        for (ImU32 n = 0; n < 256; n++)
+        {
+            ImU32 c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        return true;
+    }();
+    IM_UNUSED(table_ready);
+    crc = ~crc;
+    for (int i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void ImGui_ImplSoft_PutBE32(ImVector<unsigned char>& out, ImU32 v)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back((unsigned char)(v >> shift));
+}
+
+static void ImGui_ImplSoft_PutChunk(ImVector<unsigned char>& png, const char* type, const ImVector<unsigned char>& data)
+{
+    ImGui_ImplSoft_PutBE32(png, (ImU32)data.Size);
+    const int start = png.Size;
+    for (int i = 0; i < 4; i++)
+        png.push_back((unsigned char)type[i]);
+    png.resize(png.Size + data.Size);
+    if (data.Size > 0)
+        memcpy(png.Data + start + 4, data.Data, data.Size);
+    ImGui_ImplSoft_PutBE32(png, ImGui_ImplSoft_Crc32(0, png.Data + start, data.Size + 4));
+}
+
+static inline int ImGui_ImplSoft_Paeth(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+}
+
+bool ImGui_ImplSoft_WritePng(const char* filename, const ImU32* pixels, int width, int height)
+{
+    if (filename == nullptr || pixels == nullptr || width <= 0 || height <= 0)
+        return false;
+
+    // Unpack to RGBA bytes, then filter each row with whichever filter gives the smallest sum of absolute residuals
+    const int stride = width * 4;
+    ImVector<unsigned char> rgba, filtered, candidate;
+    rgba.resize(stride * height);
+    for (int i = 0; i < width * height; i++)
+    {
+        rgba[i * 4 + 0] = (unsigned char)(pixels[i] >> IM_COL32_R_SHIFT);
+        rgba[i * 4 + 1] = (unsigned char)(pixels[i] >> IM_COL32_G_SHIFT);
+        rgba[i * 4 + 2] = (unsigned char)(pixels[i] >> IM_COL32_B_SHIFT);
+        rgba[i * 4 + 3] = (unsigned char)(pixels[i] >> IM_COL32_A_SHIFT);
+    }
+    filtered.resize((stride + 1) * height);
+    candidate.resize(stride);
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* row = rgba.Data + y * stride;
+        const unsigned char* up = y > 0 ? row - stride : nullptr;
+        unsigned char* dst = filtered.Data + y * (stride + 1);
+        int best_sum = -1;
+        for (int filter = 0; filter < 5; filter++)
+        {
+            int sum = 0;
+            for (int i = 0; i < stride; i++)
+            {
+                const int a = i >= 4 ? row[i - 4] : 0;
+                const int b = up ? up[i] : 0;
+                const int c = (up && i >= 4) ? up[i - 4] : 0;
+                int predicted = 0;
+                switch (filter)
+                {
+                case 1: predicted = a; break;
+                case 2: predicted = b; break;
+                case 3: predicted = (a + b) >> 1; break;
+                case 4: predicted = ImGui_ImplSoft_Paeth(a, b, c); break;
+                }
+                candidate[i] = (unsigned char)(row[i] - predicted);
+                sum += abs((int)(signed char)candidate[i]);
+            }
+            if (best_sum < 0 || sum < best_sum)
+            {
+                best_sum = sum;
+                dst[0] = (unsigned char)filter;
+                memcpy(dst + 1, candidate.Data, stride);
+            }
+        }
+    }
+
+    ImVector<unsigned char> png, header, compressed, empty;
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    png.resize(8);
+    memcpy(png.Data, signature, 8);
+    ImGui_ImplSoft_PutBE32(header, (ImU32)width);
+    ImGui_ImplSoft_PutBE32(header, (ImU32)height);
+    header.push_back(8);    // Bit depth
+    header.push_back(6);    // Color type: RGBA
+    header.push_back(0);    // Compression
+    header.push_back(0);    // Filter
+    header.push_back(0);    // Interlace
+    ImGui_ImplSoft_PutChunk(png, "IHDR", header);
+    ImGui_ImplSoft_Deflate(filtered.Data, filtered.Size, compressed);
+    ImGui_ImplSoft_PutChunk(png, "IDAT", compressed);
+    ImGui_ImplSoft_PutChunk(png, "IEND", empty);
+
+    FILE* f = fopen(filename, "wb");
+    if (f == nullptr)
+        return false;
+    const bool ok = fwrite(png.Data, 1, png.Size, f) == (size_t)png.Size;
+    return fclose(f) == 0 && ok;
+}
+
+//-----------------------------------------------------------------------------
+// Init / Shutdown
+//-----------------------------------------------------------------------------
+
+bool ImGui_ImplSoft_Init()
+{
+    ImGuiIO& io = ImGui::GetIO();
+    IMGUI_CHECKVERSION();
+    IM_ASSERT(io.BackendRendererUserData == nullptr && "Already initialized a renderer backend!");
+
+    // Setup backend capabilities flags
+    ImGui_ImplSoft_Data* bd = IM_NEW(ImGui_ImplSoft_Data)();
+    io.BackendRendererUserData = (void*)bd;
+    io.BackendRendererName = "imgui_impl_soft";
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;  // We can honor the ImDrawCmd::VtxOffset field, allowing for large meshes.
+
+    ImGui_ImplSoft_CreateFontsTexture();
+    return true;
+}
+
+void ImGui_ImplSoft_Shutdown()
+{
+    ImGui_ImplSoft_Data* bd = ImGui_ImplSoft_GetBackendData();
+    IM_ASSERT(bd != nullptr && "No renderer backend to shutdown, or already shutdown?");
+    ImGuiIO& io = ImGui::GetIO();
+
+    ImGui_ImplSoft_DestroyFontsTexture();
+    io.BackendRendererName = nullptr;
+    io.BackendRendererUserData = nullptr;
+    io.BackendFlags &= ~ImGuiBackendFlags_RendererHasVtxOffset;
+    IM_DELETE(bd);
+}
+
+void ImGui_ImplSoft_NewFrame()
+{
+    ImGui_ImplSoft_Data* bd = ImGui_ImplSoft_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplSoft_Init()?");
+
+    if (bd->FontTexture.Pixels == nullptr)
+        ImGui_ImplSoft_CreateFontsTexture();
+}
+
+//-----------------------------------------------------------------------------
+
+#endif // #ifndef IMGUI_DISABLE
@@ -0,0 +1,42 @@
+// dear imgui: Renderer Backend for CPU rasterization (no GPU, no graphics API)
+// This needs to be used along with a Platform Backend. For headless use, a "null" platform is enough:
+// set io.DisplaySize and io.DeltaTime yourself before each ImGui::NewFrame().
+
+// Implemented features:
+//  [X] Renderer: User texture binding. Use 'ImGui_ImplSoft_Texture*' as ImTextureID.
+//  [X] Renderer: Large meshes support (64k+ vertices) even with 16-bit indices (ImGuiBackendFlags_RendererHasVtxOffset).
+//  [X] Renderer: Multi-threaded rasterization over horizontal bands of the framebuffer.
+//  [X] Renderer: PNG output via ImGui_ImplSoft_WritePng().
+
+// Triangles are rasterized with fixed-point edge functions (1/16 pixel) and a consistent fill rule, so
+// triangles sharing an edge never blend a pixel twice. Textures are sampled with nearest filtering, and
+// pixels are blended as non-premultiplied alpha (the same blend state as the GPU backends).
+
+#pragma once
+#include "imgui.h"      // IMGUI_IMPL_API
+#ifndef IMGUI_DISABLE
+
+// Texture in the format of the framebuffer: one ImU32 per pixel, laid out as IM_COL32().
+struct ImGui_ImplSoft_Texture
+{
+    const ImU32*    Pixels;
+    int             Width;
+    int             Height;
+};
+
+// Follow "Getting Started" link and check examples/ folder to learn about using backends!
+IMGUI_IMPL_API bool     ImGui_ImplSoft_Init();
+IMGUI_IMPL_API void     ImGui_ImplSoft_Shutdown();
+IMGUI_IMPL_API void     ImGui_ImplSoft_NewFrame();
+// Clears 'pixels' (width * height ImU32, laid out as IM_COL32()) to clear_color and rasterizes draw_data
+// into it. The framebuffer is split into bands rendered by 'threads_count' threads (0: one per core).
+IMGUI_IMPL_API void     ImGui_ImplSoft_RenderDrawData(ImDrawData* draw_data, ImU32* pixels, int width, int height, ImU32 clear_color, int threads_count = 0);
+
+// (Optional) Called by Init/NewFrame/Shutdown
+IMGUI_IMPL_API bool     ImGui_ImplSoft_CreateFontsTexture();
+IMGUI_IMPL_API void     ImGui_ImplSoft_DestroyFontsTexture();
+
+// Writes pixels (laid out as IM_COL32()) to an RGBA PNG file.
+IMGUI_IMPL_API bool     ImGui_ImplSoft_WritePng(const char* filename, const ImU32* pixels, int width, int height);
+
+#endif // #ifndef IMGUI_DISABLE
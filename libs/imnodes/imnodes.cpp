@@ -4,6 +4,7 @@
 // [SECTION] draw list helper
 // [SECTION] ui state logic
 // [SECTION] render helpers
+// [SECTION] link batch renderer
 // [SECTION] API implementation
 
 #include "imnodes_internal.h"
@@ -14,17 +15,55 @@
 #error "Minimum ImGui version requirement not met -- please use a newer version!"
 #endif
 
+#include <charconv> // std::from_chars, std::to_chars
+#include <condition_variable>
+#include <deque>
 #include <limits.h>
 #include <math.h>
+#include <memory>
+#include <mutex>
 #include <new>
 #include <stdint.h>
-#include <stdio.h> // for fwrite, ssprintf, sscanf
+#include <stdio.h> // for fwrite
 #include <stdlib.h>
-#include <string.h> // strlen, strncmp
+#include <string.h> // strlen, memcmp
+#include <string>
+#include <thread>
+
+// Platform file APIs, used to memory-map binary editor states and to flush asynchronous saves to
+// disk. Define IMNODES_DISABLE_MMAP to read binary editor states into a heap buffer instead.
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <io.h> // _commit
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if !defined(IMNODES_DISABLE_MMAP) && (defined(_WIN32) || defined(__unix__) || defined(__APPLE__))
+#define IMNODES_ENABLE_MMAP
+#endif
 
-// Use secure CRT function variants to avoid MSVC compiler errors
-#ifdef _MSC_VER
-#define sscanf sscanf_s
+// SIMD instruction sets used by the link batch renderer. Define IMNODES_DISABLE_SIMD to compile only
+// the scalar kernel.
+#if !defined(IMNODES_DISABLE_SIMD)
+#if defined(__AVX__)
+#define IMNODES_ENABLE_AVX
+#include <immintrin.h>
+#elif defined(IMGUI_ENABLE_SSE)
+#define IMNODES_ENABLE_SSE
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+#define IMNODES_ENABLE_NEON
+#include <arm_neon.h>
+#endif
 #endif
 
 ImNodesContext* GImNodes = NULL;
@@ -302,157 +341,102 @@ inline ImRect ScreenSpaceToMiniMapSpace(const ImNodesEditorContext& editor, cons
         ScreenSpaceToMiniMapSpace(editor, r.Min), ScreenSpaceToMiniMapSpace(editor, r.Max));
 }
 
-// [SECTION] draw list helper
-
-void ImDrawListGrowChannels(ImDrawList* draw_list, const int num_channels)
+// The cached mini-map contents are relative to the top-left corner of the mini-map, so that they
+// don't depend on the editor's position or panning.
+inline ImVec2 GridSpaceToMiniMapCacheSpace(const ImNodesEditorContext& editor, const ImVec2& v)
 {
-    ImDrawListSplitter& splitter = draw_list->_Splitter;
-
-    if (splitter._Count == 1)
-    {
-        splitter.Split(draw_list, num_channels + 1);
-        return;
-    }
-
-    // NOTE: this logic has been lifted from ImDrawListSplitter::Split with slight modifications
-    // to allow nested splits. The main modification is that we only create new ImDrawChannel
-    // instances after splitter._Count, instead of over the whole splitter._Channels array like
-    // the regular ImDrawListSplitter::Split method does.
-
-    const int old_channel_capacity = splitter._Channels.Size;
-    // NOTE: _Channels is not resized down, and therefore _Count <= _Channels.size()!
-    const int old_channel_count = splitter._Count;
-    const int requested_channel_count = old_channel_count + num_channels;
-    if (old_channel_capacity < old_channel_count + num_channels)
-    {
-        splitter._Channels.resize(requested_channel_count);
-    }
-
-    splitter._Count = requested_channel_count;
-
-    for (int i = old_channel_count; i < requested_channel_count; ++i)
-    {
-        ImDrawChannel& channel = splitter._Channels[i];
-
-        // If we're inside the old capacity region of the array, we need to reuse the existing
-        // memory of the command and index buffers.
-        if (i < old_channel_capacity)
-        {
-            channel._CmdBuffer.resize(0);
-            channel._IdxBuffer.resize(0);
-        }
-        // Else, we need to construct new draw channels.
-        else
-        {
-            IM_PLACEMENT_NEW(&channel) ImDrawChannel();
-        }
-
-        {
-            ImDrawCmd draw_cmd;
-            draw_cmd.ClipRect = draw_list->_ClipRectStack.back();
-            draw_cmd.TextureId = draw_list->_TextureIdStack.back();
-            channel._CmdBuffer.push_back(draw_cmd);
-        }
-    }
+    return (v - editor.GridContentBounds.Min) * editor.MiniMapScaling +
+           (editor.MiniMapContentScreenSpace.Min - editor.MiniMapRectScreenSpace.Min);
 }
 
-void ImDrawListSplitterSwapChannels(
-    ImDrawListSplitter& splitter,
-    const int           lhs_idx,
-    const int           rhs_idx)
-{
-    if (lhs_idx == rhs_idx)
-    {
-        return;
-    }
-
-    IM_ASSERT(lhs_idx >= 0 && lhs_idx < splitter._Count);
-    IM_ASSERT(rhs_idx >= 0 && rhs_idx < splitter._Count);
-
-    ImDrawChannel& lhs_channel = splitter._Channels[lhs_idx];
-    ImDrawChannel& rhs_channel = splitter._Channels[rhs_idx];
-    lhs_channel._CmdBuffer.swap(rhs_channel._CmdBuffer);
-    lhs_channel._IdxBuffer.swap(rhs_channel._IdxBuffer);
+// [SECTION] draw list helper
 
-    const int current_channel = splitter._Current;
+// The draw list channels are structured as follows. First we have our base channel, the canvas grid
+// on which we render the grid lines in BeginNodeEditor(), and on top of which the links are
+// rendered in EndNodeEditor(). All nodes share the next two channels: the node foreground is the
+// channel into which each node's ImGui content is rendered in submission order, and the node
+// background channel receives the node backgrounds rendered in EndNodeEditor(). The index buffer
+// range occupied by each node in both channels is recorded, so that EndNodeEditor() can emit every
+// node's background followed by its foreground in depth order. Finally, the last channel is used for
+// rendering the selection box and the incomplete link on top of everything else.
+//
+// +----------+----------+----------+----------+
+// |          |          |          |          |
+// |canvas    |node      |node      |click     |
+// |grid      |background|foreground|interaction
+// |          |          |          |          |
+// +----------+----------+----------+----------+
+//            |                     |
+//            | ranges indexed by   |
+//            | submission idx      |
+//            -----------------------
+//
+// The channel count doesn't depend on the number of nodes, and reordering the nodes by depth is a
+// single pass over their index buffer ranges.
 
-    if (current_channel == lhs_idx)
-    {
-        splitter._Current = rhs_idx;
-    }
-    else if (current_channel == rhs_idx)
-    {
-        splitter._Current = lhs_idx;
-    }
-}
+enum ImNodesDrawChannel_
+{
+    ImNodesDrawChannel_Canvas = 0,
+    ImNodesDrawChannel_NodeBackground,
+    ImNodesDrawChannel_NodeForeground,
+    ImNodesDrawChannel_ClickInteraction,
+    ImNodesDrawChannel_COUNT
+};
 
 void DrawListSet(ImDrawList* window_draw_list)
 {
     GImNodes->CanvasDrawList = window_draw_list;
     GImNodes->NodeIdxToSubmissionIdx.Clear();
     GImNodes->NodeIdxSubmissionOrder.clear();
+    GImNodes->NodeDrawRanges.resize(0);
+    window_draw_list->ChannelsSplit(ImNodesDrawChannel_COUNT);
 }
 
-// The draw list channels are structured as follows. First we have our base channel, the canvas grid
-// on which we render the grid lines in BeginNodeEditor(). The base channel is the reason
-// draw_list_submission_idx_to_background_channel_idx offsets the index by one. Each BeginNode()
-// call appends two new draw channels, for the node background and foreground. The node foreground
-// is the channel into which the node's ImGui content is rendered. Finally, in EndNodeEditor() we
-// append one last draw channel for rendering the selection box and the incomplete link on top of
-// everything else.
-//
-// +----------+----------+----------+----------+----------+----------+
-// |          |          |          |          |          |          |
-// |canvas    |node      |node      |...       |...       |click     |
-// |grid      |background|foreground|          |          |interaction
-// |          |          |          |          |          |          |
-// +----------+----------+----------+----------+----------+----------+
-//            |                     |
-//            |   submission idx    |
-//            |                     |
-//            -----------------------
-
-void DrawListAddNode(const int node_idx)
+// Starts a new draw command in the current channel if the current one is in use, and returns the
+// current index buffer offset and draw command index. The draw commands issued afterwards all have
+// a greater or equal index, even if the empty command gets merged away later on.
+void DrawListMarkBoundary(int* const idx_offset, int* const cmd_idx)
 {
-    GImNodes->NodeIdxToSubmissionIdx.SetInt(
-        static_cast<ImGuiID>(node_idx), GImNodes->NodeIdxSubmissionOrder.Size);
-    GImNodes->NodeIdxSubmissionOrder.push_back(node_idx);
-    ImDrawListGrowChannels(GImNodes->CanvasDrawList, 2);
+    ImDrawList* const draw_list = GImNodes->CanvasDrawList;
+    if (draw_list->CmdBuffer.empty() || draw_list->CmdBuffer.back().ElemCount != 0 ||
+        draw_list->CmdBuffer.back().UserCallback != NULL)
+    {
+        draw_list->AddDrawCmd();
+    }
+    *idx_offset = draw_list->IdxBuffer.Size;
+    *cmd_idx = draw_list->CmdBuffer.Size - 1;
 }
 
-void DrawListAppendClickInteractionChannel()
+void DrawListAddNode(const int node_idx)
 {
-    // NOTE: don't use this function outside of EndNodeEditor. Using this before all nodes have been
-    // added will screw up the node draw order.
-    ImDrawListGrowChannels(GImNodes->CanvasDrawList, 1);
-}
+    ImDrawList* const draw_list = GImNodes->CanvasDrawList;
+    draw_list->_Splitter.SetCurrentChannel(draw_list, ImNodesDrawChannel_NodeForeground);
 
-int DrawListSubmissionIdxToBackgroundChannelIdx(const int submission_idx)
-{
-    // NOTE: the first channel is the canvas background, i.e. the grid
-    return 1 + 2 * submission_idx;
-}
+    // Anything rendered between two BeginNode() calls ends up in the previous node's foreground,
+    // just like it would if that node had a channel of its own.
+    ImNodeDrawRange range;
+    memset(&range, 0, sizeof(range));
+    DrawListMarkBoundary(&range.Foreground.IdxBegin, &range.Foreground.CmdBegin);
+    if (!GImNodes->NodeDrawRanges.empty())
+    {
+        ImDrawChannelRange& previous = GImNodes->NodeDrawRanges.back().Foreground;
+        previous.IdxEnd = range.Foreground.IdxBegin;
+        previous.CmdEnd = range.Foreground.CmdBegin;
+    }
 
-int DrawListSubmissionIdxToForegroundChannelIdx(const int submission_idx)
-{
-    return DrawListSubmissionIdxToBackgroundChannelIdx(submission_idx) + 1;
+    GImNodes->NodeIdxToSubmissionIdx.SetInt(
+        static_cast<ImGuiID>(node_idx), GImNodes->NodeIdxSubmissionOrder.Size);
+    GImNodes->NodeIdxSubmissionOrder.push_back(node_idx);
+    GImNodes->NodeDrawRanges.push_back(range);
 }
 
 void DrawListActivateClickInteractionChannel()
 {
     GImNodes->CanvasDrawList->_Splitter.SetCurrentChannel(
-        GImNodes->CanvasDrawList, GImNodes->CanvasDrawList->_Splitter._Count - 1);
-}
-
-void DrawListActivateCurrentNodeForeground()
-{
-    const int foreground_channel_idx =
-        DrawListSubmissionIdxToForegroundChannelIdx(GImNodes->NodeIdxSubmissionOrder.Size - 1);
-    GImNodes->CanvasDrawList->_Splitter.SetCurrentChannel(
-        GImNodes->CanvasDrawList, foreground_channel_idx);
+        GImNodes->CanvasDrawList, ImNodesDrawChannel_ClickInteraction);
 }
 
-void DrawListActivateNodeBackground(const int node_idx)
+int DrawListNodeSubmissionIdx(const int node_idx)
 {
     const int submission_idx =
         GImNodes->NodeIdxToSubmissionIdx.GetInt(static_cast<ImGuiID>(node_idx), -1);
@@ -464,82 +448,142 @@ void DrawListActivateNodeBackground(const int node_idx)
     // * SetNodeDraggable
     // after the BeginNode/EndNode function calls?
     IM_ASSERT(submission_idx != -1);
-    const int background_channel_idx = DrawListSubmissionIdxToBackgroundChannelIdx(submission_idx);
-    GImNodes->CanvasDrawList->_Splitter.SetCurrentChannel(
-        GImNodes->CanvasDrawList, background_channel_idx);
+    return submission_idx;
 }
 
-void DrawListSwapSubmissionIndices(const int lhs_idx, const int rhs_idx)
+void DrawListBeginNodeBackground(const int node_idx)
 {
-    IM_ASSERT(lhs_idx != rhs_idx);
-
-    const int lhs_foreground_channel_idx = DrawListSubmissionIdxToForegroundChannelIdx(lhs_idx);
-    const int lhs_background_channel_idx = DrawListSubmissionIdxToBackgroundChannelIdx(lhs_idx);
-    const int rhs_foreground_channel_idx = DrawListSubmissionIdxToForegroundChannelIdx(rhs_idx);
-    const int rhs_background_channel_idx = DrawListSubmissionIdxToBackgroundChannelIdx(rhs_idx);
-
-    ImDrawListSplitterSwapChannels(
-        GImNodes->CanvasDrawList->_Splitter,
-        lhs_background_channel_idx,
-        rhs_background_channel_idx);
-    ImDrawListSplitterSwapChannels(
-        GImNodes->CanvasDrawList->_Splitter,
-        lhs_foreground_channel_idx,
-        rhs_foreground_channel_idx);
+    GImNodes->CanvasDrawList->_Splitter.SetCurrentChannel(
+        GImNodes->CanvasDrawList, ImNodesDrawChannel_NodeBackground);
+    ImDrawChannelRange& range =
+        GImNodes->NodeDrawRanges[DrawListNodeSubmissionIdx(node_idx)].Background;
+    DrawListMarkBoundary(&range.IdxBegin, &range.CmdBegin);
 }
 
-void DrawListSortChannelsByDepth(const ImVector<int>& node_idx_depth_order)
+void DrawListEndNodeBackground(const int node_idx)
 {
-    if (GImNodes->NodeIdxToSubmissionIdx.Data.Size < 2)
-    {
-        return;
-    }
-
-    IM_ASSERT(node_idx_depth_order.Size == GImNodes->NodeIdxSubmissionOrder.Size);
+    ImDrawChannelRange& range =
+        GImNodes->NodeDrawRanges[DrawListNodeSubmissionIdx(node_idx)].Background;
+    DrawListMarkBoundary(&range.IdxEnd, &range.CmdEnd);
+}
 
-    int start_idx = node_idx_depth_order.Size - 1;
+// Appends the draw commands and indices of a range of a draw channel. The draw commands straddling
+// the range boundaries are clipped to the range, and consecutive commands sharing the same clip
+// rectangle, texture and vertex offset are merged.
+void DrawChannelAppendRange(
+    const ImDrawChannel&      channel,
+    const ImDrawChannelRange& range,
+    ImVector<ImDrawCmd>&      cmd_buffer,
+    ImVector<ImDrawIdx>&      idx_buffer)
+{
+    const ImVector<ImDrawCmd>& src_cmds = channel._CmdBuffer;
 
-    while (node_idx_depth_order[start_idx] == GImNodes->NodeIdxSubmissionOrder[start_idx])
+    // Binary search for the first command which doesn't end before the range
+    int cmd_idx = 0;
     {
-        if (--start_idx == 0)
+        int last = src_cmds.Size;
+        while (cmd_idx < last)
         {
-            // early out if submission order and depth order are the same
-            return;
+            const int          mid = cmd_idx + (last - cmd_idx) / 2;
+            const ImDrawCmd&   cmd = src_cmds[mid];
+            const unsigned int cmd_end = cmd.IdxOffset + cmd.ElemCount;
+            const unsigned int range_begin = static_cast<unsigned int>(range.IdxBegin);
+            const bool         before =
+                cmd_end < range_begin ||
+                (cmd_end == range_begin && (cmd.ElemCount > 0 || mid < range.CmdBegin));
+            if (before)
+            {
+                cmd_idx = mid + 1;
+            }
+            else
+            {
+                last = mid;
+            }
         }
     }
 
-    // TODO: this is an O(N^2) algorithm. It might be worthwhile revisiting this to see if the time
-    // complexity can be reduced.
-
-    for (int depth_idx = start_idx; depth_idx > 0; --depth_idx)
+    for (; cmd_idx < src_cmds.Size; ++cmd_idx)
     {
-        const int node_idx = node_idx_depth_order[depth_idx];
-
-        // Find the current index of the node_idx in the submission order array
-        int submission_idx = -1;
-        for (int i = 0; i < GImNodes->NodeIdxSubmissionOrder.Size; ++i)
+        const ImDrawCmd& cmd = src_cmds[cmd_idx];
+        if (cmd.IdxOffset >= static_cast<unsigned int>(range.IdxEnd) && cmd_idx >= range.CmdEnd)
         {
-            if (GImNodes->NodeIdxSubmissionOrder[i] == node_idx)
-            {
-                submission_idx = i;
-                break;
-            }
+            break;
         }
-        IM_ASSERT(submission_idx >= 0);
 
-        if (submission_idx == depth_idx)
+        const int begin = ImMax(static_cast<int>(cmd.IdxOffset), range.IdxBegin);
+        const int end = ImMin(static_cast<int>(cmd.IdxOffset + cmd.ElemCount), range.IdxEnd);
+        if (end <= begin && cmd.UserCallback == NULL)
         {
             continue;
         }
 
-        for (int j = submission_idx; j < depth_idx; ++j)
+        ImDrawCmd* const last_cmd = cmd_buffer.empty() ? NULL : &cmd_buffer.back();
+        if (last_cmd != NULL && last_cmd->UserCallback == NULL && cmd.UserCallback == NULL &&
+            memcmp(&last_cmd->ClipRect, &cmd.ClipRect, sizeof(cmd.ClipRect)) == 0 &&
+            last_cmd->TextureId == cmd.TextureId && last_cmd->VtxOffset == cmd.VtxOffset)
+        {
+            last_cmd->ElemCount += end - begin;
+        }
+        else
+        {
+            ImDrawCmd new_cmd = cmd;
+            new_cmd.IdxOffset = idx_buffer.Size;
+            new_cmd.ElemCount = ImMax(end - begin, 0);
+            cmd_buffer.push_back(new_cmd);
+        }
+
+        if (end > begin)
         {
-            DrawListSwapSubmissionIndices(j, j + 1);
-            ImSwap(GImNodes->NodeIdxSubmissionOrder[j], GImNodes->NodeIdxSubmissionOrder[j + 1]);
+            const int dst_offset = idx_buffer.Size;
+            idx_buffer.resize(dst_offset + end - begin);
+            memcpy(
+                idx_buffer.Data + dst_offset,
+                channel._IdxBuffer.Data + begin,
+                (end - begin) * sizeof(ImDrawIdx));
         }
     }
 }
 
+void DrawListSortNodesByDepth(const ImVector<int>& node_idx_depth_order)
+{
+    ImDrawList* const draw_list = GImNodes->CanvasDrawList;
+    if (GImNodes->NodeDrawRanges.empty())
+    {
+        return;
+    }
+
+    IM_ASSERT(node_idx_depth_order.Size == GImNodes->NodeIdxSubmissionOrder.Size);
+
+    // The node channels are read directly, so make sure neither of them is the current channel
+    draw_list->_Splitter.SetCurrentChannel(draw_list, ImNodesDrawChannel_Canvas);
+
+    ImDrawChannel& background = draw_list->_Splitter._Channels[ImNodesDrawChannel_NodeBackground];
+    ImDrawChannel& foreground = draw_list->_Splitter._Channels[ImNodesDrawChannel_NodeForeground];
+    GImNodes->NodeDrawRanges.back().Foreground.IdxEnd = foreground._IdxBuffer.Size;
+    GImNodes->NodeDrawRanges.back().Foreground.CmdEnd = foreground._CmdBuffer.Size;
+
+    ImVector<ImDrawCmd>& cmd_buffer = GImNodes->NodeDrawCmdScratch;
+    ImVector<ImDrawIdx>& idx_buffer = GImNodes->NodeDrawIdxScratch;
+    cmd_buffer.resize(0);
+    idx_buffer.resize(0);
+    idx_buffer.reserve(background._IdxBuffer.Size + foreground._IdxBuffer.Size);
+
+    for (int depth_idx = 0; depth_idx < node_idx_depth_order.Size; ++depth_idx)
+    {
+        const ImNodeDrawRange& range =
+            GImNodes->NodeDrawRanges[DrawListNodeSubmissionIdx(node_idx_depth_order[depth_idx])];
+        DrawChannelAppendRange(background, range.Background, cmd_buffer, idx_buffer);
+        DrawChannelAppendRange(foreground, range.Foreground, cmd_buffer, idx_buffer);
+    }
+
+    // The sorted nodes replace the background channel, and the old buffers are kept as scratch
+    // memory for the next frame.
+    background._CmdBuffer.swap(cmd_buffer);
+    background._IdxBuffer.swap(idx_buffer);
+    foreground._CmdBuffer.resize(0);
+    foreground._IdxBuffer.resize(0);
+}
+
 // [SECTION] ui state logic
 
 ImVec2 GetScreenSpacePinCoordinates(
@@ -617,6 +661,7 @@ void BeginNodeSelection(ImNodesEditorContext& editor, const int node_idx)
     // To support snapping of multiple nodes, we need to store the offset of
     // each node in the selection to the origin of the dragged node.
     const ImVec2 ref_origin = editor.Nodes.Pool[node_idx].Origin;
+    editor.DragStartOrigin = ref_origin;
     editor.PrimaryNodeOffset =
         ref_origin + GImNodes->CanvasOriginScreenSpace + editor.Panning - GImNodes->MousePos;
 
@@ -819,6 +864,23 @@ ImVec2 SnapOriginToGrid(ImVec2 origin)
     return origin;
 }
 
+// Moves a node, and records it as modified for SaveEditorStateToJournal() if its origin changed.
+void SetNodeOrigin(ImNodesEditorContext& editor, const int node_idx, const ImVec2& origin)
+{
+    ImNodeData& node = editor.Nodes.Pool[node_idx];
+    if (node.Origin.x == origin.x && node.Origin.y == origin.y)
+    {
+        return;
+    }
+
+    node.Origin = origin;
+    if (!node.Modified)
+    {
+        node.Modified = true;
+        editor.ModifiedNodeIndices.push_back(node_idx);
+    }
+}
+
 void TranslateSelectedNodes(ImNodesEditorContext& editor)
 {
     if (GImNodes->LeftMouseDragging)
@@ -839,12 +901,39 @@ void TranslateSelectedNodes(ImNodesEditorContext& editor)
             ImNodeData&  node = editor.Nodes.Pool[node_idx];
             if (node.Draggable && shouldTranslate)
             {
-                node.Origin = origin + node_rel + editor.AutoPanningDelta;
+                SetNodeOrigin(editor, node_idx, origin + node_rel + editor.AutoPanningDelta);
             }
         }
     }
 }
 
+// Records the nodes moved by the node drag which just ended, for IsNodeDragFinished(). The selected
+// nodes keep their offsets to the primary node while dragged, so they all move by the same delta.
+void EndNodeDrag(ImNodesEditorContext& editor)
+{
+    editor.DraggedNodeIds.clear();
+    const int num_nodes =
+        ImMin(editor.SelectedNodeIndices.size(), editor.SelectedNodeOffsets.size());
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        const ImNodeData& node = editor.Nodes.Pool[editor.SelectedNodeIndices[i]];
+        const ImVec2      start = editor.DragStartOrigin + editor.SelectedNodeOffsets[i];
+        if (node.Draggable && (node.Origin.x != start.x || node.Origin.y != start.y))
+        {
+            if (editor.DraggedNodeIds.empty())
+            {
+                editor.DragDelta = node.Origin - start;
+            }
+            editor.DraggedNodeIds.push_back(node.Id);
+        }
+    }
+
+    if (!editor.DraggedNodeIds.empty())
+    {
+        GImNodes->ImNodesUIState |= ImNodesUIState_NodeDragFinished;
+    }
+}
+
 struct LinkPredicate
 {
     bool operator()(const ImLinkData& lhs, const ImLinkData& rhs) const
@@ -984,6 +1073,7 @@ void ClickInteractionUpdate(ImNodesEditorContext& editor)
 
         if (GImNodes->LeftMouseReleased)
         {
+            EndNodeDrag(editor);
             editor.ClickInteraction.Type = ImNodesClickInteractionType_None;
         }
     }
@@ -1396,10 +1486,164 @@ TriangleOffsets CalculateTriangleOffsets(const float side_length)
     return offset;
 }
 
+// Signed distance from p, relative to the pin position, to the edge of a pin shape (negative
+// inside). Outlined shapes are stroked along their edge, the same way DrawPinShape() strokes the
+// tessellated paths.
+float PinShapeSignedDistance(
+    const ImNodesPinShape shape,
+    const ImVec2&         p,
+    const ImNodesStyle&   style)
+{
+    switch (shape)
+    {
+    case ImNodesPinShape_Circle:
+        // NOTE: ImDrawList::AddCircle() strokes a path which is inset by half a pixel.
+        return ImFabs(ImSqrt(ImLengthSqr(p)) - (style.PinCircleRadius - 0.5f)) -
+               0.5f * style.PinLineThickness;
+    case ImNodesPinShape_CircleFilled:
+        return ImSqrt(ImLengthSqr(p)) - style.PinCircleRadius;
+    case ImNodesPinShape_Quad:
+    case ImNodesPinShape_QuadFilled:
+    {
+        const float  half_side = 0.5f * style.PinQuadSideLength;
+        const ImVec2 q(ImFabs(p.x) - half_side, ImFabs(p.y) - half_side);
+        const ImVec2 outside(ImMax(q.x, 0.f), ImMax(q.y, 0.f));
+        const float  distance = ImSqrt(ImLengthSqr(outside)) + ImMin(ImMax(q.x, q.y), 0.f);
+        return shape == ImNodesPinShape_Quad
+                   ? ImFabs(distance) - 0.5f * style.PinLineThickness
+                   : distance;
+    }
+    case ImNodesPinShape_Triangle:
+    case ImNodesPinShape_TriangleFilled:
+    {
+        const TriangleOffsets offset = CalculateTriangleOffsets(style.PinTriangleSideLength);
+        const ImVec2          vertices[3] = {offset.TopLeft, offset.Right, offset.BottomLeft};
+        const ImVec2 centroid = (offset.TopLeft + offset.BottomLeft + offset.Right) * (1.f / 3.f);
+
+        // The triangle is convex, so the largest distance to its edge lines is the signed distance
+        // everywhere except around the corners, where it yields mitered corners.
+        float distance = -FLT_MAX;
+        for (int i = 0; i < 3; ++i)
+        {
+            const ImVec2& a = vertices[i];
+            const ImVec2  edge = vertices[(i + 1) % 3] - a;
+            ImVec2        normal = ImVec2(edge.y, -edge.x) * ImInvLength(edge, 1.f);
+            if (ImDot(normal, centroid - a) > 0.f)
+            {
+                normal = ImVec2(-normal.x, -normal.y);
+            }
+            distance = ImMax(distance, ImDot(p - a, normal));
+        }
+        // NOTE: outlined triangles are stroked with twice the line thickness, see DrawPinShape().
+        return shape == ImNodesPinShape_Triangle ? ImFabs(distance) - style.PinLineThickness
+                                                 : distance;
+    }
+    default:
+        IM_ASSERT(!"Invalid PinShape value!");
+        return FLT_MAX;
+    }
+}
+
+// Half the side length of the square glyph holding a rasterized pin shape, including the
+// anti-aliasing fringe and a texel of padding for bilinear filtering.
+int PinShapeGlyphHalfSize(const ImNodesPinShape shape, const ImNodesStyle& style)
+{
+    float extent = 0.f;
+    switch (shape)
+    {
+    case ImNodesPinShape_Circle:
+        extent = style.PinCircleRadius + 0.5f * style.PinLineThickness;
+        break;
+    case ImNodesPinShape_CircleFilled:
+        extent = style.PinCircleRadius;
+        break;
+    case ImNodesPinShape_Quad:
+        extent = 0.5f * (style.PinQuadSideLength + style.PinLineThickness);
+        break;
+    case ImNodesPinShape_QuadFilled:
+        extent = 0.5f * style.PinQuadSideLength;
+        break;
+    case ImNodesPinShape_Triangle:
+    case ImNodesPinShape_TriangleFilled:
+    {
+        const TriangleOffsets offset = CalculateTriangleOffsets(style.PinTriangleSideLength);
+        extent = ImMax(ImMax(-offset.TopLeft.x, offset.Right.x), offset.TopLeft.y);
+        if (shape == ImNodesPinShape_Triangle)
+        {
+            // The miter of the outline reaches twice the line thickness past the corners
+            extent += 2.f * style.PinLineThickness;
+        }
+    }
+    break;
+    default:
+        IM_ASSERT(!"Invalid PinShape value!");
+        break;
+    }
+    return (int)ImCeil(extent) + 1;
+}
+
+void PinShapeRasterize(
+    ImFontAtlas* const           atlas,
+    const ImNodesPinShape        shape,
+    const ImNodesStyle&          style,
+    const ImFontAtlasCustomRect& rect)
+{
+    const float half_size = 0.5f * rect.Width;
+    for (int y = 0; y < rect.Height; ++y)
+    {
+        for (int x = 0; x < rect.Width; ++x)
+        {
+            // Sample the coverage at the texel center, using the same one pixel wide
+            // anti-aliasing fringe as ImDrawList.
+            const ImVec2 p(x + 0.5f - half_size, y + 0.5f - half_size);
+            const int    alpha =
+                IM_F32_TO_INT8_SAT(0.5f - PinShapeSignedDistance(shape, p, style));
+            const int texel = (rect.Y + y) * atlas->TexWidth + rect.X + x;
+            if (atlas->TexPixelsAlpha8 != NULL)
+            {
+                atlas->TexPixelsAlpha8[texel] = (unsigned char)alpha;
+            }
+            if (atlas->TexPixelsRGBA32 != NULL)
+            {
+                atlas->TexPixelsRGBA32[texel] = IM_COL32(255, 255, 255, alpha);
+            }
+        }
+    }
+}
+
+// Returns true if the pin shapes in the font atlas can be used for rendering the pins, i.e. they
+// match the current style and the canvas is currently drawn with the atlas texture.
+bool PinShapeAtlasIsUsable()
+{
+    const ImPinShapeAtlas& shapes = GImNodes->PinShapeAtlas;
+    const ImNodesStyle&    style = GImNodes->Style;
+    return shapes.Atlas != NULL && shapes.Atlas->TexWidth == shapes.TexWidth &&
+           shapes.Atlas->TexHeight == shapes.TexHeight &&
+           GImNodes->CanvasDrawList->_CmdHeader.TextureId == shapes.Atlas->TexID &&
+           shapes.PinCircleRadius == style.PinCircleRadius &&
+           shapes.PinQuadSideLength == style.PinQuadSideLength &&
+           shapes.PinTriangleSideLength == style.PinTriangleSideLength &&
+           shapes.PinLineThickness == style.PinLineThickness;
+}
+
 void DrawPinShape(const ImVec2& pin_pos, const ImPinData& pin, const ImU32 pin_color)
 {
     static const int CIRCLE_NUM_SEGMENTS = 8;
 
+    if (PinShapeAtlasIsUsable())
+    {
+        const ImPinShapeAtlas& shapes = GImNodes->PinShapeAtlas;
+        const float            half_size = (float)shapes.HalfSize[pin.Shape];
+        GImNodes->CanvasDrawList->PrimReserve(6, 4);
+        GImNodes->CanvasDrawList->PrimRectUV(
+            pin_pos - ImVec2(half_size, half_size),
+            pin_pos + ImVec2(half_size, half_size),
+            shapes.UvMin[pin.Shape],
+            shapes.UvMax[pin.Shape],
+            pin_color);
+        return;
+    }
+
     switch (pin.Shape)
     {
     case ImNodesPinShape_Circle:
@@ -1579,7 +1823,7 @@ void DrawNode(ImNodesEditorContext& editor, const int node_idx)
     }
 }
 
-void DrawLink(ImNodesEditorContext& editor, const int link_idx)
+void DrawLink(ImNodesEditorContext& editor, const int link_idx, const bool dense_links)
 {
     const ImLinkData& link = editor.Links.Pool[link_idx];
     const ImPinData&  start_pin = editor.Pins.Pool[link.StartPinIdx];
@@ -1607,8 +1851,10 @@ void DrawLink(ImNodesEditorContext& editor, const int link_idx)
         return;
     }
 
+    const bool link_selected = editor.SelectedLinkIndices.contains(link_idx);
+
     ImU32 link_color = link.ColorStyle.Base;
-    if (editor.SelectedLinkIndices.contains(link_idx))
+    if (link_selected)
     {
         link_color = link.ColorStyle.Selected;
     }
@@ -1617,18 +1863,26 @@ void DrawLink(ImNodesEditorContext& editor, const int link_idx)
         link_color = link.ColorStyle.Hovered;
     }
 
-#if IMGUI_VERSION_NUM < 18000
-    GImNodes->CanvasDrawList->AddBezierCurve(
-#else
-    GImNodes->CanvasDrawList->AddBezierCubic(
-#endif
-        cubic_bezier.P0,
-        cubic_bezier.P1,
-        cubic_bezier.P2,
-        cubic_bezier.P3,
-        link_color,
-        GImNodes->Style.LinkThickness,
-        cubic_bezier.NumSegments);
+    // Short links and links in dense link fields are indistinguishable from one another at full
+    // quality, so draw them as thin lines without anti-aliasing.
+    const ImNodesStyle& style = GImNodes->Style;
+    const bool          low_detail =
+        !link_selected && !link_hovered &&
+        (dense_links || ImLengthSqr(cubic_bezier.P3 - cubic_bezier.P0) <
+                            style.LinkLodLengthThreshold * style.LinkLodLengthThreshold);
+
+    // The link is tessellated together with all other links in EndNodeEditor()
+    ImLinkBatchEntry entry;
+    entry.P0 = cubic_bezier.P0;
+    entry.P1 = cubic_bezier.P1;
+    entry.P2 = cubic_bezier.P2;
+    entry.P3 = cubic_bezier.P3;
+    entry.NumSegments =
+        low_detail ? ImMax(cubic_bezier.NumSegments / 2, 1) : cubic_bezier.NumSegments;
+    entry.Color = link_color;
+    entry.Thickness = low_detail ? style.LinkLodThickness : style.LinkThickness;
+    entry.AntiAliased = !low_detail;
+    GImNodes->LinkBatch.push_back(entry);
 }
 
 void BeginPinAttribute(
@@ -1693,6 +1947,7 @@ void Initialize(ImNodesContext* context)
 
     context->DefaultEditorCtx = EditorContextCreate();
     context->EditorCtx = context->DefaultEditorCtx;
+    context->SaveQueue = NULL;
 
     context->CurrentAttributeFlags = ImNodesAttributeFlags_None;
     context->AttributeFlagStack.push_back(GImNodes->CurrentAttributeFlags);
@@ -1700,7 +1955,13 @@ void Initialize(ImNodesContext* context)
     StyleColorsDark(&context->Style);
 }
 
-void Shutdown(ImNodesContext* ctx) { EditorContextFree(ctx->DefaultEditorCtx); }
+void SaveQueueDestroy(ImNodesContext* ctx);
+
+void Shutdown(ImNodesContext* ctx)
+{
+    SaveQueueDestroy(ctx);
+    EditorContextFree(ctx->DefaultEditorCtx);
+}
 
 // [SECTION] minimap
 
@@ -1780,137 +2041,335 @@ static inline void CalcMiniMapLayout()
     editor.MiniMapScaling = mini_map_scaling;
 }
 
-static void MiniMapDrawNode(ImNodesEditorContext& editor, const int node_idx)
+static void MiniMapDrawNode(
+    ImDrawList*       draw_list,
+    const ImNodeData& node,
+    const ImRect&     node_rect,
+    const float       mini_map_scaling,
+    const ImU32       mini_map_node_background)
 {
-    const ImNodeData& node = editor.Nodes.Pool[node_idx];
-
-    const ImRect node_rect = ScreenSpaceToMiniMapSpace(editor, node.Rect);
-
     // Round to near whole pixel value for corner-rounding to prevent visual glitches
-    const float mini_map_node_rounding =
-        floorf(node.LayoutStyle.CornerRounding * editor.MiniMapScaling);
-
-    ImU32 mini_map_node_background;
-
-    if (editor.ClickInteraction.Type == ImNodesClickInteractionType_None &&
-        ImGui::IsMouseHoveringRect(node_rect.Min, node_rect.Max))
-    {
-        mini_map_node_background = GImNodes->Style.Colors[ImNodesCol_MiniMapNodeBackgroundHovered];
-
-        // Run user callback when hovering a mini-map node
-        if (editor.MiniMapNodeHoveringCallback)
-        {
-            editor.MiniMapNodeHoveringCallback(node.Id, editor.MiniMapNodeHoveringCallbackUserData);
-        }
-    }
-    else if (editor.SelectedNodeIndices.contains(node_idx))
-    {
-        mini_map_node_background = GImNodes->Style.Colors[ImNodesCol_MiniMapNodeBackgroundSelected];
-    }
-    else
-    {
-        mini_map_node_background = GImNodes->Style.Colors[ImNodesCol_MiniMapNodeBackground];
-    }
+    const float mini_map_node_rounding = floorf(node.LayoutStyle.CornerRounding * mini_map_scaling);
 
     const ImU32 mini_map_node_outline = GImNodes->Style.Colors[ImNodesCol_MiniMapNodeOutline];
 
-    GImNodes->CanvasDrawList->AddRectFilled(
+    draw_list->AddRectFilled(
         node_rect.Min, node_rect.Max, mini_map_node_background, mini_map_node_rounding);
 
-    GImNodes->CanvasDrawList->AddRect(
-        node_rect.Min, node_rect.Max, mini_map_node_outline, mini_map_node_rounding);
+    draw_list->AddRect(node_rect.Min, node_rect.Max, mini_map_node_outline, mini_map_node_rounding);
 }
 
-static void MiniMapDrawLink(ImNodesEditorContext& editor, const int link_idx)
+static void MiniMapQueueLink(ImNodesEditorContext& editor, const int link_idx)
 {
     const ImLinkData& link = editor.Links.Pool[link_idx];
     const ImPinData&  start_pin = editor.Pins.Pool[link.StartPinIdx];
     const ImPinData&  end_pin = editor.Pins.Pool[link.EndPinIdx];
 
     const CubicBezier cubic_bezier = GetCubicBezier(
-        ScreenSpaceToMiniMapSpace(editor, start_pin.Pos),
-        ScreenSpaceToMiniMapSpace(editor, end_pin.Pos),
+        GridSpaceToMiniMapCacheSpace(editor, ScreenSpaceToGridSpace(editor, start_pin.Pos)),
+        GridSpaceToMiniMapCacheSpace(editor, ScreenSpaceToGridSpace(editor, end_pin.Pos)),
         start_pin.Type,
         GImNodes->Style.LinkLineSegmentsPerLength / editor.MiniMapScaling);
 
-    // It's possible for a link to be deleted in begin_link_interaction. A user
-    // may detach a link, resulting in the link wire snapping to the mouse
-    // position.
-    //
-    // In other words, skip rendering the link if it was deleted.
-    if (GImNodes->DeletedLinkIdx == link_idx)
-    {
-        return;
-    }
-
     const ImU32 link_color =
         GImNodes->Style.Colors
             [editor.SelectedLinkIndices.contains(link_idx) ? ImNodesCol_MiniMapLinkSelected
                                                            : ImNodesCol_MiniMapLink];
 
-#if IMGUI_VERSION_NUM < 18000
-    GImNodes->CanvasDrawList->AddBezierCurve(
-#else
-    GImNodes->CanvasDrawList->AddBezierCubic(
-#endif
-        cubic_bezier.P0,
-        cubic_bezier.P1,
-        cubic_bezier.P2,
-        cubic_bezier.P3,
-        link_color,
-        GImNodes->Style.LinkThickness * editor.MiniMapScaling,
-        cubic_bezier.NumSegments);
+    ImLinkBatchEntry entry;
+    entry.P0 = cubic_bezier.P0;
+    entry.P1 = cubic_bezier.P1;
+    entry.P2 = cubic_bezier.P2;
+    entry.P3 = cubic_bezier.P3;
+    entry.NumSegments = cubic_bezier.NumSegments;
+    entry.Color = link_color;
+    entry.Thickness = GImNodes->Style.LinkThickness * editor.MiniMapScaling;
+    entry.AntiAliased = true;
+    GImNodes->LinkBatch.push_back(entry);
+}
+
+// Quantize positions before hashing them, so that rounding errors introduced by panning don't
+// invalidate the cache.
+static inline ImU32 MiniMapHashPosition(
+    const ImNodesEditorContext& editor,
+    const ImVec2&               screen_space_pos,
+    const ImU32                 seed)
+{
+    const ImVec2 pos =
+        GridSpaceToMiniMapCacheSpace(editor, ScreenSpaceToGridSpace(editor, screen_space_pos));
+    const int    quantized[2] = {(int)ImFloor(pos.x * 4.0f), (int)ImFloor(pos.y * 4.0f)};
+    return ImHashData(quantized, sizeof(quantized), seed);
 }
 
-static void MiniMapUpdate()
+// Hashes everything the cached mini-map contents depend on.
+static ImU32 MiniMapCalcContentHash(const ImNodesEditorContext& editor, const ImU32 clear_color)
 {
-    ImNodesEditorContext& editor = EditorContextGet();
-
-    ImU32 mini_map_background;
+    const ImNodesStyle& style = GImNodes->Style;
 
-    if (IsMiniMapHovered())
-    {
-        mini_map_background = GImNodes->Style.Colors[ImNodesCol_MiniMapBackgroundHovered];
-    }
-    else
+    ImU32 hash = ImHashData(&clear_color, sizeof(clear_color));
     {
-        mini_map_background = GImNodes->Style.Colors[ImNodesCol_MiniMapBackground];
+        const ImVec2 size = editor.MiniMapRectScreenSpace.GetSize();
+        const float  layout[4] = {size.x, size.y, editor.MiniMapScaling, style.LinkThickness};
+        hash = ImHashData(layout, sizeof(layout), hash);
+        hash = ImHashData(
+            &style.Colors[ImNodesCol_MiniMapNodeBackground],
+            sizeof(ImU32) * (ImNodesCol_MiniMapCanvas - ImNodesCol_MiniMapNodeBackground),
+            hash);
+        hash = ImHashData(
+            &GImNodes->CanvasDrawList->Flags, sizeof(GImNodes->CanvasDrawList->Flags), hash);
     }
 
-    // Create a child window bellow mini-map, so it blocks all mouse interaction on canvas.
-    int flags = ImGuiWindowFlags_NoBackground;
-    ImGui::SetCursorScreenPos(editor.MiniMapRectScreenSpace.Min);
-    ImGui::BeginChild("minimap", editor.MiniMapRectScreenSpace.GetSize(), false, flags);
+    for (int node_idx = 0; node_idx < editor.Nodes.Pool.size(); ++node_idx)
+    {
+        if (editor.Nodes.InUse[node_idx])
+        {
+            const ImNodeData& node = editor.Nodes.Pool[node_idx];
+            const int         selected = editor.SelectedNodeIndices.contains(node_idx);
+            hash = MiniMapHashPosition(editor, node.Rect.Min, hash);
+            hash = MiniMapHashPosition(editor, node.Rect.Max, hash);
+            hash = ImHashData(&node.LayoutStyle.CornerRounding, sizeof(float), hash);
+            hash = ImHashData(&selected, sizeof(selected), hash);
+        }
+    }
 
-    const ImRect& mini_map_rect = editor.MiniMapRectScreenSpace;
+    for (int link_idx = 0; link_idx < editor.Links.Pool.size(); ++link_idx)
+    {
+        // It's possible for a link to be deleted in begin_link_interaction. A user
+        // may detach a link, resulting in the link wire snapping to the mouse
+        // position.
+        //
+        // In other words, skip rendering the link if it was deleted.
+        if (editor.Links.InUse[link_idx] && GImNodes->DeletedLinkIdx != link_idx)
+        {
+            const ImLinkData& link = editor.Links.Pool[link_idx];
+            const ImPinData&  start_pin = editor.Pins.Pool[link.StartPinIdx];
+            const ImPinData&  end_pin = editor.Pins.Pool[link.EndPinIdx];
+            const int         selected = editor.SelectedLinkIndices.contains(link_idx);
+            hash = MiniMapHashPosition(editor, start_pin.Pos, hash);
+            hash = MiniMapHashPosition(editor, end_pin.Pos, hash);
+            hash = ImHashData(&start_pin.Type, sizeof(start_pin.Type), hash);
+            hash = ImHashData(&selected, sizeof(selected), hash);
+        }
+    }
 
-    // Draw minimap background and border
-    GImNodes->CanvasDrawList->AddRectFilled(
-        mini_map_rect.Min, mini_map_rect.Max, mini_map_background);
+    return hash;
+}
 
-    GImNodes->CanvasDrawList->AddRect(
-        mini_map_rect.Min, mini_map_rect.Max, GImNodes->Style.Colors[ImNodesCol_MiniMapOutline]);
+static void MiniMapUpdateCache(ImNodesEditorContext& editor, const ImU32 clear_color)
+{
+    // Checking for changes is rate limited as well, hashing the graph isn't free either
+    const double time = ImGui::GetTime();
+    if (time - editor.MiniMapCacheTime < GImNodes->Io.MiniMapRefreshInterval)
+    {
+        return;
+    }
+    editor.MiniMapCacheTime = time;
 
-    // Clip draw list items to mini-map rect (after drawing background/outline)
-    GImNodes->CanvasDrawList->PushClipRect(
-        mini_map_rect.Min, mini_map_rect.Max, true /* intersect with editor clip-rect */);
+    const ImU32 hash = MiniMapCalcContentHash(editor, clear_color);
+    if (hash == editor.MiniMapCacheHash && editor.MiniMapCache._Data != NULL)
+    {
+        return;
+    }
+    editor.MiniMapCacheHash = hash;
+
+    ImDrawList& cache = editor.MiniMapCache;
+    cache._Data = ImGui::GetDrawListSharedData();
+    cache._ResetForNewFrame();
+    cache.Flags = GImNodes->CanvasDrawList->Flags;
+    cache.PushClipRect(ImVec2(0.f, 0.f), editor.MiniMapRectScreenSpace.GetSize());
+    cache.PushTextureID(ImGui::GetIO().Fonts->TexID);
 
-    // Draw links first so they appear under nodes, and we can use the same draw channel
+    // Draw links first so they appear under nodes
+    GImNodes->LinkBatch.resize(0);
     for (int link_idx = 0; link_idx < editor.Links.Pool.size(); ++link_idx)
     {
-        if (editor.Links.InUse[link_idx])
+        if (editor.Links.InUse[link_idx] && GImNodes->DeletedLinkIdx != link_idx)
         {
-            MiniMapDrawLink(editor, link_idx);
+            MiniMapQueueLink(editor, link_idx);
         }
     }
+    LinkBatchRender(&cache, GImNodes->LinkBatch.Data, GImNodes->LinkBatch.Size);
 
     for (int node_idx = 0; node_idx < editor.Nodes.Pool.size(); ++node_idx)
     {
         if (editor.Nodes.InUse[node_idx])
         {
-            MiniMapDrawNode(editor, node_idx);
+            const ImNodeData& node = editor.Nodes.Pool[node_idx];
+            const ImRect      node_rect = ScreenSpaceToGridSpace(editor, node.Rect);
+            const ImU32       mini_map_node_background =
+                editor.SelectedNodeIndices.contains(node_idx)
+                          ? GImNodes->Style.Colors[ImNodesCol_MiniMapNodeBackgroundSelected]
+                          : GImNodes->Style.Colors[ImNodesCol_MiniMapNodeBackground];
+            MiniMapDrawNode(
+                &cache,
+                node,
+                ImRect(
+                    GridSpaceToMiniMapCacheSpace(editor, node_rect.Min),
+                    GridSpaceToMiniMapCacheSpace(editor, node_rect.Max)),
+                editor.MiniMapScaling,
+                mini_map_node_background);
+        }
+    }
+
+    editor.MiniMapCacheTexture = ImTextureID();
+    if (GImNodes->Io.MiniMapTexture.RenderCallback != NULL)
+    {
+        ImDrawData draw_data;
+        draw_data.Valid = true;
+        draw_data.DisplayPos = ImVec2(0.f, 0.f);
+        draw_data.DisplaySize = editor.MiniMapRectScreenSpace.GetSize();
+        draw_data.FramebufferScale = ImGui::GetIO().DisplayFramebufferScale;
+        draw_data.AddDrawList(&cache);
+        editor.MiniMapCacheTexture = GImNodes->Io.MiniMapTexture.RenderCallback(
+            &draw_data, clear_color, GImNodes->Io.MiniMapTexture.UserData);
+    }
+}
+
+// Copies the cached mini-map geometry into the draw list, translated to the mini-map's position.
+static void MiniMapReplayCache(const ImNodesEditorContext& editor, ImDrawList* draw_list)
+{
+    const ImDrawList& cache = editor.MiniMapCache;
+    const ImVec2      offset = editor.MiniMapRectScreenSpace.Min;
+
+    int cmd_idx = 0;
+    while (cmd_idx < cache.CmdBuffer.Size)
+    {
+        // Commands sharing a vertex offset index into the same block of vertices, which is copied
+        // with a single reservation.
+        const unsigned int vtx_offset = cache.CmdBuffer[cmd_idx].VtxOffset;
+        const unsigned int idx_offset = cache.CmdBuffer[cmd_idx].IdxOffset;
+        int                cmd_end = cmd_idx + 1;
+        while (cmd_end < cache.CmdBuffer.Size && cache.CmdBuffer[cmd_end].VtxOffset == vtx_offset)
+        {
+            ++cmd_end;
+        }
+
+        const ImDrawCmd& last_cmd = cache.CmdBuffer[cmd_end - 1];
+        const int        vtx_count =
+            (cmd_end < cache.CmdBuffer.Size ? (int)cache.CmdBuffer[cmd_end].VtxOffset
+                                                   : cache.VtxBuffer.Size) -
+            (int)vtx_offset;
+        const int idx_count = (int)(last_cmd.IdxOffset + last_cmd.ElemCount - idx_offset);
+        cmd_idx = cmd_end;
+
+        if (idx_count == 0)
+        {
+            continue;
+        }
+
+        draw_list->PrimReserve(idx_count, vtx_count);
+
+        const ImDrawVert* src_vtx = cache.VtxBuffer.Data + vtx_offset;
+        ImDrawVert*       dst_vtx = draw_list->_VtxWritePtr;
+        for (int i = 0; i < vtx_count; ++i)
+        {
+            dst_vtx[i] = src_vtx[i];
+            dst_vtx[i].pos += offset;
+        }
+
+        const unsigned int idx_base = draw_list->_VtxCurrentIdx;
+        const ImDrawIdx*   src_idx = cache.IdxBuffer.Data + idx_offset;
+        ImDrawIdx*         dst_idx = draw_list->_IdxWritePtr;
+        for (int i = 0; i < idx_count; ++i)
+        {
+            dst_idx[i] = (ImDrawIdx)(src_idx[i] + idx_base);
+        }
+
+        draw_list->_VtxWritePtr += vtx_count;
+        draw_list->_IdxWritePtr += idx_count;
+        draw_list->_VtxCurrentIdx += (unsigned int)vtx_count;
+    }
+}
+
+// Hovered nodes aren't part of the cached contents, they are drawn on top of them every frame.
+static void MiniMapDrawHoveredNodes(ImNodesEditorContext& editor)
+{
+    if (editor.ClickInteraction.Type != ImNodesClickInteractionType_None || !IsMiniMapHovered())
+    {
+        return;
+    }
+
+    for (int node_idx = 0; node_idx < editor.Nodes.Pool.size(); ++node_idx)
+    {
+        if (!editor.Nodes.InUse[node_idx])
+        {
+            continue;
+        }
+
+        const ImNodeData& node = editor.Nodes.Pool[node_idx];
+        const ImRect      node_rect = ScreenSpaceToMiniMapSpace(editor, node.Rect);
+        if (!ImGui::IsMouseHoveringRect(node_rect.Min, node_rect.Max))
+        {
+            continue;
+        }
+
+        MiniMapDrawNode(
+            GImNodes->CanvasDrawList,
+            node,
+            node_rect,
+            editor.MiniMapScaling,
+            GImNodes->Style.Colors[ImNodesCol_MiniMapNodeBackgroundHovered]);
+
+        // Run user callback when hovering a mini-map node
+        if (editor.MiniMapNodeHoveringCallback)
+        {
+            editor.MiniMapNodeHoveringCallback(node.Id, editor.MiniMapNodeHoveringCallbackUserData);
         }
     }
+}
+
+static void MiniMapUpdate()
+{
+    ImNodesEditorContext& editor = EditorContextGet();
+
+    ImU32 mini_map_background;
+
+    if (IsMiniMapHovered())
+    {
+        mini_map_background = GImNodes->Style.Colors[ImNodesCol_MiniMapBackgroundHovered];
+    }
+    else
+    {
+        mini_map_background = GImNodes->Style.Colors[ImNodesCol_MiniMapBackground];
+    }
+
+    // Create a child window bellow mini-map, so it blocks all mouse interaction on canvas.
+    int flags = ImGuiWindowFlags_NoBackground;
+    ImGui::SetCursorScreenPos(editor.MiniMapRectScreenSpace.Min);
+    ImGui::BeginChild("minimap", editor.MiniMapRectScreenSpace.GetSize(), false, flags);
+
+    const ImRect& mini_map_rect = editor.MiniMapRectScreenSpace;
+
+    // The background is only part of the cached contents when they are rendered to a texture,
+    // where it is used as the clear color.
+    const bool has_render_callback = GImNodes->Io.MiniMapTexture.RenderCallback != NULL;
+    MiniMapUpdateCache(editor, has_render_callback ? mini_map_background : 0);
+
+    // Draw minimap background and border
+    if (editor.MiniMapCacheTexture != ImTextureID())
+    {
+        GImNodes->CanvasDrawList->AddImage(
+            editor.MiniMapCacheTexture, mini_map_rect.Min, mini_map_rect.Max);
+    }
+    else
+    {
+        GImNodes->CanvasDrawList->AddRectFilled(
+            mini_map_rect.Min, mini_map_rect.Max, mini_map_background);
+    }
+
+    GImNodes->CanvasDrawList->AddRect(
+        mini_map_rect.Min, mini_map_rect.Max, GImNodes->Style.Colors[ImNodesCol_MiniMapOutline]);
+
+    // Clip draw list items to mini-map rect (after drawing background/outline)
+    GImNodes->CanvasDrawList->PushClipRect(
+        mini_map_rect.Min, mini_map_rect.Max, true /* intersect with editor clip-rect */);
+
+    if (editor.MiniMapCacheTexture == ImTextureID())
+    {
+        MiniMapReplayCache(editor, GImNodes->CanvasDrawList);
+    }
+
+    MiniMapDrawHoveredNodes(editor);
 
     // Draw editor canvas rect inside mini-map
     {
@@ -1975,6 +2434,533 @@ bool IsObjectSelected(const ImObjectPool<T>& objects, ImVector<int>& selected_in
 }
 
 } // namespace
+
+// [SECTION] link batch renderer
+
+namespace
+{
+#if defined(IMNODES_ENABLE_AVX)
+typedef __m256 ImSimdFloat;
+#define IMNODES_SIMD_WIDTH 8
+inline ImSimdFloat SimdLoad(const float* p) { return _mm256_loadu_ps(p); }
+inline void        SimdStore(float* p, const ImSimdFloat v) { _mm256_storeu_ps(p, v); }
+inline ImSimdFloat SimdSet1(const float f) { return _mm256_set1_ps(f); }
+inline ImSimdFloat SimdIota() { return _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f); }
+inline ImSimdFloat SimdAdd(const ImSimdFloat a, const ImSimdFloat b) { return _mm256_add_ps(a, b); }
+inline ImSimdFloat SimdSub(const ImSimdFloat a, const ImSimdFloat b) { return _mm256_sub_ps(a, b); }
+inline ImSimdFloat SimdMul(const ImSimdFloat a, const ImSimdFloat b) { return _mm256_mul_ps(a, b); }
+inline ImSimdFloat SimdDiv(const ImSimdFloat a, const ImSimdFloat b) { return _mm256_div_ps(a, b); }
+inline ImSimdFloat SimdMin(const ImSimdFloat a, const ImSimdFloat b) { return _mm256_min_ps(a, b); }
+inline ImSimdFloat SimdSqrt(const ImSimdFloat a) { return _mm256_sqrt_ps(a); }
+// Returns (a > b) ? if_true : if_false, per lane
+inline ImSimdFloat SimdSelectGt(
+    const ImSimdFloat a,
+    const ImSimdFloat b,
+    const ImSimdFloat if_true,
+    const ImSimdFloat if_false)
+{
+    return _mm256_blendv_ps(if_false, if_true, _mm256_cmp_ps(a, b, _CMP_GT_OQ));
+}
+#elif defined(IMNODES_ENABLE_SSE)
+typedef __m128 ImSimdFloat;
+#define IMNODES_SIMD_WIDTH 4
+inline ImSimdFloat SimdLoad(const float* p) { return _mm_loadu_ps(p); }
+inline void        SimdStore(float* p, const ImSimdFloat v) { _mm_storeu_ps(p, v); }
+inline ImSimdFloat SimdSet1(const float f) { return _mm_set1_ps(f); }
+inline ImSimdFloat SimdIota() { return _mm_setr_ps(0.f, 1.f, 2.f, 3.f); }
+inline ImSimdFloat SimdAdd(const ImSimdFloat a, const ImSimdFloat b) { return _mm_add_ps(a, b); }
+inline ImSimdFloat SimdSub(const ImSimdFloat a, const ImSimdFloat b) { return _mm_sub_ps(a, b); }
+inline ImSimdFloat SimdMul(const ImSimdFloat a, const ImSimdFloat b) { return _mm_mul_ps(a, b); }
+inline ImSimdFloat SimdDiv(const ImSimdFloat a, const ImSimdFloat b) { return _mm_div_ps(a, b); }
+inline ImSimdFloat SimdMin(const ImSimdFloat a, const ImSimdFloat b) { return _mm_min_ps(a, b); }
+inline ImSimdFloat SimdSqrt(const ImSimdFloat a) { return _mm_sqrt_ps(a); }
+inline ImSimdFloat SimdSelectGt(
+    const ImSimdFloat a,
+    const ImSimdFloat b,
+    const ImSimdFloat if_true,
+    const ImSimdFloat if_false)
+{
+    const __m128 mask = _mm_cmpgt_ps(a, b);
+    return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+}
+#elif defined(IMNODES_ENABLE_NEON)
+typedef float32x4_t ImSimdFloat;
+#define IMNODES_SIMD_WIDTH 4
+inline ImSimdFloat SimdLoad(const float* p) { return vld1q_f32(p); }
+inline void        SimdStore(float* p, const ImSimdFloat v) { vst1q_f32(p, v); }
+inline ImSimdFloat SimdSet1(const float f) { return vdupq_n_f32(f); }
+inline ImSimdFloat SimdIota()
+{
+    static const float iota[4] = {0.f, 1.f, 2.f, 3.f};
+    return vld1q_f32(iota);
+}
+inline ImSimdFloat SimdAdd(const ImSimdFloat a, const ImSimdFloat b) { return vaddq_f32(a, b); }
+inline ImSimdFloat SimdSub(const ImSimdFloat a, const ImSimdFloat b) { return vsubq_f32(a, b); }
+inline ImSimdFloat SimdMul(const ImSimdFloat a, const ImSimdFloat b) { return vmulq_f32(a, b); }
+inline ImSimdFloat SimdDiv(const ImSimdFloat a, const ImSimdFloat b) { return vdivq_f32(a, b); }
+inline ImSimdFloat SimdMin(const ImSimdFloat a, const ImSimdFloat b) { return vminq_f32(a, b); }
+inline ImSimdFloat SimdSqrt(const ImSimdFloat a) { return vsqrtq_f32(a); }
+inline ImSimdFloat SimdSelectGt(
+    const ImSimdFloat a,
+    const ImSimdFloat b,
+    const ImSimdFloat if_true,
+    const ImSimdFloat if_false)
+{
+    return vbslq_f32(vcgtq_f32(a, b), if_true, if_false);
+}
+#else
+#define IMNODES_SIMD_WIDTH 1
+#endif
+
+// Same clamping as IM_FIXNORMAL2F in imgui_draw.cpp
+static const float LINK_BATCH_FIXNORMAL_MAX_INVLEN2 = 100.0f;
+
+// The stroke parameters of a single link, matching the anti-aliased paths of
+// ImDrawList::AddPolyline() for open polylines. Lines without anti-aliasing are drawn as a single
+// strip of full-color vertices.
+struct LinkBatchStroke
+{
+    bool   SingleStrip;        // Two vertices per point, with the UVs TexUv0 and TexUv1
+    float  HalfInnerThickness; // Unused when SingleStrip is true
+    float  HalfOuterThickness;
+    ImVec2 TexUv0, TexUv1;
+    int    VtxPerPoint, IdxPerSegment;
+};
+
+// Returns false if the stroke can't be generated by the batch renderer. This is the case for thin,
+// non-textured anti-aliased lines; those links are drawn with AddBezierCubic().
+bool LinkBatchCalcStroke(
+    const ImDrawList* draw_list,
+    float             thickness,
+    const bool        anti_aliased,
+    LinkBatchStroke*  stroke)
+{
+    if (!anti_aliased || (draw_list->Flags & ImDrawListFlags_AntiAliasedLines) == 0)
+    {
+        stroke->SingleStrip = true;
+        stroke->HalfInnerThickness = 0.f;
+        stroke->HalfOuterThickness = thickness * 0.5f;
+        stroke->TexUv0 = stroke->TexUv1 = draw_list->_Data->TexUvWhitePixel;
+        stroke->VtxPerPoint = 2;
+        stroke->IdxPerSegment = 6;
+        return true;
+    }
+
+    const float aa_size = draw_list->_FringeScale;
+    const bool  thick_line = thickness > aa_size;
+
+    thickness = ImMax(thickness, 1.0f);
+    const int   integer_thickness = (int)thickness;
+    const float fractional_thickness = thickness - integer_thickness;
+    const bool  use_texture = (draw_list->Flags & ImDrawListFlags_AntiAliasedLinesUseTex) &&
+                             (integer_thickness < IM_DRAWLIST_TEX_LINES_WIDTH_MAX) &&
+                             (fractional_thickness <= 0.00001f) && (aa_size == 1.0f);
+
+    if (use_texture)
+    {
+        const ImVec4 tex_uvs = draw_list->_Data->TexUvLines[integer_thickness];
+        stroke->SingleStrip = true;
+        stroke->HalfInnerThickness = 0.f;
+        stroke->HalfOuterThickness = (thickness * 0.5f) + 1.f;
+        stroke->TexUv0 = ImVec2(tex_uvs.x, tex_uvs.y);
+        stroke->TexUv1 = ImVec2(tex_uvs.z, tex_uvs.w);
+        stroke->VtxPerPoint = 2;
+        stroke->IdxPerSegment = 6;
+        return true;
+    }
+
+    if (thick_line)
+    {
+        stroke->SingleStrip = false;
+        stroke->HalfInnerThickness = (thickness - aa_size) * 0.5f;
+        stroke->HalfOuterThickness = stroke->HalfInnerThickness + aa_size;
+        stroke->TexUv0 = stroke->TexUv1 = draw_list->_Data->TexUvWhitePixel;
+        stroke->VtxPerPoint = 4;
+        stroke->IdxPerSegment = 18;
+        return true;
+    }
+
+    return false;
+}
+
+// Evaluates the curve at t = i / NumSegments, for i in [0, NumSegments]
+void LinkBatchEvalCurveScalar(const ImLinkBatchEntry& entry, float* xs, float* ys)
+{
+    const float t_step = 1.0f / (float)entry.NumSegments;
+    xs[0] = entry.P0.x;
+    ys[0] = entry.P0.y;
+    for (int i = 1; i <= entry.NumSegments; ++i)
+    {
+        const ImVec2 p = EvalCubicBezier(t_step * i, entry.P0, entry.P1, entry.P2, entry.P3);
+        xs[i] = p.x;
+        ys[i] = p.y;
+    }
+}
+
+// Calculates the per-point offset directions of the stroke. Each point's direction is the average of
+// the normals of the adjacent line segments, scaled the same way as in ImDrawList::AddPolyline().
+void LinkBatchCalcNormalsScalar(
+    const float* xs,
+    const float* ys,
+    const int    num_points,
+    float*       nx,
+    float*       ny,
+    float*       dmx,
+    float*       dmy)
+{
+    const int count = num_points - 1;
+    for (int i = 0; i < count; ++i)
+    {
+        float       dx = xs[i + 1] - xs[i];
+        float       dy = ys[i + 1] - ys[i];
+        const float d2 = dx * dx + dy * dy;
+        if (d2 > 0.0f)
+        {
+            const float inv_len = 1.0f / sqrtf(d2);
+            dx *= inv_len;
+            dy *= inv_len;
+        }
+        nx[i] = dy;
+        ny[i] = -dx;
+    }
+    nx[count] = nx[count - 1];
+    ny[count] = ny[count - 1];
+
+    dmx[0] = nx[0];
+    dmy[0] = ny[0];
+    for (int i = 1; i < num_points; ++i)
+    {
+        float       x = (nx[i - 1] + nx[i]) * 0.5f;
+        float       y = (ny[i - 1] + ny[i]) * 0.5f;
+        const float d2 = x * x + y * y;
+        if (d2 > 0.000001f)
+        {
+            const float inv_len2 = ImMin(1.0f / d2, LINK_BATCH_FIXNORMAL_MAX_INVLEN2);
+            x *= inv_len2;
+            y *= inv_len2;
+        }
+        dmx[i] = x;
+        dmy[i] = y;
+    }
+}
+
+#if IMNODES_SIMD_WIDTH > 1
+// NOTE: the SIMD kernels read and write up to IMNODES_SIMD_WIDTH floats past the end of each array.
+// The scratch arrays are padded accordingly in LinkBatchRender().
+
+void LinkBatchEvalCurveSimd(const ImLinkBatchEntry& entry, float* xs, float* ys)
+{
+    const int         num_points = entry.NumSegments + 1;
+    const ImSimdFloat t_step = SimdSet1(1.0f / (float)entry.NumSegments);
+    const ImSimdFloat one = SimdSet1(1.f);
+    const ImSimdFloat three = SimdSet1(3.f);
+    const ImSimdFloat x0 = SimdSet1(entry.P0.x), y0 = SimdSet1(entry.P0.y);
+    const ImSimdFloat x1 = SimdSet1(entry.P1.x), y1 = SimdSet1(entry.P1.y);
+    const ImSimdFloat x2 = SimdSet1(entry.P2.x), y2 = SimdSet1(entry.P2.y);
+    const ImSimdFloat x3 = SimdSet1(entry.P3.x), y3 = SimdSet1(entry.P3.y);
+    const ImSimdFloat idx_step = SimdSet1((float)IMNODES_SIMD_WIDTH);
+
+    ImSimdFloat idx = SimdIota();
+    for (int i = 0; i < num_points; i += IMNODES_SIMD_WIDTH)
+    {
+        const ImSimdFloat t = SimdMul(idx, t_step);
+        const ImSimdFloat u = SimdSub(one, t);
+        const ImSimdFloat uu = SimdMul(u, u);
+        const ImSimdFloat tt = SimdMul(t, t);
+        const ImSimdFloat b0 = SimdMul(uu, u);
+        const ImSimdFloat b1 = SimdMul(three, SimdMul(uu, t));
+        const ImSimdFloat b2 = SimdMul(three, SimdMul(u, tt));
+        const ImSimdFloat b3 = SimdMul(tt, t);
+
+        const ImSimdFloat x = SimdAdd(
+            SimdAdd(SimdMul(b0, x0), SimdMul(b1, x1)), SimdAdd(SimdMul(b2, x2), SimdMul(b3, x3)));
+        const ImSimdFloat y = SimdAdd(
+            SimdAdd(SimdMul(b0, y0), SimdMul(b1, y1)), SimdAdd(SimdMul(b2, y2), SimdMul(b3, y3)));
+        SimdStore(xs + i, x);
+        SimdStore(ys + i, y);
+
+        idx = SimdAdd(idx, idx_step);
+    }
+}
+
+void LinkBatchCalcNormalsSimd(
+    const float* xs,
+    const float* ys,
+    const int    num_points,
+    float*       nx,
+    float*       ny,
+    float*       dmx,
+    float*       dmy)
+{
+    const ImSimdFloat zero = SimdSet1(0.f);
+    const ImSimdFloat one = SimdSet1(1.f);
+    const ImSimdFloat half = SimdSet1(0.5f);
+    const ImSimdFloat min_len2 = SimdSet1(0.000001f);
+    const ImSimdFloat max_inv_len2 = SimdSet1(LINK_BATCH_FIXNORMAL_MAX_INVLEN2);
+
+    const int count = num_points - 1;
+    for (int i = 0; i < count; i += IMNODES_SIMD_WIDTH)
+    {
+        const ImSimdFloat dx = SimdSub(SimdLoad(xs + i + 1), SimdLoad(xs + i));
+        const ImSimdFloat dy = SimdSub(SimdLoad(ys + i + 1), SimdLoad(ys + i));
+        const ImSimdFloat d2 = SimdAdd(SimdMul(dx, dx), SimdMul(dy, dy));
+        // Degenerate segments keep their zero-length direction, like IM_NORMALIZE2F_OVER_ZERO
+        const ImSimdFloat inv_len =
+            SimdSelectGt(d2, zero, SimdDiv(one, SimdSqrt(SimdSelectGt(d2, zero, d2, one))), one);
+        SimdStore(nx + i, SimdMul(dy, inv_len));
+        SimdStore(ny + i, SimdSub(zero, SimdMul(dx, inv_len)));
+    }
+    nx[count] = nx[count - 1];
+    ny[count] = ny[count - 1];
+
+    for (int i = 1; i < num_points; i += IMNODES_SIMD_WIDTH)
+    {
+        const ImSimdFloat x = SimdMul(SimdAdd(SimdLoad(nx + i - 1), SimdLoad(nx + i)), half);
+        const ImSimdFloat y = SimdMul(SimdAdd(SimdLoad(ny + i - 1), SimdLoad(ny + i)), half);
+        const ImSimdFloat d2 = SimdAdd(SimdMul(x, x), SimdMul(y, y));
+        const ImSimdFloat scale =
+            SimdSelectGt(d2, min_len2, SimdMin(SimdDiv(one, d2), max_inv_len2), one);
+        SimdStore(dmx + i, SimdMul(x, scale));
+        SimdStore(dmy + i, SimdMul(y, scale));
+    }
+    dmx[0] = nx[0];
+    dmy[0] = ny[0];
+}
+#endif
+
+// Writes the vertices and indices of a single stroke into memory reserved with PrimReserve().
+void LinkBatchWriteStroke(
+    ImDrawList*            draw_list,
+    const LinkBatchStroke& stroke,
+    const ImU32            col,
+    const float*           xs,
+    const float*           ys,
+    const float*           dmx,
+    const float*           dmy,
+    const int              num_points)
+{
+    const unsigned int idx_base = draw_list->_VtxCurrentIdx;
+    const float        outer = stroke.HalfOuterThickness;
+    ImDrawVert*        vtx = draw_list->_VtxWritePtr;
+    ImDrawIdx*         idx = draw_list->_IdxWritePtr;
+
+    if (stroke.SingleStrip)
+    {
+        for (int i = 0; i < num_points; ++i)
+        {
+            const float ox = dmx[i] * outer;
+            const float oy = dmy[i] * outer;
+            vtx[0].pos = ImVec2(xs[i] + ox, ys[i] + oy);
+            vtx[0].uv = stroke.TexUv0;
+            vtx[0].col = col;
+            vtx[1].pos = ImVec2(xs[i] - ox, ys[i] - oy);
+            vtx[1].uv = stroke.TexUv1;
+            vtx[1].col = col;
+            vtx += 2;
+        }
+
+        for (int i = 0; i < num_points - 1; ++i)
+        {
+            const unsigned int idx1 = idx_base + 2 * i;
+            const unsigned int idx2 = idx1 + 2;
+            idx[0] = (ImDrawIdx)(idx2 + 0);
+            idx[1] = (ImDrawIdx)(idx1 + 0);
+            idx[2] = (ImDrawIdx)(idx1 + 1);
+            idx[3] = (ImDrawIdx)(idx2 + 1);
+            idx[4] = (ImDrawIdx)(idx1 + 1);
+            idx[5] = (ImDrawIdx)(idx2 + 0);
+            idx += 6;
+        }
+    }
+    else
+    {
+        const float  inner = stroke.HalfInnerThickness;
+        const ImU32  col_trans = col & ~IM_COL32_A_MASK;
+        const ImVec2 uv = stroke.TexUv0;
+        for (int i = 0; i < num_points; ++i)
+        {
+            const float ox = dmx[i] * outer;
+            const float oy = dmy[i] * outer;
+            const float ix = dmx[i] * inner;
+            const float iy = dmy[i] * inner;
+            vtx[0].pos = ImVec2(xs[i] + ox, ys[i] + oy);
+            vtx[0].uv = uv;
+            vtx[0].col = col_trans;
+            vtx[1].pos = ImVec2(xs[i] + ix, ys[i] + iy);
+            vtx[1].uv = uv;
+            vtx[1].col = col;
+            vtx[2].pos = ImVec2(xs[i] - ix, ys[i] - iy);
+            vtx[2].uv = uv;
+            vtx[2].col = col;
+            vtx[3].pos = ImVec2(xs[i] - ox, ys[i] - oy);
+            vtx[3].uv = uv;
+            vtx[3].col = col_trans;
+            vtx += 4;
+        }
+
+        for (int i = 0; i < num_points - 1; ++i)
+        {
+            const unsigned int idx1 = idx_base + 4 * i;
+            const unsigned int idx2 = idx1 + 4;
+            idx[0] = (ImDrawIdx)(idx2 + 1);
+            idx[1] = (ImDrawIdx)(idx1 + 1);
+            idx[2] = (ImDrawIdx)(idx1 + 2);
+            idx[3] = (ImDrawIdx)(idx1 + 2);
+            idx[4] = (ImDrawIdx)(idx2 + 2);
+            idx[5] = (ImDrawIdx)(idx2 + 1);
+            idx[6] = (ImDrawIdx)(idx2 + 1);
+            idx[7] = (ImDrawIdx)(idx1 + 1);
+            idx[8] = (ImDrawIdx)(idx1 + 0);
+            idx[9] = (ImDrawIdx)(idx1 + 0);
+            idx[10] = (ImDrawIdx)(idx2 + 0);
+            idx[11] = (ImDrawIdx)(idx2 + 1);
+            idx[12] = (ImDrawIdx)(idx2 + 2);
+            idx[13] = (ImDrawIdx)(idx1 + 2);
+            idx[14] = (ImDrawIdx)(idx1 + 3);
+            idx[15] = (ImDrawIdx)(idx1 + 3);
+            idx[16] = (ImDrawIdx)(idx2 + 3);
+            idx[17] = (ImDrawIdx)(idx2 + 2);
+            idx += 18;
+        }
+    }
+
+    draw_list->_VtxWritePtr = vtx;
+    draw_list->_IdxWritePtr = idx;
+    draw_list->_VtxCurrentIdx += (unsigned int)(num_points * stroke.VtxPerPoint);
+}
+} // namespace
+
+void LinkBatchRender(
+    ImDrawList* const             draw_list,
+    const ImLinkBatchEntry* const entries,
+    const int                     count,
+    const ImNodesLinkBatchKernel  kernel)
+{
+    IM_ASSERT(draw_list != NULL);
+    IM_ASSERT(count == 0 || entries != NULL);
+
+#if IMNODES_SIMD_WIDTH > 1
+    const bool use_simd = kernel == ImNodesLinkBatchKernel_Simd;
+#else
+    (void)kernel;
+#endif
+
+    int max_num_points = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        IM_ASSERT(entries[i].NumSegments > 0);
+        max_num_points = ImMax(max_num_points, entries[i].NumSegments + 1);
+    }
+
+    // Six scratch arrays: points, segment normals and stroke directions, each padded for the SIMD
+    // kernels.
+    const int stride = max_num_points + 2 * IMNODES_SIMD_WIDTH;
+    GImNodes->LinkBatchScratch.reserve_discard(6 * stride);
+    float* const xs = GImNodes->LinkBatchScratch.Data;
+    float* const ys = xs + stride;
+    float* const nx = ys + stride;
+    float* const ny = nx + stride;
+    float* const dmx = ny + stride;
+    float* const dmy = dmx + stride;
+
+    // With 16-bit indices, the geometry of a single reservation must be addressable from one vertex
+    // offset.
+    const int max_vtx_per_reservation = sizeof(ImDrawIdx) == 2 ? (1 << 16) - 1 : INT_MAX;
+
+    int entry_idx = 0;
+    while (entry_idx < count)
+    {
+        // Find the longest run of links which can be written into one reserved region
+        int run_end = entry_idx;
+        int run_vtx_count = 0;
+        int run_idx_count = 0;
+        for (; run_end < count; ++run_end)
+        {
+            const ImLinkBatchEntry& entry = entries[run_end];
+            if ((entry.Color & IM_COL32_A_MASK) == 0)
+            {
+                continue;
+            }
+
+            LinkBatchStroke stroke;
+            if (!LinkBatchCalcStroke(draw_list, entry.Thickness, entry.AntiAliased, &stroke))
+            {
+                break;
+            }
+
+            const int vtx_count = (entry.NumSegments + 1) * stroke.VtxPerPoint;
+            if (run_vtx_count + vtx_count > max_vtx_per_reservation)
+            {
+                break;
+            }
+            run_vtx_count += vtx_count;
+            run_idx_count += entry.NumSegments * stroke.IdxPerSegment;
+        }
+
+        // The link at entry_idx is not handled by the batch renderer
+        if (run_end == entry_idx)
+        {
+            const ImLinkBatchEntry& entry = entries[entry_idx];
+#if IMGUI_VERSION_NUM < 18000
+            draw_list->AddBezierCurve(
+#else
+            draw_list->AddBezierCubic(
+#endif
+                entry.P0,
+                entry.P1,
+                entry.P2,
+                entry.P3,
+                entry.Color,
+                entry.Thickness,
+                entry.NumSegments);
+            ++entry_idx;
+            continue;
+        }
+
+        draw_list->PrimReserve(run_idx_count, run_vtx_count);
+
+        for (; entry_idx < run_end; ++entry_idx)
+        {
+            const ImLinkBatchEntry& entry = entries[entry_idx];
+            if ((entry.Color & IM_COL32_A_MASK) == 0)
+            {
+                continue;
+            }
+
+            LinkBatchStroke stroke;
+            LinkBatchCalcStroke(draw_list, entry.Thickness, entry.AntiAliased, &stroke);
+
+            const int num_points = entry.NumSegments + 1;
+#if IMNODES_SIMD_WIDTH > 1
+            if (use_simd)
+            {
+                LinkBatchEvalCurveSimd(entry, xs, ys);
+                LinkBatchCalcNormalsSimd(xs, ys, num_points, nx, ny, dmx, dmy);
+            }
+            else
+#endif
+            {
+                LinkBatchEvalCurveScalar(entry, xs, ys);
+                LinkBatchCalcNormalsScalar(xs, ys, num_points, nx, ny, dmx, dmy);
+            }
+
+            LinkBatchWriteStroke(draw_list, stroke, entry.Color, xs, ys, dmx, dmy, num_points);
+        }
+    }
+}
+
+const char* LinkBatchSimdInstructionSet()
+{
+#if defined(IMNODES_ENABLE_AVX)
+    return "AVX";
+#elif defined(IMNODES_ENABLE_SSE)
+    return "SSE";
+#elif defined(IMNODES_ENABLE_NEON)
+    return "NEON";
+#else
+    return NULL;
+#endif
+}
 } // namespace IMNODES_NAMESPACE
 
 // [SECTION] API implementation
@@ -1985,15 +2971,19 @@ ImNodesIO::LinkDetachWithModifierClick::LinkDetachWithModifierClick() : Modifier
 
 ImNodesIO::MultipleSelectModifier::MultipleSelectModifier() : Modifier(NULL) {}
 
+ImNodesIO::MiniMapTexture::MiniMapTexture() : RenderCallback(NULL), UserData(NULL) {}
+
 ImNodesIO::ImNodesIO()
     : EmulateThreeButtonMouse(), LinkDetachWithModifierClick(),
-      AltMouseButton(ImGuiMouseButton_Middle), AutoPanningSpeed(1000.0f)
+      AltMouseButton(ImGuiMouseButton_Middle), AutoPanningSpeed(1000.0f), MiniMapTexture(),
+      MiniMapRefreshInterval(1.0f / 30.0f), JournalCompactionRatio(1.0f)
 {
 }
 
 ImNodesStyle::ImNodesStyle()
     : GridSpacing(24.f), NodeCornerRounding(4.f), NodePadding(8.f, 8.f), NodeBorderThickness(1.f),
       LinkThickness(3.f), LinkLineSegmentsPerLength(0.1f), LinkHoverDistance(10.f),
+      LinkLodThickness(1.f), LinkLodLengthThreshold(16.f), LinkLodCountThreshold(1000),
       PinCircleRadius(4.f), PinQuadSideLength(7.f), PinTriangleSideLength(9.5),
       PinLineThickness(1.f), PinHoverRadius(10.f), PinOffset(0.f), MiniMapPadding(8.0f, 8.0f),
       MiniMapOffset(4.0f, 4.0f), Flags(ImNodesStyleFlags_NodeOutline | ImNodesStyleFlags_GridLines),
@@ -2199,6 +3189,55 @@ void StyleColorsLight(ImNodesStyle* dest)
     dest->Colors[ImNodesCol_MiniMapCanvasOutline] = IM_COL32(200, 200, 200, 200);
 }
 
+void AddPinShapesToFontAtlas(ImFontAtlas* atlas)
+{
+    if (atlas == NULL)
+    {
+        atlas = ImGui::GetIO().Fonts;
+    }
+
+    ImPinShapeAtlas&    shapes = GImNodes->PinShapeAtlas;
+    const ImNodesStyle& style = GImNodes->Style;
+
+    // Register a rectangle for each shape. The rectangles of a previous call are reused if they
+    // still have the right size, since the atlas has no way of removing them.
+    bool rebuild = atlas->TexPixelsAlpha8 == NULL && atlas->TexPixelsRGBA32 == NULL;
+    for (int shape = 0; shape < ImNodesPinShape_COUNT; ++shape)
+    {
+        const int glyph_size = 2 * PinShapeGlyphHalfSize(shape, style);
+        int       rect_id = shapes.Atlas == atlas ? shapes.RectIds[shape] : -1;
+        if (rect_id < 0 || rect_id >= atlas->CustomRects.Size ||
+            atlas->CustomRects[rect_id].Width != glyph_size)
+        {
+            rect_id = atlas->AddCustomRectRegular(glyph_size, glyph_size);
+        }
+        rebuild |= !atlas->GetCustomRectByIndex(rect_id)->IsPacked();
+        shapes.RectIds[shape] = rect_id;
+        shapes.HalfSize[shape] = glyph_size / 2;
+    }
+
+    if (rebuild)
+    {
+        atlas->ClearTexData();
+        atlas->Build();
+    }
+
+    for (int shape = 0; shape < ImNodesPinShape_COUNT; ++shape)
+    {
+        const ImFontAtlasCustomRect* rect = atlas->GetCustomRectByIndex(shapes.RectIds[shape]);
+        PinShapeRasterize(atlas, shape, style, *rect);
+        atlas->CalcCustomRectUV(rect, &shapes.UvMin[shape], &shapes.UvMax[shape]);
+    }
+
+    shapes.Atlas = atlas;
+    shapes.TexWidth = atlas->TexWidth;
+    shapes.TexHeight = atlas->TexHeight;
+    shapes.PinCircleRadius = style.PinCircleRadius;
+    shapes.PinQuadSideLength = style.PinQuadSideLength;
+    shapes.PinTriangleSideLength = style.PinTriangleSideLength;
+    shapes.PinLineThickness = style.PinLineThickness;
+}
+
 void BeginNodeEditor()
 {
     IM_ASSERT(GImNodes->CurrentScope == ImNodesScope_None);
@@ -2330,27 +3369,37 @@ void EndNodeEditor()
     {
         if (editor.Nodes.InUse[node_idx])
         {
-            DrawListActivateNodeBackground(node_idx);
+            DrawListBeginNodeBackground(node_idx);
             DrawNode(editor, node_idx);
+            DrawListEndNodeBackground(node_idx);
         }
     }
 
     // In order to render the links underneath the nodes, we want to first select the bottom draw
     // channel.
-    GImNodes->CanvasDrawList->ChannelsSetCurrent(0);
+    GImNodes->CanvasDrawList->ChannelsSetCurrent(ImNodesDrawChannel_Canvas);
+
+    int link_count = 0;
+    for (int link_idx = 0; link_idx < editor.Links.Pool.size(); ++link_idx)
+    {
+        link_count += editor.Links.InUse[link_idx] ? 1 : 0;
+    }
+    const bool dense_links = GImNodes->Style.LinkLodCountThreshold > 0 &&
+                             link_count > GImNodes->Style.LinkLodCountThreshold;
 
+    GImNodes->LinkBatch.resize(0);
     for (int link_idx = 0; link_idx < editor.Links.Pool.size(); ++link_idx)
     {
         if (editor.Links.InUse[link_idx])
         {
-            DrawLink(editor, link_idx);
+            DrawLink(editor, link_idx, dense_links);
         }
     }
+    LinkBatchRender(GImNodes->CanvasDrawList, GImNodes->LinkBatch.Data, GImNodes->LinkBatch.Size);
 
     // Render the click interaction UI elements (partial links, box selector) on top of everything
     // else.
 
-    DrawListAppendClickInteractionChannel();
     DrawListActivateClickInteractionChannel();
 
     if (IsMiniMapActive())
@@ -2409,7 +3458,7 @@ void EndNodeEditor()
     ObjectPoolUpdate(editor.Nodes);
     ObjectPoolUpdate(editor.Pins);
 
-    DrawListSortChannelsByDepth(editor.NodeDepthOrder);
+    DrawListSortNodesByDepth(editor.NodeDepthOrder);
 
     // After the links have been rendered, the link pool can be updated as well.
     ObjectPoolUpdate(editor.Links);
@@ -2482,7 +3531,6 @@ void BeginNode(const int node_id)
     ImGui::SetCursorPos(GridSpaceToEditorSpace(editor, GetNodeTitleBarOrigin(node)));
 
     DrawListAddNode(node_idx);
-    DrawListActivateCurrentNodeForeground();
 
     ImGui::PushID(node.Id);
     ImGui::BeginGroup();
@@ -2677,6 +3725,10 @@ static const ImNodesStyleVarInfo GStyleVarInfo[] = {
     {ImGuiDataType_Float, 2, (ImU32)offsetof(ImNodesStyle, MiniMapPadding)},
     // ImNodesStyleVar_MiniMapOffset
     {ImGuiDataType_Float, 2, (ImU32)offsetof(ImNodesStyle, MiniMapOffset)},
+    // ImNodesStyleVar_LinkLodThickness
+    {ImGuiDataType_Float, 1, (ImU32)offsetof(ImNodesStyle, LinkLodThickness)},
+    // ImNodesStyleVar_LinkLodLengthThreshold
+    {ImGuiDataType_Float, 1, (ImU32)offsetof(ImNodesStyle, LinkLodLengthThreshold)},
 };
 
 static const ImNodesStyleVarInfo* GetStyleVarInfo(ImNodesStyleVar idx)
@@ -2737,22 +3789,22 @@ void PopStyleVar(int count)
 void SetNodeScreenSpacePos(const int node_id, const ImVec2& screen_space_pos)
 {
     ImNodesEditorContext& editor = EditorContextGet();
-    ImNodeData&           node = ObjectPoolFindOrCreateObject(editor.Nodes, node_id);
-    node.Origin = ScreenSpaceToGridSpace(editor, screen_space_pos);
+    const int             node_idx = ObjectPoolFindOrCreateIndex(editor.Nodes, node_id);
+    SetNodeOrigin(editor, node_idx, ScreenSpaceToGridSpace(editor, screen_space_pos));
 }
 
 void SetNodeEditorSpacePos(const int node_id, const ImVec2& editor_space_pos)
 {
     ImNodesEditorContext& editor = EditorContextGet();
-    ImNodeData&           node = ObjectPoolFindOrCreateObject(editor.Nodes, node_id);
-    node.Origin = EditorSpaceToGridSpace(editor, editor_space_pos);
+    const int             node_idx = ObjectPoolFindOrCreateIndex(editor.Nodes, node_id);
+    SetNodeOrigin(editor, node_idx, EditorSpaceToGridSpace(editor, editor_space_pos));
 }
 
 void SetNodeGridSpacePos(const int node_id, const ImVec2& grid_pos)
 {
     ImNodesEditorContext& editor = EditorContextGet();
-    ImNodeData&           node = ObjectPoolFindOrCreateObject(editor.Nodes, node_id);
-    node.Origin = grid_pos;
+    const int             node_idx = ObjectPoolFindOrCreateIndex(editor.Nodes, node_id);
+    SetNodeOrigin(editor, node_idx, grid_pos);
 }
 
 void SetNodeDraggable(const int node_id, const bool draggable)
@@ -2792,8 +3844,8 @@ ImVec2 GetNodeGridSpacePos(const int node_id)
 void SnapNodeToGrid(int node_id)
 {
     ImNodesEditorContext& editor = EditorContextGet();
-    ImNodeData&           node = ObjectPoolFindOrCreateObject(editor.Nodes, node_id);
-    node.Origin = SnapOriginToGrid(node.Origin);
+    const int             node_idx = ObjectPoolFindOrCreateIndex(editor.Nodes, node_id);
+    SetNodeOrigin(editor, node_idx, SnapOriginToGrid(editor.Nodes.Pool[node_idx].Origin));
 }
 
 bool IsEditorHovered() { return MouseInCanvas(); }
@@ -3098,168 +4150,1340 @@ bool IsLinkDestroyed(int* const link_id)
     return link_destroyed;
 }
 
-namespace
-{
-void NodeLineHandler(ImNodesEditorContext& editor, const char* const line)
+bool IsNodeDragFinished(ImVec2* const delta)
 {
-    int id;
-    int x, y;
-    if (sscanf(line, "[node.%i", &id) == 1)
-    {
-        const int node_idx = ObjectPoolFindOrCreateIndex(editor.Nodes, id);
-        GImNodes->CurrentNodeIdx = node_idx;
-        ImNodeData& node = editor.Nodes.Pool[node_idx];
-        node.Id = id;
-    }
-    else if (sscanf(line, "origin=%i,%i", &x, &y) == 2)
+    IM_ASSERT(GImNodes->CurrentScope == ImNodesScope_None);
+
+    const bool is_finished = (GImNodes->ImNodesUIState & ImNodesUIState_NodeDragFinished) != 0;
+    if (is_finished && delta != NULL)
     {
-        ImNodeData& node = editor.Nodes.Pool[GImNodes->CurrentNodeIdx];
-        node.Origin = SnapOriginToGrid(ImVec2((float)x, (float)y));
+        *delta = EditorContextGet().DragDelta;
     }
+
+    return is_finished;
 }
 
-void EditorLineHandler(ImNodesEditorContext& editor, const char* const line)
+int NumDraggedNodes()
 {
-    (void)sscanf(line, "panning=%f,%f", &editor.Panning.x, &editor.Panning.y);
+    IM_ASSERT(GImNodes->CurrentScope == ImNodesScope_None);
+    const ImNodesEditorContext& editor = EditorContextGet();
+    return editor.DraggedNodeIds.size();
 }
-} // namespace
 
-const char* SaveCurrentEditorStateToIniString(size_t* const data_size)
+void GetDraggedNodes(int* const node_ids)
 {
-    return SaveEditorStateToIniString(&EditorContextGet(), data_size);
+    IM_ASSERT(node_ids != NULL);
+
+    const ImNodesEditorContext& editor = EditorContextGet();
+    memcpy(node_ids, editor.DraggedNodeIds.Data, editor.DraggedNodeIds.size() * sizeof(int));
 }
 
-const char* SaveEditorStateToIniString(
-    const ImNodesEditorContext* const editor_ptr,
-    size_t* const                     data_size)
+namespace
 {
-    IM_ASSERT(editor_ptr != NULL);
-    const ImNodesEditorContext& editor = *editor_ptr;
-
-    GImNodes->TextBuffer.clear();
-    // TODO: check to make sure that the estimate is the upper bound of element
-    GImNodes->TextBuffer.reserve(64 * editor.Nodes.Pool.size());
+inline size_t BinaryStateMaxSize(const ImNodesEditorContext& editor)
+{
+    return sizeof(ImNodesBinaryStateHeader) +
+           (size_t)editor.Nodes.Pool.size() * sizeof(ImNodesBinaryStateNode);
+}
 
-    GImNodes->TextBuffer.appendf(
-        "[editor]\npanning=%i,%i\n", (int)editor.Panning.x, (int)editor.Panning.y);
+// Writes the binary state of the editor to data, which must hold at least BinaryStateMaxSize()
+// bytes. Returns the size of the state.
+size_t BinaryStateWrite(const ImNodesEditorContext& editor, char* const data)
+{
+    ImNodesBinaryStateHeader header;
+    memset(&header, 0, sizeof(header));
+    header.Magic = IMNODES_BINARY_STATE_MAGIC;
+    header.Version = IMNODES_BINARY_STATE_VERSION;
+    header.HeaderSize = sizeof(ImNodesBinaryStateHeader);
+    header.NodeRecordSize = sizeof(ImNodesBinaryStateNode);
+    header.MinReaderVersion = 1u;
+    header.JournalGeneration = editor.JournalGeneration;
+    header.PanningX = editor.Panning.x;
+    header.PanningY = editor.Panning.y;
 
+    ImNodesBinaryStateNode* const records =
+        (ImNodesBinaryStateNode*)(data + sizeof(ImNodesBinaryStateHeader));
+    int node_count = 0;
     for (int i = 0; i < editor.Nodes.Pool.size(); i++)
     {
         if (editor.Nodes.InUse[i])
         {
-            const ImNodeData& node = editor.Nodes.Pool[i];
-            GImNodes->TextBuffer.appendf("\n[node.%d]\n", node.Id);
-            GImNodes->TextBuffer.appendf("origin=%i,%i\n", (int)node.Origin.x, (int)node.Origin.y);
+            const ImNodeData&       node = editor.Nodes.Pool[i];
+            ImNodesBinaryStateNode& record = records[node_count++];
+            record.Id = node.Id;
+            record.OriginX = node.Origin.x;
+            record.OriginY = node.Origin.y;
         }
     }
 
-    if (data_size != NULL)
+    header.NodeCount = (ImU32)node_count;
+    memcpy(data, &header, sizeof(header));
+    return sizeof(ImNodesBinaryStateHeader) + node_count * sizeof(ImNodesBinaryStateNode);
+}
+
+// Checks the header of a binary editor state. On success, returns the panning, the journal
+// generation and the node records, which may be unaligned.
+bool BinaryStateParse(
+    const void* const  data,
+    const size_t       data_size,
+    ImVec2* const      panning,
+    ImU32* const       journal_generation,
+    const char** const records,
+    size_t* const      record_size,
+    int* const         record_count)
+{
+    ImNodesBinaryStateHeader header;
+    memset(&header, 0, sizeof(header));
+    if (data == NULL || data_size < IMNODES_BINARY_STATE_V1_HEADER_SIZE)
     {
-        *data_size = GImNodes->TextBuffer.size();
+        return false;
+    }
+    memcpy(&header, data, IMNODES_BINARY_STATE_V1_HEADER_SIZE);
+    if (header.HeaderSize < IMNODES_BINARY_STATE_V1_HEADER_SIZE ||
+        (size_t)header.HeaderSize > data_size)
+    {
+        return false;
+    }
+    memcpy(&header, data, ImMin((size_t)header.HeaderSize, sizeof(header)));
+
+    // Fields appended by newer versions are skipped using the sizes below. Data which older readers
+    // can't read that way says so through MinReaderVersion, and is rejected like an unknown version.
+    const ImU32 min_reader_version =
+        header.HeaderSize >= IMNODES_BINARY_STATE_V1_HEADER_SIZE + sizeof(ImU32)
+            ? header.MinReaderVersion
+            : header.Version;
+    if (header.Magic != IMNODES_BINARY_STATE_MAGIC || min_reader_version < 1u ||
+        min_reader_version > header.Version || min_reader_version > IMNODES_BINARY_STATE_VERSION ||
+        header.NodeRecordSize < sizeof(ImNodesBinaryStateNode) || header.NodeCount > (ImU32)INT_MAX)
+    {
+        return false;
     }
 
-    return GImNodes->TextBuffer.c_str();
+    if ((size_t)header.NodeCount > (data_size - header.HeaderSize) / header.NodeRecordSize)
+    {
+        return false;
+    }
+
+    *panning = ImVec2(header.PanningX, header.PanningY);
+    *journal_generation = header.JournalGeneration;
+    *records = (const char*)data + header.HeaderSize;
+    *record_size = header.NodeRecordSize;
+    *record_count = (int)header.NodeCount;
+    return true;
 }
 
-void LoadCurrentEditorStateFromIniString(const char* const data, const size_t data_size)
+int BinaryStateComparePairs(const void* const lhs, const void* const rhs)
 {
-    LoadEditorStateFromIniString(&EditorContextGet(), data, data_size);
+    const ImGuiStoragePair& a = *(const ImGuiStoragePair*)lhs;
+    const ImGuiStoragePair& b = *(const ImGuiStoragePair*)rhs;
+    if (a.key != b.key)
+    {
+        return a.key < b.key ? -1 : 1;
+    }
+    return a.val_i < b.val_i ? -1 : (a.val_i > b.val_i ? 1 : 0);
 }
 
-void LoadEditorStateFromIniString(
-    ImNodesEditorContext* const editor_ptr,
-    const char* const           data,
-    const size_t                data_size)
+// Creates or updates one node per record, as if the records were loaded one after another. Unlike
+// ObjectPoolFindOrCreateIndex(), which keeps the id map sorted by inserting one id at a time, the
+// ids of new nodes are collected first and merged into the id map with a single sort.
+void LoadNodeRecords(
+    ImNodesEditorContext& editor,
+    const char* const     records,
+    const size_t          record_size,
+    const int             record_count)
 {
-    if (data_size == 0u)
+    ImObjectPool<ImNodeData>& nodes = editor.Nodes;
+    ImVector<ImGuiStoragePair> new_ids;
+
+    for (int i = 0; i < record_count; ++i)
+    {
+        ImNodesBinaryStateNode record;
+        memcpy(&record, records + i * record_size, sizeof(record));
+
+        const int node_idx = nodes.IdMap.GetInt(static_cast<ImGuiID>(record.Id), -1);
+        if (node_idx == -1)
+        {
+            new_ids.push_back(ImGuiStoragePair(static_cast<ImGuiID>(record.Id), i));
+            continue;
+        }
+
+        nodes.Pool[node_idx].Origin = SnapOriginToGrid(ImVec2(record.OriginX, record.OriginY));
+        nodes.InUse[node_idx] = true;
+    }
+
+    if (new_ids.empty())
     {
         return;
     }
 
-    ImNodesEditorContext& editor = editor_ptr == NULL ? EditorContextGet() : *editor_ptr;
+    // Sorting by record index within equal ids lets the last record of a repeated id win, as it
+    // would in the INI format. Files written by SaveEditorStateToBinaryFile() are usually sorted
+    // already.
+    bool sorted = true;
+    for (int i = 1; i < new_ids.Size && sorted; ++i)
+    {
+        sorted = BinaryStateComparePairs(&new_ids[i - 1], &new_ids[i]) < 0;
+    }
+    if (!sorted)
+    {
+        ImQsort(
+            new_ids.Data, (size_t)new_ids.Size, sizeof(ImGuiStoragePair), BinaryStateComparePairs);
+    }
+
+    const int new_node_count = new_ids.Size - nodes.FreeList.Size;
+    if (new_node_count > 0)
+    {
+        IM_ASSERT(nodes.Pool.size() == nodes.InUse.size());
+        nodes.Pool.reserve(nodes.Pool.size() + new_node_count);
+        nodes.InUse.reserve(nodes.InUse.size() + new_node_count);
+    }
+    editor.NodeDepthOrder.reserve(editor.NodeDepthOrder.size() + new_ids.Size);
+
+    int new_id_count = 0;
+    for (int i = 0; i < new_ids.Size; ++i)
+    {
+        if (i + 1 < new_ids.Size && new_ids[i + 1].key == new_ids[i].key)
+        {
+            continue;
+        }
+
+        ImNodesBinaryStateNode record;
+        memcpy(&record, records + new_ids[i].val_i * record_size, sizeof(record));
+
+        int node_idx;
+        if (nodes.FreeList.empty())
+        {
+            node_idx = nodes.Pool.size();
+            nodes.Pool.resize(node_idx + 1);
+            nodes.InUse.resize(node_idx + 1);
+        }
+        else
+        {
+            node_idx = nodes.FreeList.back();
+            nodes.FreeList.pop_back();
+        }
+        IM_PLACEMENT_NEW(nodes.Pool.Data + node_idx) ImNodeData(record.Id);
+        nodes.Pool[node_idx].Origin = SnapOriginToGrid(ImVec2(record.OriginX, record.OriginY));
+        nodes.InUse[node_idx] = true;
+        editor.NodeDepthOrder.push_back(node_idx);
 
-    char*       buf = (char*)ImGui::MemAlloc(data_size + 1);
-    const char* buf_end = buf + data_size;
-    memcpy(buf, data, data_size);
-    buf[data_size] = 0;
+        new_ids[new_id_count++] = ImGuiStoragePair(new_ids[i].key, node_idx);
+    }
 
-    void (*line_handler)(ImNodesEditorContext&, const char*);
-    line_handler = NULL;
-    char* line_end = NULL;
-    for (char* line = buf; line < buf_end; line = line_end + 1)
+    // Merge the sorted new ids into the sorted id map. The map keeps the ids of deleted nodes
+    // mapped to -1, and those entries are overwritten.
+    const ImVector<ImGuiStoragePair>& id_map = nodes.IdMap.Data;
+    ImVector<ImGuiStoragePair>        merged;
+    merged.reserve(id_map.Size + new_id_count);
+    int old_idx = 0;
+    for (int i = 0; i < new_id_count; ++i)
     {
-        while (*line == '\n' || *line == '\r')
+        while (old_idx < id_map.Size && id_map[old_idx].key < new_ids[i].key)
         {
-            line++;
+            merged.push_back(id_map[old_idx++]);
         }
-        line_end = line;
-        while (line_end < buf_end && *line_end != '\n' && *line_end != '\r')
+        if (old_idx < id_map.Size && id_map[old_idx].key == new_ids[i].key)
+        {
+            ++old_idx;
+        }
+        merged.push_back(new_ids[i]);
+    }
+    while (old_idx < id_map.Size)
+    {
+        merged.push_back(id_map[old_idx++]);
+    }
+    nodes.IdMap.Data.swap(merged);
+}
+
+// INI parsing. The parser works in place on the input range, which doesn't need to be null
+// terminated, and collects the nodes into records which are loaded in one batch.
+
+inline const char* IniSkipSpaces(const char* p, const char* const end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+    {
+        ++p;
+    }
+    return p;
+}
+
+// Returns the end of the literal, or NULL if the range doesn't start with it
+inline const char* IniParseLiteral(const char* const p, const char* const end, const char* literal)
+{
+    const size_t length = strlen(literal);
+    return (size_t)(end - p) >= length && memcmp(p, literal, length) == 0 ? p + length : NULL;
+}
+
+// Parses an integer like sscanf's %i: an optional sign, then a decimal, octal (0 prefix) or
+// hexadecimal (0x prefix) number. Returns the end of the number, or NULL on failure.
+const char* IniParseInt(const char* p, const char* const end, int* const value)
+{
+    p = IniSkipSpaces(p, end);
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-'))
+    {
+        negative = *p++ == '-';
+    }
+
+    int base = 10;
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    {
+        base = 16;
+        p += 2;
+    }
+    else if (end - p > 1 && p[0] == '0')
+    {
+        base = 8;
+    }
+
+    unsigned int                 magnitude;
+    const std::from_chars_result result = std::from_chars(p, end, magnitude, base);
+    if (result.ec != std::errc())
+    {
+        return NULL;
+    }
+    *value = (int)(negative ? 0u - magnitude : magnitude);
+    return result.ptr;
+}
+
+const char* IniParseFloat(const char* p, const char* const end, float* const value)
+{
+    p = IniSkipSpaces(p, end);
+    if (p < end && *p == '+')
+    {
+        ++p;
+    }
+
+    const std::from_chars_result result = std::from_chars(p, end, *value);
+    return result.ec == std::errc() ? result.ptr : NULL;
+}
+
+// Parses a pair of values separated by a comma. Like sscanf, the first value is stored even if the
+// second one can't be parsed. Returns the number of values stored.
+template<typename T>
+int IniParsePair(
+    const char* p,
+    const char* const end,
+    const char* (*parse)(const char*, const char*, T*),
+    T* const first,
+    T* const second)
+{
+    if ((p = parse(p, end, first)) == NULL)
+    {
+        return 0;
+    }
+    if ((p = IniParseLiteral(p, end, ",")) == NULL || parse(p, end, second) == NULL)
+    {
+        return 1;
+    }
+    return 2;
+}
+
+void IniParse(ImNodesEditorContext& editor, const char* const data, const size_t data_size)
+{
+    enum IniSection
+    {
+        IniSection_None,
+        IniSection_Editor,
+        IniSection_Node
+    };
+
+    // Nodes with an origin, and the ids of nodes without one. Only the latter keep the origin of
+    // existing nodes, so they are loaded separately.
+    ImVector<ImNodesBinaryStateNode> records;
+    ImVector<int>                    ids_without_origin;
+
+    IniSection  section = IniSection_None;
+    int         node_id = 0;
+    bool        node_has_origin = true;
+    const char* end = data + data_size;
+    for (const char* line = data; line < end;)
+    {
+        const char* line_end = line;
+        while (line_end < end && *line_end != '\n' && *line_end != '\r')
         {
             line_end++;
         }
-        line_end[0] = 0;
 
-        if (*line == ';' || *line == '\0')
+        if (line == line_end || *line == ';')
         {
+            line = line_end + 1;
             continue;
         }
 
         if (line[0] == '[' && line_end[-1] == ']')
         {
-            line_end[-1] = 0;
-            if (strncmp(line + 1, "node", 4) == 0)
+            if (section == IniSection_Node && !node_has_origin)
+            {
+                ids_without_origin.push_back(node_id);
+            }
+            node_has_origin = true;
+
+            const char* p;
+            if ((p = IniParseLiteral(line + 1, line_end, "node")) != NULL)
+            {
+                const char* const id_begin = IniParseLiteral(p, line_end, ".");
+                section = id_begin != NULL && IniParseInt(id_begin, line_end, &node_id) != NULL
+                              ? IniSection_Node
+                              : IniSection_None;
+                node_has_origin = section != IniSection_Node;
+            }
+            else
+            {
+                section = IniParseLiteral(line + 1, line_end, "editor]") == line_end
+                              ? IniSection_Editor
+                              : IniSection_None;
+            }
+        }
+        else if (section == IniSection_Node)
+        {
+            const char* const p = IniParseLiteral(line, line_end, "origin=");
+            int               x, y;
+            if (p != NULL && IniParsePair(p, line_end, IniParseInt, &x, &y) == 2)
             {
-                line_handler = NodeLineHandler;
+                if (node_has_origin)
+                {
+                    records.back().OriginX = (float)x;
+                    records.back().OriginY = (float)y;
+                }
+                else
+                {
+                    ImNodesBinaryStateNode record;
+                    record.Id = node_id;
+                    record.OriginX = (float)x;
+                    record.OriginY = (float)y;
+                    records.push_back(record);
+                    node_has_origin = true;
+                }
             }
-            else if (strcmp(line + 1, "editor") == 0)
+        }
+        else if (section == IniSection_Editor)
+        {
+            const char* const p = IniParseLiteral(line, line_end, "panning=");
+            if (p != NULL)
             {
-                line_handler = EditorLineHandler;
+                IniParsePair(p, line_end, IniParseFloat, &editor.Panning.x, &editor.Panning.y);
             }
         }
 
-        if (line_handler != NULL)
+        line = line_end + 1;
+    }
+
+    if (section == IniSection_Node && !node_has_origin)
+    {
+        ids_without_origin.push_back(node_id);
+    }
+
+    LoadNodeRecords(editor, (const char*)records.Data, sizeof(ImNodesBinaryStateNode), records.Size);
+
+    // Nodes without an origin are created at the default origin, and existing ones are kept as is
+    records.resize(0);
+    for (int i = 0; i < ids_without_origin.size(); ++i)
+    {
+        const int node_idx = ObjectPoolFind(editor.Nodes, ids_without_origin[i]);
+        if (node_idx != -1)
         {
-            line_handler(editor, line);
+            editor.Nodes.InUse[node_idx] = true;
+            continue;
         }
+
+        ImNodesBinaryStateNode record;
+        record.Id = ids_without_origin[i];
+        record.OriginX = 0.0f;
+        record.OriginY = 0.0f;
+        records.push_back(record);
     }
-    ImGui::MemFree(buf);
+    LoadNodeRecords(editor, (const char*)records.Data, sizeof(ImNodesBinaryStateNode), records.Size);
 }
 
-void SaveCurrentEditorStateToIniFile(const char* const file_name)
+inline char* IniFormatInt(char* const p, const int value)
 {
-    SaveEditorStateToIniFile(&EditorContextGet(), file_name);
+    return std::to_chars(p, p + 16, value).ptr;
 }
 
-void SaveEditorStateToIniFile(const ImNodesEditorContext* const editor, const char* const file_name)
+// Formats an editor state, given as binary node records, as INI text. The worker thread formats
+// asynchronous saves with it too, so it doesn't go through ImGui's allocator or text buffers.
+template<typename Buffer>
+void IniWrite(
+    Buffer&                             buffer,
+    const ImVec2                        panning,
+    const ImNodesBinaryStateNode* const records,
+    const int                           record_count)
 {
-    size_t      data_size = 0u;
-    const char* data = SaveEditorStateToIniString(editor, &data_size);
-    FILE*       file = ImFileOpen(file_name, "wt");
+    char  line[64];
+    char* p = line;
+    p = (char*)memcpy(p, "[editor]\npanning=", 17) + 17;
+    p = IniFormatInt(p, (int)panning.x);
+    *p++ = ',';
+    p = IniFormatInt(p, (int)panning.y);
+    *p++ = '\n';
+    buffer.append(line, p);
+
+    for (int i = 0; i < record_count; ++i)
+    {
+        const ImNodesBinaryStateNode& record = records[i];
+        p = line;
+        p = (char*)memcpy(p, "\n[node.", 7) + 7;
+        p = IniFormatInt(p, record.Id);
+        p = (char*)memcpy(p, "]\norigin=", 9) + 9;
+        p = IniFormatInt(p, (int)record.OriginX);
+        *p++ = ',';
+        p = IniFormatInt(p, (int)record.OriginY);
+        *p++ = '\n';
+        buffer.append(line, p);
+    }
+}
+
+// Writes data to a temporary file next to file_name, flushes it to disk, and renames it over
+// file_name. Either the previous or the new contents of file_name survive a crash.
+bool FileWriteAtomic(const char* const file_name, const char* const data, const size_t data_size)
+{
+    const std::string temp_file_name = std::string(file_name) + ".tmp";
+    FILE*             file = ImFileOpen(temp_file_name.c_str(), "wb");
     if (!file)
     {
-        return;
+        return false;
     }
 
-    fwrite(data, sizeof(char), data_size, file);
-    fclose(file);
+    bool written = fwrite(data, 1u, data_size, file) == data_size && fflush(file) == 0;
+#if defined(_WIN32)
+    written = written && _commit(_fileno(file)) == 0;
+#elif defined(__unix__) || defined(__APPLE__)
+    written = written && fsync(fileno(file)) == 0;
+#endif
+    written = fclose(file) == 0 && written;
+    if (!written)
+    {
+        remove(temp_file_name.c_str());
+        return false;
+    }
+
+#if defined(_WIN32)
+    const int wsize = ::MultiByteToWideChar(CP_UTF8, 0, file_name, -1, NULL, 0);
+    std::wstring wfile_name(wsize, L'\0');
+    std::wstring wtemp_file_name(wsize + 4, L'\0');
+    ::MultiByteToWideChar(CP_UTF8, 0, file_name, -1, &wfile_name[0], wsize);
+    ::MultiByteToWideChar(CP_UTF8, 0, temp_file_name.c_str(), -1, &wtemp_file_name[0], wsize + 4);
+    const bool renamed = ::MoveFileExW(
+                             wtemp_file_name.c_str(),
+                             wfile_name.c_str(),
+                             MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    const bool renamed = rename(temp_file_name.c_str(), file_name) == 0;
+#endif
+    if (!renamed)
+    {
+        remove(temp_file_name.c_str());
+        return false;
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    // Flush the directory entry as well, so that the rename itself is durable
+    const char* const slash = strrchr(file_name, '/');
+    const std::string directory =
+        slash == NULL ? std::string(".")
+                      : std::string(file_name, slash == file_name ? slash + 1 : slash);
+    const int fd = open(directory.c_str(), O_RDONLY);
+    if (fd != -1)
+    {
+        (void)fsync(fd);
+        close(fd);
+    }
+#endif
+    return true;
 }
 
-void LoadCurrentEditorStateFromIniFile(const char* const file_name)
+} // namespace
+} // namespace IMNODES_NAMESPACE
+
+// Asynchronous saves are written by a single worker thread, in the order they were requested. Each
+// job owns a copy of the editor state in the binary format. Jobs are destroyed on the worker thread,
+// so they allocate through the standard library rather than ImGui's allocator.
+struct ImNodesSaveJob
+{
+    std::string             FileName;
+    bool                    Ini;
+    std::unique_ptr<char[]> State;
+    size_t                  StateSize;
+    size_t                  StateCapacity;
+    ImNodesSaveCallback     Callback;
+    void*                   UserData;
+};
+
+struct ImNodesSaveQueue
 {
-    LoadEditorStateFromIniFile(&EditorContextGet(), file_name);
+    std::mutex                 Mutex;
+    std::condition_variable    JobAdded;
+    std::condition_variable    JobsDone;
+    std::deque<ImNodesSaveJob> Jobs;
+    // The state buffer of the last completed job, reused by the next one
+    std::unique_ptr<char[]>    SpareState;
+    size_t                     SpareStateCapacity;
+    bool                       Busy;
+    bool                       Quit;
+    std::thread                Worker;
+
+    ImNodesSaveQueue() : SpareStateCapacity(0u), Busy(false), Quit(false) {}
+};
+
+namespace IMNODES_NAMESPACE
+{
+namespace
+{
+bool SaveJobRun(const ImNodesSaveJob& job)
+{
+    if (!job.Ini)
+    {
+        return FileWriteAtomic(job.FileName.c_str(), job.State.get(), job.StateSize);
+    }
+
+    ImNodesBinaryStateHeader header;
+    memcpy(&header, job.State.get(), sizeof(header));
+    const ImNodesBinaryStateNode* const records =
+        (const ImNodesBinaryStateNode*)(job.State.get() + sizeof(header));
+
+    std::string text;
+    text.reserve(32 + 40 * (size_t)header.NodeCount);
+    IniWrite(text, ImVec2(header.PanningX, header.PanningY), records, (int)header.NodeCount);
+    return FileWriteAtomic(job.FileName.c_str(), text.data(), text.size());
 }
 
-void LoadEditorStateFromIniFile(ImNodesEditorContext* const editor, const char* const file_name)
+void SaveQueueWorker(ImNodesSaveQueue* const queue)
 {
-    size_t data_size = 0u;
-    char*  file_data = (char*)ImFileLoadToMemory(file_name, "rb", &data_size);
+    std::unique_lock<std::mutex> lock(queue->Mutex);
+    for (;;)
+    {
+        queue->JobAdded.wait(lock, [queue] { return queue->Quit || !queue->Jobs.empty(); });
+        if (queue->Jobs.empty())
+        {
+            return;
+        }
 
-    if (!file_data)
+        ImNodesSaveJob job = std::move(queue->Jobs.front());
+        queue->Jobs.pop_front();
+        queue->Busy = true;
+        lock.unlock();
+
+        const bool success = SaveJobRun(job);
+        if (job.Callback != NULL)
+        {
+            job.Callback(job.FileName.c_str(), success, job.UserData);
+        }
+
+        lock.lock();
+        if (job.StateCapacity > queue->SpareStateCapacity)
+        {
+            queue->SpareState = std::move(job.State);
+            queue->SpareStateCapacity = job.StateCapacity;
+        }
+        queue->Busy = false;
+        if (queue->Jobs.empty())
+        {
+            queue->JobsDone.notify_all();
+        }
+    }
+}
+
+void SaveQueuePush(
+    const ImNodesEditorContext* const editor,
+    const char* const                 file_name,
+    const bool                        ini,
+    const ImNodesSaveCallback         callback,
+    void* const                       user_data)
+{
+    ImNodesSaveQueue*& queue = GImNodes->SaveQueue;
+    if (queue == NULL)
     {
-        return;
+        queue = IM_NEW(ImNodesSaveQueue)();
+        queue->Worker = std::thread(SaveQueueWorker, queue);
     }
 
-    LoadEditorStateFromIniString(editor, file_data, data_size);
-    ImGui::MemFree(file_data);
+    // Copying the node state is the only part of the save done on the calling thread
+    ImNodesSaveJob job;
+    job.FileName = file_name;
+    job.Ini = ini;
+    job.StateCapacity = BinaryStateMaxSize(*editor);
+    {
+        std::lock_guard<std::mutex> lock(queue->Mutex);
+        if (queue->SpareStateCapacity >= job.StateCapacity)
+        {
+            job.State = std::move(queue->SpareState);
+            job.StateCapacity = queue->SpareStateCapacity;
+            queue->SpareStateCapacity = 0u;
+        }
+    }
+    if (!job.State)
+    {
+        job.State.reset(new char[job.StateCapacity]);
+    }
+    job.StateSize = BinaryStateWrite(*editor, job.State.get());
+    job.Callback = callback;
+    job.UserData = user_data;
+
+    {
+        std::lock_guard<std::mutex> lock(queue->Mutex);
+        queue->Jobs.push_back(std::move(job));
+    }
+    queue->JobAdded.notify_one();
+}
+
+void SaveQueueWait(ImNodesSaveQueue* const queue)
+{
+    std::unique_lock<std::mutex> lock(queue->Mutex);
+    queue->JobsDone.wait(lock, [queue] { return queue->Jobs.empty() && !queue->Busy; });
+}
+
+void SaveQueueDestroy(ImNodesContext* const ctx)
+{
+    ImNodesSaveQueue* const queue = ctx->SaveQueue;
+    if (queue == NULL)
+    {
+        return;
+    }
+
+    // Pending saves are completed before the worker exits
+    {
+        std::lock_guard<std::mutex> lock(queue->Mutex);
+        queue->Quit = true;
+    }
+    queue->JobAdded.notify_one();
+    queue->Worker.join();
+    IM_DELETE(queue);
+    ctx->SaveQueue = NULL;
+}
+
+// A read-only view of a whole file, memory-mapped where possible.
+struct ImMappedFile
+{
+    const void* Data;
+    size_t      Size;
+    bool        Mapped;
+#if defined(_WIN32) && defined(IMNODES_ENABLE_MMAP)
+    HANDLE Mapping;
+#endif
+};
+
+bool MappedFileOpen(ImMappedFile& file, const char* const file_name)
+{
+    file.Data = NULL;
+    file.Size = 0u;
+    file.Mapped = false;
+
+#if defined(IMNODES_ENABLE_MMAP) && defined(_WIN32)
+    wchar_t   local_buf[MAX_PATH];
+    const int wsize = ::MultiByteToWideChar(CP_UTF8, 0, file_name, -1, NULL, 0);
+    if (wsize > 0 && wsize <= IM_ARRAYSIZE(local_buf))
+    {
+        ::MultiByteToWideChar(CP_UTF8, 0, file_name, -1, local_buf, wsize);
+        const HANDLE handle = ::CreateFileW(
+            local_buf,
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            NULL,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+            NULL);
+        if (handle != INVALID_HANDLE_VALUE)
+        {
+            LARGE_INTEGER size;
+            if (::GetFileSizeEx(handle, &size) && size.QuadPart > 0 &&
+                (ImU64)size.QuadPart <= (ImU64)(size_t)-1)
+            {
+                file.Mapping = ::CreateFileMappingW(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+                if (file.Mapping != NULL)
+                {
+                    file.Data = ::MapViewOfFile(file.Mapping, FILE_MAP_READ, 0, 0, 0);
+                    if (file.Data == NULL)
+                    {
+                        ::CloseHandle(file.Mapping);
+                    }
+                }
+            }
+            ::CloseHandle(handle);
+            if (file.Data != NULL)
+            {
+                file.Size = (size_t)size.QuadPart;
+                file.Mapped = true;
+                return true;
+            }
+        }
+    }
+#elif defined(IMNODES_ENABLE_MMAP)
+    const int fd = open(file_name, O_RDONLY);
+    if (fd != -1)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* const data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                file.Data = data;
+                file.Size = (size_t)st.st_size;
+                file.Mapped = true;
+            }
+        }
+        close(fd);
+        if (file.Mapped)
+        {
+            return true;
+        }
+    }
+#endif
+
+    // Fall back to reading the file into memory
+    size_t      data_size = 0u;
+    void* const data = ImFileLoadToMemory(file_name, "rb", &data_size);
+    file.Data = data;
+    file.Size = data_size;
+    return data != NULL;
+}
+
+void MappedFileClose(ImMappedFile& file)
+{
+    if (file.Data == NULL)
+    {
+        return;
+    }
+
+    if (!file.Mapped)
+    {
+        ImGui::MemFree(const_cast<void*>(file.Data));
+    }
+#if defined(IMNODES_ENABLE_MMAP) && defined(_WIN32)
+    else
+    {
+        ::UnmapViewOfFile(file.Data);
+        ::CloseHandle(file.Mapping);
+    }
+#elif defined(IMNODES_ENABLE_MMAP)
+    else
+    {
+        munmap(const_cast<void*>(file.Data), file.Size);
+    }
+#endif
+    file.Data = NULL;
+}
+
+// Drops the stale and duplicate entries of ImNodesEditorContext::ModifiedNodeIndices. An entry is
+// stale if its node was deleted, and duplicated if its slot was reused by a node moved since.
+void ModifiedNodesCompact(ImNodesEditorContext& editor)
+{
+    ImVector<int>& indices = editor.ModifiedNodeIndices;
+    int            count = 0;
+    for (int i = 0; i < indices.size(); ++i)
+    {
+        const int node_idx = indices[i];
+        if (node_idx >= editor.Nodes.Pool.size())
+        {
+            continue;
+        }
+
+        ImNodeData& node = editor.Nodes.Pool[node_idx];
+        if (node.Modified && editor.Nodes.InUse[node_idx])
+        {
+            indices[count++] = node_idx;
+        }
+        node.Modified = false;
+    }
+    indices.resize(count);
+
+    for (int i = 0; i < indices.size(); ++i)
+    {
+        editor.Nodes.Pool[indices[i]].Modified = true;
+    }
+}
+
+void ModifiedNodesClear(ImNodesEditorContext& editor)
+{
+    for (int i = 0; i < editor.ModifiedNodeIndices.size(); ++i)
+    {
+        const int node_idx = editor.ModifiedNodeIndices[i];
+        if (node_idx < editor.Nodes.Pool.size())
+        {
+            editor.Nodes.Pool[node_idx].Modified = false;
+        }
+    }
+    editor.ModifiedNodeIndices.clear();
+    editor.JournalPanning = editor.Panning;
+}
+
+bool JournalWrite(const char* const file_name, const char* const mode, const ImVector<char>& data)
+{
+    FILE* file = ImFileOpen(file_name, mode);
+    if (!file)
+    {
+        return false;
+    }
+
+    const bool written = fwrite(data.Data, 1u, (size_t)data.size(), file) == (size_t)data.size();
+    return fclose(file) == 0 && written;
+}
+
+// Empties the journal, leaving only its header
+bool JournalReset(ImNodesEditorContext& editor, const char* const journal_file_name)
+{
+    ImNodesJournalHeader header;
+    header.Magic = IMNODES_JOURNAL_MAGIC;
+    header.Version = IMNODES_JOURNAL_VERSION;
+    header.HeaderSize = sizeof(ImNodesJournalHeader);
+    header.NodeRecordSize = sizeof(ImNodesBinaryStateNode);
+    header.Generation = editor.JournalGeneration;
+
+    ImVector<char> data;
+    data.resize(sizeof(header));
+    memcpy(data.Data, &header, sizeof(header));
+    if (!JournalWrite(journal_file_name, "wb", data))
+    {
+        editor.JournalSize = -1;
+        return false;
+    }
+
+    editor.JournalSize = (ImS64)sizeof(header);
+    return true;
+}
+
+// Returns the generation of the journal file, or 0 if it can't be read
+ImU32 JournalReadGeneration(const char* const journal_file_name)
+{
+    ImNodesJournalHeader header;
+    FILE* const          file = ImFileOpen(journal_file_name, "rb");
+    if (!file)
+    {
+        return 0u;
+    }
+    const bool read = fread(&header, sizeof(header), 1u, file) == 1u;
+    fclose(file);
+    return read && header.Magic == IMNODES_JOURNAL_MAGIC && header.Version == IMNODES_JOURNAL_VERSION
+               ? header.Generation
+               : 0u;
+}
+
+// Writes a full snapshot of a new generation through a temporary file, so that a crash leaves
+// either the previous or the new snapshot intact. The new generation differs from the journal's
+// on disk, so that a journal the crash keeps from being emptied isn't replayed on the snapshot.
+bool JournalWriteSnapshot(
+    ImNodesEditorContext& editor,
+    const char* const     snapshot_file_name,
+    const char* const     journal_file_name)
+{
+    editor.JournalGeneration =
+        ImMax(editor.JournalGeneration, JournalReadGeneration(journal_file_name)) + 1u;
+    size_t            data_size = 0u;
+    const char* const data = (const char*)SaveEditorStateToBinaryMemory(&editor, &data_size);
+    return FileWriteAtomic(snapshot_file_name, data, data_size);
+}
+
+// Replays the journal frames. Returns the size of the journal up to the last complete frame, or -1
+// if the journal isn't valid.
+ImS64 JournalReplay(ImNodesEditorContext& editor, const void* const data, const size_t data_size)
+{
+    ImNodesJournalHeader header;
+    if (data == NULL || data_size < sizeof(header))
+    {
+        return -1;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    if (header.Magic != IMNODES_JOURNAL_MAGIC || header.Version != IMNODES_JOURNAL_VERSION ||
+        header.HeaderSize < sizeof(header) || (size_t)header.HeaderSize > data_size ||
+        header.NodeRecordSize < sizeof(ImNodesBinaryStateNode) ||
+        header.Generation != editor.JournalGeneration)
+    {
+        return -1;
+    }
+
+    const char* const begin = (const char*)data;
+    size_t            offset = header.HeaderSize;
+    while (data_size - offset >= sizeof(ImNodesJournalFrame))
+    {
+        ImNodesJournalFrame frame;
+        memcpy(&frame, begin + offset, sizeof(frame));
+
+        const size_t records_size = data_size - offset - sizeof(frame);
+        if (frame.NodeCount > (ImU32)INT_MAX ||
+            (size_t)frame.NodeCount > records_size / header.NodeRecordSize)
+        {
+            break;
+        }
+
+        editor.Panning = ImVec2(frame.PanningX, frame.PanningY);
+        LoadNodeRecords(
+            editor, begin + offset + sizeof(frame), header.NodeRecordSize, (int)frame.NodeCount);
+        offset += sizeof(frame) + (size_t)frame.NodeCount * header.NodeRecordSize;
+    }
+
+    return (ImS64)offset;
+}
+} // namespace
+
+const char* SaveCurrentEditorStateToIniString(size_t* const data_size)
+{
+    return SaveEditorStateToIniString(&EditorContextGet(), data_size);
+}
+
+const char* SaveEditorStateToIniString(
+    const ImNodesEditorContext* const editor_ptr,
+    size_t* const                     data_size)
+{
+    IM_ASSERT(editor_ptr != NULL);
+    const ImNodesEditorContext& editor = *editor_ptr;
+
+    // Snapshot the nodes in use, then format them the same way asynchronous saves do
+    size_t      state_size = 0u;
+    const char* state = (const char*)SaveEditorStateToBinaryMemory(&editor, &state_size);
+    const int   node_count = (int)((state_size - sizeof(ImNodesBinaryStateHeader)) /
+                                 sizeof(ImNodesBinaryStateNode));
+
+    GImNodes->TextBuffer.clear();
+    GImNodes->TextBuffer.reserve(32 + 40 * node_count);
+    IniWrite(
+        GImNodes->TextBuffer,
+        editor.Panning,
+        (const ImNodesBinaryStateNode*)(state + sizeof(ImNodesBinaryStateHeader)),
+        node_count);
+
+    if (data_size != NULL)
+    {
+        *data_size = GImNodes->TextBuffer.size();
+    }
+
+    return GImNodes->TextBuffer.c_str();
+}
+
+void LoadCurrentEditorStateFromIniString(const char* const data, const size_t data_size)
+{
+    LoadEditorStateFromIniString(&EditorContextGet(), data, data_size);
+}
+
+void LoadEditorStateFromIniString(
+    ImNodesEditorContext* const editor_ptr,
+    const char* const           data,
+    const size_t                data_size)
+{
+    if (data_size == 0u)
+    {
+        return;
+    }
+
+    ImNodesEditorContext& editor = editor_ptr == NULL ? EditorContextGet() : *editor_ptr;
+    IniParse(editor, data, data_size);
+}
+
+void SaveCurrentEditorStateToIniFile(const char* const file_name)
+{
+    SaveEditorStateToIniFile(&EditorContextGet(), file_name);
+}
+
+void SaveEditorStateToIniFile(const ImNodesEditorContext* const editor, const char* const file_name)
+{
+    size_t      data_size = 0u;
+    const char* data = SaveEditorStateToIniString(editor, &data_size);
+    FILE*       file = ImFileOpen(file_name, "wt");
+    if (!file)
+    {
+        return;
+    }
+
+    fwrite(data, sizeof(char), data_size, file);
+    fclose(file);
+}
+
+void LoadCurrentEditorStateFromIniFile(const char* const file_name)
+{
+    LoadEditorStateFromIniFile(&EditorContextGet(), file_name);
+}
+
+void LoadEditorStateFromIniFile(ImNodesEditorContext* const editor, const char* const file_name)
+{
+    size_t data_size = 0u;
+    char*  file_data = (char*)ImFileLoadToMemory(file_name, "rb", &data_size);
+
+    if (!file_data)
+    {
+        return;
+    }
+
+    LoadEditorStateFromIniString(editor, file_data, data_size);
+    ImGui::MemFree(file_data);
+}
+
+const void* SaveCurrentEditorStateToBinaryMemory(size_t* const data_size)
+{
+    return SaveEditorStateToBinaryMemory(&EditorContextGet(), data_size);
+}
+
+const void* SaveEditorStateToBinaryMemory(
+    const ImNodesEditorContext* const editor_ptr,
+    size_t* const                     data_size)
+{
+    IM_ASSERT(editor_ptr != NULL);
+    const ImNodesEditorContext& editor = *editor_ptr;
+
+    // The buffer is sized for every pooled node and trimmed to the nodes in use
+    ImVector<char>& buffer = GImNodes->BinaryBuffer;
+    buffer.resize((int)BinaryStateMaxSize(editor));
+    buffer.resize((int)BinaryStateWrite(editor, buffer.Data));
+
+    if (data_size != NULL)
+    {
+        *data_size = (size_t)buffer.size();
+    }
+
+    return buffer.Data;
+}
+
+bool LoadCurrentEditorStateFromBinaryMemory(const void* const data, const size_t data_size)
+{
+    return LoadEditorStateFromBinaryMemory(&EditorContextGet(), data, data_size);
+}
+
+bool LoadEditorStateFromBinaryMemory(
+    ImNodesEditorContext* const editor_ptr,
+    const void* const           data,
+    const size_t                data_size)
+{
+    ImVec2      panning;
+    ImU32       journal_generation;
+    const char* records;
+    size_t      record_size;
+    int         record_count;
+    if (!BinaryStateParse(
+            data, data_size, &panning, &journal_generation, &records, &record_size, &record_count))
+    {
+        return false;
+    }
+
+    ImNodesEditorContext& editor = editor_ptr == NULL ? EditorContextGet() : *editor_ptr;
+    editor.Panning = panning;
+    editor.JournalGeneration = journal_generation;
+    LoadNodeRecords(editor, records, record_size, record_count);
+    return true;
+}
+
+bool SaveCurrentEditorStateToBinaryFile(const char* const file_name)
+{
+    return SaveEditorStateToBinaryFile(&EditorContextGet(), file_name);
+}
+
+bool SaveEditorStateToBinaryFile(
+    const ImNodesEditorContext* const editor,
+    const char* const                 file_name)
+{
+    size_t      data_size = 0u;
+    const void* data = SaveEditorStateToBinaryMemory(editor, &data_size);
+    FILE*       file = ImFileOpen(file_name, "wb");
+    if (!file)
+    {
+        return false;
+    }
+
+    const bool written = fwrite(data, 1u, data_size, file) == data_size;
+    return fclose(file) == 0 && written;
+}
+
+bool LoadCurrentEditorStateFromBinaryFile(const char* const file_name)
+{
+    return LoadEditorStateFromBinaryFile(&EditorContextGet(), file_name);
+}
+
+bool LoadEditorStateFromBinaryFile(ImNodesEditorContext* const editor, const char* const file_name)
+{
+    ImMappedFile file;
+    if (!MappedFileOpen(file, file_name))
+    {
+        return false;
+    }
+
+    const bool loaded = LoadEditorStateFromBinaryMemory(editor, file.Data, file.Size);
+    MappedFileClose(file);
+    return loaded;
+}
+
+bool SaveCurrentEditorStateToJournal(
+    const char* const snapshot_file_name,
+    const char* const journal_file_name)
+{
+    return SaveEditorStateToJournal(&EditorContextGet(), snapshot_file_name, journal_file_name);
+}
+
+bool SaveEditorStateToJournal(
+    ImNodesEditorContext* const editor_ptr,
+    const char* const           snapshot_file_name,
+    const char* const           journal_file_name)
+{
+    IM_ASSERT(editor_ptr != NULL);
+    ImNodesEditorContext& editor = *editor_ptr;
+
+    // The snapshot replaces the previous one atomically, and the journal is emptied only once the
+    // new snapshot is in place. A crash in between leaves the old journal behind, which the new
+    // snapshot's generation keeps from being replayed on top of it.
+    if (editor.JournalSize < 0)
+    {
+        if (!JournalWriteSnapshot(editor, snapshot_file_name, journal_file_name) ||
+            !JournalReset(editor, journal_file_name))
+        {
+            editor.JournalSize = -1;
+            return false;
+        }
+        ModifiedNodesClear(editor);
+        return true;
+    }
+
+    ModifiedNodesCompact(editor);
+    const bool panning_changed =
+        editor.Panning.x != editor.JournalPanning.x || editor.Panning.y != editor.JournalPanning.y;
+    if (editor.ModifiedNodeIndices.empty() && !panning_changed)
+    {
+        return true;
+    }
+
+    ImNodesJournalFrame frame;
+    frame.NodeCount = (ImU32)editor.ModifiedNodeIndices.size();
+    frame.PanningX = editor.Panning.x;
+    frame.PanningY = editor.Panning.y;
+
+    ImVector<char>& buffer = GImNodes->BinaryBuffer;
+    buffer.resize(
+        (int)(sizeof(ImNodesJournalFrame) +
+              editor.ModifiedNodeIndices.size() * sizeof(ImNodesBinaryStateNode)));
+    memcpy(buffer.Data, &frame, sizeof(frame));
+    ImNodesBinaryStateNode* const records =
+        (ImNodesBinaryStateNode*)(buffer.Data + sizeof(ImNodesJournalFrame));
+    for (int i = 0; i < editor.ModifiedNodeIndices.size(); ++i)
+    {
+        const ImNodeData& node = editor.Nodes.Pool[editor.ModifiedNodeIndices[i]];
+        records[i].Id = node.Id;
+        records[i].OriginX = node.Origin.x;
+        records[i].OriginY = node.Origin.y;
+    }
+
+    if (!JournalWrite(journal_file_name, "ab", buffer))
+    {
+        // The frame may have been partially written
+        editor.JournalSize = -1;
+        return false;
+    }
+    editor.JournalSize += buffer.size();
+    ModifiedNodesClear(editor);
+
+    // Compact the journal once it outgrows a snapshot. If the journal then can't be emptied, the
+    // next save writes yet another snapshot.
+    const int   node_count = editor.Nodes.Pool.size() - editor.Nodes.FreeList.size();
+    const float snapshot_size =
+        (float)(sizeof(ImNodesBinaryStateHeader) + node_count * sizeof(ImNodesBinaryStateNode));
+    if ((float)editor.JournalSize > GImNodes->Io.JournalCompactionRatio * snapshot_size)
+    {
+        if (!JournalWriteSnapshot(editor, snapshot_file_name, journal_file_name) ||
+            !JournalReset(editor, journal_file_name))
+        {
+            editor.JournalSize = -1;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool LoadCurrentEditorStateFromJournal(
+    const char* const snapshot_file_name,
+    const char* const journal_file_name)
+{
+    return LoadEditorStateFromJournal(&EditorContextGet(), snapshot_file_name, journal_file_name);
+}
+
+bool LoadEditorStateFromJournal(
+    ImNodesEditorContext* const editor_ptr,
+    const char* const           snapshot_file_name,
+    const char* const           journal_file_name)
+{
+    ImNodesEditorContext& editor = editor_ptr == NULL ? EditorContextGet() : *editor_ptr;
+    if (!LoadEditorStateFromBinaryFile(&editor, snapshot_file_name))
+    {
+        return false;
+    }
+
+    // A missing or invalid journal leaves the snapshot as is, and the next save writes a new
+    // snapshot. So does a journal ending in an incomplete frame, which can't be appended to.
+    ImS64        journal_size = -1;
+    ImMappedFile file;
+    if (MappedFileOpen(file, journal_file_name))
+    {
+        journal_size = JournalReplay(editor, file.Data, file.Size);
+        if (journal_size != (ImS64)file.Size)
+        {
+            journal_size = -1;
+        }
+        MappedFileClose(file);
+    }
+
+    ModifiedNodesClear(editor);
+    editor.JournalSize = journal_size;
+    return true;
+}
+
+void SaveCurrentEditorStateToIniFileAsync(
+    const char* const         file_name,
+    const ImNodesSaveCallback callback,
+    void* const               user_data)
+{
+    SaveQueuePush(&EditorContextGet(), file_name, true, callback, user_data);
+}
+
+void SaveEditorStateToIniFileAsync(
+    const ImNodesEditorContext* const editor,
+    const char* const                 file_name,
+    const ImNodesSaveCallback         callback,
+    void* const                       user_data)
+{
+    IM_ASSERT(editor != NULL);
+    SaveQueuePush(editor, file_name, true, callback, user_data);
+}
+
+void SaveCurrentEditorStateToBinaryFileAsync(
+    const char* const         file_name,
+    const ImNodesSaveCallback callback,
+    void* const               user_data)
+{
+    SaveQueuePush(&EditorContextGet(), file_name, false, callback, user_data);
+}
+
+void SaveEditorStateToBinaryFileAsync(
+    const ImNodesEditorContext* const editor,
+    const char* const                 file_name,
+    const ImNodesSaveCallback         callback,
+    void* const                       user_data)
+{
+    IM_ASSERT(editor != NULL);
+    SaveQueuePush(editor, file_name, false, callback, user_data);
+}
+
+void WaitForEditorStateSaves()
+{
+    if (GImNodes->SaveQueue != NULL)
+    {
+        SaveQueueWait(GImNodes->SaveQueue);
+    }
+}
+
+int NumModifiedNodes()
+{
+    IM_ASSERT(GImNodes->CurrentScope == ImNodesScope_None);
+    ImNodesEditorContext& editor = EditorContextGet();
+    ModifiedNodesCompact(editor);
+    return editor.ModifiedNodeIndices.size();
+}
+
+void GetModifiedNodes(int* const node_ids)
+{
+    IM_ASSERT(node_ids != NULL);
+
+    ImNodesEditorContext& editor = EditorContextGet();
+    ModifiedNodesCompact(editor);
+    for (int i = 0; i < editor.ModifiedNodeIndices.size(); ++i)
+    {
+        const int node_idx = editor.ModifiedNodeIndices[i];
+        node_ids[i] = editor.Nodes.Pool[node_idx].Id;
+    }
 }
 } // namespace IMNODES_NAMESPACE
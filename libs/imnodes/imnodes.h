@@ -18,6 +18,16 @@ typedef int ImNodesPinShape;        // -> enum ImNodesPinShape_
 typedef int ImNodesAttributeFlags;  // -> enum ImNodesAttributeFlags_
 typedef int ImNodesMiniMapLocation; // -> enum ImNodesMiniMapLocation_
 
+// Callback type used to render the mini-map contents into a texture, see ImNodesIO::MiniMapTexture
+typedef ImTextureID (*ImNodesMiniMapRenderCallback)(
+    ImDrawData* draw_data,
+    ImU32       clear_color,
+    void*       user_data);
+
+// Callback type notified of the completion of an asynchronous save, see
+// SaveEditorStateToIniFileAsync()
+typedef void (*ImNodesSaveCallback)(const char* file_name, bool success, void* user_data);
+
 enum ImNodesCol_
 {
     ImNodesCol_NodeBackground = 0,
@@ -69,6 +79,8 @@ enum ImNodesStyleVar_
     ImNodesStyleVar_PinOffset,
     ImNodesStyleVar_MiniMapPadding,
     ImNodesStyleVar_MiniMapOffset,
+    ImNodesStyleVar_LinkLodThickness,
+    ImNodesStyleVar_LinkLodLengthThreshold,
     ImNodesStyleVar_COUNT
 };
 
@@ -88,7 +100,8 @@ enum ImNodesPinShape_
     ImNodesPinShape_Triangle,
     ImNodesPinShape_TriangleFilled,
     ImNodesPinShape_Quad,
-    ImNodesPinShape_QuadFilled
+    ImNodesPinShape_QuadFilled,
+    ImNodesPinShape_COUNT
 };
 
 // This enum controls the way the attribute pins behave.
@@ -159,6 +172,31 @@ struct ImNodesIO
     // Panning speed when dragging an element and mouse is outside the main editor view.
     float AutoPanningSpeed;
 
+    struct MiniMapTexture
+    {
+        MiniMapTexture();
+
+        // Optional callback rendering the mini-map contents into a texture, for example an
+        // offscreen image registered with the renderer backend. Set to NULL by default, in which
+        // case the cached mini-map geometry is copied into the editor's draw list every frame.
+        //
+        // The callback is invoked whenever the mini-map contents are updated. The target texture
+        // should be draw_data->DisplaySize * draw_data->FramebufferScale pixels large, and cleared
+        // to clear_color before draw_data is rendered into it. Return the texture to display, or 0
+        // to fall back to drawing the cached geometry.
+        ImNodesMiniMapRenderCallback RenderCallback;
+        void*                        UserData;
+    } MiniMapTexture;
+
+    // The mini-map contents are only updated when the graph, the selection or the mini-map layout
+    // changes, and at most once every MiniMapRefreshInterval seconds. Set to 1/30 by default.
+    float MiniMapRefreshInterval;
+
+    // SaveEditorStateToJournal() rewrites the snapshot and empties the journal once the journal
+    // would grow larger than JournalCompactionRatio times the size of a snapshot. Set to 1 by
+    // default.
+    float JournalCompactionRatio;
+
     ImNodesIO();
 };
 
@@ -174,6 +212,15 @@ struct ImNodesStyle
     float LinkLineSegmentsPerLength;
     float LinkHoverDistance;
 
+    // Level of detail for dense link fields. Links are drawn as thin lines of LinkLodThickness
+    // without anti-aliasing and with half the line segments when their end points are closer than
+    // LinkLodLengthThreshold on screen, or when more than LinkLodCountThreshold links are drawn in
+    // the editor. Hovered and selected links are always drawn at full quality. A threshold of 0
+    // disables that rule.
+    float LinkLodThickness;
+    float LinkLodLengthThreshold;
+    int   LinkLodCountThreshold;
+
     // The following variables control the look and behavior of the pins. The default size of each
     // pin shape is balanced to occupy approximately the same surface area on the screen.
 
@@ -265,6 +312,13 @@ void StyleColorsDark(ImNodesStyle* dest = NULL); // on by default
 void StyleColorsClassic(ImNodesStyle* dest = NULL);
 void StyleColorsLight(ImNodesStyle* dest = NULL);
 
+// Rasterize the pin shapes into the font atlas at the current style's pin sizes, so that each pin is
+// rendered as a single textured quad instead of a tessellated path. Call this after setting up the
+// style and adding the fonts, before the atlas texture is uploaded, and again whenever the atlas is
+// rebuilt. The atlas is (re)built by this call if needed. Pins are tessellated as before while the
+// style's pin sizes differ from the rasterized ones. If atlas is NULL, ImGui::GetIO().Fonts is used.
+void AddPinShapesToFontAtlas(ImFontAtlas* atlas = NULL);
+
 // The top-level function call. Call this before calling BeginNode/EndNode. Calling this function
 // will result the node editor grid workspace being rendered.
 void BeginNodeEditor();
@@ -419,6 +473,14 @@ bool IsLinkCreated(
 // output argument link_id.
 bool IsLinkDestroyed(int* link_id);
 
+// Did the user just finish dragging nodes? Returns true once, on the frame the mouse is released,
+// if the drag moved at least one node. All moved nodes moved by the same distance in grid space,
+// which is assigned to the output argument delta. Use NumDraggedNodes() and GetDraggedNodes() to
+// get the ids of the moved nodes, for instance to record the move in an undo history.
+bool IsNodeDragFinished(ImVec2* delta = NULL);
+int  NumDraggedNodes();
+void GetDraggedNodes(int* node_ids);
+
 // Use the following functions to write the editor context's state to a string, or directly to a
 // file. The editor context is serialized in the INI file format.
 
@@ -435,4 +497,90 @@ void SaveEditorStateToIniFile(const ImNodesEditorContext* editor, const char* fi
 
 void LoadCurrentEditorStateFromIniFile(const char* file_name);
 void LoadEditorStateFromIniFile(ImNodesEditorContext* editor, const char* file_name);
+
+// Binary counterparts of the functions above. The binary format stores the same state as a
+// versioned header followed by a table of node ids and origins, which is loaded straight into the
+// node pool without any text parsing. Files are memory-mapped where the platform supports it.
+//
+// The load functions return false, and leave the editor unchanged, if the data isn't a binary
+// editor state of a version this library can read.
+
+const void* SaveCurrentEditorStateToBinaryMemory(size_t* data_size = NULL);
+const void* SaveEditorStateToBinaryMemory(
+    const ImNodesEditorContext* editor,
+    size_t*                     data_size = NULL);
+
+bool LoadCurrentEditorStateFromBinaryMemory(const void* data, size_t data_size);
+bool LoadEditorStateFromBinaryMemory(
+    ImNodesEditorContext* editor,
+    const void*           data,
+    size_t                data_size);
+
+bool SaveCurrentEditorStateToBinaryFile(const char* file_name);
+bool SaveEditorStateToBinaryFile(const ImNodesEditorContext* editor, const char* file_name);
+
+bool LoadCurrentEditorStateFromBinaryFile(const char* file_name);
+bool LoadEditorStateFromBinaryFile(ImNodesEditorContext* editor, const char* file_name);
+
+// Asynchronous counterparts of the save functions above, which don't block the calling thread on
+// formatting or disk writes. Only a copy of the node ids, origins and panning is taken before the
+// function returns. A worker thread then formats the copy, writes it to a temporary file, flushes
+// it to disk and renames it over file_name, so file_name always holds either the previous or the
+// new editor state.
+//
+// Saves are completed in the order they were requested. The optional callback is called on the
+// worker thread once the save succeeded or failed. WaitForEditorStateSaves() blocks until all
+// requested saves are complete, and DestroyContext() waits for them as well.
+
+void SaveCurrentEditorStateToIniFileAsync(
+    const char*         file_name,
+    ImNodesSaveCallback callback = NULL,
+    void*               user_data = NULL);
+void SaveEditorStateToIniFileAsync(
+    const ImNodesEditorContext* editor,
+    const char*                 file_name,
+    ImNodesSaveCallback         callback = NULL,
+    void*                       user_data = NULL);
+
+void SaveCurrentEditorStateToBinaryFileAsync(
+    const char*         file_name,
+    ImNodesSaveCallback callback = NULL,
+    void*               user_data = NULL);
+void SaveEditorStateToBinaryFileAsync(
+    const ImNodesEditorContext* editor,
+    const char*                 file_name,
+    ImNodesSaveCallback         callback = NULL,
+    void*                       user_data = NULL);
+
+void WaitForEditorStateSaves();
+
+// Journaled saving, for editors too large to save in full every time. SaveEditorStateToJournal()
+// appends the panning and the origins of the nodes moved since the previous save to an
+// append-only journal. The first save, and any save which would grow the journal past
+// ImNodesIO::JournalCompactionRatio times the size of a snapshot, instead writes a full binary
+// snapshot and empties the journal. LoadEditorStateFromJournal() loads the snapshot and replays the
+// journal on top of it, unless the journal was written for an older snapshot.
+//
+// Pass the same pair of files to every call for a given editor. The functions return false if a
+// file couldn't be read or written.
+
+bool SaveCurrentEditorStateToJournal(const char* snapshot_file_name, const char* journal_file_name);
+bool SaveEditorStateToJournal(
+    ImNodesEditorContext* editor,
+    const char*           snapshot_file_name,
+    const char*           journal_file_name);
+
+bool LoadCurrentEditorStateFromJournal(
+    const char* snapshot_file_name,
+    const char* journal_file_name);
+bool LoadEditorStateFromJournal(
+    ImNodesEditorContext* editor,
+    const char*           snapshot_file_name,
+    const char*           journal_file_name);
+
+// The nodes moved since the current editor was last saved to, or loaded from, a journal. The
+// pointer argument should point to an integer array with at least as many elements as
+// NumModifiedNodes() returned.
+int  NumModifiedNodes();
+void GetModifiedNodes(int* node_ids);
 } // namespace IMNODES_NAMESPACE
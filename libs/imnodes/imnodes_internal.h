@@ -14,8 +14,10 @@
 // [SECTION] internal data structures
 // [SECTION] global and editor context structs
 // [SECTION] object pool implementation
+// [SECTION] link batch renderer
 
 struct ImNodesContext;
+struct ImNodesSaveQueue;
 
 extern ImNodesContext* GImNodes;
 
@@ -26,6 +28,7 @@ typedef int ImNodesAttributeType;
 typedef int ImNodesUIState;
 typedef int ImNodesClickInteractionType;
 typedef int ImNodesLinkCreationType;
+typedef int ImNodesLinkBatchKernel;
 
 enum ImNodesScope_
 {
@@ -47,7 +50,8 @@ enum ImNodesUIState_
     ImNodesUIState_None = 0,
     ImNodesUIState_LinkStarted = 1 << 0,
     ImNodesUIState_LinkDropped = 1 << 1,
-    ImNodesUIState_LinkCreated = 1 << 2
+    ImNodesUIState_LinkCreated = 1 << 2,
+    ImNodesUIState_NodeDragFinished = 1 << 3
 };
 
 enum ImNodesClickInteractionType_
@@ -67,6 +71,14 @@ enum ImNodesLinkCreationType_
     ImNodesLinkCreationType_FromDetach
 };
 
+enum ImNodesLinkBatchKernel_
+{
+    ImNodesLinkBatchKernel_Scalar,
+    // Uses the instruction set reported by LinkBatchSimdInstructionSet(). Falls back to the scalar
+    // kernel when imnodes was compiled without SIMD support.
+    ImNodesLinkBatchKernel_Simd
+};
+
 // [SECTION] internal data structures
 
 // The object T must have the following interface:
@@ -150,11 +162,13 @@ struct ImNodeData
 
     ImVector<int> PinIndices;
     bool          Draggable;
+    // Set when the node is moved, and cleared when the editor is saved to a journal
+    bool Modified;
 
     ImNodeData(const int node_id)
         : Id(node_id), Origin(0.0f, 0.0f), TitleBarContentRect(),
           Rect(ImVec2(0.0f, 0.0f), ImVec2(0.0f, 0.0f)), ColorStyle(), LayoutStyle(), PinIndices(),
-          Draggable(true)
+          Draggable(true), Modified(false)
     {
     }
 
@@ -197,6 +211,116 @@ struct ImLinkData
     ImLinkData(const int link_id) : Id(link_id), StartPinIdx(), EndPinIdx(), ColorStyle() {}
 };
 
+// A link curve queued for tessellation by LinkBatchRender().
+struct ImLinkBatchEntry
+{
+    ImVec2 P0, P1, P2, P3;
+    int    NumSegments;
+    ImU32  Color;
+    float  Thickness;
+    bool   AntiAliased;
+};
+
+// A range of a draw channel, delimited by index buffer offsets. The draw command indices tell apart
+// the empty commands (i.e. callbacks) issued right before and right after each boundary.
+struct ImDrawChannelRange
+{
+    int IdxBegin, IdxEnd;
+    int CmdBegin, CmdEnd;
+};
+
+// The ranges holding a node's geometry in the shared node background and foreground draw channels.
+struct ImNodeDrawRange
+{
+    ImDrawChannelRange Background;
+    ImDrawChannelRange Foreground;
+};
+
+// Binary editor state, as written by SaveEditorStateToBinaryFile(). The data is a header followed by
+// NodeCount node records. All fields are 4 bytes wide and little-endian, so a memory-mapped file can
+// be read in place.
+#define IMNODES_BINARY_STATE_MAGIC 0x424e4d49u // "IMNB"
+#define IMNODES_BINARY_STATE_VERSION 3u
+
+struct ImNodesBinaryStateHeader
+{
+    ImU32 Magic;
+    ImU32 Version;
+    // Sizes of the header and of a node record. Readers skip fields appended by newer versions.
+    ImU32 HeaderSize;
+    ImU32 NodeRecordSize;
+    ImU32 NodeCount;
+    float PanningX, PanningY;
+    // Added in version 2: the oldest reader version able to read the data. A version which only
+    // appends fields leaves it unchanged, so older readers still accept the data; any other layout
+    // change raises it to the new version. Version 1 data doesn't have it and is read as version 1.
+    ImU32 MinReaderVersion;
+    // Added in version 3: the generation of the journal written on top of this snapshot by
+    // SaveEditorStateToJournal(), or 0. A journal of another generation doesn't apply to it.
+    ImU32 JournalGeneration;
+};
+
+// Size of the version 1 header, which ends before MinReaderVersion
+#define IMNODES_BINARY_STATE_V1_HEADER_SIZE ((ImU32)offsetof(ImNodesBinaryStateHeader, MinReaderVersion))
+
+struct ImNodesBinaryStateNode
+{
+    int   Id;
+    float OriginX, OriginY;
+};
+
+// Journal written by SaveEditorStateToJournal(). The header is followed by frames, each holding the
+// panning and the nodes moved since the previous frame. A frame cut short by an interrupted write
+// is ignored when the journal is replayed, and so is a journal whose generation differs from the
+// snapshot's, which a crash between writing a new snapshot and emptying the journal leaves behind.
+#define IMNODES_JOURNAL_MAGIC 0x4a4e4d49u // "IMNJ"
+#define IMNODES_JOURNAL_VERSION 2u
+
+struct ImNodesJournalHeader
+{
+    ImU32 Magic;
+    ImU32 Version;
+    ImU32 HeaderSize;
+    ImU32 NodeRecordSize;
+    ImU32 Generation;
+};
+
+struct ImNodesJournalFrame
+{
+    ImU32 NodeCount; // Number of ImNodesBinaryStateNode records following the frame
+    float PanningX, PanningY;
+};
+
+// The pin shapes rasterized into a font atlas by AddPinShapesToFontAtlas(). Each shape is a square
+// glyph centered on the pin position.
+struct ImPinShapeAtlas
+{
+    ImFontAtlas* Atlas;
+    int          TexWidth, TexHeight;
+
+    // The style values the shapes were rasterized with
+    float PinCircleRadius;
+    float PinQuadSideLength;
+    float PinTriangleSideLength;
+    float PinLineThickness;
+
+    int    RectIds[ImNodesPinShape_COUNT];
+    int    HalfSize[ImNodesPinShape_COUNT];
+    ImVec2 UvMin[ImNodesPinShape_COUNT];
+    ImVec2 UvMax[ImNodesPinShape_COUNT];
+
+    ImPinShapeAtlas()
+        : Atlas(NULL), TexWidth(0), TexHeight(0), PinCircleRadius(0.f), PinQuadSideLength(0.f),
+          PinTriangleSideLength(0.f), PinLineThickness(0.f)
+    {
+        for (int i = 0; i < ImNodesPinShape_COUNT; ++i)
+        {
+            RectIds[i] = -1;
+            HalfSize[i] = 0;
+        }
+    }
+};
+
 struct ImClickInteractionState
 {
     ImNodesClickInteractionType Type;
@@ -265,9 +389,24 @@ struct ImNodesEditorContext
     ImVector<ImVec2> SelectedNodeOffsets;
     // Offset of the primary node origin relative to the mouse cursor.
     ImVec2 PrimaryNodeOffset;
+    // Origin of the primary node when the current node drag started
+    ImVec2 DragStartOrigin;
+    // Nodes moved by the last finished node drag, and the distance they moved in grid space
+    ImVector<int> DraggedNodeIds;
+    ImVec2        DragDelta;
 
     ImClickInteractionState ClickInteraction;
 
+    // Journaled saving state. ModifiedNodeIndices lists the nodes whose Modified flag was set, and
+    // may hold stale entries for nodes deleted since. JournalSize is the size of the journal file
+    // in bytes, or -1 if the next save has to write a new snapshot. JournalGeneration is the
+    // generation of the last snapshot loaded or written, bumped by every new snapshot.
+
+    ImVector<int> ModifiedNodeIndices;
+    ImVec2        JournalPanning;
+    ImS64         JournalSize;
+    ImU32         JournalGeneration;
+
     // Mini-map state set by MiniMap()
 
     bool                                       MiniMapEnabled;
@@ -282,11 +421,21 @@ struct ImNodesEditorContext
     ImRect MiniMapContentScreenSpace;
     float  MiniMapScaling;
 
+    // Mini-map contents, cached relative to MiniMapRectScreenSpace.Min. The contents are rebuilt
+    // when their hash changes, at most once every ImNodesIO::MiniMapRefreshInterval seconds.
+
+    ImDrawList  MiniMapCache;
+    ImU32       MiniMapCacheHash;
+    double      MiniMapCacheTime;
+    ImTextureID MiniMapCacheTexture;
+
     ImNodesEditorContext()
         : Nodes(), Pins(), Links(), Panning(0.f, 0.f), SelectedNodeIndices(), SelectedLinkIndices(),
-          SelectedNodeOffsets(), PrimaryNodeOffset(0.f, 0.f), ClickInteraction(),
-          MiniMapEnabled(false), MiniMapSizeFraction(0.0f), MiniMapNodeHoveringCallback(NULL),
-          MiniMapNodeHoveringCallbackUserData(NULL), MiniMapScaling(0.0f)
+          SelectedNodeOffsets(), PrimaryNodeOffset(0.f, 0.f), DragStartOrigin(0.f, 0.f),
+          DraggedNodeIds(), DragDelta(0.f, 0.f), ClickInteraction(),
+          ModifiedNodeIndices(), JournalPanning(0.f, 0.f), JournalSize(-1), JournalGeneration(0), MiniMapEnabled(false), MiniMapSizeFraction(0.0f), MiniMapNodeHoveringCallback(NULL),
+          MiniMapNodeHoveringCallbackUserData(NULL), MiniMapScaling(0.0f), MiniMapCache(NULL),
+          MiniMapCacheHash(0), MiniMapCacheTime(-FLT_MAX), MiniMapCacheTexture()
     {
     }
 };
@@ -303,6 +452,22 @@ struct ImNodesContext
     ImVector<int> NodeIndicesOverlappingWithMouse;
     ImVector<int> OccludedPinIndices;
 
+    // Node geometry ranges indexed by submission index, and scratch memory for reordering them by
+    // depth in EndNodeEditor()
+    ImVector<ImNodeDrawRange> NodeDrawRanges;
+    ImVector<ImDrawCmd>       NodeDrawCmdScratch;
+    ImVector<ImDrawIdx>       NodeDrawIdxScratch;
+
+    // Links queued during EndNodeEditor(), and scratch memory for tessellating them
+    ImVector<ImLinkBatchEntry> LinkBatch;
+    ImVector<float>            LinkBatchScratch;
+
+    // Pin shapes pre-rasterized into the font atlas
+    ImPinShapeAtlas PinShapeAtlas;
+
+    // Worker thread writing asynchronous saves, created by the first one
+    ImNodesSaveQueue* SaveQueue;
+
     // Canvas extents
     ImVec2 CanvasOriginScreenSpace;
     ImRect CanvasRectScreenSpace;
@@ -316,6 +481,7 @@ struct ImNodesContext
     ImVector<ImNodesColElement>      ColorModifierStack;
     ImVector<ImNodesStyleVarElement> StyleModifierStack;
     ImGuiTextBuffer                  TextBuffer;
+    ImVector<char>                   BinaryBuffer;
 
     int           CurrentAttributeFlags;
     ImVector<int> AttributeFlagStack;
@@ -497,4 +663,20 @@ static inline T& ObjectPoolFindOrCreateObject(ImObjectPool<T>& objects, const in
     const int index = ObjectPoolFindOrCreateIndex(objects, id);
     return objects.Pool[index];
 }
+
+// [SECTION] link batch renderer
+
+// Tessellates the link curves into the draw list. The output is equivalent to calling
+// ImDrawList::AddBezierCubic() for each entry in order, but the curves are evaluated and stroked in
+// bulk, and the geometry of consecutive links is written into a single reserved region of the draw
+// list.
+void LinkBatchRender(
+    ImDrawList*             draw_list,
+    const ImLinkBatchEntry* entries,
+    int                     count,
+    ImNodesLinkBatchKernel  kernel = ImNodesLinkBatchKernel_Simd);
+
+// Returns the name of the instruction set used by ImNodesLinkBatchKernel_Simd, or NULL if imnodes was
+// compiled without SIMD support (or with IMNODES_DISABLE_SIMD defined).
+const char* LinkBatchSimdInstructionSet();
 } // namespace IMNODES_NAMESPACE